@@ -0,0 +1,391 @@
+//
+//  Benchmark.cpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+//  Times each stage of the pipeline over a fixed corpus of meshes and writes
+//  the results as JSON so they can be compared between releases.
+//
+//  usage: 5AxLerBench [--repeat N] [--sizes N,N,...] [--shapes sphere,torus,...] [--output file.json] [file.STL ...]
+//
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/resource.h>
+
+#ifdef __APPLE__
+#include <mach/mach.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "../libs/rapidjson/prettywriter.h"
+#include "../libs/rapidjson/stringbuffer.h"
+#include "../libs/Cura/utils/OutputBuffer.h"
+
+#include "../src/Utility.hpp"
+#include "../src/Mesh.hpp"
+#include "../src/MeshGenerator.hpp"
+#include "../src/MemoryTracker.hpp"
+#include "../src/ProcessSTL.hpp"
+#include "../src/Slicer.hpp"
+#include "../src/BuildMap.hpp"
+#include "../src/DirectedGraph.hpp"
+
+#define DEFAULT_REPEAT 5
+#define CUSP_GRID_STEP_DEGREES 10.0 //spacing of the directions sampled by the cusp height grid stage
+
+using namespace mapmqp;
+using namespace std;
+
+namespace {
+    //timing samples of one stage, along with how many items (triangles, layers, ...) one run processes
+    struct StageResult {
+        string name;
+        string unit;
+        double itemsPerRun = 0;
+        vector<double> milliseconds;
+        long rssKilobytes = 0; //resident set size once the stage is done
+        long rssGrowthKilobytes = 0; //how much the stage grew the resident set size, i.e. what it allocated and kept
+        long peakRssKilobytes = 0; //highest resident set size of the process up to the end of the stage
+        bool failed = false; //the stage reported an error, so its samples time an aborted run
+    };
+
+    //current resident set size of the process
+    long rssKilobytes() {
+#ifdef __APPLE__
+        mach_task_basic_info info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+            return 0;
+        }
+        return info.resident_size / 1024;
+#else
+        long size = 0, pages = 0;
+        FILE * statm = fopen("/proc/self/statm", "r");
+        if (statm) {
+            if (fscanf(statm, "%ld %ld", &size, &pages) != 2) {
+                pages = 0;
+            }
+            fclose(statm);
+        }
+        return pages * (sysconf(_SC_PAGESIZE) / 1024);
+#endif
+    }
+
+    //highest resident set size of the process so far
+    long peakRssKilobytes() {
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024; //bytes on macOS
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+
+    //runs a stage repeat times, setup is run before each sample and is not timed; run returns the number of items it processed
+    StageResult timeStage(string name, string unit, unsigned int repeat, function<void()> setup, function<double()> run) {
+        StageResult result;
+        result.name = name;
+        result.unit = unit;
+        long rssBefore = rssKilobytes();
+        for (unsigned int i = 0; i < repeat; i++) {
+            setup();
+            int64_t start = Clock::monotonicTime();
+            result.itemsPerRun = run();
+            result.milliseconds.push_back((Clock::monotonicTime() - start) / 1e6);
+        }
+        result.rssKilobytes = rssKilobytes();
+        result.rssGrowthKilobytes = result.rssKilobytes - rssBefore;
+        result.peakRssKilobytes = peakRssKilobytes();
+        return result;
+    }
+
+    //nearest-rank percentile of a set of samples
+    double percentile(vector<double> samples, double p) {
+        sort(samples.begin(), samples.end());
+        size_t rank = static_cast<size_t>(ceil(p * samples.size()));
+        return samples[(rank > 0) ? rank - 1 : 0];
+    }
+
+    //a stage that processed no items without reporting an error timed nothing, so none of the results of its input can be trusted
+    bool processedItems(const vector<StageResult> & results) {
+        for (vector<StageResult>::const_iterator it = results.begin(); it != results.end(); it++) {
+            if ((it->itemsPerRun <= 0) && !it->failed) {
+                writeLog(ERROR, "stage %s processed no items", it->name.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //times the stages that work on a mesh once it has been loaded
+    void benchmarkMesh(shared_ptr<Mesh> p_mesh, unsigned int repeat, vector<StageResult> & results) {
+        double faceCount = p_mesh->p_faces().size();
+
+        //the first plane is half a layer above the lowest vertex, so that it cuts through the mesh instead of along its bottom faces
+        SlicerConfig config;
+        double lowestZ = 0;
+        for (vector<shared_ptr<Mesh::Vertex>>::const_iterator it = p_mesh->p_vertices().begin(); it != p_mesh->p_vertices().end(); it++) {
+            lowestZ = (it == p_mesh->p_vertices().begin()) ? (*it)->vertex().z() : min(lowestZ, (*it)->vertex().z());
+        }
+        Plane firstPlane(Vector3D(0, 0, 1), lowestZ + config.layerHeight / 2);
+        results.push_back(timeStage("slicing", "layers/s", repeat, [](){ }, [&]() {
+            Slicer slicer(p_mesh, config);
+            double layers = 0;
+            for (Slicer::Slice slice = slicer.slice(firstPlane); slice.islands().size() > 0; slice = slicer.nextSlice()) {
+                layers++;
+            }
+            return layers;
+        }));
+
+        //the stages which use the build map are skipped when it can't be solved, and a failed stage reports no throughput
+        shared_ptr<BuildMap> p_buildMap;
+        bool solved = true;
+        results.push_back(timeStage("build_map_solve", "faces/s", repeat, [&]() {
+            p_buildMap.reset(new BuildMap(p_mesh, config));
+        }, [&]() {
+            solved = p_buildMap->solve() && solved;
+            return solved ? faceCount : 0;
+        }));
+        results.back().failed = !solved;
+        if (!solved) {
+            writeLog(ERROR, "unable to solve the build map, skipping the stages which use it");
+        } else {
+            bool foundVector = true;
+            results.push_back(timeStage("find_best_vector", "faces/s", repeat, [](){ }, [&]() {
+                foundVector = !(p_buildMap->findBestVector() == Vector3D(0, 0, 0)) && foundVector;
+                return foundVector ? faceCount : 0;
+            }));
+            results.back().failed = !foundVector;
+
+            results.push_back(timeStage("cusp_height_grid", "directions/s", repeat, [](){ }, [&]() {
+                double directions = 0;
+                for (double theta = 0; theta < 360.0; theta += CUSP_GRID_STEP_DEGREES) {
+                    for (double phi = 0; phi <= 90.0; phi += CUSP_GRID_STEP_DEGREES) {
+                        p_buildMap->averageCuspHeight(Vector3D(Angle(Angle::degreesToRadians(theta)), Angle(Angle::degreesToRadians(phi))));
+                        directions++;
+                    }
+                }
+                return directions;
+            }));
+        }
+
+        //writes an extrusion move to every corner of every face, formatted the way the gcode exporter writes them
+        ostringstream gcode;
+        results.push_back(timeStage("gcode_write", "lines/s", repeat, [&gcode]() {
+            gcode.str("");
+        }, [&]() {
+            cura::OutputBuffer output(&gcode);
+            double extruded = 0;
+            double lines = 0;
+            for (vector<shared_ptr<Mesh::Face>>::const_iterator it = p_mesh->p_faces().begin(); it != p_mesh->p_faces().end(); it++) {
+                for (uint16_t i = 0; i < 3; i++) {
+                    const Vector3D & vertex = (*it)->p_vertex(i)->vertex();
+                    extruded += 0.0123;
+                    output << "G1 X" << cura::MMtoStream{llround(vertex.x() * 1000)} << " Y" << cura::MMtoStream{llround(vertex.y() * 1000)}
+                        << " Z" << cura::MMtoStream{llround(vertex.z() * 1000)} << " E" << cura::PrecisionedDouble{5, extruded} << '\n';
+                    lines++;
+                }
+            }
+            output.flush();
+            return lines;
+        }));
+
+        //faces are connected to the neighbors at or above them, flat regions become strongly connected components
+        DirectedGraph<int> graph;
+        unordered_map<const Mesh::Face *, int> faceIndices;
+        for (unsigned int i = 0; i < p_mesh->p_faces().size(); i++) {
+            faceIndices[p_mesh->p_faces()[i].get()] = graph.addVertex(i);
+        }
+        for (vector<shared_ptr<Mesh::Face>>::const_iterator it = p_mesh->p_faces().begin(); it != p_mesh->p_faces().end(); it++) {
+            double height = (*it)->p_vertex(0)->vertex().z() + (*it)->p_vertex(1)->vertex().z() + (*it)->p_vertex(2)->vertex().z();
+            for (uint16_t i = 0; i < 3; i++) {
+                shared_ptr<const Mesh::Face> p_neighbor = (*it)->p_connectedFace(i);
+                if (p_neighbor && (p_neighbor->p_vertex(0)->vertex().z() + p_neighbor->p_vertex(1)->vertex().z() + p_neighbor->p_vertex(2)->vertex().z() >= height)) {
+                    graph.addDirectedEdge(faceIndices[it->get()], faceIndices[p_neighbor.get()]);
+                }
+            }
+        }
+        results.push_back(timeStage("graph_scc", "vertices/s", repeat, [](){ }, [&graph]() {
+            graph.findCycles();
+            return static_cast<double>(graph.elements().size());
+        }));
+    }
+
+    void writeResults(rapidjson::PrettyWriter<rapidjson::StringBuffer> & writer, const string & name, size_t triangleCount, const vector<StageResult> & results) {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(name.c_str());
+        writer.Key("triangles");
+        writer.Uint64(triangleCount);
+        writer.Key("stages");
+        writer.StartArray();
+        for (vector<StageResult>::const_iterator it = results.begin(); it != results.end(); it++) {
+            double median = percentile(it->milliseconds, 0.5);
+            writer.StartObject();
+            writer.Key("stage");
+            writer.String(it->name.c_str());
+            writer.Key("samples");
+            writer.Uint(it->milliseconds.size());
+            writer.Key("median_ms");
+            writer.Double(median);
+            writer.Key("p95_ms");
+            writer.Double(percentile(it->milliseconds, 0.95));
+            writer.Key("throughput");
+            writer.Double((median > 0) ? it->itemsPerRun * 1000.0 / median : 0);
+            writer.Key("throughput_unit");
+            writer.String(it->unit.c_str());
+            writer.Key("rss_kb");
+            writer.Int64(it->rssKilobytes);
+            writer.Key("rss_growth_kb");
+            writer.Int64(it->rssGrowthKilobytes);
+            writer.Key("peak_rss_kb");
+            writer.Int64(it->peakRssKilobytes);
+            writer.Key("failed");
+            writer.Bool(it->failed);
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+}
+
+int main(int argc, const char * argv[]) {
+    unsigned int repeat = DEFAULT_REPEAT;
+    vector<unsigned int> generatedSizes = {20000, 100000}; //triangle counts of the generated meshes
+    vector<string> generatedShapes = MeshGenerator::shapes();
+    string outputPath;
+    vector<string> stlFilePaths;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if ((arg == "--repeat") && (i + 1 < argc)) {
+            repeat = max(1, atoi(argv[++i]));
+        } else if ((arg == "--sizes") && (i + 1 < argc)) {
+            generatedSizes.clear();
+            for (const char * size = argv[++i]; *size; size += strspn(size, ",")) {
+                char * end;
+                generatedSizes.push_back(strtoul(size, &end, 10));
+                size = end;
+            }
+        } else if ((arg == "--shapes") && (i + 1 < argc)) {
+            generatedShapes.clear();
+            stringstream shapes(argv[++i]);
+            for (string shape; getline(shapes, shape, ','); ) {
+                generatedShapes.push_back(shape);
+            }
+        } else if ((arg == "--output") && (i + 1 < argc)) {
+            outputPath = argv[++i];
+        } else {
+            stlFilePaths.push_back(arg);
+        }
+    }
+    if (stlFilePaths.empty()) {
+        stlFilePaths.push_back("./tests/stl/F.STL");
+        stlFilePaths.push_back("./tests/stl/Pillar.STL");
+        stlFilePaths.push_back("./tests/stl/Tee.STL");
+    }
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("date");
+    writer.String(Clock::wallTimeString().c_str());
+    writer.Key("repeat");
+    writer.Uint(repeat);
+    writer.Key("inputs");
+    writer.StartArray();
+
+    for (vector<string>::iterator it = stlFilePaths.begin(); it != stlFilePaths.end(); it++) {
+        vector<StageResult> results;
+        vector<Vector3D> points, vertices;
+        vector<array<uint32_t, 3>> triangles;
+        shared_ptr<Mesh> p_mesh;
+
+        bool read = true;
+        results.push_back(timeStage("stl_parse", "triangles/s", repeat, [](){ }, [&]() {
+            read = ProcessSTL::readSTL(*it, points);
+            return points.size() / 3.0;
+        }));
+        if (!read) {
+            writeLog(ERROR, "skipping benchmark of %s", it->c_str());
+            continue;
+        }
+        results.push_back(timeStage("welding", "triangles/s", repeat, [](){ }, [&]() {
+            ProcessSTL::weldVertices(points, vertices, triangles);
+            return static_cast<double>(triangles.size());
+        }));
+        results.push_back(timeStage("adjacency", "triangles/s", repeat, [](){ }, [&]() {
+            p_mesh.reset(new Mesh());
+            p_mesh->addShell(vertices, triangles);
+            return static_cast<double>(triangles.size());
+        }));
+
+        benchmarkMesh(p_mesh, repeat, results);
+        if (!processedItems(results)) {
+            writeLog(ERROR, "benchmark of %s failed", it->c_str());
+            return 1;
+        }
+        writeResults(writer, *it, triangles.size(), results);
+        MEMORY_REPORT(it->c_str());
+    }
+
+    //generated meshes show how each stage scales with the number of triangles
+    for (vector<string>::iterator shape = generatedShapes.begin(); shape != generatedShapes.end(); shape++) {
+        for (unsigned int size : generatedSizes) {
+            vector<StageResult> results;
+            vector<Vector3D> vertices;
+            vector<array<uint32_t, 3>> triangles;
+            if (!MeshGenerator::generate(*shape, size, vertices, triangles)) {
+                break; //unknown shape
+            }
+
+            shared_ptr<Mesh> p_mesh;
+            results.push_back(timeStage("adjacency", "triangles/s", repeat, [](){ }, [&]() {
+                p_mesh.reset(new Mesh());
+                p_mesh->addShell(vertices, triangles);
+                return static_cast<double>(triangles.size());
+            }));
+
+            benchmarkMesh(p_mesh, repeat, results);
+            if (!processedItems(results)) {
+                writeLog(ERROR, "benchmark of %s-%u failed", shape->c_str(), size);
+                return 1;
+            }
+            writeResults(writer, *shape + "-" + to_string(size), triangles.size(), results);
+            MEMORY_REPORT((*shape + "-" + to_string(size)).c_str());
+        }
+    }
+
+    writer.EndArray();
+    writer.EndObject();
+
+    if (outputPath.empty()) {
+        printf("%s\n", buffer.GetString());
+    } else {
+        FILE * file = fopen(outputPath.c_str(), "w");
+        if (!file) {
+            writeLog(ERROR, "unable to open benchmark output file %s", outputPath.c_str());
+            return 1;
+        }
+        fprintf(file, "%s\n", buffer.GetString());
+        fclose(file);
+        writeLog(INFO, "wrote benchmark results to %s", outputPath.c_str());
+    }
+
+    return 0;
+}
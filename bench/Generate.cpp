@@ -0,0 +1,42 @@
+//
+//  Generate.cpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+//  Writes a generated mesh to a binary STL file, for reproducing large inputs
+//  outside of the benchmark.
+//
+//  usage: 5AxLerGenerate shape triangles file.STL
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "../src/Utility.hpp"
+#include "../src/MeshGenerator.hpp"
+#include "../src/ProcessSTL.hpp"
+
+using namespace mapmqp;
+using namespace std;
+
+int main(int argc, const char * argv[]) {
+    if (argc != 4) {
+        string shapes;
+        for (const string & shape : MeshGenerator::shapes()) {
+            shapes += (shapes.empty() ? "" : "|") + shape;
+        }
+        fprintf(stderr, "usage: %s %s triangles file.STL\n", argv[0], shapes.c_str());
+        return 1;
+    }
+
+    vector<Vector3D> vertices;
+    vector<MeshGenerator::Triangle> triangles;
+    if (!MeshGenerator::generate(argv[1], strtoull(argv[2], nullptr, 10), vertices, triangles)) {
+        return 1;
+    }
+    return ProcessSTL::writeSTL(argv[3], vertices, triangles) ? 0 : 1;
+}
@@ -0,0 +1,400 @@
+/** Copyright (C) 2017 Ultimaker - Released under terms of the AGPLv3 License */
+#include "BinaryGCode.h"
+
+#include <algorithm> // find
+#include <cstring> // memcmp
+
+#include "utils/string.h" // writeInt2mmToBuffer, writeFixedPointToBuffer
+
+namespace cura
+{
+
+namespace
+{
+
+/*!
+ * A parameter of a move, in the order in which they are written.
+ */
+struct MoveParameter
+{
+    char letter;
+    uint8_t flag;
+    unsigned int precision; //!< The number of digits after the decimal dot of the integer the value is stored as
+};
+
+constexpr size_t parameter_count = 5;
+constexpr MoveParameter parameters[parameter_count] = {
+    {'F', BinaryGCode::HAS_F, 1},
+    {'X', BinaryGCode::HAS_X, 3},
+    {'Y', BinaryGCode::HAS_Y, 3},
+    {'Z', BinaryGCode::HAS_Z, 3},
+    {'E', BinaryGCode::HAS_E, 5}
+};
+constexpr size_t first_position_parameter = 1; //!< X, Y, Z and E are stored as the difference with their last value
+
+/*!
+ * Write the value of a parameter the way GCodeExport writes it.
+ *
+ * \return The number of characters written
+ */
+int writeParameterValue(const size_t parameter_idx, const int64_t value, char* buffer)
+{
+    const char letter = parameters[parameter_idx].letter;
+    if (letter == 'X' || letter == 'Y' || letter == 'Z')
+    {
+        return writeInt2mmToBuffer(value, buffer);
+    }
+    if (value < 0)
+    {
+        buffer[0] = '-';
+        return 1 + writeFixedPointToBuffer(-static_cast<uint64_t>(value), parameters[parameter_idx].precision, buffer + 1);
+    }
+    return writeFixedPointToBuffer(value, parameters[parameter_idx].precision, buffer);
+}
+
+/*!
+ * Parse a decimal number with at most \p precision digits after the decimal dot into an integer.
+ *
+ * \param[out] value The number times 10^precision
+ * \return Whether the text was such a number
+ */
+bool parseFixedPoint(const char* begin, const char* end, const unsigned int precision, int64_t& value)
+{
+    constexpr unsigned int max_digit_count = 18; // so that the value can't overflow
+    const bool is_negative = begin < end && *begin == '-';
+    const char* pos = begin + is_negative;
+    uint64_t magnitude = 0;
+    unsigned int digit_count = 0;
+    int decimal_count = -1; // the number of digits after the dot, if there is a dot
+    for (; pos < end; pos++)
+    {
+        if (*pos == '.' && decimal_count < 0)
+        {
+            decimal_count = 0;
+            continue;
+        }
+        if (*pos < '0' || *pos > '9' || ++digit_count > max_digit_count)
+        {
+            return false;
+        }
+        magnitude = magnitude * 10 + (*pos - '0');
+        if (decimal_count >= 0)
+        {
+            decimal_count++;
+        }
+    }
+    if (digit_count == 0 || decimal_count > static_cast<int>(precision))
+    {
+        return false;
+    }
+    for (int decimal_idx = std::max(decimal_count, 0); decimal_idx < static_cast<int>(precision); decimal_idx++)
+    {
+        magnitude *= 10;
+    }
+    value = is_negative ? -static_cast<int64_t>(magnitude) : magnitude;
+    return true;
+}
+
+void writeVarint(uint64_t value, std::string& output)
+{
+    while (value >= 0x80)
+    {
+        output.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    output.push_back(static_cast<char>(value));
+}
+
+/*!
+ * \return Whether the varint was complete
+ */
+bool readVarint(const char*& pos, const char* end, uint64_t& value)
+{
+    value = 0;
+    for (unsigned int shift = 0; pos < end && shift < 64; shift += 7)
+    {
+        const uint8_t byte = *pos++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t zigzagEncode(const int64_t value)
+{ // small negative numbers become small positive numbers
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t zigzagDecode(const uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+}//anonymous namespace
+
+BinaryGCodeEncoder::BinaryGCodeEncoder()
+: header_is_written(false)
+, last_position{0, 0, 0, 0}
+{
+}
+
+void BinaryGCodeEncoder::encode(const char* data, size_t size, std::string& output)
+{
+    if (!header_is_written)
+    {
+        output.append(BinaryGCode::magic, sizeof(BinaryGCode::magic));
+        header_is_written = true;
+    }
+    const char* end = data + size;
+    const char* line_start = data;
+    if (!incomplete_line.empty())
+    { // finish the line started in the previous data
+        const char* line_end = std::find(data, end, '\n');
+        incomplete_line.append(data, line_end - data + (line_end < end));
+        if (line_end == end)
+        {
+            return;
+        }
+        encodeLine(incomplete_line.data(), incomplete_line.size(), output);
+        incomplete_line.clear();
+        line_start = line_end + 1;
+    }
+    while (true)
+    {
+        const char* line_end = std::find(line_start, end, '\n');
+        if (line_end == end)
+        {
+            incomplete_line.assign(line_start, end);
+            break;
+        }
+        encodeLine(line_start, line_end + 1 - line_start, output);
+        line_start = line_end + 1;
+    }
+    writeLiteralText(output);
+}
+
+void BinaryGCodeEncoder::flush(std::string& output)
+{
+    encode(nullptr, 0, output); // writes the header if nothing has been encoded yet
+    literal_text.append(incomplete_line);
+    incomplete_line.clear();
+    writeLiteralText(output);
+}
+
+void BinaryGCodeEncoder::finish(std::string& output)
+{
+    flush(output);
+}
+
+void BinaryGCodeEncoder::encodeLine(const char* line, size_t length, std::string& output)
+{
+    const char* end = line + length - 1; // before the line ending
+    uint8_t flags = 0;
+    int64_t values[parameter_count];
+    bool is_move = length > 3 && line[0] == 'G' && (line[1] == '0' || line[1] == '1');
+    if (is_move)
+    {
+        flags = (line[1] == '1') ? BinaryGCode::IS_EXTRUSION : 0;
+        const char* pos = line + 2;
+        for (size_t parameter_idx = 0; parameter_idx < parameter_count && is_move; parameter_idx++)
+        {
+            if (end - pos < 2 || pos[0] != ' ' || pos[1] != parameters[parameter_idx].letter)
+            {
+                continue;
+            }
+            const char* value_start = pos + 2;
+            const char* value_end = std::find(value_start, end, ' ');
+            char formatted[32];
+            is_move = parseFixedPoint(value_start, value_end, parameters[parameter_idx].precision, values[parameter_idx])
+                && writeParameterValue(parameter_idx, values[parameter_idx], formatted) == value_end - value_start
+                && memcmp(formatted, value_start, value_end - value_start) == 0; // only if decoding gives the exact same text
+            flags |= parameters[parameter_idx].flag;
+            pos = value_end;
+        }
+        is_move = is_move && pos == end && (flags & ~BinaryGCode::IS_EXTRUSION) != 0;
+    }
+    if (!is_move)
+    {
+        literal_text.append(line, length);
+        return;
+    }
+
+    writeLiteralText(output);
+    output.push_back(static_cast<char>(BinaryGCode::move_tag | flags));
+    if (flags & BinaryGCode::HAS_F)
+    {
+        auto feedrate_index = feedrate_indices.find(values[0]);
+        if (feedrate_index != feedrate_indices.end())
+        {
+            output.push_back(static_cast<char>(feedrate_index->second));
+        }
+        else
+        {
+            output.push_back(static_cast<char>(BinaryGCode::new_feedrate));
+            writeVarint(values[0], output);
+            if (feedrate_indices.size() < BinaryGCode::max_feedrate_count)
+            {
+                const uint8_t new_index = feedrate_indices.size();
+                feedrate_indices.emplace(values[0], new_index);
+            }
+        }
+    }
+    for (size_t parameter_idx = first_position_parameter; parameter_idx < parameter_count; parameter_idx++)
+    {
+        if (flags & parameters[parameter_idx].flag)
+        {
+            int64_t& last_value = last_position[parameter_idx - first_position_parameter];
+            writeVarint(zigzagEncode(values[parameter_idx] - last_value), output);
+            last_value = values[parameter_idx];
+        }
+    }
+}
+
+void BinaryGCodeEncoder::writeLiteralText(std::string& output)
+{
+    if (literal_text.empty())
+    {
+        return;
+    }
+    output.push_back(static_cast<char>(BinaryGCode::literal_tag));
+    writeVarint(literal_text.size(), output);
+    output.append(literal_text);
+    literal_text.clear();
+}
+
+BinaryGCodeDecoder::BinaryGCodeDecoder()
+: header_is_read(false)
+, last_position{0, 0, 0, 0}
+{
+}
+
+bool BinaryGCodeDecoder::decode(const char* data, size_t size, std::string& output)
+{
+    pending_input.append(data, size);
+    const char* pos = pending_input.data();
+    const char* end = pos + pending_input.size();
+    if (!header_is_read)
+    {
+        const size_t header_size = sizeof(BinaryGCode::magic);
+        if (memcmp(pos, BinaryGCode::magic, std::min(pending_input.size(), header_size)) != 0)
+        {
+            return false;
+        }
+        if (pending_input.size() < header_size)
+        {
+            return true;
+        }
+        pos += header_size;
+        header_is_read = true;
+    }
+    bool is_valid = true;
+    while (decodeRecord(pos, end, output, is_valid))
+    {
+    }
+    pending_input.erase(0, pos - pending_input.data());
+    return is_valid;
+}
+
+bool BinaryGCodeDecoder::isComplete() const
+{
+    return header_is_read && pending_input.empty();
+}
+
+bool BinaryGCodeDecoder::decodeRecord(const char*& pos, const char* end, std::string& output, bool& is_valid)
+{
+    const char* record_pos = pos;
+    if (record_pos == end)
+    {
+        return false;
+    }
+    const uint8_t tag = *record_pos++;
+    if (tag == BinaryGCode::literal_tag)
+    {
+        uint64_t length;
+        if (!readVarint(record_pos, end, length) || static_cast<uint64_t>(end - record_pos) < length)
+        {
+            return false;
+        }
+        output.append(record_pos, length);
+        pos = record_pos + length;
+        return true;
+    }
+    const uint8_t flags = tag & ~BinaryGCode::move_tag;
+    if (!(tag & BinaryGCode::move_tag) || flags > (BinaryGCode::HAS_X | BinaryGCode::HAS_Y | BinaryGCode::HAS_Z | BinaryGCode::HAS_E | BinaryGCode::HAS_F | BinaryGCode::IS_EXTRUSION))
+    {
+        is_valid = false;
+        return false;
+    }
+
+    // read the whole record before changing any state, in case it isn't complete yet
+    int64_t values[parameter_count];
+    bool is_new_feedrate = false;
+    if (flags & BinaryGCode::HAS_F)
+    {
+        if (record_pos == end)
+        {
+            return false;
+        }
+        const uint8_t feedrate_index = *record_pos++;
+        if (feedrate_index == BinaryGCode::new_feedrate)
+        {
+            uint64_t feedrate;
+            if (!readVarint(record_pos, end, feedrate))
+            {
+                return false;
+            }
+            values[0] = feedrate;
+            is_new_feedrate = true;
+        }
+        else if (feedrate_index < feedrates.size())
+        {
+            values[0] = feedrates[feedrate_index];
+        }
+        else
+        {
+            is_valid = false;
+            return false;
+        }
+    }
+    for (size_t parameter_idx = first_position_parameter; parameter_idx < parameter_count; parameter_idx++)
+    {
+        if (flags & parameters[parameter_idx].flag)
+        {
+            uint64_t delta;
+            if (!readVarint(record_pos, end, delta))
+            {
+                return false;
+            }
+            values[parameter_idx] = last_position[parameter_idx - first_position_parameter] + zigzagDecode(delta);
+        }
+    }
+
+    pos = record_pos;
+    if (is_new_feedrate && feedrates.size() < BinaryGCode::max_feedrate_count)
+    {
+        feedrates.push_back(values[0]);
+    }
+    output.append((flags & BinaryGCode::IS_EXTRUSION) ? "G1" : "G0");
+    for (size_t parameter_idx = 0; parameter_idx < parameter_count; parameter_idx++)
+    {
+        if (flags & parameters[parameter_idx].flag)
+        {
+            char buffer[32];
+            buffer[0] = ' ';
+            buffer[1] = parameters[parameter_idx].letter;
+            const int value_length = writeParameterValue(parameter_idx, values[parameter_idx], buffer + 2);
+            output.append(buffer, 2 + value_length);
+            if (parameter_idx >= first_position_parameter)
+            {
+                last_position[parameter_idx - first_position_parameter] = values[parameter_idx];
+            }
+        }
+    }
+    output.push_back('\n');
+    return true;
+}
+
+}//namespace cura
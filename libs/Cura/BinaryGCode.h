@@ -0,0 +1,129 @@
+/** Copyright (C) 2017 Ultimaker - Released under terms of the AGPLv3 License */
+#ifndef BINARY_GCODE_H
+#define BINARY_GCODE_H
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/EncodingOutputStream.h" // StreamEncoder
+
+namespace cura
+{
+
+/*!
+ * A compact binary encoding of gcode, which decodes to exactly the gcode it was made from.
+ *
+ * The encoding starts with the 8 byte \ref BinaryGCode::magic, followed by records which each start with a tag byte:
+ * - \ref BinaryGCode::literal_tag is followed by a varint length and that many bytes of gcode text, stored as is.
+ * - A tag with \ref BinaryGCode::move_tag set is a G0 or G1 move, see \ref BinaryGCode::MoveFlags for the remaining bits.
+ *   The feedrate (F) is a byte indexing the feedrates seen before, or \ref BinaryGCode::new_feedrate followed by a varint in 0.1 mm/min.
+ *   X, Y and Z are zigzag varints with the difference in micron from the last encoded value, E likewise in 0.00001 mm (or mm^3).
+ *
+ * Varints store 7 bits per byte, least significant first, with the high bit set on all but the last byte.
+ *
+ * Only moves written the way \ref GCodeExport writes them are encoded as moves: parameters in the order F, X, Y, Z, E,
+ * with coordinates written by \ref writeInt2mm and F and E by \ref writeDoubleToStream with a precision of 1 and 5.
+ * All other lines are stored as literal text.
+ */
+namespace BinaryGCode
+{
+    constexpr char magic[8] = {'C', 'u', 'r', 'a', 'B', 'G', 'C', 1}; //!< The start of every binary gcode stream, ending in the version of the format
+    constexpr uint8_t literal_tag = 0x00;
+    constexpr uint8_t move_tag = 0x80;
+    constexpr uint8_t new_feedrate = 0xFF; //!< Feedrate index saying that a feedrate follows, which is added to the feedrate table unless it is full
+    constexpr size_t max_feedrate_count = 255;
+
+    enum MoveFlags : uint8_t
+    {
+        HAS_X = 0x01,
+        HAS_Y = 0x02,
+        HAS_Z = 0x04,
+        HAS_E = 0x08,
+        HAS_F = 0x10,
+        IS_EXTRUSION = 0x20 //!< Whether the move is a G1 rather than a G0
+    };
+}
+
+/*!
+ * Encodes gcode text into binary gcode as it is written.
+ */
+class BinaryGCodeEncoder : public StreamEncoder
+{
+public:
+    BinaryGCodeEncoder();
+
+    void encode(const char* data, size_t size, std::string& output);
+
+    void flush(std::string& output); //!< Writes a line which hasn't been ended yet as literal text
+
+    void finish(std::string& output);
+
+private:
+    bool header_is_written;
+    std::string incomplete_line; //!< The start of a line of which the end hasn't been encoded yet
+    std::string literal_text; //!< Lines which can't be encoded as a move and haven't been written yet
+    int64_t last_position[4]; //!< The last encoded X, Y, Z and E
+    std::unordered_map<int64_t, uint8_t> feedrate_indices; //!< The index of each feedrate in the feedrate table
+
+    /*!
+     * Encode a complete line.
+     *
+     * \param line The start of the line
+     * \param length The length of the line, including the line ending
+     * \param[out] output Where to append the encoded line
+     */
+    void encodeLine(const char* line, size_t length, std::string& output);
+
+    /*!
+     * Write the literal text collected so far as a single record.
+     */
+    void writeLiteralText(std::string& output);
+};
+
+/*!
+ * Decodes binary gcode into gcode text, a piece at a time.
+ */
+class BinaryGCodeDecoder
+{
+public:
+    BinaryGCodeDecoder();
+
+    /*!
+     * Decode the next part of a binary gcode stream.
+     *
+     * Records which are cut off at the end of \p data are decoded once the rest has been given.
+     *
+     * \param data The next part of the binary gcode
+     * \param size The number of bytes in \p data
+     * \param[out] output Where to append the gcode
+     * \return False if the data isn't valid binary gcode
+     */
+    bool decode(const char* data, size_t size, std::string& output);
+
+    /*!
+     * Whether all data given to \ref BinaryGCodeDecoder::decode has been decoded, i.e. the stream doesn't end halfway a record.
+     */
+    bool isComplete() const;
+
+private:
+    bool header_is_read;
+    std::string pending_input; //!< The start of a record which hasn't been decoded yet
+    int64_t last_position[4]; //!< The last decoded X, Y, Z and E
+    std::vector<int64_t> feedrates; //!< The feedrate table
+
+    /*!
+     * Decode a single record.
+     *
+     * \param[in,out] pos The start of the record, which is moved to the end of the record if it is complete
+     * \param end The end of the available data
+     * \param[out] output Where to append the gcode
+     * \param[out] is_valid Set to false if the record isn't valid
+     * \return Whether the record was complete
+     */
+    bool decodeRecord(const char*& pos, const char* end, std::string& output, bool& is_valid);
+};
+
+}//namespace cura
+#endif//BINARY_GCODE_H
@@ -12,11 +12,13 @@
 #endif
 #include <stddef.h>
 #include <vector>
+#include <zlib.h>
 
 #include "utils/gettime.h"
 #include "utils/logoutput.h"
 #include "utils/string.h"
 
+#include "BinaryGCode.h"
 #include "FffProcessor.h"
 #include "settings/SettingRegistry.h"
 
@@ -46,7 +48,10 @@ void print_usage()
     logAlways("  -g\n\tSwitch setting focus to the current mesh group only.\n\tUsed for one-at-a-time printing.\n");
     logAlways("  -e<extruder_nr>\n\tSwitch setting focus to the extruder train with the given number.\n");
     logAlways("  --next\n\tGenerate gcode for the previously supplied mesh group and append that to \n\tthe gcode of further models for one-at-a-time printing.\n");
-    logAlways("  -o <output_file>\n\tSpecify a file to which to write the generated gcode.\n");
+    logAlways("  -o <output_file>\n\tSpecify a file to which to write the generated gcode.\n\tFiles ending in .gz are gzip compressed, files ending in .bgcode or .bgcode.gz contain binary gcode.\n");
+    logAlways("\n");
+    logAlways("CuraEngine decode <input.bgcode> [<output.gcode>]\n");
+    logAlways("\tDecode a binary gcode file, which may be gzip compressed, into plain gcode.\n\tWrites to stdout if no output file is given.\n");
     logAlways("\n");
     logAlways("The settings are appended to the last supplied object:\n");
     logAlways("CuraEngine slice [general settings] \n\t-g [current group settings] \n\t-e0 [extruder train 0 settings] \n\t-l obj_inheriting_from_last_extruder_train.stl [object settings] \n\t--next [next group settings]\n\t... etc.\n");
@@ -71,6 +76,80 @@ void print_call(int argc, char **argv)
     cura::logError("\n");
 }
 
+/*!
+ * Get the format in which to write gcode from the extension of the output file.
+ */
+GCodeOutputFormat getOutputFormat(const char* filename)
+{
+    const std::string name(filename);
+    auto hasExtension = [&name](const std::string& extension)
+    {
+        return name.size() >= extension.size() && stringcasecompare(name.c_str() + name.size() - extension.size(), extension.c_str()) == 0;
+    };
+    if (hasExtension(".bgcode.gz"))
+    {
+        return GCodeOutputFormat::BINARY_GZIP;
+    }
+    if (hasExtension(".bgcode"))
+    {
+        return GCodeOutputFormat::BINARY;
+    }
+    if (hasExtension(".gz"))
+    {
+        return GCodeOutputFormat::GZIP;
+    }
+    return GCodeOutputFormat::TEXT;
+}
+
+void decode(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        print_usage();
+        exit(1);
+    }
+    gzFile input = gzopen(argv[2], "rb"); // reads uncompressed files as well
+    if (!input)
+    {
+        cura::logError("Failed to open %s.\n", argv[2]);
+        exit(1);
+    }
+    FILE* output = stdout;
+    if (argc >= 4)
+    {
+        output = fopen(argv[3], "wb");
+        if (!output)
+        {
+            cura::logError("Failed to open %s for output.\n", argv[3]);
+            exit(1);
+        }
+    }
+    BinaryGCodeDecoder decoder;
+    std::vector<char> chunk(1 << 20);
+    std::string gcode;
+    int read_size;
+    while ((read_size = gzread(input, chunk.data(), chunk.size())) > 0)
+    {
+        gcode.clear();
+        if (!decoder.decode(chunk.data(), read_size, gcode))
+        {
+            cura::logError("%s is not a valid binary gcode file.\n", argv[2]);
+            exit(1);
+        }
+        fwrite(gcode.data(), 1, gcode.size(), output);
+    }
+    gzclose(input);
+    if (read_size < 0 || !decoder.isComplete())
+    {
+        cura::logError("Failed to read all of %s, the file may be truncated.\n", argv[2]);
+        exit(1);
+    }
+    if (output != stdout)
+    {
+        fclose(output);
+    }
+}
+
 void connect(int argc, char **argv)
 {
     std::string ip;
@@ -217,7 +296,7 @@ void slice(int argc, char **argv)
                         break;
                     case 'o':
                         argn++;
-                        if (!FffProcessor::getInstance()->setTargetFile(argv[argn]))
+                        if (!FffProcessor::getInstance()->setTargetFile(argv[argn], getOutputFormat(argv[argn])))
                         {
                             cura::logError("Failed to open %s for output.\n", argv[argn]);
                             exit(1);
@@ -339,6 +418,10 @@ int cura_main(int argc, char **argv)
     {
         slice(argc, argv);
     }
+    else if (stringcasecompare(argv[1], "decode") == 0)
+    {
+        decode(argc, argv);
+    }
     else if (stringcasecompare(argv[1], "help") == 0)
     {
         print_usage();
@@ -1,15 +1,76 @@
 
 #include <list>
+#include <utility> // swap
 
 #include "utils/math.h"
+#include "utils/ThreadPool.h"
 #include "FffGcodeWriter.h"
 #include "FffProcessor.h"
+#include "BinaryGCode.h"
 #include "progress/Progress.h"
 #include "wallOverlap.h"
 
 namespace cura
 {
 
+namespace setting_keys
+{
+// Settings queried per layer, per part or per path, see SettingKey
+const SettingKey adhesion_extruder_nr("adhesion_extruder_nr");
+const SettingKey bottom_layers("bottom_layers");
+const SettingKey draft_shield_enabled("draft_shield_enabled");
+const SettingKey draft_shield_height("draft_shield_height");
+const SettingKey extruder_nr("extruder_nr");
+const SettingKey infill_before_walls("infill_before_walls");
+const SettingKey infill_line_distance("infill_line_distance");
+const SettingKey infill_overlap_mm("infill_overlap_mm");
+const SettingKey infill_sparse_thickness("infill_sparse_thickness");
+const SettingKey infill_wipe_dist("infill_wipe_dist");
+const SettingKey layer_height("layer_height");
+const SettingKey layer_height_0("layer_height_0");
+const SettingKey magic_spiralize("magic_spiralize");
+const SettingKey outer_inset_first("outer_inset_first");
+const SettingKey prime_tower_enable("prime_tower_enable");
+const SettingKey prime_tower_wipe_enabled("prime_tower_wipe_enabled");
+const SettingKey skin_alternate_rotation("skin_alternate_rotation");
+const SettingKey skin_overlap_mm("skin_overlap_mm");
+const SettingKey support_connect_zigzags("support_connect_zigzags");
+const SettingKey support_extruder_nr_layer_0("support_extruder_nr_layer_0");
+const SettingKey support_infill_extruder_nr("support_infill_extruder_nr");
+const SettingKey support_interface_extruder_nr("support_interface_extruder_nr");
+const SettingKey support_interface_line_distance("support_interface_line_distance");
+const SettingKey support_line_distance("support_line_distance");
+const SettingKey support_roof_height("support_roof_height");
+const SettingKey top_layers("top_layers");
+const SettingKey travel_avoid_distance("travel_avoid_distance");
+const SettingKey travel_avoid_other_parts("travel_avoid_other_parts");
+const SettingKey travel_compensate_overlapping_walls_0_enabled("travel_compensate_overlapping_walls_0_enabled");
+const SettingKey travel_compensate_overlapping_walls_x_enabled("travel_compensate_overlapping_walls_x_enabled");
+const SettingKey wall_line_count("wall_line_count");
+const SettingKey wall_line_width_0("wall_line_width_0");
+const SettingKey wall_line_width_x("wall_line_width_x");
+}//namespace setting_keys
+
+
+void FffGcodeWriter::setTargetStream(std::ostream* stream, GCodeOutputFormat format)
+{
+    std::unique_ptr<EncodingOutputStream> previous_encoding_stream = std::move(encoding_stream); // is finished once the gcode buffered for it has been written
+    if (format != GCodeOutputFormat::TEXT)
+    {
+        std::vector<std::unique_ptr<StreamEncoder>> encoders;
+        if (format == GCodeOutputFormat::BINARY || format == GCodeOutputFormat::BINARY_GZIP)
+        {
+            encoders.emplace_back(new BinaryGCodeEncoder());
+        }
+        if (format == GCodeOutputFormat::GZIP || format == GCodeOutputFormat::BINARY_GZIP)
+        {
+            encoders.emplace_back(new GzipEncoder());
+        }
+        encoding_stream.reset(new EncodingOutputStream(stream, std::move(encoders)));
+        stream = encoding_stream.get();
+    }
+    gcode.setOutputStream(stream);
+}
 
 void FffGcodeWriter::writeGCode(SliceDataStorage& storage, TimeKeeper& time_keeper)
 {
@@ -74,16 +135,10 @@ void FffGcodeWriter::writeGCode(SliceDataStorage& storage, TimeKeeper& time_keep
     {
         processRaft(storage, total_layers);
         // process filler layers to fill the airgap with helper object (support etc) so that they stick better to the raft.
-        for (int layer_nr = -Raft::getFillerLayerCount(storage); layer_nr < 0; layer_nr++)
-        {
-            processLayer(storage, layer_nr, total_layers);
-        }
+        processLayers(storage, -Raft::getFillerLayerCount(storage), 0, total_layers);
     }
 
-    for(unsigned int layer_nr=0; layer_nr<total_layers; layer_nr++)
-    {
-        processLayer(storage, layer_nr, total_layers);
-    }
+    processLayers(storage, 0, total_layers, total_layers);
     
     Progress::messageProgressStage(Progress::Stage::FINISH, &time_keeper);
 
@@ -94,6 +149,7 @@ void FffGcodeWriter::writeGCode(SliceDataStorage& storage, TimeKeeper& time_keep
 
     constexpr bool force = true;
     gcode.writeRetraction(&storage.retraction_config_per_extruder[gcode.getExtruderNr()], force); // retract after finishing each meshgroup
+    gcode.flushOutputStream();
 }
 
 void FffGcodeWriter::setConfigFanSpeedLayerTime(SliceDataStorage& storage)
@@ -387,12 +443,82 @@ void FffGcodeWriter::processRaft(SliceDataStorage& storage, unsigned int total_l
     }
 }
 
-void FffGcodeWriter::processLayer(SliceDataStorage& storage, int layer_nr, unsigned int total_layers)
+void FffGcodeWriter::processLayers(SliceDataStorage& storage, int start_layer_nr, int end_layer_nr, unsigned int total_layers)
+{
+    ThreadPool& thread_pool = ThreadPool::getInstance();
+    // enough layers to keep all threads busy, while keeping few layers of paths in memory
+    const int batch_size = thread_pool.getThreadCount() * 2;
+    std::vector<LayerFillPaths> batch_fill_paths(batch_size);
+    std::vector<LayerFillPaths> next_batch_fill_paths(batch_size);
+    int batch_start = start_layer_nr;
+    int batch_end = std::min(batch_start + batch_size, end_layer_nr);
+    thread_pool.parallel_for(0, std::max(0, batch_end - batch_start), [&](size_t batch_idx)
+        {
+            batch_fill_paths[batch_idx] = generateLayerFillPaths(storage, batch_start + batch_idx);
+        });
+    while (batch_start < end_layer_nr)
+    {
+        // the workers generate the paths of the next batch while this thread plans and writes the current one
+        const int next_batch_start = batch_end;
+        const int next_batch_end = std::min(next_batch_start + batch_size, end_layer_nr);
+        ThreadPool::BackgroundLoop next_batch(thread_pool, 0, std::max(0, next_batch_end - next_batch_start), [&](size_t batch_idx)
+            {
+                next_batch_fill_paths[batch_idx] = generateLayerFillPaths(storage, next_batch_start + batch_idx);
+            });
+        // the layers are planned in order, since each layer starts where the previous one ended
+        for (int layer_nr = batch_start; layer_nr < batch_end; layer_nr++)
+        {
+            processLayer(storage, layer_nr, total_layers, batch_fill_paths[layer_nr - batch_start]);
+        }
+        next_batch.wait();
+        std::swap(batch_fill_paths, next_batch_fill_paths);
+        batch_start = next_batch_start;
+        batch_end = next_batch_end;
+    }
+}
+
+LayerFillPaths FffGcodeWriter::generateLayerFillPaths(SliceDataStorage& storage, int layer_nr)
+{
+    LayerFillPaths fill_paths;
+    if (layer_nr >= 0)
+    {
+        fill_paths.mesh_parts.resize(storage.meshes.size());
+        for (unsigned int mesh_idx = 0; mesh_idx < storage.meshes.size(); mesh_idx++)
+        {
+            SliceMeshStorage* mesh = &storage.meshes[mesh_idx];
+            if (mesh->getSettingAsSurfaceMode("magic_mesh_surface_mode") == ESurfaceMode::SURFACE || !hasPartsToPrint(mesh, layer_nr))
+            {
+                continue;
+            }
+            for (SliceLayerPart& part : mesh->layers[layer_nr].parts)
+            {
+                fill_paths.mesh_parts[mesh_idx].push_back(generatePartFillPaths(mesh, part, layer_nr));
+            }
+        }
+    }
+
+    const int support_layer_nr = std::max(0, layer_nr); // the layers between the raft and the model print the support of the first layer
+    if (storage.support.generated && support_layer_nr <= storage.support.layer_nr_max_filled_layer)
+    {
+        SupportLayer& support_layer = storage.support.supportLayers[support_layer_nr];
+        if (support_layer.supportAreas.size() > 0)
+        {
+            fill_paths.support_islands = generateSupportInfillPaths(storage, support_layer_nr);
+        }
+        if (support_layer.skin.size() > 0)
+        {
+            fill_paths.support_roofs = generateSupportRoofPaths(storage, support_layer_nr);
+        }
+    }
+    return fill_paths;
+}
+
+void FffGcodeWriter::processLayer(SliceDataStorage& storage, int layer_nr, unsigned int total_layers, LayerFillPaths& fill_paths)
 {
     Progress::messageProgress(Progress::Stage::EXPORT, std::max(0, layer_nr) + 1, total_layers);
     logDebug("GcodeWriter processing layer %i of %i\n", layer_nr, total_layers);
 
-    int layer_thickness = getSettingInMicrons("layer_height");
+    int layer_thickness = getSettingInMicrons(setting_keys::layer_height);
     int64_t z;
     bool include_helper_parts = true;
     if (layer_nr < 0)
@@ -418,7 +544,7 @@ void FffGcodeWriter::processLayer(SliceDataStorage& storage, int layer_nr, unsig
             {
                 include_helper_parts = false;
             }
-            layer_thickness = getSettingInMicrons("layer_height_0");
+            layer_thickness = getSettingInMicrons(setting_keys::layer_height_0);
         }
     }
 
@@ -430,10 +556,10 @@ void FffGcodeWriter::processLayer(SliceDataStorage& storage, int layer_nr, unsig
         {
             ExtruderTrain* extr = storage.meshgroup->getExtruderTrain(extr_nr);
 
-            if (extr->getSettingBoolean("travel_avoid_other_parts"))
+            if (extr->getSettingBoolean(setting_keys::travel_avoid_other_parts))
             {
                 avoid_other_parts = true;
-                avoid_distance = std::max(avoid_distance, extr->getSettingInMicrons("travel_avoid_distance"));
+                avoid_distance = std::max(avoid_distance, extr->getSettingInMicrons(setting_keys::travel_avoid_distance));
             }
         }
     }
@@ -441,7 +567,7 @@ void FffGcodeWriter::processLayer(SliceDataStorage& storage, int layer_nr, unsig
     int max_inner_wall_width = 0;
     for (SettingsBaseVirtual& mesh_settings : storage.meshes)
     {
-        max_inner_wall_width = std::max(max_inner_wall_width, mesh_settings.getSettingInMicrons((mesh_settings.getSettingAsCount("wall_line_count") > 1) ? "wall_line_width_x" : "wall_line_width_0")); 
+        max_inner_wall_width = std::max(max_inner_wall_width, mesh_settings.getSettingInMicrons((mesh_settings.getSettingAsCount(setting_keys::wall_line_count) > 1) ? setting_keys::wall_line_width_x : setting_keys::wall_line_width_0)); 
     }
     int64_t comb_offset_from_outlines = max_inner_wall_width * 2;
 
@@ -451,7 +577,7 @@ void FffGcodeWriter::processLayer(SliceDataStorage& storage, int layer_nr, unsig
 
     if (include_helper_parts && layer_nr == 0)
     { // process the skirt or the brim of the starting extruder.
-        int extruder_nr = getSettingAsIndex("adhesion_extruder_nr");
+        int extruder_nr = getSettingAsIndex(setting_keys::adhesion_extruder_nr);
         if (storage.skirt_brim[extruder_nr].size() > 0)
         {
             gcode_layer.setExtruder(extruder_nr);
@@ -462,7 +588,7 @@ void FffGcodeWriter::processLayer(SliceDataStorage& storage, int layer_nr, unsig
     int extruder_nr_before = gcode_layer.getExtruder();
     if (include_helper_parts)
     {
-        addSupportToGCode(storage, gcode_layer, std::max(0, layer_nr), extruder_nr_before, true);
+        addSupportToGCode(storage, gcode_layer, std::max(0, layer_nr), extruder_nr_before, true, fill_paths);
 
         processOozeShield(storage, gcode_layer, std::max(0, layer_nr));
 
@@ -482,14 +608,14 @@ void FffGcodeWriter::processLayer(SliceDataStorage& storage, int layer_nr, unsig
             }
             else
             {
-                addMeshLayerToGCode(storage, mesh, gcode_layer, layer_nr);
+                addMeshLayerToGCode(storage, mesh, gcode_layer, layer_nr, fill_paths.mesh_parts[mesh_idx]);
             }
         }
     }
 
     if (include_helper_parts)
     {
-        addSupportToGCode(storage, gcode_layer, std::max(0, layer_nr), extruder_nr_before, false);
+        addSupportToGCode(storage, gcode_layer, std::max(0, layer_nr), extruder_nr_before, false, fill_paths);
     }
 
     if (include_helper_parts && layer_nr == 0)
@@ -551,7 +677,7 @@ void FffGcodeWriter::processDraftShield(SliceDataStorage& storage, GCodePlanner&
     {
         return;
     }
-    if (!getSettingBoolean("draft_shield_enabled"))
+    if (!getSettingBoolean(setting_keys::draft_shield_enabled))
     {
         return;
     }
@@ -562,9 +688,9 @@ void FffGcodeWriter::processDraftShield(SliceDataStorage& storage, GCodePlanner&
 
     if (getSettingAsDraftShieldHeightLimitation("draft_shield_height_limitation") == DraftShieldHeightLimitation::LIMITED)
     {
-        const int draft_shield_height = getSettingInMicrons("draft_shield_height");
-        const int layer_height_0 = getSettingInMicrons("layer_height_0");
-        const int layer_height = getSettingInMicrons("layer_height");
+        const int draft_shield_height = getSettingInMicrons(setting_keys::draft_shield_height);
+        const int layer_height_0 = getSettingInMicrons(setting_keys::layer_height_0);
+        const int layer_height = getSettingInMicrons(setting_keys::layer_height);
         const unsigned int max_screen_layer = (unsigned int)((draft_shield_height - layer_height_0) / layer_height + 1);
         if (layer_nr > max_screen_layer)
         {
@@ -587,7 +713,7 @@ std::vector<unsigned int> FffGcodeWriter::calculateMeshOrder(SliceDataStorage& s
     {
         for(auto add_it = add_list.begin(); add_it != add_list.end(); )
         {
-            if (storage.meshes[*add_it].getSettingAsIndex("extruder_nr") == add_extruder_nr)
+            if (storage.meshes[*add_it].getSettingAsIndex(setting_keys::extruder_nr) == add_extruder_nr)
             {
                 ret.push_back(*add_it);
                 add_it = add_list.erase(add_it);
@@ -598,7 +724,7 @@ std::vector<unsigned int> FffGcodeWriter::calculateMeshOrder(SliceDataStorage& s
             }
         }
         if (add_list.size() > 0)
-            add_extruder_nr = storage.meshes[*add_list.begin()].getSettingAsIndex("extruder_nr");
+            add_extruder_nr = storage.meshes[*add_list.begin()].getSettingAsIndex(setting_keys::extruder_nr);
     }
     return ret;
 }
@@ -610,7 +736,7 @@ void FffGcodeWriter::addMeshLayerToGCode_meshSurfaceMode(SliceDataStorage& stora
         return;
     }
     
-    setExtruder_addPrime(storage, gcode_layer, layer_nr, mesh->getSettingAsIndex("extruder_nr"));
+    setExtruder_addPrime(storage, gcode_layer, layer_nr, mesh->getSettingAsIndex(setting_keys::extruder_nr));
 
     SliceLayer* layer = &mesh->layers[layer_nr];
 
@@ -622,7 +748,7 @@ void FffGcodeWriter::addMeshLayerToGCode_meshSurfaceMode(SliceDataStorage& stora
     }
 
     EZSeamType z_seam_type = mesh->getSettingAsZSeamType("z_seam_type");
-    gcode_layer.addPolygonsByOptimizer(polygons, &mesh->inset0_config, nullptr, z_seam_type, mesh->getSettingBoolean("magic_spiralize"));
+    gcode_layer.addPolygonsByOptimizer(polygons, &mesh->inset0_config, nullptr, z_seam_type, mesh->getSettingBoolean(setting_keys::magic_spiralize));
 
     addMeshOpenPolyLinesToGCode(storage, mesh, gcode_layer, layer_nr);
 }
@@ -646,38 +772,44 @@ void FffGcodeWriter::addMeshOpenPolyLinesToGCode(SliceDataStorage& storage, Slic
     
 }
 
-void FffGcodeWriter::addMeshLayerToGCode(SliceDataStorage& storage, SliceMeshStorage* mesh, GCodePlanner& gcode_layer, int layer_nr)
+bool FffGcodeWriter::hasPartsToPrint(SliceMeshStorage* mesh, int layer_nr)
 {
     if (layer_nr > mesh->layer_nr_max_filled_layer)
     {
-        return;
+        return false;
     }
     
     SliceLayer* layer = &mesh->layers[layer_nr];
 
     if (layer->parts.size() == 0)
     {
-        return;
+        return false;
     }
 
-    if (mesh->getSettingAsCount("wall_line_count") > 0)
+    if (mesh->getSettingAsCount(setting_keys::wall_line_count) > 0)
     { // don't switch extruder if there's nothing to print
-        bool empty = true;
         for (SliceLayerPart& part : layer->parts)
         {
             if (part.insets.size() > 0)
             {
-                empty = false;
-                break;
+                return true;
             }
         }
-        if (empty)
-        {
-            return;
-        }
+        return false;
+    }
+    return true;
+}
+
+void FffGcodeWriter::addMeshLayerToGCode(SliceDataStorage& storage, SliceMeshStorage* mesh, GCodePlanner& gcode_layer, int layer_nr, std::vector<PartFillPaths>& part_fill_paths)
+{
+    if (!hasPartsToPrint(mesh, layer_nr))
+    {
+        return;
     }
+    
+    SliceLayer* layer = &mesh->layers[layer_nr];
 
-    setExtruder_addPrime(storage, gcode_layer, layer_nr, mesh->getSettingAsIndex("extruder_nr"));
+    setExtruder_addPrime(storage, gcode_layer, layer_nr, mesh->getSettingAsIndex(setting_keys::extruder_nr));
 
     EZSeamType z_seam_type = mesh->getSettingAsZSeamType("z_seam_type");
     PathOrderOptimizer part_order_optimizer(last_position_planned, z_seam_type);
@@ -687,58 +819,33 @@ void FffGcodeWriter::addMeshLayerToGCode(SliceDataStorage& storage, SliceMeshSto
     }
     part_order_optimizer.optimize();
 
-    bool skin_alternate_rotation = mesh->getSettingBoolean("skin_alternate_rotation") && ( mesh->getSettingAsCount("top_layers") >= 4 || mesh->getSettingAsCount("bottom_layers") >= 4 );
-    
     for(int order_idx : part_order_optimizer.polyOrder)
     {
         SliceLayerPart& part = layer->parts[order_idx];
+        PartFillPaths& fill_paths = part_fill_paths[order_idx];
 
-        EFillMethod infill_pattern = mesh->getSettingAsFillMethod("infill_pattern");
-        int infill_angle = 45;
-        if ((infill_pattern == EFillMethod::LINES || infill_pattern == EFillMethod::ZIG_ZAG))
-        {
-            unsigned int combined_infill_layers = std::max(1U, round_divide(mesh->getSettingInMicrons("infill_sparse_thickness"), std::max(getSettingInMicrons("layer_height"), 1)));
-            if ((layer_nr / combined_infill_layers) & 1)
-            { // switch every [combined_infill_layers] layers
-                infill_angle += 90;
-            }
-        }
-        
-        int infill_line_distance = mesh->getSettingInMicrons("infill_line_distance");
-        int infill_overlap = mesh->getSettingInMicrons("infill_overlap_mm");
-        
         gcode_layer.setIsInside(true); // going to print inside stuff below
         
-        if (mesh->getSettingBoolean("infill_before_walls"))
+        if (mesh->getSettingBoolean(setting_keys::infill_before_walls))
         {
-            processMultiLayerInfill(gcode_layer, mesh, part, layer_nr, infill_line_distance, infill_overlap, infill_angle);
-            processSingleLayerInfill(gcode_layer, mesh, part, layer_nr, infill_line_distance, infill_overlap, infill_angle);
+            processMultiLayerInfill(gcode_layer, mesh, fill_paths);
+            processSingleLayerInfill(gcode_layer, mesh, fill_paths);
         }
         
-        processInsets(gcode_layer, mesh, part, layer_nr, z_seam_type);
-
-        if (!mesh->getSettingBoolean("infill_before_walls"))
-        {
-            processMultiLayerInfill(gcode_layer, mesh, part, layer_nr, infill_line_distance, infill_overlap, infill_angle);
-            processSingleLayerInfill(gcode_layer, mesh, part, layer_nr, infill_line_distance, infill_overlap, infill_angle);
-        }
+        processInsets(gcode_layer, mesh, part, layer_nr, z_seam_type, fill_paths);
 
-        EFillMethod skin_pattern = mesh->getSettingAsFillMethod("top_bottom_pattern");
-        int skin_angle = 45;
-        if ((skin_pattern == EFillMethod::LINES || skin_pattern == EFillMethod::ZIG_ZAG) && layer_nr & 1)
+        if (!mesh->getSettingBoolean(setting_keys::infill_before_walls))
         {
-            skin_angle += 90; // should coincide with infill_angle (if both skin and infill are lines) so that the first top layer is orthogonal to the last infill layer
+            processMultiLayerInfill(gcode_layer, mesh, fill_paths);
+            processSingleLayerInfill(gcode_layer, mesh, fill_paths);
         }
-        if (skin_alternate_rotation && ( layer_nr / 2 ) & 1)
-            skin_angle -= 45;
 
-        int64_t skin_overlap = mesh->getSettingInMicrons("skin_overlap_mm");
-        processSkin(gcode_layer, mesh, part, layer_nr, skin_overlap, skin_angle);
+        processSkin(gcode_layer, mesh, part, fill_paths);
 
         //After a layer part, make sure the nozzle is inside the comb boundary, so we do not retract on the perimeter.
-        if (!mesh->getSettingBoolean("magic_spiralize") || static_cast<int>(layer_nr) < mesh->getSettingAsCount("bottom_layers"))
+        if (!mesh->getSettingBoolean(setting_keys::magic_spiralize) || static_cast<int>(layer_nr) < mesh->getSettingAsCount(setting_keys::bottom_layers))
         {
-            gcode_layer.moveInsideCombBoundary(mesh->getSettingInMicrons((mesh->getSettingAsCount("wall_line_count") > 1) ? "wall_line_width_x" : "wall_line_width_0") * 1);
+            gcode_layer.moveInsideCombBoundary(mesh->getSettingInMicrons((mesh->getSettingAsCount(setting_keys::wall_line_count) > 1) ? "wall_line_width_x" : "wall_line_width_0") * 1);
         }
 
         gcode_layer.setIsInside(false);
@@ -749,22 +856,34 @@ void FffGcodeWriter::addMeshLayerToGCode(SliceDataStorage& storage, SliceMeshSto
     }
 }
 
+PartFillPaths FffGcodeWriter::generatePartFillPaths(SliceMeshStorage* mesh, SliceLayerPart& part, unsigned int layer_nr)
+{
+    PartFillPaths fill_paths;
+    int64_t z = layer_nr * getSettingInMicrons(setting_keys::layer_height);
 
-            
-
+    EFillMethod infill_pattern = mesh->getSettingAsFillMethod("infill_pattern");
+    int infill_angle = 45;
+    if ((infill_pattern == EFillMethod::LINES || infill_pattern == EFillMethod::ZIG_ZAG))
+    {
+        unsigned int combined_infill_layers = std::max(1U, round_divide(mesh->getSettingInMicrons(setting_keys::infill_sparse_thickness), std::max(getSettingInMicrons(setting_keys::layer_height), 1)));
+        if ((layer_nr / combined_infill_layers) & 1)
+        { // switch every [combined_infill_layers] layers
+            infill_angle += 90;
+        }
+    }
+    
+    int infill_line_distance = mesh->getSettingInMicrons(setting_keys::infill_line_distance);
+    int infill_overlap = mesh->getSettingInMicrons(setting_keys::infill_overlap_mm);
 
-void FffGcodeWriter::processMultiLayerInfill(GCodePlanner& gcode_layer, SliceMeshStorage* mesh, SliceLayerPart& part, unsigned int layer_nr, int infill_line_distance, int infill_overlap, int infill_angle)
-{
-    int64_t z = layer_nr * getSettingInMicrons("layer_height");
     if (infill_line_distance > 0)
     {
         //Print the thicker infill lines first. (double or more layer thickness, infill combined with previous layers)
         for(unsigned int combine_idx = 1; combine_idx < part.infill_area_per_combine_per_density[0].size(); combine_idx++)
         {
             const unsigned int infill_line_width = mesh->infill_config[combine_idx].getLineWidth();
-            EFillMethod infill_pattern = mesh->getSettingAsFillMethod("infill_pattern");
-            Polygons infill_polygons;
-            Polygons infill_lines;
+            fill_paths.multi_layer_infill.emplace_back();
+            FillPaths& combined_infill = fill_paths.multi_layer_infill.back();
+            combined_infill.pattern = infill_pattern;
             for (unsigned int density_idx = 0; density_idx < part.infill_area_per_combine_per_density.size(); density_idx++)
             { // combine different density infill areas (for gradual infill)
                 unsigned int density_factor = 2 << density_idx; // == pow(2, density_idx + 1)
@@ -776,35 +895,25 @@ void FffGcodeWriter::processMultiLayerInfill(GCodePlanner& gcode_layer, SliceMes
                 }
                 
                 Infill infill_comp(infill_pattern, part.infill_area_per_combine_per_density[density_idx][combine_idx], 0, infill_line_width, infill_line_distance_here, infill_overlap, infill_angle, z, infill_shift, false, false);
-                infill_comp.generate(infill_polygons, infill_lines);
+                infill_comp.generate(combined_infill.polygons, combined_infill.lines);
             }
-            gcode_layer.addPolygonsByOptimizer(infill_polygons, &mesh->infill_config[combine_idx]);
-            gcode_layer.addLinesByOptimizer(infill_lines, &mesh->infill_config[combine_idx], (infill_pattern == EFillMethod::ZIG_ZAG)? SpaceFillType::PolyLines : SpaceFillType::Lines);
         }
     }
-}
 
-void FffGcodeWriter::processSingleLayerInfill(GCodePlanner& gcode_layer, SliceMeshStorage* mesh, SliceLayerPart& part, unsigned int layer_nr, int infill_line_distance, int infill_overlap, int infill_angle)
-{
-    if (infill_line_distance == 0 || part.infill_area_per_combine_per_density[0].size() == 0)
+    if (infill_line_distance != 0 && part.infill_area_per_combine_per_density[0].size() != 0)
     {
-        return;
-    }
-    const unsigned int infill_line_width = mesh->infill_config[0].getLineWidth();
-        
-    //Combine the 1 layer thick infill with the top/bottom skin and print that as one thing.
-    Polygons infill_polygons;
-    Polygons infill_lines;
-
-    int64_t z = layer_nr * getSettingInMicrons("layer_height");
+        const unsigned int infill_line_width = mesh->infill_config[0].getLineWidth();
 
-    EFillMethod pattern = mesh->getSettingAsFillMethod("infill_pattern");
-    for (unsigned int density_idx = 0; density_idx < part.infill_area_per_combine_per_density.size(); density_idx++)
-    {
-        unsigned int density_factor = 2 << density_idx; // == pow(2, density_idx + 1)
-        int infill_line_distance_here = infill_line_distance * density_factor; // the highest density infill combines with the next to create a grid with density_factor 1
-        int infill_shift = infill_line_distance_here / 2;
-        // infill shift explanation: [>]=shift ["]=line_dist
+        //Combine the 1 layer thick infill with the top/bottom skin and print that as one thing.
+        fill_paths.has_single_layer_infill = true;
+        FillPaths& infill = fill_paths.single_layer_infill;
+        infill.pattern = infill_pattern;
+        for (unsigned int density_idx = 0; density_idx < part.infill_area_per_combine_per_density.size(); density_idx++)
+        {
+            unsigned int density_factor = 2 << density_idx; // == pow(2, density_idx + 1)
+            int infill_line_distance_here = infill_line_distance * density_factor; // the highest density infill combines with the next to create a grid with density_factor 1
+            int infill_shift = infill_line_distance_here / 2;
+            // infill shift explanation: [>]=shift ["]=line_dist
 // :       |       :       |       :       |       :       |         > furthest from top
 // :   |   |   |   :   |   |   |   :   |   |   |   :   |   |   |     > further from top
 // : | | | | | | | : | | | | | | | : | | | | | | | : | | | | | | |   > near top
@@ -817,8 +926,8 @@ void FffGcodeWriter::processSingleLayerInfill(GCodePlanner& gcode_layer, SliceMe
 // :   |   |   |   :   |   |   |   :   |   |   |   :   |   |   |     > further from top
 // : | | | | | | | : | | | | | | | : | | | | | | | : | | | | | | |   > near top
 // >>>>>>>>"""""""""""""""""
-        if (density_idx == part.infill_area_per_combine_per_density.size() - 1)
-        { // the least dense infill should fill up all remaining gaps
+            if (density_idx == part.infill_area_per_combine_per_density.size() - 1)
+            { // the least dense infill should fill up all remaining gaps
 // :       |       :       |       :       |       :       |       :  > furthest from top
 // :   |   |   |   :   |   |   |   :   |   |   |   :   |   |   |   :  > further from top
 // : | | | | | | | : | | | | | | | : | | | | | | | : | | | | | | | :  > near top
@@ -829,36 +938,121 @@ void FffGcodeWriter::processSingleLayerInfill(GCodePlanner& gcode_layer, SliceMe
 //                                       ^ infill_line_distance_here for lowest density infill up till here
 //                 ^ middle density line dist
 //     ^   highest density line dist
-            infill_line_distance_here /= 2;
+                infill_line_distance_here /= 2;
+            }
+            Infill infill_comp(infill_pattern, part.infill_area_per_combine_per_density[density_idx][0], 0, infill_line_width, infill_line_distance_here, infill_overlap, infill_angle, z, infill_shift, false, false);
+            infill_comp.generate(infill.polygons, infill.lines);
+        }
+    }
+
+    EFillMethod skin_pattern = mesh->getSettingAsFillMethod("top_bottom_pattern");
+    int skin_angle = 45;
+    if ((skin_pattern == EFillMethod::LINES || skin_pattern == EFillMethod::ZIG_ZAG) && layer_nr & 1)
+    {
+        skin_angle += 90; // should coincide with infill_angle (if both skin and infill are lines) so that the first top layer is orthogonal to the last infill layer
+    }
+    bool skin_alternate_rotation = mesh->getSettingBoolean(setting_keys::skin_alternate_rotation) && ( mesh->getSettingAsCount(setting_keys::top_layers) >= 4 || mesh->getSettingAsCount(setting_keys::bottom_layers) >= 4 );
+    if (skin_alternate_rotation && ( layer_nr / 2 ) & 1)
+        skin_angle -= 45;
+
+    int64_t skin_overlap = mesh->getSettingInMicrons(setting_keys::skin_overlap_mm);
+    const unsigned int skin_line_width = mesh->skin_config.getLineWidth();
+
+    for(SkinPart& skin_part : part.skin_parts)
+    {
+        fill_paths.skin.emplace_back();
+        FillPaths& skin = fill_paths.skin.back();
+
+        EFillMethod pattern = mesh->getSettingAsFillMethod("top_bottom_pattern");
+        int bridge = -1;
+        if (layer_nr > 0)
+            bridge = bridgeAngle(skin_part.outline, &mesh->layers[layer_nr-1]);
+        if (bridge > -1)
+        {
+            pattern = EFillMethod::LINES;
+            skin_angle = bridge;
+        }
+        skin.pattern = pattern;
+        Polygons* inner_skin_outline = nullptr;
+        int offset_from_inner_skin_outline = 0;
+        if (pattern != EFillMethod::CONCENTRIC && skin_part.insets.size() > 0)
+        {
+            inner_skin_outline = &skin_part.insets.back();
+            offset_from_inner_skin_outline = -mesh->insetX_config.getLineWidth() / 2;
+        }
+
+        if (inner_skin_outline == nullptr)
+        {
+            inner_skin_outline = &skin_part.outline;
+        }
+
+        int extra_infill_shift = 0;
+        Infill infill_comp(pattern, *inner_skin_outline, offset_from_inner_skin_outline, skin_line_width, skin_line_width, skin_overlap, skin_angle, z, extra_infill_shift, false, false);
+        infill_comp.generate(skin.polygons, skin.lines);
+    }
+
+    // linking the nearby parts of the walls doesn't depend on the order in which the parts are printed either
+    const bool compensate_overlap_0 = mesh->getSettingBoolean(setting_keys::travel_compensate_overlapping_walls_0_enabled);
+    const bool compensate_overlap_x = mesh->getSettingBoolean(setting_keys::travel_compensate_overlapping_walls_x_enabled);
+    fill_paths.wall_overlaps.resize(part.insets.size());
+    if (mesh->getSettingAsCount(setting_keys::wall_line_count) > 0)
+    {
+        for (unsigned int inset_idx = 0; inset_idx < part.insets.size(); inset_idx++)
+        {
+            if (inset_idx == 0 && compensate_overlap_0)
+            {
+                fill_paths.wall_overlaps[inset_idx].reset(new WallOverlapComputation(part.insets[inset_idx], mesh->getSettingInMicrons(setting_keys::wall_line_width_0)));
+            }
+            else if (inset_idx > 0 && compensate_overlap_x)
+            {
+                fill_paths.wall_overlaps[inset_idx].reset(new WallOverlapComputation(part.insets[inset_idx], mesh->getSettingInMicrons(setting_keys::wall_line_width_x)));
+            }
         }
-        Infill infill_comp(pattern, part.infill_area_per_combine_per_density[density_idx][0], 0, infill_line_width, infill_line_distance_here, infill_overlap, infill_angle, z, infill_shift, false, false);
-        infill_comp.generate(infill_polygons, infill_lines);
     }
-    gcode_layer.addPolygonsByOptimizer(infill_polygons, &mesh->infill_config[0]);
-    if (pattern == EFillMethod::GRID || pattern == EFillMethod::LINES || pattern == EFillMethod::TRIANGLES)
+    return fill_paths;
+}
+
+void FffGcodeWriter::processMultiLayerInfill(GCodePlanner& gcode_layer, SliceMeshStorage* mesh, PartFillPaths& fill_paths)
+{
+    //Print the thicker infill lines first. (double or more layer thickness, infill combined with previous layers)
+    for(unsigned int combine_idx = 1; combine_idx <= fill_paths.multi_layer_infill.size(); combine_idx++)
+    {
+        FillPaths& infill = fill_paths.multi_layer_infill[combine_idx - 1];
+        gcode_layer.addPolygonsByOptimizer(infill.polygons, &mesh->infill_config[combine_idx]);
+        gcode_layer.addLinesByOptimizer(infill.lines, &mesh->infill_config[combine_idx], (infill.pattern == EFillMethod::ZIG_ZAG)? SpaceFillType::PolyLines : SpaceFillType::Lines);
+    }
+}
+
+void FffGcodeWriter::processSingleLayerInfill(GCodePlanner& gcode_layer, SliceMeshStorage* mesh, PartFillPaths& fill_paths)
+{
+    if (!fill_paths.has_single_layer_infill)
+    {
+        return;
+    }
+    FillPaths& infill = fill_paths.single_layer_infill;
+    gcode_layer.addPolygonsByOptimizer(infill.polygons, &mesh->infill_config[0]);
+    if (infill.pattern == EFillMethod::GRID || infill.pattern == EFillMethod::LINES || infill.pattern == EFillMethod::TRIANGLES)
     {
-        gcode_layer.addLinesByOptimizer(infill_lines, &mesh->infill_config[0], SpaceFillType::Lines, mesh->getSettingInMicrons("infill_wipe_dist")); 
+        gcode_layer.addLinesByOptimizer(infill.lines, &mesh->infill_config[0], SpaceFillType::Lines, mesh->getSettingInMicrons(setting_keys::infill_wipe_dist)); 
     }
     else 
     {
-        gcode_layer.addLinesByOptimizer(infill_lines, &mesh->infill_config[0], (pattern == EFillMethod::ZIG_ZAG)? SpaceFillType::PolyLines : SpaceFillType::Lines); 
+        gcode_layer.addLinesByOptimizer(infill.lines, &mesh->infill_config[0], (infill.pattern == EFillMethod::ZIG_ZAG)? SpaceFillType::PolyLines : SpaceFillType::Lines); 
     }
 }
 
-void FffGcodeWriter::processInsets(GCodePlanner& gcode_layer, SliceMeshStorage* mesh, SliceLayerPart& part, unsigned int layer_nr, EZSeamType z_seam_type)
+void FffGcodeWriter::processInsets(GCodePlanner& gcode_layer, SliceMeshStorage* mesh, SliceLayerPart& part, unsigned int layer_nr, EZSeamType z_seam_type, PartFillPaths& fill_paths)
 {
-    bool compensate_overlap_0 = mesh->getSettingBoolean("travel_compensate_overlapping_walls_0_enabled");
-    bool compensate_overlap_x = mesh->getSettingBoolean("travel_compensate_overlapping_walls_x_enabled");
-    if (mesh->getSettingAsCount("wall_line_count") > 0)
+    if (mesh->getSettingAsCount(setting_keys::wall_line_count) > 0)
     {
         bool spiralize = false;
-        if (mesh->getSettingBoolean("magic_spiralize"))
+        if (mesh->getSettingBoolean(setting_keys::magic_spiralize))
         {
-            if (static_cast<int>(layer_nr) >= mesh->getSettingAsCount("bottom_layers"))
+            if (static_cast<int>(layer_nr) >= mesh->getSettingAsCount(setting_keys::bottom_layers))
             {
                 spiralize = true;
             }
-            if (static_cast<int>(layer_nr) == mesh->getSettingAsCount("bottom_layers") && part.insets.size() > 0)
+            if (static_cast<int>(layer_nr) == mesh->getSettingAsCount(setting_keys::bottom_layers) && part.insets.size() > 0)
             { // on the last normal layer first make the outer wall normally and then start a second outer wall from the same hight, but gradually moving upward
                 gcode_layer.addPolygonsByOptimizer(part.insets[0], &mesh->insetX_config, nullptr, EZSeamType::SHORTEST, false);
             }
@@ -867,34 +1061,32 @@ void FffGcodeWriter::processInsets(GCodePlanner& gcode_layer, SliceMeshStorage*
         for(int inset_number=part.insets.size()-1; inset_number>-1; inset_number--)
         {
             processed_inset_number = inset_number;
-            if (mesh->getSettingBoolean("outer_inset_first"))
+            if (mesh->getSettingBoolean(setting_keys::outer_inset_first))
             {
                 processed_inset_number = part.insets.size() - 1 - inset_number;
             }
             if (processed_inset_number == 0)
             {
-                if (!compensate_overlap_0)
+                if (!fill_paths.wall_overlaps[0])
                 {
                     gcode_layer.addPolygonsByOptimizer(part.insets[0], &mesh->inset0_config, nullptr, z_seam_type, spiralize);
                 }
                 else
                 {
-                    Polygons& outer_wall = part.insets[0];
-                    WallOverlapComputation wall_overlap_computation(outer_wall, mesh->getSettingInMicrons("wall_line_width_0"));
-                    gcode_layer.addPolygonsByOptimizer(outer_wall, &mesh->inset0_config, &wall_overlap_computation, z_seam_type, spiralize);
+                    WallOverlapComputation& wall_overlap_computation = *fill_paths.wall_overlaps[0];
+                    gcode_layer.addPolygonsByOptimizer(wall_overlap_computation.getPolygons(), &mesh->inset0_config, &wall_overlap_computation, z_seam_type, spiralize);
                 }
             }
             else
             {
-                if (!compensate_overlap_x)
+                if (!fill_paths.wall_overlaps[processed_inset_number])
                 {
                     gcode_layer.addPolygonsByOptimizer(part.insets[processed_inset_number], &mesh->insetX_config);
                 }
                 else
                 {
-                    Polygons& outer_wall = part.insets[processed_inset_number];
-                    WallOverlapComputation wall_overlap_computation(outer_wall, mesh->getSettingInMicrons("wall_line_width_x"));
-                    gcode_layer.addPolygonsByOptimizer(outer_wall, &mesh->insetX_config, &wall_overlap_computation);
+                    WallOverlapComputation& wall_overlap_computation = *fill_paths.wall_overlaps[processed_inset_number];
+                    gcode_layer.addPolygonsByOptimizer(wall_overlap_computation.getPolygons(), &mesh->insetX_config, &wall_overlap_computation);
                 }
             }
         }
@@ -902,69 +1094,40 @@ void FffGcodeWriter::processInsets(GCodePlanner& gcode_layer, SliceMeshStorage*
 }
 
 
-void FffGcodeWriter::processSkin(GCodePlanner& gcode_layer, SliceMeshStorage* mesh, SliceLayerPart& part, unsigned int layer_nr, int skin_overlap, int skin_angle)
+void FffGcodeWriter::processSkin(GCodePlanner& gcode_layer, SliceMeshStorage* mesh, SliceLayerPart& part, PartFillPaths& fill_paths)
 {
-    int64_t z = layer_nr * getSettingInMicrons("layer_height");
-    const unsigned int skin_line_width = mesh->skin_config.getLineWidth();
-
-    for(SkinPart& skin_part : part.skin_parts) // TODO: optimize parts order
+    for (unsigned int skin_part_idx = 0; skin_part_idx < part.skin_parts.size(); skin_part_idx++) // TODO: optimize parts order
     {
-        Polygons skin_polygons;
-        Polygons skin_lines;
-        
-        EFillMethod pattern = mesh->getSettingAsFillMethod("top_bottom_pattern");
-        int bridge = -1;
-        if (layer_nr > 0)
-            bridge = bridgeAngle(skin_part.outline, &mesh->layers[layer_nr-1]);
-        if (bridge > -1)
-        {
-            pattern = EFillMethod::LINES;
-            skin_angle = bridge;
-        }
-        Polygons* inner_skin_outline = nullptr;
-        int offset_from_inner_skin_outline = 0;
-        if (pattern != EFillMethod::CONCENTRIC)
+        SkinPart& skin_part = part.skin_parts[skin_part_idx];
+        FillPaths& skin = fill_paths.skin[skin_part_idx];
+        if (skin.pattern != EFillMethod::CONCENTRIC)
         {
             for (Polygons& skin_perimeter : skin_part.insets)
             {
                 gcode_layer.addPolygonsByOptimizer(skin_perimeter, &mesh->insetX_config); // add polygons to gcode in inward order
             }
-            if (skin_part.insets.size() > 0)
-            {
-                inner_skin_outline = &skin_part.insets.back();
-                offset_from_inner_skin_outline = -mesh->insetX_config.getLineWidth() / 2;
-            }
         }
 
-        if (inner_skin_outline == nullptr)
-        {
-            inner_skin_outline = &skin_part.outline;
-        }
+        gcode_layer.addPolygonsByOptimizer(skin.polygons, &mesh->skin_config);
 
-        int extra_infill_shift = 0;
-        Infill infill_comp(pattern, *inner_skin_outline, offset_from_inner_skin_outline, skin_line_width, skin_line_width, skin_overlap, skin_angle, z, extra_infill_shift, false, false);
-        infill_comp.generate(skin_polygons, skin_lines);
-
-        gcode_layer.addPolygonsByOptimizer(skin_polygons, &mesh->skin_config);
-
-        if (pattern == EFillMethod::GRID || pattern == EFillMethod::LINES || pattern == EFillMethod::TRIANGLES)
+        if (skin.pattern == EFillMethod::GRID || skin.pattern == EFillMethod::LINES || skin.pattern == EFillMethod::TRIANGLES)
         {
-            gcode_layer.addLinesByOptimizer(skin_lines, &mesh->skin_config, SpaceFillType::Lines, mesh->getSettingInMicrons("infill_wipe_dist"));
+            gcode_layer.addLinesByOptimizer(skin.lines, &mesh->skin_config, SpaceFillType::Lines, mesh->getSettingInMicrons(setting_keys::infill_wipe_dist));
         }
         else
         {
-            gcode_layer.addLinesByOptimizer(skin_lines, &mesh->skin_config, (pattern == EFillMethod::ZIG_ZAG)? SpaceFillType::PolyLines : SpaceFillType::Lines);
+            gcode_layer.addLinesByOptimizer(skin.lines, &mesh->skin_config, (skin.pattern == EFillMethod::ZIG_ZAG)? SpaceFillType::PolyLines : SpaceFillType::Lines);
         }
     }
 }
 
-void FffGcodeWriter::addSupportToGCode(SliceDataStorage& storage, GCodePlanner& gcode_layer, int layer_nr, int extruder_nr_before, bool before_rest)
+void FffGcodeWriter::addSupportToGCode(SliceDataStorage& storage, GCodePlanner& gcode_layer, int layer_nr, int extruder_nr_before, bool before_rest, LayerFillPaths& fill_paths)
 {
     if (!storage.support.generated || layer_nr > storage.support.layer_nr_max_filled_layer)
         return; 
     
-    int support_skin_extruder_nr = getSettingAsIndex("support_interface_extruder_nr");
-    int support_infill_extruder_nr = (layer_nr == 0)? getSettingAsIndex("support_extruder_nr_layer_0") : getSettingAsIndex("support_infill_extruder_nr");
+    int support_skin_extruder_nr = getSettingAsIndex(setting_keys::support_interface_extruder_nr);
+    int support_infill_extruder_nr = (layer_nr == 0)? getSettingAsIndex(setting_keys::support_extruder_nr_layer_0) : getSettingAsIndex(setting_keys::support_infill_extruder_nr);
     
     bool print_support_before_rest = support_infill_extruder_nr == extruder_nr_before
                                     || support_skin_extruder_nr == extruder_nr_before;
@@ -985,108 +1148,116 @@ void FffGcodeWriter::addSupportToGCode(SliceDataStorage& storage, GCodePlanner&
     {
         if (support_skin_extruder_nr != support_infill_extruder_nr && support_skin_extruder_nr == current_extruder_nr)
         {
-            addSupportRoofsToGCode(storage, gcode_layer, layer_nr);
-            addSupportInfillToGCode(storage, gcode_layer, layer_nr);
+            addSupportRoofsToGCode(storage, gcode_layer, layer_nr, fill_paths.support_roofs);
+            addSupportInfillToGCode(storage, gcode_layer, layer_nr, fill_paths.support_islands);
         }
         else 
         {
-            addSupportInfillToGCode(storage, gcode_layer, layer_nr);
-            addSupportRoofsToGCode(storage, gcode_layer, layer_nr);
+            addSupportInfillToGCode(storage, gcode_layer, layer_nr, fill_paths.support_islands);
+            addSupportRoofsToGCode(storage, gcode_layer, layer_nr, fill_paths.support_roofs);
         }
     }
     else
     {
-        addSupportInfillToGCode(storage, gcode_layer, layer_nr);
+        addSupportInfillToGCode(storage, gcode_layer, layer_nr, fill_paths.support_islands);
     }
 }
 
-void FffGcodeWriter::addSupportInfillToGCode(SliceDataStorage& storage, GCodePlanner& gcode_layer, int layer_nr)
+std::vector<SupportIslandFillPaths> FffGcodeWriter::generateSupportInfillPaths(SliceDataStorage& storage, int layer_nr)
 {
-    if (!storage.support.generated 
-        || layer_nr > storage.support.layer_nr_max_filled_layer 
-        || storage.support.supportLayers[layer_nr].supportAreas.size() == 0)
-    {
-        return;
-    }
+    int64_t z = layer_nr * getSettingInMicrons(setting_keys::layer_height);
 
-    int64_t z = layer_nr * getSettingInMicrons("layer_height");
-
-    const ExtruderTrain& infill_extr = *storage.meshgroup->getExtruderTrain(getSettingAsIndex("support_infill_extruder_nr"));
-    int support_line_distance = infill_extr.getSettingInMicrons("support_line_distance"); // first layer line distance must be the same as the second layer line distance
+    const ExtruderTrain& infill_extr = *storage.meshgroup->getExtruderTrain(getSettingAsIndex(setting_keys::support_infill_extruder_nr));
+    int support_line_distance = infill_extr.getSettingInMicrons(setting_keys::support_line_distance); // first layer line distance must be the same as the second layer line distance
     const int support_line_width = storage.support_config.getLineWidth();
     EFillMethod support_pattern = infill_extr.getSettingAsFillMethod("support_pattern"); // first layer pattern must be same as other layers
     if (layer_nr == 0 && (support_pattern == EFillMethod::LINES || support_pattern == EFillMethod::ZIG_ZAG)) { support_pattern = EFillMethod::GRID; }
 
-    int infill_extruder_nr_here = (layer_nr == 0)? getSettingAsIndex("support_extruder_nr_layer_0") : getSettingAsIndex("support_infill_extruder_nr");
+    int infill_extruder_nr_here = (layer_nr == 0)? getSettingAsIndex(setting_keys::support_extruder_nr_layer_0) : getSettingAsIndex(setting_keys::support_infill_extruder_nr);
     const ExtruderTrain& infill_extr_here = *storage.meshgroup->getExtruderTrain(infill_extruder_nr_here);
 
     Polygons& support = storage.support.supportLayers[layer_nr].supportAreas;
 
     std::vector<PolygonsPart> support_islands = support.splitIntoParts();
 
-    PathOrderOptimizer island_order_optimizer(gcode_layer.getLastPosition());
+    std::vector<SupportIslandFillPaths> island_fill_paths(support_islands.size());
     for(unsigned int n=0; n<support_islands.size(); n++)
     {
-        island_order_optimizer.addPolygon(support_islands[n][0]);
-    }
-    island_order_optimizer.optimize();
-
-    for(unsigned int n=0; n<support_islands.size(); n++)
-    {
-        PolygonsPart& island = support_islands[island_order_optimizer.polyOrder[n]];
+        SupportIslandFillPaths& island_paths = island_fill_paths[n];
+        island_paths.island = std::move(support_islands[n]);
+        PolygonsPart& island = island_paths.island;
 
         int support_infill_overlap = 0; // support infill should not be expanded outward
         
         int offset_from_outline = 0;
         if (support_pattern == EFillMethod::GRID || support_pattern == EFillMethod::TRIANGLES)
         {
-            Polygons boundary = island.offset(-support_line_width / 2);
-            if (boundary.size() > 0)
-            {
-                setExtruder_addPrime(storage, gcode_layer, layer_nr, infill_extruder_nr_here); // only switch extruder if we're sure we're going to switch
-                gcode_layer.addPolygonsByOptimizer(boundary, &storage.support_config);
-            }
+            island_paths.boundary = island.offset(-support_line_width / 2);
             offset_from_outline = -support_line_width;
-            support_infill_overlap = infill_extr_here.getSettingInMicrons("infill_overlap_mm"); // support lines area should be expanded outward to overlap with the boundary polygon
+            support_infill_overlap = infill_extr_here.getSettingInMicrons(setting_keys::infill_overlap_mm); // support lines area should be expanded outward to overlap with the boundary polygon
         }
 
         int extra_infill_shift = 0;
-        Infill infill_comp(support_pattern, island, offset_from_outline, support_line_width, support_line_distance, support_infill_overlap, 0, z, extra_infill_shift, infill_extr.getSettingBoolean("support_connect_zigzags"), true);
-        Polygons support_polygons;
-        Polygons support_lines;
-        infill_comp.generate(support_polygons, support_lines);
-        if (support_lines.size() > 0 || support_polygons.size() > 0)
-        {
-            setExtruder_addPrime(storage, gcode_layer, layer_nr, infill_extruder_nr_here); // only switch extruder if we're sure we're going to switch
-            gcode_layer.addPolygonsByOptimizer(support_polygons, &storage.support_config);
-            gcode_layer.addLinesByOptimizer(support_lines, &storage.support_config, (support_pattern == EFillMethod::ZIG_ZAG)? SpaceFillType::PolyLines : SpaceFillType::Lines);
-        }
+        Infill infill_comp(support_pattern, island, offset_from_outline, support_line_width, support_line_distance, support_infill_overlap, 0, z, extra_infill_shift, infill_extr.getSettingBoolean(setting_keys::support_connect_zigzags), true);
+        island_paths.infill.pattern = support_pattern;
+        infill_comp.generate(island_paths.infill.polygons, island_paths.infill.lines);
     }
+    return island_fill_paths;
 }
 
-void FffGcodeWriter::addSupportRoofsToGCode(SliceDataStorage& storage, GCodePlanner& gcode_layer, int layer_nr)
+void FffGcodeWriter::addSupportInfillToGCode(SliceDataStorage& storage, GCodePlanner& gcode_layer, int layer_nr, std::vector<SupportIslandFillPaths>& support_islands)
 {
     if (!storage.support.generated 
         || layer_nr > storage.support.layer_nr_max_filled_layer 
-        || storage.support.supportLayers[layer_nr].skin.size() == 0)
+        || storage.support.supportLayers[layer_nr].supportAreas.size() == 0)
     {
         return;
     }
 
-    int64_t z = layer_nr * getSettingInMicrons("layer_height");
+    int infill_extruder_nr_here = (layer_nr == 0)? getSettingAsIndex(setting_keys::support_extruder_nr_layer_0) : getSettingAsIndex(setting_keys::support_infill_extruder_nr);
+
+    PathOrderOptimizer island_order_optimizer(gcode_layer.getLastPosition());
+    for(unsigned int n=0; n<support_islands.size(); n++)
+    {
+        island_order_optimizer.addPolygon(support_islands[n].island[0]);
+    }
+    island_order_optimizer.optimize();
+
+    for(unsigned int n=0; n<support_islands.size(); n++)
+    {
+        SupportIslandFillPaths& island_paths = support_islands[island_order_optimizer.polyOrder[n]];
+
+        if (island_paths.boundary.size() > 0)
+        {
+            setExtruder_addPrime(storage, gcode_layer, layer_nr, infill_extruder_nr_here); // only switch extruder if we're sure we're going to switch
+            gcode_layer.addPolygonsByOptimizer(island_paths.boundary, &storage.support_config);
+        }
+
+        FillPaths& infill = island_paths.infill;
+        if (infill.lines.size() > 0 || infill.polygons.size() > 0)
+        {
+            setExtruder_addPrime(storage, gcode_layer, layer_nr, infill_extruder_nr_here); // only switch extruder if we're sure we're going to switch
+            gcode_layer.addPolygonsByOptimizer(infill.polygons, &storage.support_config);
+            gcode_layer.addLinesByOptimizer(infill.lines, &storage.support_config, (infill.pattern == EFillMethod::ZIG_ZAG)? SpaceFillType::PolyLines : SpaceFillType::Lines);
+        }
+    }
+}
+
+FillPaths FffGcodeWriter::generateSupportRoofPaths(SliceDataStorage& storage, int layer_nr)
+{
+    int64_t z = layer_nr * getSettingInMicrons(setting_keys::layer_height);
 
-    int skin_extruder_nr = getSettingAsIndex("support_interface_extruder_nr");
+    int skin_extruder_nr = getSettingAsIndex(setting_keys::support_interface_extruder_nr);
     const ExtruderTrain& interface_extr = *storage.meshgroup->getExtruderTrain(skin_extruder_nr);
-    setExtruder_addPrime(storage, gcode_layer, layer_nr, skin_extruder_nr);
 
     EFillMethod pattern = interface_extr.getSettingAsFillMethod("support_interface_pattern");
-    int support_line_distance = interface_extr.getSettingInMicrons("support_interface_line_distance");
+    int support_line_distance = interface_extr.getSettingInMicrons(setting_keys::support_interface_line_distance);
     
     
     bool all_roofs_are_low = true;
     for (SliceMeshStorage& mesh : storage.meshes)
     {
-        if (mesh.getSettingInMicrons("support_roof_height") >= 2 * getSettingInMicrons("layer_height"))
+        if (mesh.getSettingInMicrons(setting_keys::support_roof_height) >= 2 * getSettingInMicrons(setting_keys::layer_height))
         {
             all_roofs_are_low = false;
             break;
@@ -1111,12 +1282,26 @@ void FffGcodeWriter::addSupportRoofsToGCode(SliceDataStorage& storage, GCodePlan
     int extra_infill_shift = 0;
     
     Infill infill_comp(pattern, storage.support.supportLayers[layer_nr].skin, outline_offset, storage.support_skin_config.getLineWidth(), support_line_distance, support_skin_overlap, fillAngle, z, extra_infill_shift, false, true);
-    Polygons support_polygons;
-    Polygons support_lines;
-    infill_comp.generate(support_polygons, support_lines);
+    FillPaths support_roofs;
+    support_roofs.pattern = pattern;
+    infill_comp.generate(support_roofs.polygons, support_roofs.lines);
+    return support_roofs;
+}
 
-    gcode_layer.addPolygonsByOptimizer(support_polygons, &storage.support_skin_config);
-    gcode_layer.addLinesByOptimizer(support_lines, &storage.support_skin_config, (pattern == EFillMethod::ZIG_ZAG)? SpaceFillType::PolyLines : SpaceFillType::Lines);
+void FffGcodeWriter::addSupportRoofsToGCode(SliceDataStorage& storage, GCodePlanner& gcode_layer, int layer_nr, FillPaths& support_roofs)
+{
+    if (!storage.support.generated 
+        || layer_nr > storage.support.layer_nr_max_filled_layer 
+        || storage.support.supportLayers[layer_nr].skin.size() == 0)
+    {
+        return;
+    }
+
+    int skin_extruder_nr = getSettingAsIndex(setting_keys::support_interface_extruder_nr);
+    setExtruder_addPrime(storage, gcode_layer, layer_nr, skin_extruder_nr);
+
+    gcode_layer.addPolygonsByOptimizer(support_roofs.polygons, &storage.support_skin_config);
+    gcode_layer.addLinesByOptimizer(support_roofs.lines, &storage.support_skin_config, (support_roofs.pattern == EFillMethod::ZIG_ZAG)? SpaceFillType::PolyLines : SpaceFillType::Lines);
 }
 
 void FffGcodeWriter::setExtruder_addPrime(SliceDataStorage& storage, GCodePlanner& gcode_layer, int layer_nr, int extruder_nr)
@@ -1145,12 +1330,12 @@ void FffGcodeWriter::setExtruder_addPrime(SliceDataStorage& storage, GCodePlanne
 void FffGcodeWriter::addPrimeTower(SliceDataStorage& storage, GCodePlanner& gcodeLayer, int layer_nr, int prev_extruder)
 {
     
-    if (!getSettingBoolean("prime_tower_enable"))
+    if (!getSettingBoolean(setting_keys::prime_tower_enable))
     {
         return;
     }
 
-    bool wipe = getSettingBoolean("prime_tower_wipe_enabled");
+    bool wipe = getSettingBoolean(setting_keys::prime_tower_wipe_enabled);
 
     storage.primeTower.addToGcode(storage, gcodeLayer, gcode, layer_nr, prev_extruder, wipe);
 }
@@ -1196,6 +1381,11 @@ void FffGcodeWriter::finalize()
     }
 
     gcode.writeComment("End of Gcode");
+    gcode.flushOutputStream();
+    if (encoding_stream)
+    { // end the compressed or binary stream, so that the output is complete
+        encoding_stream->finish();
+    }
     /*
     the profile string below can be executed since the M25 doesn't end the gcode on an UMO and when printing via USB.
     gcode.writeCode("M25 ;Stop reading from this point on.");
@@ -3,6 +3,8 @@
 
 
 #include <fstream>
+#include <memory> // shared_ptr, unique_ptr
+#include "utils/EncodingOutputStream.h"
 #include "utils/gettime.h"
 #include "utils/logoutput.h"
 #include "utils/NoCopy.h"
@@ -18,6 +20,7 @@
 #include "PrimeTower.h"
 #include "FanSpeedLayerTime.h"
 #include "PrintFeature.h"
+#include "wallOverlap.h"
 
 
 #include "LayerPlanBuffer.h"
@@ -26,6 +29,62 @@
 namespace cura 
 {
 
+/*!
+ * The format in which gcode is written to its target.
+ */
+enum class GCodeOutputFormat
+{
+    TEXT, //!< Plain gcode
+    GZIP, //!< Gzip compressed gcode
+    BINARY, //!< Binary gcode, see \ref BinaryGCode
+    BINARY_GZIP //!< Gzip compressed binary gcode
+};
+
+/*!
+ * The polygons and lines generated by Infill for a single area.
+ */
+struct FillPaths
+{
+    EFillMethod pattern; //!< The pattern with which the paths were generated
+    Polygons polygons;
+    Polygons lines;
+};
+
+/*!
+ * The infill and skin paths of a single layer part, and the overlap compensation of its walls.
+ */
+struct PartFillPaths
+{
+    std::vector<FillPaths> multi_layer_infill; //!< The thicker infill, for combining 2, 3, etc. layers
+    bool has_single_layer_infill = false;
+    FillPaths single_layer_infill;
+    std::vector<FillPaths> skin; //!< The paths of each skin part
+    std::vector<std::shared_ptr<WallOverlapComputation>> wall_overlaps; //!< For each inset the overlap compensation, or nullptr if the inset is printed without compensation (shared, because parts are copied into the vector of parts of a layer)
+};
+
+/*!
+ * The infill of a single support island.
+ */
+struct SupportIslandFillPaths
+{
+    PolygonsPart island;
+    Polygons boundary; //!< The polygon around the support lines, if the support pattern has one
+    FillPaths infill;
+};
+
+/*!
+ * The paths of a layer which are generated by Infill.
+ * 
+ * These don't depend on where the previous layer ended, which decides the order in which parts are printed,
+ * so they can be generated for several layers in parallel ahead of planning the layers one by one.
+ */
+struct LayerFillPaths
+{
+    std::vector<std::vector<PartFillPaths>> mesh_parts; //!< The paths of each part of each mesh, empty for meshes which aren't printed normally on this layer
+    std::vector<SupportIslandFillPaths> support_islands;
+    FillPaths support_roofs;
+};
+
 /*!
  * Secondary stage in Fused Filament Fabrication processing: The generated polygons are used in the gcode generation.
  * Some polygons in the SliceDataStorage signify areas which are to be filled with parallel lines, 
@@ -48,16 +107,25 @@ private:
     LayerPlanBuffer layer_plan_buffer; 
 
     /*!
-     * The class holding the current state of the gcode being written.
+     * The gcode file to write to when using CuraEngine as command line tool.
      * 
-     * It holds information such as the last written position etc.
+     * Declared before \ref FffGcodeWriter::gcode, which writes the gcode it still buffers when it is destroyed.
      */
-    GCodeExport gcode;
+    std::ofstream output_file;
 
     /*!
-     * The gcode file to write to when using CuraEngine as command line tool.
+     * Encodes the gcode on a background thread before writing it to the target, unless the gcode is written as plain text.
+     * 
+     * Declared after \ref FffGcodeWriter::output_file, to which it may write when it is destroyed.
      */
-    std::ofstream output_file;
+    std::unique_ptr<EncodingOutputStream> encoding_stream;
+
+    /*!
+     * The class holding the current state of the gcode being written.
+     * 
+     * It holds information such as the last written position etc.
+     */
+    GCodeExport gcode;
 
     /*!
      * Whether the skirt or brim polygons have been processed into planned paths
@@ -87,13 +155,14 @@ public:
      * Used when CuraEngine is used as command line tool.
      * 
      * \param filename The filename of the file to which to write the gcode.
+     * \param format The format in which to write the gcode
      */
-    bool setTargetFile(const char* filename)
+    bool setTargetFile(const char* filename, GCodeOutputFormat format = GCodeOutputFormat::TEXT)
     {
-        output_file.open(filename);
+        output_file.open(filename, (format == GCodeOutputFormat::TEXT) ? std::ios::out : std::ios::out | std::ios::binary);
         if (output_file.is_open())
         {
-            gcode.setOutputStream(&output_file);
+            setTargetStream(&output_file, format);
             return true;
         }
         return false;
@@ -104,12 +173,13 @@ public:
      * 
      * Used when CuraEngine is NOT used as command line tool.
      * 
+     * Compressed and binary gcode are encoded on a background thread while the gcode is generated.
+     * The encoded stream is ended by \ref FffGcodeWriter::finalize.
+     * 
      * \param stream The stream to write gcode to.
+     * \param format The format in which to write the gcode
      */
-    void setTargetStream(std::ostream* stream)
-    {
-        gcode.setOutputStream(stream);
-    }
+    void setTargetStream(std::ostream* stream, GCodeOutputFormat format = GCodeOutputFormat::TEXT);
 
     /*!
      * Get the total extruded volume for a specific extruder in mm^3
@@ -200,6 +270,58 @@ private:
      */
     void processRaft(SliceDataStorage& storage, unsigned int total_layers);
 
+    /*!
+     * Convert the polygon data of a range of layers into layer plans on the FffGcodeWriter::layer_plan_buffer
+     * 
+     * The layers are processed in batches: the fill paths of all layers in a batch are generated in parallel,
+     * after which the layers are planned in order while the worker threads already generate the fill paths of the next batch.
+     * 
+     * \param[in] storage where the slice data is stored.
+     * \param start_layer_nr The index of the first layer to write the gcode of.
+     * \param end_layer_nr One past the index of the last layer to write the gcode of.
+     * \param total_layers The total number of layers.
+     */
+    void processLayers(SliceDataStorage& storage, int start_layer_nr, int end_layer_nr, unsigned int total_layers);
+
+    /*!
+     * Generate the infill, skin and support paths of a layer.
+     * 
+     * Only reads \p storage, so that it can be called for several layers at once.
+     * 
+     * \param[in] storage where the slice data is stored.
+     * \param layer_nr The index of the layer, negative for the layers between the raft and the model.
+     * \return The paths to use in FffGcodeWriter::processLayer
+     */
+    LayerFillPaths generateLayerFillPaths(SliceDataStorage& storage, int layer_nr);
+
+    /*!
+     * Generate the infill and skin paths of a single layer part.
+     * 
+     * \param mesh The mesh of the part.
+     * \param part The part for which to generate the paths.
+     * \param layer_nr The current layer number.
+     * \return The paths to use in FffGcodeWriter::processMultiLayerInfill, FffGcodeWriter::processSingleLayerInfill, FffGcodeWriter::processInsets and FffGcodeWriter::processSkin
+     */
+    PartFillPaths generatePartFillPaths(SliceMeshStorage* mesh, SliceLayerPart& part, unsigned int layer_nr);
+
+    /*!
+     * Generate the support infill paths of a layer, per support island.
+     * 
+     * \param[in] storage where the slice data is stored.
+     * \param layer_nr The index of the layer.
+     * \return The paths to use in FffGcodeWriter::addSupportInfillToGCode
+     */
+    std::vector<SupportIslandFillPaths> generateSupportInfillPaths(SliceDataStorage& storage, int layer_nr);
+
+    /*!
+     * Generate the support roof paths of a layer.
+     * 
+     * \param[in] storage where the slice data is stored.
+     * \param layer_nr The index of the layer.
+     * \return The paths to use in FffGcodeWriter::addSupportRoofsToGCode
+     */
+    FillPaths generateSupportRoofPaths(SliceDataStorage& storage, int layer_nr);
+
     /*!
      * Convert the polygon data of a layer into a layer plan on the FffGcodeWriter::layer_plan_buffer
      * 
@@ -209,8 +331,9 @@ private:
      * \param[in] storage where the slice data is stored.
      * \param layer_nr The index of the layer to write the gcode of.
      * \param total_layers The total number of layers.
+     * \param fill_paths The paths generated for this layer by FffGcodeWriter::generateLayerFillPaths
      */
-    void processLayer(SliceDataStorage& storage, int layer_nr, unsigned int total_layers);
+    void processLayer(SliceDataStorage& storage, int layer_nr, unsigned int total_layers, LayerFillPaths& fill_paths);
     
     /*!
      * Add the skirt or the brim to the layer plan \p gcodeLayer.
@@ -270,6 +393,14 @@ private:
      * 
      */
     void addMeshOpenPolyLinesToGCode(SliceDataStorage& storage, SliceMeshStorage* mesh, GCodePlanner& gcode_layer, int layer_nr);
+
+    /*!
+     * Whether a layer of a mesh has any parts to print.
+     * 
+     * \param mesh The mesh to check.
+     * \param layer_nr The index of the layer to check.
+     */
+    bool hasPartsToPrint(SliceMeshStorage* mesh, int layer_nr);
     
     /*!
      * Add a single layer from a single mesh-volume to the layer plan \p gcodeLayer.
@@ -278,34 +409,27 @@ private:
      * \param mesh The mesh to add to the layer plan \p gcodeLayer.
      * \param gcodeLayer The initial planning of the gcode of the layer.
      * \param layer_nr The index of the layer to write the gcode of.
+     * \param part_fill_paths The infill and skin paths of each part of the layer.
      * 
      */
-    void addMeshLayerToGCode(SliceDataStorage& storage, SliceMeshStorage* mesh, GCodePlanner& gcodeLayer, int layer_nr);
+    void addMeshLayerToGCode(SliceDataStorage& storage, SliceMeshStorage* mesh, GCodePlanner& gcodeLayer, int layer_nr, std::vector<PartFillPaths>& part_fill_paths);
     
     /*!
      * Add thicker (multiple layers) sparse infill for a given part in a layer plan.
      * 
      * \param gcodeLayer The initial planning of the gcode of the layer.
      * \param mesh The mesh for which to add to the layer plan \p gcodeLayer.
-     * \param part The part for which to create gcode
-     * \param layer_nr The current layer number.
-     * \param infill_line_distance The distance between the infill lines
-     * \param infill_overlap The distance by which the infill overlaps with the wall insets.
-     * \param fillAngle The angle in the XY plane at which the infill is generated.
+     * \param fill_paths The paths generated for the part
      */
-    void processMultiLayerInfill(GCodePlanner& gcodeLayer, SliceMeshStorage* mesh, SliceLayerPart& part, unsigned int layer_nr, int infill_line_distance, int infill_overlap, int fillAngle); 
+    void processMultiLayerInfill(GCodePlanner& gcodeLayer, SliceMeshStorage* mesh, PartFillPaths& fill_paths); 
     
     /*!
      * Add normal sparse infill for a given part in a layer.
      * \param gcodeLayer The initial planning of the gcode of the layer.
      * \param mesh The mesh for which to add to the layer plan \p gcodeLayer.
-     * \param part The part for which to create gcode
-     * \param layer_nr The current layer number.
-     * \param infill_line_distance The distance between the infill lines
-     * \param infill_overlap The distance by which the infill overlaps with the wall insets.
-     * \param fillAngle The angle in the XY plane at which the infill is generated.
+     * \param fill_paths The paths generated for the part
      */
-    void processSingleLayerInfill(GCodePlanner& gcodeLayer, SliceMeshStorage* mesh, SliceLayerPart& part, unsigned int layer_nr, int infill_line_distance, int infill_overlap, int fillAngle);
+    void processSingleLayerInfill(GCodePlanner& gcodeLayer, SliceMeshStorage* mesh, PartFillPaths& fill_paths);
     
     /*!
      * Generate the insets for the walls of a given layer part.
@@ -314,8 +438,9 @@ private:
      * \param part The part for which to create gcode
      * \param layer_nr The current layer number.
      * \param z_seam_type dir3ective for where to start the outer paerimeter of a part
+     * \param fill_paths The paths generated for this part by FffGcodeWriter::generatePartFillPaths, containing the overlap compensation of the insets
      */
-    void processInsets(GCodePlanner& gcodeLayer, SliceMeshStorage* mesh, SliceLayerPart& part, unsigned int layer_nr, EZSeamType z_seam_type);
+    void processInsets(GCodePlanner& gcodeLayer, SliceMeshStorage* mesh, SliceLayerPart& part, unsigned int layer_nr, EZSeamType z_seam_type, PartFillPaths& fill_paths);
     
     
     /*!
@@ -323,11 +448,9 @@ private:
      * \param gcodeLayer The initial planning of the gcode of the layer.
      * \param mesh The mesh for which to add to the layer plan \p gcodeLayer.
      * \param part The part for which to create gcode
-     * \param layer_nr The current layer number.
-     * \param skin_overlap The distance by which the skin overlaps with the wall insets.
-     * \param fillAngle The angle in the XY plane at which the infill is generated.
+     * \param fill_paths The paths generated for the part
      */
-    void processSkin(cura::GCodePlanner& gcode_layer, cura::SliceMeshStorage* mesh, cura::SliceLayerPart& part, unsigned int layer_nr, int skin_overlap, int infill_angle);
+    void processSkin(cura::GCodePlanner& gcode_layer, cura::SliceMeshStorage* mesh, cura::SliceLayerPart& part, PartFillPaths& fill_paths);
     
     /*!
      * Add the support to the layer plan \p gcodeLayer of the current layer.
@@ -336,22 +459,25 @@ private:
      * \param layer_nr The index of the layer to write the gcode of.
      * \param extruder_nr_before The extruder number at the start of the layer (before other print parts aka the rest)
      * \param before_rest Whether the function has been called before adding the rest to the layer plan \p gcodeLayer, or after.
+     * \param fill_paths The paths generated for the layer
      */
-    void addSupportToGCode(SliceDataStorage& storage, GCodePlanner& gcodeLayer, int layer_nr, int extruder_nr_before, bool before_rest);
+    void addSupportToGCode(SliceDataStorage& storage, GCodePlanner& gcodeLayer, int layer_nr, int extruder_nr_before, bool before_rest, LayerFillPaths& fill_paths);
     /*!
      * Add the support lines/walls to the layer plan \p gcodeLayer of the current layer.
      * \param[in] storage where the slice data is stored.
      * \param gcodeLayer The initial planning of the gcode of the layer.
      * \param layer_nr The index of the layer to write the gcode of.
+     * \param support_islands The paths generated for each support island of the layer
      */
-    void addSupportInfillToGCode(SliceDataStorage& storage, GCodePlanner& gcodeLayer, int layer_nr);
+    void addSupportInfillToGCode(SliceDataStorage& storage, GCodePlanner& gcodeLayer, int layer_nr, std::vector<SupportIslandFillPaths>& support_islands);
     /*!
      * Add the support skins to the layer plan \p gcodeLayer of the current layer.
      * \param[in] storage where the slice data is stored.
      * \param gcodeLayer The initial planning of the gcode of the layer.
      * \param layer_nr The index of the layer to write the gcode of.
+     * \param support_roofs The paths generated for the support roofs of the layer
      */
-    void addSupportRoofsToGCode(SliceDataStorage& storage, GCodePlanner& gcodeLayer, int layer_nr);
+    void addSupportRoofsToGCode(SliceDataStorage& storage, GCodePlanner& gcodeLayer, int layer_nr, FillPaths& support_roofs);
     
     /*!
      * Change to a new extruder, and add the prime tower instructions if the new extruder is different from the last.
@@ -2,11 +2,14 @@
 
 #include <algorithm>
 #include <map> // multimap (ordered map allowing duplicate keys)
+#include <memory> // unique_ptr
+#include <mutex>
 
 #include "utils/math.h"
 #include "slicer.h"
 #include "utils/gettime.h"
 #include "utils/logoutput.h"
+#include "utils/ThreadPool.h"
 #include "MeshGroup.h"
 #include "support.h"
 #include "multiVolumes.h"
@@ -27,6 +30,30 @@
 namespace cura
 {
 
+namespace setting_keys
+{
+// Settings queried per layer, per part or per path, see SettingKey
+const SettingKey alternate_extra_perimeter("alternate_extra_perimeter");
+const SettingKey bottom_layers("bottom_layers");
+const SettingKey gradual_infill_step_height("gradual_infill_step_height");
+const SettingKey gradual_infill_steps("gradual_infill_steps");
+const SettingKey infill_line_distance("infill_line_distance");
+const SettingKey infill_line_width("infill_line_width");
+const SettingKey infill_mesh("infill_mesh");
+const SettingKey infill_sparse_thickness("infill_sparse_thickness");
+const SettingKey layer_height("layer_height");
+const SettingKey magic_fuzzy_skin_enabled("magic_fuzzy_skin_enabled");
+const SettingKey magic_spiralize("magic_spiralize");
+const SettingKey skin_no_small_gaps_heuristic("skin_no_small_gaps_heuristic");
+const SettingKey skin_outline_count("skin_outline_count");
+const SettingKey support_enable("support_enable");
+const SettingKey top_layers("top_layers");
+const SettingKey wall_0_inset("wall_0_inset");
+const SettingKey wall_line_count("wall_line_count");
+const SettingKey wall_line_width_0("wall_line_width_0");
+const SettingKey wall_line_width_x("wall_line_width_x");
+}//namespace setting_keys
+
 
 bool FffPolygonGenerator::generateAreas(SliceDataStorage& storage, MeshGroup* meshgroup, TimeKeeper& timeKeeper)
 {
@@ -298,7 +325,7 @@ void FffPolygonGenerator::processBasicWallsSkinInfill(SliceDataStorage& storage,
 {
     unsigned int mesh_idx = mesh_order[mesh_order_idx];
     SliceMeshStorage& mesh = storage.meshes[mesh_idx];
-    if (mesh.getSettingBoolean("infill_mesh"))
+    if (mesh.getSettingBoolean(setting_keys::infill_mesh))
     {
         processInfillMesh(storage, mesh_order_idx, mesh_order, total_layers);
     }
@@ -314,26 +341,35 @@ void FffPolygonGenerator::processBasicWallsSkinInfill(SliceDataStorage& storage,
     mesh_inset_skin_progress_estimator->nextStage(inset_estimator);
     
     
-    // walls
-    for(unsigned int layer_number = 0; layer_number < total_layers; layer_number++)
-    {
-        logDebug("Processing insets for layer %i of %i\n", layer_number, total_layers);
-        processInsets(mesh, layer_number);
-        double progress = inset_skin_progress_estimate.progress(layer_number);
-        Progress::messageProgress(Progress::Stage::INSET_SKIN, progress * 100, 100);
-    }
+    // Layers finish in any order, so progress is counted under a lock to only ever increase
+    std::mutex progress_mutex;
+    unsigned int processed_layer_count = 0;
+    auto layerProcessed = [&]()
+        {
+            std::lock_guard<std::mutex> lock(progress_mutex);
+            double progress = inset_skin_progress_estimate.progress(processed_layer_count++);
+            Progress::messageProgress(Progress::Stage::INSET_SKIN, progress * 100, 100);
+        };
+
+    // walls, every layer only uses its own parts
+    ThreadPool::getInstance().parallel_for(0, total_layers, [&](unsigned int layer_number)
+        {
+            logDebug("Processing insets for layer %i of %i\n", layer_number, total_layers);
+            processInsets(mesh, layer_number);
+            layerProcessed();
+        });
 
     ProgressEstimatorLinear* skin_estimator = new ProgressEstimatorLinear(total_layers);
     mesh_inset_skin_progress_estimator->nextStage(skin_estimator);
 
-    bool process_infill = mesh.getSettingInMicrons("infill_line_distance") > 0;
+    bool process_infill = mesh.getSettingInMicrons(setting_keys::infill_line_distance) > 0;
     if (!process_infill)
     { // do process infill anyway if it's modified by modifier meshes
         for (unsigned int other_mesh_order_idx(mesh_order_idx + 1); other_mesh_order_idx < mesh_order.size(); ++other_mesh_order_idx)
         {
             unsigned int other_mesh_idx = mesh_order[other_mesh_order_idx];
             SliceMeshStorage& other_mesh = storage.meshes[other_mesh_idx];
-            if (other_mesh.getSettingBoolean("infill_mesh"))
+            if (other_mesh.getSettingBoolean(setting_keys::infill_mesh))
             {
                 AABB3D aabb = storage.meshgroup->meshes[mesh_idx].getAABB();
                 AABB3D other_aabb = storage.meshgroup->meshes[other_mesh_idx].getAABB();
@@ -347,20 +383,29 @@ void FffPolygonGenerator::processBasicWallsSkinInfill(SliceDataStorage& storage,
     // skin & infill
 //     Progress::messageProgressStage(Progress::Stage::SKIN, &time_keeper);
     int mesh_max_bottom_layer_count = 0;
-    if (mesh.getSettingBoolean("magic_spiralize"))
+    if (mesh.getSettingBoolean(setting_keys::magic_spiralize))
     {
-        mesh_max_bottom_layer_count = std::max(mesh_max_bottom_layer_count, mesh.getSettingAsCount("bottom_layers"));
+        mesh_max_bottom_layer_count = std::max(mesh_max_bottom_layer_count, mesh.getSettingAsCount(setting_keys::bottom_layers));
     }
-    for(unsigned int layer_number = 0; layer_number < total_layers; layer_number++)
+    const bool magic_spiralize = mesh.getSettingBoolean(setting_keys::magic_spiralize);
+    const unsigned int skin_layer_count = magic_spiralize ? std::min(total_layers, static_cast<size_t>(mesh_max_bottom_layer_count)) : total_layers;
+    // the areas inside the walls of the top and bottom skin ranges are computed for all layers with skin at once
+    std::unique_ptr<SkinNotAir> skin_not_air;
+    if (skin_layer_count > 0 && !mesh.getSettingBoolean(setting_keys::skin_no_small_gaps_heuristic) && mesh.getSettingAsSurfaceMode("magic_mesh_surface_mode") != ESurfaceMode::SURFACE)
     {
-        logDebug("Processing skins and infill layer %i of %i\n", layer_number, total_layers);
-        if (!mesh.getSettingBoolean("magic_spiralize") || static_cast<int>(layer_number) < mesh_max_bottom_layer_count)    //Only generate up/downskin and infill for the first X layers when spiralize is choosen.
-        {
-            processSkinsAndInfill(mesh, layer_number, process_infill);
-        }
-        double progress = inset_skin_progress_estimate.progress(layer_number);
-        Progress::messageProgress(Progress::Stage::INSET_SKIN, progress * 100, 100);
+        skin_not_air = std::unique_ptr<SkinNotAir>(new SkinNotAir(mesh, mesh.getSettingAsCount(setting_keys::bottom_layers), mesh.getSettingAsCount(setting_keys::top_layers), mesh.getSettingAsCount(setting_keys::wall_line_count), skin_layer_count));
     }
+    // every layer only reads the walls of the layers within its top and bottom skin range, which are all done, and writes its own skin and infill
+    processed_layer_count = 0;
+    ThreadPool::getInstance().parallel_for(0, total_layers, [&](unsigned int layer_number)
+        {
+            logDebug("Processing skins and infill layer %i of %i\n", layer_number, total_layers);
+            if (layer_number < skin_layer_count)    //Only generate up/downskin and infill for the first X layers when spiralize is choosen.
+            {
+                processSkinsAndInfill(mesh, layer_number, process_infill, skin_not_air.get());
+            }
+            layerProcessed();
+        });
 }
 
 void FffPolygonGenerator::processInfillMesh(SliceDataStorage& storage, unsigned int mesh_order_idx, std::vector<unsigned int>& mesh_order, size_t total_layers)
@@ -437,14 +482,14 @@ void FffPolygonGenerator::processInfillMesh(SliceDataStorage& storage, unsigned
 void FffPolygonGenerator::processDerivedWallsSkinInfill(SliceMeshStorage& mesh, size_t total_layers)
 {
     // create gradual infill areas
-    SkinInfillAreaComputation::generateGradualInfill(mesh, mesh.getSettingInMicrons("gradual_infill_step_height"), mesh.getSettingAsCount("gradual_infill_steps"));
+    SkinInfillAreaComputation::generateGradualInfill(mesh, mesh.getSettingInMicrons(setting_keys::gradual_infill_step_height), mesh.getSettingAsCount(setting_keys::gradual_infill_steps));
 
     // combine infill
-    unsigned int combined_infill_layers = std::max(1U, round_divide(mesh.getSettingInMicrons("infill_sparse_thickness"), std::max(getSettingInMicrons("layer_height"), 1))); //How many infill layers to combine to obtain the requested sparse thickness.
+    unsigned int combined_infill_layers = std::max(1U, round_divide(mesh.getSettingInMicrons(setting_keys::infill_sparse_thickness), std::max(getSettingInMicrons(setting_keys::layer_height), 1))); //How many infill layers to combine to obtain the requested sparse thickness.
     combineInfillLayers(mesh,combined_infill_layers);
 
     // fuzzy skin
-    if (mesh.getSettingBoolean("magic_fuzzy_skin_enabled"))
+    if (mesh.getSettingBoolean(setting_keys::magic_fuzzy_skin_enabled))
     {
         processFuzzyWalls(mesh);
     }
@@ -455,15 +500,15 @@ void FffPolygonGenerator::processInsets(SliceMeshStorage& mesh, unsigned int lay
     SliceLayer* layer = &mesh.layers[layer_nr];
     if (mesh.getSettingAsSurfaceMode("magic_mesh_surface_mode") != ESurfaceMode::SURFACE)
     {
-        int inset_count = mesh.getSettingAsCount("wall_line_count");
-        if (mesh.getSettingBoolean("magic_spiralize") && static_cast<int>(layer_nr) < mesh.getSettingAsCount("bottom_layers") && layer_nr % 2 == 1)//Add extra insets every 2 layers when spiralizing, this makes bottoms of cups watertight.
+        int inset_count = mesh.getSettingAsCount(setting_keys::wall_line_count);
+        if (mesh.getSettingBoolean(setting_keys::magic_spiralize) && static_cast<int>(layer_nr) < mesh.getSettingAsCount(setting_keys::bottom_layers) && layer_nr % 2 == 1)//Add extra insets every 2 layers when spiralizing, this makes bottoms of cups watertight.
             inset_count += 5;
-        int line_width_x = mesh.getSettingInMicrons("wall_line_width_x");
-        int line_width_0 = mesh.getSettingInMicrons("wall_line_width_0");
-        if (mesh.getSettingBoolean("alternate_extra_perimeter"))
+        int line_width_x = mesh.getSettingInMicrons(setting_keys::wall_line_width_x);
+        int line_width_0 = mesh.getSettingInMicrons(setting_keys::wall_line_width_0);
+        if (mesh.getSettingBoolean(setting_keys::alternate_extra_perimeter))
             inset_count += layer_nr % 2; 
-        bool recompute_outline_based_on_outer_wall = mesh.getSettingBoolean("support_enable");
-        WallsComputation walls_computation(mesh.getSettingInMicrons("wall_0_inset"), line_width_0, line_width_x, inset_count, recompute_outline_based_on_outer_wall);
+        bool recompute_outline_based_on_outer_wall = mesh.getSettingBoolean(setting_keys::support_enable);
+        WallsComputation walls_computation(mesh.getSettingInMicrons(setting_keys::wall_0_inset), line_width_0, line_width_x, inset_count, recompute_outline_based_on_outer_wall);
         walls_computation.generateInsets(layer);
     }
 }
@@ -515,22 +560,22 @@ void FffPolygonGenerator::removeEmptyFirstLayers(SliceDataStorage& storage, cons
     }
 }
   
-void FffPolygonGenerator::processSkinsAndInfill(SliceMeshStorage& mesh, unsigned int layer_nr, bool process_infill) 
+void FffPolygonGenerator::processSkinsAndInfill(SliceMeshStorage& mesh, unsigned int layer_nr, bool process_infill, const SkinNotAir* skin_not_air) 
 {
     if (mesh.getSettingAsSurfaceMode("magic_mesh_surface_mode") == ESurfaceMode::SURFACE) 
     { 
         return;
     }
 
-    const int wall_line_count = mesh.getSettingAsCount("wall_line_count");
-    const int innermost_wall_line_width = (wall_line_count == 1) ? mesh.getSettingInMicrons("wall_line_width_0") : mesh.getSettingInMicrons("wall_line_width_x");
-    generateSkins(layer_nr, mesh, mesh.getSettingAsCount("bottom_layers"), mesh.getSettingAsCount("top_layers"), wall_line_count, innermost_wall_line_width, mesh.getSettingAsCount("skin_outline_count"), mesh.getSettingBoolean("skin_no_small_gaps_heuristic"));
+    const int wall_line_count = mesh.getSettingAsCount(setting_keys::wall_line_count);
+    const int innermost_wall_line_width = (wall_line_count == 1) ? mesh.getSettingInMicrons(setting_keys::wall_line_width_0) : mesh.getSettingInMicrons(setting_keys::wall_line_width_x);
+    generateSkins(layer_nr, mesh, mesh.getSettingAsCount(setting_keys::bottom_layers), mesh.getSettingAsCount(setting_keys::top_layers), wall_line_count, innermost_wall_line_width, mesh.getSettingAsCount(setting_keys::skin_outline_count), mesh.getSettingBoolean(setting_keys::skin_no_small_gaps_heuristic), skin_not_air);
 
     if (process_infill)
     { // process infill when infill density > 0
         // or when other infill meshes want to modify this infill
         int infill_skin_overlap = 0;
-        bool infill_is_dense = mesh.getSettingInMicrons("infill_line_distance") < mesh.getSettingInMicrons("infill_line_width") + 10;
+        bool infill_is_dense = mesh.getSettingInMicrons(setting_keys::infill_line_distance) < mesh.getSettingInMicrons(setting_keys::infill_line_width) + 10;
         if (!infill_is_dense && mesh.getSettingAsFillMethod("infill_pattern") != EFillMethod::CONCENTRIC)
         {
             infill_skin_overlap = innermost_wall_line_width / 2;
@@ -16,6 +16,8 @@
 namespace cura
 {
 
+class SkinNotAir;
+
 /*!
  * Primary stage in Fused Filament Fabrication processing: Polygons are generated.
  * The model is sliced and each slice consists of polygons representing the outlines: the boundaries between inside and outside the object.
@@ -137,8 +139,9 @@ private:
      * \param mesh Input and Output parameter: fetches the outline information (see SliceLayerPart::outline) and generates the other reachable field of the \p storage
      * \param layer_nr The layer for which to generate the skin areas.
      * \param process_infill Generate infill areas
+     * \param skin_not_air The areas inside the walls of the skin ranges of all layers, only needed without the small gaps heuristic
      */
-    void processSkinsAndInfill(SliceMeshStorage& mesh, unsigned int layer_nr, bool process_infill); 
+    void processSkinsAndInfill(SliceMeshStorage& mesh, unsigned int layer_nr, bool process_infill, const SkinNotAir* skin_not_air); 
 
     /*!
      * Generate the polygons where the draft screen should be.
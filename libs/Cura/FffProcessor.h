@@ -102,10 +102,11 @@ public:
      * Used when CuraEngine is used as command line tool.
      * 
      * \param filename The filename of the file to which to write the gcode.
+     * \param format The format in which to write the gcode
      */
-    bool setTargetFile(const char* filename)
+    bool setTargetFile(const char* filename, GCodeOutputFormat format = GCodeOutputFormat::TEXT)
     {
-        return gcode_writer.setTargetFile(filename);
+        return gcode_writer.setTargetFile(filename, format);
     }
 
     /*!
@@ -114,10 +115,11 @@ public:
      * Used when CuraEngine is NOT used as command line tool.
      * 
      * \param stream The stream to write gcode to.
+     * \param format The format in which to write the gcode
      */
-    void setTargetStream(std::ostream* stream)
+    void setTargetStream(std::ostream* stream, GCodeOutputFormat format = GCodeOutputFormat::TEXT)
     {
-        return gcode_writer.setTargetStream(stream);
+        return gcode_writer.setTargetStream(stream, format);
     }
 
     /*!
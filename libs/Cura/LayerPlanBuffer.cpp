@@ -20,6 +20,7 @@ void LayerPlanBuffer::flush()
         buffer.front().writeGCode(gcode);
         if (CommandSocket::isInstantiated())
         {
+            gcode.flushOutputStream();
             CommandSocket::getInstance()->flushGcode();
         }
         buffer.pop_front();
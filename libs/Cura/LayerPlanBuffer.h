@@ -57,6 +57,7 @@ public:
             buffer.front().writeGCode(gcode);
             if (CommandSocket::isInstantiated())
             {
+                gcode.flushOutputStream();
                 CommandSocket::getInstance()->flushGcode();
             }
             buffer.pop_front();
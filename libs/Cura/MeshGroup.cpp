@@ -6,7 +6,9 @@
 #include "MeshGroup.h"
 #include "utils/gettime.h"
 #include "utils/logoutput.h"
+#include "utils/MappedFile.h"
 #include "utils/string.h"
+#include "utils/ThreadPool.h"
 
 #include "settings/SettingRegistry.h" // loadExtruderJSONsettings
 
@@ -15,22 +17,6 @@ namespace cura
 
 FILE* binaryMeshBlob = nullptr;
 
-/* Custom fgets function to support Mac line-ends in Ascii STL files. OpenSCAD produces this when used on Mac */
-void* fgets_(char* ptr, size_t len, FILE* f)
-{
-    while(len && fread(ptr, 1, 1, f) > 0)
-    {
-        if (*ptr == '\n' || *ptr == '\r')
-        {
-            *ptr = '\0';
-            return ptr;
-        }
-        ptr++;
-        len--;
-    }
-    return nullptr;
-}
-
 MeshGroup::MeshGroup(SettingsBaseVirtual* settings_base)
 : SettingsBase(settings_base)
 , extruder_count(-1)
@@ -183,63 +169,232 @@ void MeshGroup::finalize()
     }
 }
 
-bool loadMeshSTL_ascii(Mesh* mesh, const char* filename, const FMatrix3x3& matrix)
+namespace
+{
+
+const size_t binary_stl_header_size = 80 + sizeof(uint32_t); //!< The header text and the face count
+const size_t binary_stl_face_size = 50; //!< Normal(3*float), Vertices(9*float), 2 Bytes Spacer
+const size_t ascii_stl_chunk_size = 1 << 22; //!< Number of bytes of an ASCII STL parsed by one task
+
+inline bool isLineEnd(char c)
+{
+    return c == '\n' || c == '\r'; // Mac line-ends are used by OpenSCAD on Mac
+}
+
+inline bool isBlank(char c)
 {
-    FILE* f = fopen(filename, "rt");
-    char buffer[1024];
-    FPoint3 vertex;
+    return c == ' ' || c == '\t' || c == '\v' || c == '\f';
+}
+
+/*!
+ * Parse a float the way sscanf's %f does, skipping leading blanks.
+ *
+ * Plain decimal numbers with at most 7 to 8 significant digits and a small exponent are computed with a single exactly rounded float operation,
+ * which gives the same result as strtof. Anything else is handed to strtof.
+ *
+ * \param[in,out] pos The position to parse from, moved past the number
+ * \param end The end of the line
+ * \param[out] value The parsed number
+ * \return Whether there was a number
+ */
+bool parseFloat(const char*& pos, const char* end, float& value)
+{
+    static const float powers_of_ten[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f }; // all exactly representable
+    const uint64_t max_exact_mantissa = 1 << 24;
+
+    while (pos < end && isBlank(*pos))
+    {
+        pos++;
+    }
+    const char* p = pos;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        p++;
+    }
+    uint64_t mantissa = 0;
+    int digit_count = 0;
+    int exponent = 0;
+    for (; p < end && isdigit(static_cast<unsigned char>(*p)); p++, digit_count++)
+    {
+        mantissa = mantissa * 10 + (*p - '0');
+    }
+    if (p < end && *p == '.')
+    {
+        for (p++; p < end && isdigit(static_cast<unsigned char>(*p)); p++, digit_count++)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            exponent--;
+        }
+    }
+    bool fast_path = digit_count > 0 && digit_count <= 18;
+    if (fast_path && p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        bool negative_exponent = false;
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            negative_exponent = *p == '-';
+            p++;
+        }
+        int exponent_value = 0;
+        int exponent_digit_count = 0;
+        for (; p < end && isdigit(static_cast<unsigned char>(*p)) && exponent_digit_count < 4; p++, exponent_digit_count++)
+        {
+            exponent_value = exponent_value * 10 + (*p - '0');
+        }
+        fast_path = exponent_digit_count > 0 && exponent_digit_count < 4;
+        exponent += negative_exponent ? -exponent_value : exponent_value;
+    }
+    fast_path = fast_path && (p == end || !(isalnum(static_cast<unsigned char>(*p)) || *p == '.')); // e.g. hexadecimal or out of range exponents
+    while (fast_path && mantissa > max_exact_mantissa && mantissa % 10 == 0)
+    {
+        mantissa /= 10;
+        exponent++;
+    }
+    if (fast_path && mantissa <= max_exact_mantissa && exponent >= -10 && exponent <= 10)
+    {
+        value = (exponent >= 0) ? float(mantissa) * powers_of_ten[exponent] : float(mantissa) / powers_of_ten[-exponent];
+        if (negative)
+        {
+            value = -value;
+        }
+        pos = p;
+        return true;
+    }
+
+    char token[64];
+    size_t token_size = 0;
+    for (p = pos; p < end && !isspace(static_cast<unsigned char>(*p)) && token_size < sizeof(token) - 1; p++)
+    {
+        token[token_size++] = *p;
+    }
+    token[token_size] = '\0';
+    char* token_end;
+    value = strtof(token, &token_end);
+    if (token_end == token)
+    {
+        return false;
+    }
+    pos += token_end - token;
+    return true;
+}
+
+/*!
+ * Parse the vertex lines (" vertex %f %f %f") of part of an ASCII STL.
+ *
+ * \param begin The start of the first line to parse
+ * \param end The end of the last line to parse
+ * \param matrix The transformation to apply to the vertices
+ * \param[out] vertices The transformed vertices, in file order
+ */
+void parseSTLVertices(const char* begin, const char* end, const FMatrix3x3& matrix, std::vector<Point3>& vertices)
+{
+    const char* line = begin;
+    while (line < end)
+    {
+        const char* line_end = line;
+        while (line_end < end && !isLineEnd(*line_end))
+        {
+            line_end++;
+        }
+
+        const char* pos = line;
+        while (pos < line_end && isspace(static_cast<unsigned char>(*pos)))
+        {
+            pos++;
+        }
+        FPoint3 vertex;
+        if (line_end - pos >= 6 && strncmp(pos, "vertex", 6) == 0)
+        {
+            pos += 6;
+            if (parseFloat(pos, line_end, vertex.x) && parseFloat(pos, line_end, vertex.y) && parseFloat(pos, line_end, vertex.z))
+            {
+                vertices.push_back(matrix.apply(vertex));
+            }
+        }
+        line = line_end + 1;
+    }
+}
+
+/*!
+ * Report how fast a mesh file was parsed.
+ */
+void logThroughput(const char* format, size_t file_size, double seconds)
+{
+    const double megabytes = file_size / (1024.0 * 1024.0);
+    log("parsing %.1f MB of %s STL took %.3f seconds (%.1f MB/s)\n", megabytes, format, seconds, (seconds > 0) ? megabytes / seconds : 0.0);
+}
+
+}//anonymous namespace
+
+bool loadMeshSTL_ascii(Mesh* mesh, const MappedFile& file, const FMatrix3x3& matrix)
+{
+    TimeKeeper parse_timer;
+
+    // Parse chunks of whole lines in parallel, then add the vertices in file order so that every third vertex completes a face like in a serial pass.
+    const char* const file_end = file.data() + file.size();
+    std::vector<const char*> chunk_starts(1, file.data());
+    while (static_cast<size_t>(file_end - chunk_starts.back()) > ascii_stl_chunk_size)
+    {
+        const char* chunk_start = chunk_starts.back() + ascii_stl_chunk_size;
+        while (chunk_start < file_end && !isLineEnd(chunk_start[-1]))
+        {
+            chunk_start++;
+        }
+        chunk_starts.push_back(chunk_start);
+    }
+    chunk_starts.push_back(file_end);
+
+    std::vector<std::vector<Point3>> chunk_vertices(chunk_starts.size() - 1);
+    ThreadPool::getInstance().parallel_for(0, chunk_vertices.size(), [&](size_t chunk_idx)
+        {
+            parseSTLVertices(chunk_starts[chunk_idx], chunk_starts[chunk_idx + 1], matrix, chunk_vertices[chunk_idx]);
+        });
+
     int n = 0;
     Point3 v0(0,0,0), v1(0,0,0), v2(0,0,0);
-    while(fgets_(buffer, sizeof(buffer), f))
+    for (std::vector<Point3>& vertices : chunk_vertices)
     {
-        if (sscanf(buffer, " vertex %f %f %f", &vertex.x, &vertex.y, &vertex.z) == 3)
+        for (Point3& vertex : vertices)
         {
             n++;
             switch(n)
             {
             case 1:
-                v0 = matrix.apply(vertex);
+                v0 = vertex;
                 break;
             case 2:
-                v1 = matrix.apply(vertex);
+                v1 = vertex;
                 break;
             case 3:
-                v2 = matrix.apply(vertex);
+                v2 = vertex;
                 mesh->addFace(v0, v1, v2);
                 n = 0;
                 break;
             }
         }
+        std::vector<Point3>().swap(vertices);
     }
-    fclose(f);
     mesh->finish();
+    logThroughput("ASCII", file.size(), parse_timer.restart());
     return true;
 }
 
-bool loadMeshSTL_binary(Mesh* mesh, const char* filename, const FMatrix3x3& matrix)
+bool loadMeshSTL_binary(Mesh* mesh, const MappedFile& file, const FMatrix3x3& matrix)
 {
-    FILE* f = fopen(filename, "rb");
+    TimeKeeper parse_timer;
 
-    fseek(f, 0L, SEEK_END);
-    long long file_size = ftell(f); //The file size is the position of the cursor after seeking to the end.
-    rewind(f); //Seek back to start.
-    size_t face_count = (file_size - 80 - sizeof(uint32_t)) / 50; //Subtract the size of the header. Every face uses exactly 50 bytes.
-
-    char buffer[80];
-    //Skip the header
-    if (fread(buffer, 80, 1, f) != 1)
+    if (file.size() < binary_stl_header_size)
     {
-        fclose(f);
         return false;
     }
+    size_t face_count = (file.size() - binary_stl_header_size) / binary_stl_face_size;
 
     uint32_t reported_face_count;
-    //Read the face count. We'll use it as a sort of redundancy code to check for file corruption.
-    if (fread(&reported_face_count, sizeof(uint32_t), 1, f) != 1)
-    {
-        fclose(f);
-        return false;
-    }
+    //Read the face count after the header text. We'll use it as a sort of redundancy code to check for file corruption.
+    memcpy(&reported_face_count, file.data() + 80, sizeof(uint32_t));
     if (reported_face_count != face_count)
     {
         logWarning("Face count reported by file (%s) is not equal to actual face count (%s). File could be corrupt!\n", std::to_string(reported_face_count).c_str(), std::to_string(face_count).c_str());
@@ -247,67 +402,56 @@ bool loadMeshSTL_binary(Mesh* mesh, const char* filename, const FMatrix3x3& matr
 
     //For each face read:
     //float(x,y,z) = normal, float(X,Y,Z)*3 = vertexes, uint16_t = flags
-    // Every Face is 50 Bytes: Normal(3*float), Vertices(9*float), 2 Bytes Spacer
+    // Decode and transform the corners of all faces in parallel, then add the faces in file order so that the vertex indices don't depend on the number of threads.
+    const char* const face_data = file.data() + binary_stl_header_size;
+    std::vector<Point3> corners(face_count * 3);
+    ThreadPool::getInstance().parallel_for(0, face_count, [&](size_t face_idx)
+        {
+            float v[9];
+            memcpy(v, face_data + face_idx * binary_stl_face_size + 3 * sizeof(float), sizeof(v)); // faces aren't aligned for floats
+            for (int corner = 0; corner < 3; corner++)
+            {
+                corners[face_idx * 3 + corner] = matrix.apply(FPoint3(v[corner * 3], v[corner * 3 + 1], v[corner * 3 + 2]));
+            }
+        }, 4096);
+
     mesh->faces.reserve(face_count);
     mesh->vertices.reserve(face_count);
-    for (unsigned int i = 0; i < face_count; i++)
+    for (size_t face_idx = 0; face_idx < face_count; face_idx++)
     {
-        if (fread(buffer, 50, 1, f) != 1)
-        {
-            fclose(f);
-            return false;
-        }
-        float *v= ((float*)buffer)+3;
-
-        Point3 v0 = matrix.apply(FPoint3(v[0], v[1], v[2]));
-        Point3 v1 = matrix.apply(FPoint3(v[3], v[4], v[5]));
-        Point3 v2 = matrix.apply(FPoint3(v[6], v[7], v[8]));
-        mesh->addFace(v0, v1, v2);
+        mesh->addFace(corners[face_idx * 3 + 0], corners[face_idx * 3 + 1], corners[face_idx * 3 + 2]);
     }
-    fclose(f);
     mesh->finish();
+    logThroughput("binary", file.size(), parse_timer.restart());
     return true;
 }
 
 bool loadMeshSTL(Mesh* mesh, const char* filename, const FMatrix3x3& matrix)
 {
-    FILE* f = fopen(filename, "r");
-    if (f == nullptr)
+    MappedFile file(filename);
+    if (!file.isOpen())
     {
         return false;
     }
 
     //Skip any whitespace at the beginning of the file.
-    unsigned long long num_whitespace = 0; //Number of whitespace characters.
-    unsigned char whitespace;
-    if (fread(&whitespace, 1, 1, f) != 1)
-    {
-        fclose(f);
-        return false;
-    }
-    while(isspace(whitespace))
+    const char* start = file.data();
+    const char* const file_end = file.data() + file.size();
+    while (start < file_end && isspace(static_cast<unsigned char>(*start)))
     {
-        num_whitespace++;
-        if (fread(&whitespace, 1, 1, f) != 1)
-        {
-            fclose(f);
-            return false;
-        }
+        start++;
     }
-    fseek(f, num_whitespace, SEEK_SET); //Seek to the place after all whitespace (we may have just read too far).
-
-    char buffer[6];
-    if (fread(buffer, 5, 1, f) != 1)
+    if (file_end - start < 5)
     {
-        fclose(f);
         return false;
     }
-    fclose(f);
 
+    char buffer[6];
+    memcpy(buffer, start, 5);
     buffer[5] = '\0';
     if (stringcasecompare(buffer, "solid") == 0)
     {
-        bool load_success = loadMeshSTL_ascii(mesh, filename, matrix);
+        bool load_success = loadMeshSTL_ascii(mesh, file, matrix);
         if (!load_success)
             return false;
 
@@ -316,11 +460,11 @@ bool loadMeshSTL(Mesh* mesh, const char* filename, const FMatrix3x3& matrix)
         if (mesh->faces.size() < 1)
         {
             mesh->clear();
-            return loadMeshSTL_binary(mesh, filename, matrix);
+            return loadMeshSTL_binary(mesh, file, matrix);
         }
         return true;
     }
-    return loadMeshSTL_binary(mesh, filename, matrix);
+    return loadMeshSTL_binary(mesh, file, matrix);
 }
 
 bool loadMeshIntoMeshGroup(MeshGroup* meshgroup, const char* filename, const FMatrix3x3& transformation, SettingsBaseVirtual* object_parent_settings)
@@ -16,8 +16,6 @@ GCodeExport::GCodeExport()
 , currentPosition(0,0,MM2INT(20))
 , layer_nr(0)
 {
-    *output_stream << std::fixed;
-
     current_e_value = 0;
     current_extruder = 0;
     currentFanSpeed = -1;
@@ -193,8 +191,12 @@ void GCodeExport::setLayerNr(unsigned int layer_nr_) {
 
 void GCodeExport::setOutputStream(std::ostream* stream)
 {
-    output_stream = stream;
-    *output_stream << std::fixed;
+    output_stream.setOutputStream(stream);
+}
+
+void GCodeExport::flushOutputStream()
+{
+    output_stream.flush();
 }
 
 bool GCodeExport::getExtruderIsUsed(const int extruder_nr) const
@@ -376,22 +378,22 @@ void GCodeExport::updateTotalPrintTime()
 
 void GCodeExport::writeComment(std::string comment)
 {
-    *output_stream << ";";
+    output_stream << ";";
     for (unsigned int i = 0; i < comment.length(); i++)
     {
         if (comment[i] == '\n')
         {
-            *output_stream << "\\n";
+            output_stream << "\\n";
         }else{
-            *output_stream << comment[i];
+            output_stream << comment[i];
         }
     }
-    *output_stream << new_line;
+    output_stream << new_line;
 }
 
 void GCodeExport::writeTimeComment(const double time)
 {
-    *output_stream << ";TIME_ELAPSED:" << time << new_line;
+    output_stream << ";TIME_ELAPSED:" << time << new_line;
 }
 
 void GCodeExport::writeTypeComment(PrintFeatureType type)
@@ -399,25 +401,25 @@ void GCodeExport::writeTypeComment(PrintFeatureType type)
     switch (type)
     {
         case PrintFeatureType::OuterWall:
-            *output_stream << ";TYPE:WALL-OUTER" << new_line;
+            output_stream << ";TYPE:WALL-OUTER" << new_line;
             break;
         case PrintFeatureType::InnerWall:
-            *output_stream << ";TYPE:WALL-INNER" << new_line;
+            output_stream << ";TYPE:WALL-INNER" << new_line;
             break;
         case PrintFeatureType::Skin:
-            *output_stream << ";TYPE:SKIN" << new_line;
+            output_stream << ";TYPE:SKIN" << new_line;
             break;
         case PrintFeatureType::Support:
-            *output_stream << ";TYPE:SUPPORT" << new_line;
+            output_stream << ";TYPE:SUPPORT" << new_line;
             break;
         case PrintFeatureType::SkirtBrim:
-            *output_stream << ";TYPE:SKIRT" << new_line;
+            output_stream << ";TYPE:SKIRT" << new_line;
             break;
         case PrintFeatureType::Infill:
-            *output_stream << ";TYPE:FILL" << new_line;
+            output_stream << ";TYPE:FILL" << new_line;
             break;
         case PrintFeatureType::SupportInfill:
-            *output_stream << ";TYPE:SUPPORT" << new_line;
+            output_stream << ";TYPE:SUPPORT" << new_line;
             break;
         case PrintFeatureType::MoveCombing:
         case PrintFeatureType::MoveRetraction:
@@ -430,24 +432,24 @@ void GCodeExport::writeTypeComment(PrintFeatureType type)
 
 void GCodeExport::writeLayerComment(int layer_nr)
 {
-    *output_stream << ";LAYER:" << layer_nr << new_line;
+    output_stream << ";LAYER:" << layer_nr << new_line;
 }
 
 void GCodeExport::writeLayerCountComment(int layer_count)
 {
-    *output_stream << ";LAYER_COUNT:" << layer_count << new_line;
+    output_stream << ";LAYER_COUNT:" << layer_count << new_line;
 }
 
 void GCodeExport::writeLine(const char* line)
 {
-    *output_stream << line << new_line;
+    output_stream << line << new_line;
 }
 
 void GCodeExport::resetExtrusionValue()
 {
     if (flavor != EGCodeFlavor::MAKERBOT && flavor != EGCodeFlavor::BFB)
     {
-        *output_stream << "G92 " << extruder_attr[current_extruder].extruderCharacter << "0" << new_line;
+        output_stream << "G92 " << extruder_attr[current_extruder].extruderCharacter << "0" << new_line;
         double current_extruded_volume = getCurrentExtrudedVolume();
         extruder_attr[current_extruder].totalFilament += current_extruded_volume;
         for (double& extruded_volume_at_retraction : extruder_attr[current_extruder].extruded_volume_at_previous_n_retractions)
@@ -461,7 +463,7 @@ void GCodeExport::resetExtrusionValue()
 
 void GCodeExport::writeDelay(double timeAmount)
 {
-    *output_stream << "G4 P" << int(timeAmount * 1000) << new_line;
+    output_stream << "G4 P" << int(timeAmount * 1000) << new_line;
     estimateCalculator.addTime(timeAmount);
 }
 
@@ -494,11 +496,11 @@ void GCodeExport::writeMoveBFB(int x, int y, int z, double speed, double extrusi
             {
                 //fprintf(f, "; %f e-per-mm %d mm-width %d mm/s\n", extrusion_per_mm, lineWidth, speed);
                 //fprintf(f, "M108 S%0.1f\r\n", rpm);
-                *output_stream << "M108 S" << PrecisionedDouble{1, rpm} << new_line;
+                output_stream << "M108 S" << PrecisionedDouble{1, rpm} << new_line;
                 currentSpeed = double(rpm);
             }
             //Add M101 or M201 to enable the proper extruder.
-            *output_stream << "M" << int((current_extruder + 1) * 100 + 1) << new_line;
+            output_stream << "M" << int((current_extruder + 1) * 100 + 1) << new_line;
             extruder_attr[current_extruder].retraction_e_amount_current = 0.0;
         }
         //Fix the speed by the actual RPM we are asking, because of rounding errors we cannot get all RPM values, but we have a lot more resolution in the feedrate value.
@@ -515,12 +517,12 @@ void GCodeExport::writeMoveBFB(int x, int y, int z, double speed, double extrusi
         //If we are not extruding, check if we still need to disable the extruder. This causes a retraction due to auto-retraction.
         if (!extruder_attr[current_extruder].retraction_e_amount_current)
         {
-            *output_stream << "M103" << new_line;
+            output_stream << "M103" << new_line;
             extruder_attr[current_extruder].retraction_e_amount_current = 1.0; // 1.0 used as stub; BFB doesn't use the actual retraction amount; it performs retraction on the firmware automatically
         }
     }
-    *output_stream << "G1 X" << MMtoStream{gcode_pos.X} << " Y" << MMtoStream{gcode_pos.Y} << " Z" << MMtoStream{z};
-    *output_stream << " F" << PrecisionedDouble{1, fspeed} << new_line;
+    output_stream << "G1 X" << MMtoStream{gcode_pos.X} << " Y" << MMtoStream{gcode_pos.Y} << " Z" << MMtoStream{z};
+    output_stream << " F" << PrecisionedDouble{1, fspeed} << new_line;
     
     currentPosition = Point3(x, y, z);
     estimateCalculator.plan(TimeEstimateCalculator::Position(INT2MM(currentPosition.x), INT2MM(currentPosition.y), INT2MM(currentPosition.z), eToMm(current_e_value)), speed);
@@ -556,7 +558,7 @@ void GCodeExport::writeMove(int x, int y, int z, double speed, double extrusion_
         Point3 diff = Point3(x,y,z) - getPosition();
         if (isZHopped > 0)
         {
-            *output_stream << "G1 Z" << MMtoStream{currentPosition.z} << new_line;
+            output_stream << "G1 Z" << MMtoStream{currentPosition.z} << new_line;
             isZHopped = 0;
         }
         double prime_volume = extruder_attr[current_extruder].prime_volume;
@@ -565,11 +567,11 @@ void GCodeExport::writeMove(int x, int y, int z, double speed, double extrusion_
         {
             if (firmware_retract)
             { // note that BFB is handled differently
-                *output_stream << "G11" << new_line;
+                output_stream << "G11" << new_line;
                 //Assume default UM2 retraction settings.
                 if (prime_volume > 0)
                 {
-                    *output_stream << "G1 F" << PrecisionedDouble{1, extruder_attr[current_extruder].last_retraction_prime_speed * 60} << " " << extruder_attr[current_extruder].extruderCharacter << PrecisionedDouble{5, current_e_value} << new_line;
+                    output_stream << "G1 F" << PrecisionedDouble{1, extruder_attr[current_extruder].last_retraction_prime_speed * 60} << " " << extruder_attr[current_extruder].extruderCharacter << PrecisionedDouble{5, current_e_value} << new_line;
                     currentSpeed = extruder_attr[current_extruder].last_retraction_prime_speed;
                 }
                 estimateCalculator.plan(TimeEstimateCalculator::Position(INT2MM(currentPosition.x), INT2MM(currentPosition.y), INT2MM(currentPosition.z), eToMm(current_e_value)), 25.0);
@@ -577,7 +579,7 @@ void GCodeExport::writeMove(int x, int y, int z, double speed, double extrusion_
             else
             {
                 current_e_value += extruder_attr[current_extruder].retraction_e_amount_current;
-                *output_stream << "G1 F" << PrecisionedDouble{1, extruder_attr[current_extruder].last_retraction_prime_speed * 60} << " " << extruder_attr[current_extruder].extruderCharacter << PrecisionedDouble{5, current_e_value} << new_line;
+                output_stream << "G1 F" << PrecisionedDouble{1, extruder_attr[current_extruder].last_retraction_prime_speed * 60} << " " << extruder_attr[current_extruder].extruderCharacter << PrecisionedDouble{5, current_e_value} << new_line;
                 currentSpeed = extruder_attr[current_extruder].last_retraction_prime_speed;
                 estimateCalculator.plan(TimeEstimateCalculator::Position(INT2MM(currentPosition.x), INT2MM(currentPosition.y), INT2MM(currentPosition.z), eToMm(current_e_value)), currentSpeed);
             }
@@ -589,35 +591,35 @@ void GCodeExport::writeMove(int x, int y, int z, double speed, double extrusion_
         }
         else if (prime_volume > 0.0)
         {
-            *output_stream << "G1 F" << PrecisionedDouble{1, extruder_attr[current_extruder].last_retraction_prime_speed * 60} << " " << extruder_attr[current_extruder].extruderCharacter << PrecisionedDouble{5, current_e_value} << new_line;
+            output_stream << "G1 F" << PrecisionedDouble{1, extruder_attr[current_extruder].last_retraction_prime_speed * 60} << " " << extruder_attr[current_extruder].extruderCharacter << PrecisionedDouble{5, current_e_value} << new_line;
             currentSpeed = extruder_attr[current_extruder].last_retraction_prime_speed;
             estimateCalculator.plan(TimeEstimateCalculator::Position(INT2MM(currentPosition.x), INT2MM(currentPosition.y), INT2MM(currentPosition.z), eToMm(current_e_value)), currentSpeed);
         }
         extruder_attr[current_extruder].prime_volume = 0.0;
         current_e_value += extrusion_per_mm * diff.vSizeMM();
-        *output_stream << "G1";
+        output_stream << "G1";
     }
     else
     {
-        *output_stream << "G0";
+        output_stream << "G0";
 
         CommandSocket::sendLineTo(extruder_attr[current_extruder].retraction_e_amount_current ? PrintFeatureType::MoveRetraction : PrintFeatureType::MoveCombing, Point(x, y), extruder_attr[current_extruder].retraction_e_amount_current ? MM2INT(0.2) : MM2INT(0.1));
     }
 
     if (currentSpeed != speed)
     {
-        *output_stream << " F" << PrecisionedDouble{1, speed * 60};
+        output_stream << " F" << PrecisionedDouble{1, speed * 60};
         currentSpeed = speed;
     }
 
-    *output_stream << " X" << MMtoStream{gcode_pos.X} << " Y" << MMtoStream{gcode_pos.Y};
+    output_stream << " X" << MMtoStream{gcode_pos.X} << " Y" << MMtoStream{gcode_pos.Y};
     if (z != currentPosition.z + isZHopped)
     {
-        *output_stream << " Z" << MMtoStream{z + isZHopped};
+        output_stream << " Z" << MMtoStream{z + isZHopped};
     }
     if (extrusion_mm3_per_mm > 0.000001)
-        *output_stream << " " << extruder_attr[current_extruder].extruderCharacter << PrecisionedDouble{5, current_e_value};
-    *output_stream << new_line;
+        output_stream << " " << extruder_attr[current_extruder].extruderCharacter << PrecisionedDouble{5, current_e_value};
+    output_stream << new_line;
     
     currentPosition = Point3(x, y, z);
     estimateCalculator.plan(TimeEstimateCalculator::Position(INT2MM(currentPosition.x), INT2MM(currentPosition.y), INT2MM(currentPosition.z), eToMm(current_e_value)), speed);
@@ -632,7 +634,7 @@ void GCodeExport::writeRetraction(RetractionConfig* config, bool force, bool ext
         if (extruder_switch)
         {
             if (!extr_attr.retraction_e_amount_current)
-                *output_stream << "M103" << new_line;
+                output_stream << "M103" << new_line;
 
             extr_attr.retraction_e_amount_current = 1.0; // 1.0 is a stub; BFB doesn't use the actual retracted amount; retraction is performed by firmware
         }
@@ -678,12 +680,12 @@ void GCodeExport::writeRetraction(RetractionConfig* config, bool force, bool ext
         {
             return; 
         }
-        *output_stream << "G10";
+        output_stream << "G10";
         if (extruder_switch)
         {
-            *output_stream << " S1";
+            output_stream << " S1";
         }
-        *output_stream << new_line;
+        output_stream << new_line;
         //Assume default UM2 retraction settings.
         estimateCalculator.plan(TimeEstimateCalculator::Position(INT2MM(currentPosition.x), INT2MM(currentPosition.y), INT2MM(currentPosition.z), eToMm(current_e_value + retraction_diff_e_amount)), 25); // TODO: hardcoded values!
     }
@@ -691,7 +693,7 @@ void GCodeExport::writeRetraction(RetractionConfig* config, bool force, bool ext
     {
         double speed = ((retraction_diff_e_amount < 0.0)? config->speed : extr_attr.last_retraction_prime_speed) * 60;
         current_e_value += retraction_diff_e_amount;
-        *output_stream << "G1 F" << PrecisionedDouble{1, speed} << " "
+        output_stream << "G1 F" << PrecisionedDouble{1, speed} << " "
             << extr_attr.extruderCharacter << PrecisionedDouble{5, current_e_value} << new_line;
         currentSpeed = speed;
         estimateCalculator.plan(TimeEstimateCalculator::Position(INT2MM(currentPosition.x), INT2MM(currentPosition.y), INT2MM(currentPosition.z), eToMm(current_e_value)), currentSpeed);
@@ -708,7 +710,7 @@ void GCodeExport::writeZhopStart(int hop_height)
     if (hop_height > 0)
     {
         isZHopped = hop_height;
-        *output_stream << "G1 Z" << MMtoStream{currentPosition.z + isZHopped} << new_line;
+        output_stream << "G1 Z" << MMtoStream{currentPosition.z + isZHopped} << new_line;
     }
 }
 
@@ -718,11 +720,11 @@ void GCodeExport::startExtruder(int new_extruder)
     {
         if (flavor == EGCodeFlavor::MAKERBOT)
         {
-            *output_stream << "M135 T" << new_extruder << new_line;
+            output_stream << "M135 T" << new_extruder << new_line;
         }
         else
         {
-            *output_stream << "T" << new_extruder << new_line;
+            output_stream << "T" << new_extruder << new_line;
         }
     }
 
@@ -759,7 +761,7 @@ void GCodeExport::switchExtruder(int new_extruder, const RetractionConfig& retra
 
 void GCodeExport::writeCode(const char* str)
 {
-    *output_stream << str << new_line;
+    output_stream << str << new_line;
 }
 
 void GCodeExport::writePrimeTrain(double travel_speed)
@@ -777,7 +779,7 @@ void GCodeExport::writePrimeTrain(double travel_speed)
 
     if (flavor == EGCodeFlavor::GRIFFIN)
     {
-        *output_stream << "G280" << new_line;
+        output_stream << "G280" << new_line;
     }
     else
     {
@@ -795,16 +797,16 @@ void GCodeExport::writeFanCommand(double speed)
     if (speed > 0)
     {
         if (flavor == EGCodeFlavor::MAKERBOT)
-            *output_stream << "M126 T0" << new_line; //value = speed * 255 / 100 // Makerbot cannot set fan speed...;
+            output_stream << "M126 T0" << new_line; //value = speed * 255 / 100 // Makerbot cannot set fan speed...;
         else
-            *output_stream << "M106 S" << PrecisionedDouble{1, speed * 255 / 100} << new_line;
+            output_stream << "M106 S" << PrecisionedDouble{1, speed * 255 / 100} << new_line;
     }
     else
     {
         if (flavor == EGCodeFlavor::MAKERBOT)
-            *output_stream << "M127 T0" << new_line;
+            output_stream << "M127 T0" << new_line;
         else
-            *output_stream << "M107" << new_line;
+            output_stream << "M107" << new_line;
     }
     currentFanSpeed = speed;
 }
@@ -815,32 +817,32 @@ void GCodeExport::writeTemperatureCommand(int extruder, double temperature, bool
         return;
     
     if (wait)
-        *output_stream << "M109";
+        output_stream << "M109";
     else
-        *output_stream << "M104";
+        output_stream << "M104";
     if (extruder != current_extruder)
-        *output_stream << " T" << extruder;
+        output_stream << " T" << extruder;
 #ifdef ASSERT_INSANE_OUTPUT
     assert(temperature >= 0);
 #endif // ASSERT_INSANE_OUTPUT
-    *output_stream << " S" << PrecisionedDouble{1, temperature} << new_line;
+    output_stream << " S" << PrecisionedDouble{1, temperature} << new_line;
     extruder_attr[extruder].currentTemperature = temperature;
 }
 
 void GCodeExport::writeBedTemperatureCommand(double temperature, bool wait)
 {
     if (wait)
-        *output_stream << "M190 S";
+        output_stream << "M190 S";
     else
-        *output_stream << "M140 S";
-    *output_stream << PrecisionedDouble{1, temperature} << new_line;
+        output_stream << "M140 S";
+    output_stream << PrecisionedDouble{1, temperature} << new_line;
 }
 
 void GCodeExport::writeAcceleration(double acceleration)
 {
     if (current_acceleration != acceleration)
     {
-        *output_stream << "M204 S" << PrecisionedDouble{0, acceleration} << new_line; // Print and Travel acceleration
+        output_stream << "M204 S" << PrecisionedDouble{0, acceleration} << new_line; // Print and Travel acceleration
         current_acceleration = acceleration;
         estimateCalculator.setAcceleration(acceleration);
     }
@@ -852,13 +854,13 @@ void GCodeExport::writeJerk(double jerk)
     {
         if (getFlavor() == EGCodeFlavor::REPETIER)
         {
-            *output_stream << "M207 X";
+            output_stream << "M207 X";
         }
         else
         {
-            *output_stream << "M205 X";
+            output_stream << "M205 X";
         }
-        *output_stream << PrecisionedDouble{2, jerk} << new_line;
+        output_stream << PrecisionedDouble{2, jerk} << new_line;
         current_jerk = jerk;
         estimateCalculator.setMaxXyJerk(jerk);
     }
@@ -868,7 +870,7 @@ void GCodeExport::writeMaxZFeedrate(double max_z_feedrate)
 {
     if (current_max_z_feedrate != max_z_feedrate)
     {
-        *output_stream << "M203 Z" << int(max_z_feedrate * 60) << new_line;
+        output_stream << "M203 Z" << int(max_z_feedrate * 60) << new_line;
         current_max_z_feedrate = max_z_feedrate;
         estimateCalculator.setMaxZFeedrate(max_z_feedrate);
     }
@@ -891,7 +893,7 @@ void GCodeExport::finalize(const char* endCode)
     for(int n=1; n<MAX_EXTRUDERS; n++)
         if (getTotalFilamentUsed(n) > 0)
             log("Filament%d: %d\n", n + 1, int(getTotalFilamentUsed(n)));
-    output_stream->flush();
+    output_stream.flush();
 }
 
 }//namespace cura
@@ -9,6 +9,7 @@
 #include "settings/settings.h"
 #include "utils/intpoint.h"
 #include "utils/NoCopy.h"
+#include "utils/OutputBuffer.h"
 #include "timeEstimate.h"
 #include "MeshGroup.h"
 #include "commandSocket.h"
@@ -89,7 +90,7 @@ private:
     Point3 machine_dimensions;
     std::string machine_name;
 
-    std::ostream* output_stream;
+    OutputBuffer output_stream; //!< Collects the gcode and writes it to the output stream in large blocks
     std::string new_line;
 
     double current_e_value; //!< The last E value written to gcode (in mm or mm^3)
@@ -175,6 +176,13 @@ public:
     
     void setOutputStream(std::ostream* stream);
 
+    /*!
+     * Write all gcode collected so far to the output stream.
+     * 
+     * Gcode is buffered, so this has to be called before reading what has been written to the output stream.
+     */
+    void flushOutputStream();
+
     bool getExtruderIsUsed(const int extruder_nr) const; //!< Returns whether the extruder with the given index is used up until the current meshgroup
 
     int getNozzleSize(const int extruder_nr) const;
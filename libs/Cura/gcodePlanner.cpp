@@ -99,6 +99,7 @@ GCodePlanner::GCodePlanner(SliceDataStorage& storage, unsigned int layer_nr, int
 , last_extruder_previous_layer(current_extruder)
 , last_planned_extruder_setting_base(storage.meshgroup->getExtruderTrain(current_extruder))
 , comb_boundary_inside(computeCombBoundaryInside(combing_mode))
+, path_order_time_budget(storage.getSettingInSeconds("path_order_improvement_time"))
 , fan_speed_layer_time_settings_per_extruder(fan_speed_layer_time_settings_per_extruder)
 {
     extruder_plans.reserve(storage.meshgroup->getExtruderCount());
@@ -380,12 +381,13 @@ void GCodePlanner::addPolygonsByOptimizer(Polygons& polygons, GCodePathConfig* c
     {
         return;
     }
-    PathOrderOptimizer orderOptimizer(lastPosition, z_seam_type);
+    PathOrderOptimizer orderOptimizer(lastPosition, z_seam_type, path_order_time_budget);
     for (unsigned int poly_idx = 0; poly_idx < polygons.size(); poly_idx++)
     {
         orderOptimizer.addPolygon(polygons[poly_idx]);
     }
     orderOptimizer.optimize();
+    path_order_time_budget = orderOptimizer.improvement_time_budget;
     for (unsigned int poly_idx : orderOptimizer.polyOrder)
     {
         addPolygon(polygons[poly_idx], orderOptimizer.polyStart[poly_idx], config, wall_overlap_computation, spiralize);
@@ -393,12 +395,13 @@ void GCodePlanner::addPolygonsByOptimizer(Polygons& polygons, GCodePathConfig* c
 }
 void GCodePlanner::addLinesByOptimizer(Polygons& polygons, GCodePathConfig* config, SpaceFillType space_fill_type, int wipe_dist)
 {
-    LineOrderOptimizer orderOptimizer(lastPosition);
+    LineOrderOptimizer orderOptimizer(lastPosition, path_order_time_budget);
     for (unsigned int line_idx = 0; line_idx < polygons.size(); line_idx++)
     {
         orderOptimizer.addPolygon(polygons[line_idx]);
     }
     orderOptimizer.optimize();
+    path_order_time_budget = orderOptimizer.improvement_time_budget;
     for (int poly_idx : orderOptimizer.polyOrder)
     {
         PolygonRef polygon = polygons[poly_idx];
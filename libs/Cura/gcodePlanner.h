@@ -470,6 +470,7 @@ private:
     bool is_inside; //!< Whether the destination of the next planned travel move is inside a layer part
     Polygons comb_boundary_inside; //!< The boundary within which to comb, or to move into when performing a retraction.
     Comb* comb;
+    double path_order_time_budget; //!< The time in seconds left for improving the order of the paths in this layer, see PathOrderImprover
 
 
     std::vector<FanSpeedLayerTimeSettings>& fan_speed_layer_time_settings_per_extruder;
@@ -6,6 +6,101 @@
 
 namespace cura {
 
+constexpr size_t InfillLineCache::max_entry_count;
+
+bool InfillLineCache::Parameters::operator==(const Parameters& other) const
+{
+    return outline_offset == other.outline_offset
+        && infill_overlap == other.infill_overlap
+        && infill_line_width == other.infill_line_width
+        && line_distance == other.line_distance
+        && fill_angle == other.fill_angle
+        && shift == other.shift;
+}
+
+InfillLineCache& InfillLineCache::getInstance()
+{
+    static InfillLineCache instance;
+    return instance;
+}
+
+bool InfillLineCache::get(const Polygons& area, const Parameters& parameters, Polygons& result)
+{
+    const size_t key = hash(area, parameters);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto range = entries.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        const Entry& entry = it->second;
+        if (entry.parameters == parameters && isSameArea(entry.area, area))
+        {
+            result.add(entry.lines);
+            return true;
+        }
+    }
+    return false;
+}
+
+void InfillLineCache::store(const Polygons& area, const Parameters& parameters, const Polygons& lines)
+{
+    const size_t key = hash(area, parameters);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entries.size() >= max_entry_count)
+    { // the areas of layers far apart seldom match, so there's little use in keeping old entries
+        entries.clear();
+    }
+    Entry& entry = entries.emplace(key, Entry())->second;
+    entry.parameters = parameters;
+    entry.area = area;
+    entry.lines = lines;
+}
+
+size_t InfillLineCache::hash(const Polygons& area, const Parameters& parameters)
+{
+    size_t result = std::hash<int64_t>()(parameters.shift) ^ (std::hash<double>()(parameters.fill_angle) << 1);
+    auto combine = [&result](size_t value)
+    {
+        result ^= value + 0x9e3779b9 + (result << 6) + (result >> 2);
+    };
+    combine(parameters.line_distance);
+    combine(parameters.outline_offset);
+    for (unsigned int poly_idx = 0; poly_idx < area.size(); poly_idx++)
+    {
+        const PolygonRef poly = area[poly_idx];
+        combine(poly.size());
+        for (const Point& p : poly)
+        {
+            combine(std::hash<Point>()(p));
+        }
+    }
+    return result;
+}
+
+bool InfillLineCache::isSameArea(const Polygons& a, const Polygons& b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    for (unsigned int poly_idx = 0; poly_idx < a.size(); poly_idx++)
+    {
+        const PolygonRef poly_a = a[poly_idx];
+        const PolygonRef poly_b = b[poly_idx];
+        if (poly_a.size() != poly_b.size())
+        {
+            return false;
+        }
+        for (unsigned int point_idx = 0; point_idx < poly_a.size(); point_idx++)
+        {
+            if (poly_a[point_idx] != poly_b[point_idx])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 int Infill::computeScanSegmentIdx(int x, int line_width)
 {
     if (x < 0)
@@ -139,10 +234,57 @@ void Infill::addLineInfill(Polygons& result, const PointMatrix& rotation_matrix,
 
 void Infill::generateLineInfill(Polygons& result, int line_distance, const double& fill_angle, int64_t shift)
 {
+    if (line_distance == 0)
+    {
+        return;
+    }
+    InfillLineCache::Parameters parameters;
+    parameters.outline_offset = outline_offset;
+    parameters.infill_overlap = infill_overlap;
+    parameters.infill_line_width = infill_line_width;
+    parameters.line_distance = line_distance;
+    parameters.fill_angle = fill_angle;
+    parameters.shift = normalizeShift(int(shift + this->shift), line_distance);
+    InfillLineCache& cache = InfillLineCache::getInstance();
+    if (cache.get(in_outline, parameters, result))
+    {
+        return;
+    }
+
+    Polygons lines;
     PointMatrix rotation_matrix(fill_angle);
-    NoZigZagConnectorProcessor lines_processor(rotation_matrix, result);
+    NoZigZagConnectorProcessor lines_processor(rotation_matrix, lines);
     bool connected_zigzags = false;
-    generateLinearBasedInfill(outline_offset, result, line_distance, rotation_matrix, lines_processor, connected_zigzags, shift);
+    generateLinearBasedInfill(outline_offset, lines, line_distance, rotation_matrix, lines_processor, connected_zigzags, shift);
+    cache.store(in_outline, parameters, lines);
+    result.add(lines);
+}
+
+const Polygons& Infill::getLinearInfillOutline(const int outline_offset)
+{
+    if (!has_linear_infill_outline || outline_offset != linear_infill_outline_offset)
+    {
+        if (outline_offset != 0)
+        {
+            linear_infill_outline = in_outline.offset(outline_offset).offset(infill_overlap);
+        }
+        else
+        {
+            linear_infill_outline = in_outline.offset(infill_overlap);
+        }
+        linear_infill_outline_offset = outline_offset;
+        has_linear_infill_outline = true;
+    }
+    return linear_infill_outline;
+}
+
+int Infill::normalizeShift(const int shift, const int line_distance)
+{
+    if (shift < 0)
+    {
+        return line_distance - (-shift) % line_distance;
+    }
+    return shift % line_distance;
 }
 
 
@@ -206,33 +348,16 @@ void Infill::generateLinearBasedInfill(const int outline_offset, Polygons& resul
 
     int shift = extra_shift + this->shift;
 
-    Polygons outline;
-    if (outline_offset != 0)
-    {
-        outline = in_outline.offset(outline_offset);
-    }
-    else
-    {
-        outline = in_outline;
-    }
-    
-        outline = outline.offset(infill_overlap);
-    
-    if (outline.size() == 0)
+    const Polygons& offsetted_outline = getLinearInfillOutline(outline_offset);
+    if (offsetted_outline.size() == 0)
     {
         return;
     }
+    Polygons outline = offsetted_outline;
 
     outline.applyMatrix(rotation_matrix);
 
-    if (shift < 0)
-    {
-        shift = line_distance - (-shift) % line_distance;
-    }
-    else
-    {
-        shift = shift % line_distance;
-    }
+    shift = normalizeShift(shift, line_distance);
 
     AABB boundary(outline);
 
@@ -2,6 +2,10 @@
 #ifndef INFILL_H
 #define INFILL_H
 
+#include <mutex>
+#include <unordered_map>
+
+#include "utils/NoCopy.h"
 #include "utils/polygon.h"
 #include "settings/settings.h"
 // #include "ZigzagConnectorProcessor.h"
@@ -18,6 +22,75 @@
 namespace cura
 {
 
+/*!
+ * Remembers the lines of linear infill generated for recent areas.
+ * 
+ * The infill area is often the same on many consecutive layers, while the linear infill patterns repeat every one or two layers,
+ * so the lines only need to be generated once for all those layers.
+ * Lines are looked up by the exact area and all other parameters which determine them, so cached lines are the same as newly generated ones.
+ * 
+ * Can be used by several threads at once.
+ */
+class InfillLineCache : NoCopy
+{
+public:
+    /*!
+     * Everything other than the area which determines the lines in a single direction.
+     */
+    struct Parameters
+    {
+        int outline_offset;
+        int infill_overlap;
+        int infill_line_width;
+        int line_distance;
+        double fill_angle;
+        int64_t shift; //!< The total shift of the scanlines, see Infill::normalizeShift
+
+        bool operator==(const Parameters& other) const;
+    };
+
+    /*!
+     * The cache shared by all infill generation.
+     */
+    static InfillLineCache& getInstance();
+
+    /*!
+     * Get the lines generated before for an area.
+     * 
+     * \param area The area within which the lines were generated, before offsetting it
+     * \param parameters The other parameters with which the lines were generated
+     * \param[out] result Where to add the lines
+     * \return Whether the lines were in the cache
+     */
+    bool get(const Polygons& area, const Parameters& parameters, Polygons& result);
+
+    /*!
+     * Remember the lines generated for an area.
+     * 
+     * \param area The area within which the lines were generated, before offsetting it
+     * \param parameters The other parameters with which the lines were generated
+     * \param lines The generated lines
+     */
+    void store(const Polygons& area, const Parameters& parameters, const Polygons& lines);
+
+private:
+    static constexpr size_t max_entry_count = 256; //!< The cache is emptied when it gets larger than this
+
+    struct Entry
+    {
+        Parameters parameters;
+        Polygons area;
+        Polygons lines;
+    };
+
+    std::mutex mutex;
+    std::unordered_multimap<size_t, Entry> entries; //!< The cached lines by the hash of their area and parameters
+
+    static size_t hash(const Polygons& area, const Parameters& parameters);
+
+    static bool isSameArea(const Polygons& a, const Polygons& b);
+};
+
 class Infill 
 {
     EFillMethod pattern; //!< the space filling pattern of the infill to generate
@@ -32,6 +105,10 @@ class Infill
     bool connected_zigzags; //!< (ZigZag) Whether endpieces of zigzag infill should be connected to the nearest infill line on both sides of the zigzag connector
     bool use_endpieces; //!< (ZigZag) Whether to include endpieces: zigzag connector segments from one infill line to itself
 
+    Polygons linear_infill_outline; //!< The area within which linear infill was last generated, see Infill::getLinearInfillOutline
+    int linear_infill_outline_offset; //!< The offset from Infill::in_outline of Infill::linear_infill_outline
+    bool has_linear_infill_outline; //!< Whether Infill::linear_infill_outline has been computed
+
     static constexpr double one_over_sqrt_2 = 0.7071067811865475244008443621048490392848359376884740; //!< 1.0 / sqrt(2.0)
 public:
     Infill(EFillMethod pattern, const Polygons& in_outline, int outline_offset, int infill_line_width, int line_distance, int infill_overlap, double fill_angle, int64_t z, int64_t shift, bool connected_zigzags = false, bool use_endpieces = false)
@@ -46,6 +123,8 @@ public:
     , shift(shift)
     , connected_zigzags(connected_zigzags)
     , use_endpieces(use_endpieces)
+    , linear_infill_outline_offset(0)
+    , has_linear_infill_outline(false)
     {
     }
     /*!
@@ -68,6 +147,11 @@ private:
      * \param line_distance the width of the scan segments
      */
     static inline int computeScanSegmentIdx(int x, int line_distance);
+
+    /*!
+     * Bring a shift of the scanlines within [0, \p line_distance], which shifts the scanlines to the same positions.
+     */
+    static int normalizeShift(const int shift, const int line_distance);
     /*!
      * Generate sparse concentric infill 
      * \param outline The actual outline of the area within which to generate infill
@@ -125,6 +209,15 @@ private:
      */
     void generateLineInfill(Polygons& result, int line_distance, const double& fill_angle, int64_t extra_shift);
     
+    /*!
+     * Get the area within which to generate linear infill: Infill::in_outline offset by \p outline_offset and then by Infill::infill_overlap.
+     * 
+     * The area is only computed once, since grid, triangle, cubic and tetrahedral infill all generate lines in several directions within the same area.
+     * 
+     * \param outline_offset An offset from the reference polygon (Infill::in_outline)
+     */
+    const Polygons& getLinearInfillOutline(const int outline_offset);
+
     /*!
      * Function for creating linear based infill types (Lines, ZigZag).
      * 
@@ -1,19 +1,28 @@
 #include "mesh.h"
 #include "utils/logoutput.h"
+#include "utils/ThreadPool.h"
 
 namespace cura
 {
 
 const int vertex_meld_distance = MM2INT(0.03);
 /*!
- * returns a hash for the location, but first divides by the vertex_meld_distance,
- * so that any point within a box of vertex_meld_distance by vertex_meld_distance would get mapped to the same hash.
+ * returns the cell of the location in a grid with cells of vertex_meld_distance by vertex_meld_distance,
+ * so that any point within a box of vertex_meld_distance by vertex_meld_distance would get mapped to the same cell.
+ * Points within vertex_meld_distance of each other are always in the same or in neighbouring cells.
  */
-static inline uint32_t pointHash(const Point3& p)
+static inline Point3 pointCell(const Point3& p)
 {
-    return ((p.x + vertex_meld_distance/2) / vertex_meld_distance) ^ (((p.y + vertex_meld_distance/2) / vertex_meld_distance) << 10) ^ (((p.z + vertex_meld_distance/2) / vertex_meld_distance) << 20);
+    return Point3((p.x + vertex_meld_distance/2) / vertex_meld_distance, (p.y + vertex_meld_distance/2) / vertex_meld_distance, (p.z + vertex_meld_distance/2) / vertex_meld_distance);
 }
 
+static inline uint32_t cellHash(const Point3& cell)
+{
+    return (uint32_t(cell.x) * 73856093u) ^ (uint32_t(cell.y) * 19349663u) ^ (uint32_t(cell.z) * 83492791u);
+}
+
+constexpr uint32_t Mesh::empty_vertex_hash_entry;
+
 Mesh::Mesh(SettingsBaseVirtual* parent)
 : SettingsBase(parent)
 {
@@ -32,32 +41,52 @@ void Mesh::addFace(Point3& v0, Point3& v1, Point3& v2)
     face.vertex_index[0] = vi0;
     face.vertex_index[1] = vi1;
     face.vertex_index[2] = vi2;
-    vertices[face.vertex_index[0]].connected_faces.push_back(idx);
-    vertices[face.vertex_index[1]].connected_faces.push_back(idx);
-    vertices[face.vertex_index[2]].connected_faces.push_back(idx);
 }
 
 void Mesh::clear()
 {
     faces.clear();
     vertices.clear();
-    vertex_hash_map.clear();
+    vertex_hash_table.clear();
 }
 
 void Mesh::finish()
 {
-    // Finish up the mesh, clear the vertex_hash_map, as it's no longer needed from this point on and uses quite a bit of memory.
-    vertex_hash_map.clear();
+    // Finish up the mesh, free the vertex_hash_table, as it's no longer needed from this point on and uses quite a bit of memory.
+    std::vector<VertexHashEntry>().swap(vertex_hash_table);
 
-    // For each face, store which other face is connected with it.
-    for(unsigned int i=0; i<faces.size(); i++)
+    // Store for each vertex which faces it is part of, in two passes so that every list is allocated once at its exact size.
+    std::vector<uint32_t> connected_face_count(vertices.size(), 0);
+    for (const MeshFace& face : faces)
+    {
+        for (int corner = 0; corner < 3; corner++)
+        {
+            connected_face_count[face.vertex_index[corner]]++;
+        }
+    }
+    for (unsigned int vertex_idx = 0; vertex_idx < vertices.size(); vertex_idx++)
     {
-        MeshFace& face = faces[i];
-        // faces are connected via the outside
-        face.connected_face_index[0] = getFaceIdxWithPoints(face.vertex_index[0], face.vertex_index[1], i, face.vertex_index[2]);
-        face.connected_face_index[1] = getFaceIdxWithPoints(face.vertex_index[1], face.vertex_index[2], i, face.vertex_index[0]);
-        face.connected_face_index[2] = getFaceIdxWithPoints(face.vertex_index[2], face.vertex_index[0], i, face.vertex_index[1]);
+        std::vector<uint32_t>& connected_faces = vertices[vertex_idx].connected_faces;
+        connected_faces.clear();
+        connected_faces.reserve(connected_face_count[vertex_idx]);
     }
+    for (unsigned int face_idx = 0; face_idx < faces.size(); face_idx++)
+    {
+        for (int corner = 0; corner < 3; corner++)
+        {
+            vertices[faces[face_idx].vertex_index[corner]].connected_faces.push_back(face_idx);
+        }
+    }
+
+    // For each face, store which other face is connected with it. Faces only read the connected faces of their own vertices, so they can be done in parallel.
+    ThreadPool::getInstance().parallel_for(0, faces.size(), [this](size_t i)
+        {
+            MeshFace& face = faces[i];
+            // faces are connected via the outside
+            face.connected_face_index[0] = getFaceIdxWithPoints(face.vertex_index[0], face.vertex_index[1], i, face.vertex_index[2]);
+            face.connected_face_index[1] = getFaceIdxWithPoints(face.vertex_index[1], face.vertex_index[2], i, face.vertex_index[0]);
+            face.connected_face_index[2] = getFaceIdxWithPoints(face.vertex_index[2], face.vertex_index[0], i, face.vertex_index[1]);
+        }, 1024);
 }
 
 Point3 Mesh::min() const
@@ -80,16 +109,26 @@ void Mesh::expandXY(int64_t offset)
 
 int Mesh::findIndexOfVertex(const Point3& v)
 {
-    uint32_t hash = pointHash(v);
+    const Point3 cell = pointCell(v);
 
-    for(unsigned int idx = 0; idx < vertex_hash_map[hash].size(); idx++)
+    if (!vertex_hash_table.empty())
     {
-        if ((vertices[vertex_hash_map[hash][idx]].p - v).testLength(vertex_meld_distance))
+        const size_t mask = vertex_hash_table.size() - 1;
+        for (size_t slot = cellHash(cell) & mask; vertex_hash_table[slot].vertex_idx != empty_vertex_hash_entry; slot = (slot + 1) & mask)
         {
-            return vertex_hash_map[hash][idx];
+            const VertexHashEntry& entry = vertex_hash_table[slot];
+            if (entry.cell == cell && (vertices[entry.vertex_idx].p - v).testLength(vertex_meld_distance))
+            {
+                return entry.vertex_idx;
+            }
         }
     }
-    vertex_hash_map[hash].push_back(vertices.size());
+
+    if ((vertices.size() + 1) * 2 > vertex_hash_table.size())
+    {
+        growVertexHashTable();
+    }
+    insertVertexHashEntry(cell, vertices.size());
     vertices.emplace_back(v);
     
     aabb.include(v);
@@ -97,6 +136,32 @@ int Mesh::findIndexOfVertex(const Point3& v)
     return vertices.size() - 1;
 }
 
+void Mesh::insertVertexHashEntry(const Point3& cell, uint32_t vertex_idx)
+{
+    const size_t mask = vertex_hash_table.size() - 1;
+    size_t slot = cellHash(cell) & mask;
+    while (vertex_hash_table[slot].vertex_idx != empty_vertex_hash_entry)
+    {
+        slot = (slot + 1) & mask;
+    }
+    vertex_hash_table[slot].cell = cell;
+    vertex_hash_table[slot].vertex_idx = vertex_idx;
+}
+
+void Mesh::growVertexHashTable()
+{
+    const size_t size = std::max(size_t(1024), vertex_hash_table.size() * 2);
+    VertexHashEntry empty_entry;
+    empty_entry.cell = Point3(0, 0, 0);
+    empty_entry.vertex_idx = empty_vertex_hash_entry;
+    vertex_hash_table.assign(size, empty_entry);
+    // Reinserting in vertex order keeps the entries of each cell in the order in which the vertices were added
+    for (uint32_t vertex_idx = 0; vertex_idx < vertices.size(); vertex_idx++)
+    {
+        insertVertexHashEntry(pointCell(vertices[vertex_idx].p), vertex_idx);
+    }
+}
+
 /*!
 Returns the index of the 'other' face connected to the edge between vertices with indices idx0 and idx1.
 In case more than two faces are connected via the same edge, the next face in a counter-clockwise ordering (looking from idx1 to idx0) is returned.
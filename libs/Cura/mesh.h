@@ -1,6 +1,8 @@
 #ifndef MESH_H
 #define MESH_H
 
+#include <limits>
+
 #include "settings/settings.h"
 #include "utils/AABB3D.h"
 
@@ -15,9 +17,9 @@ class MeshVertex
 {
 public:
     Point3 p; //!< location of the vertex
-    std::vector<uint32_t> connected_faces; //!< list of the indices of connected faces
+    std::vector<uint32_t> connected_faces; //!< list of the indices of connected faces, in increasing order. Set by Mesh::finish
 
-    MeshVertex(Point3 p) : p(p) {connected_faces.reserve(8);} //!< doesn't set connected_faces
+    MeshVertex(Point3 p) : p(p) {} //!< doesn't set connected_faces
 };
 
 /*! A MeshFace is a 3 dimensional model triangle with 3 points. These points are already converted to integers
@@ -56,8 +58,23 @@ See MeshFace for the specifics of how/when faces are connected.
 */
 class Mesh : public SettingsBase // inherits settings
 {
-    //! The vertex_hash_map stores a index reference of each vertex for the hash of that location. Allows for quick retrieval of points with the same location.
-    std::unordered_map<uint32_t, std::vector<uint32_t> > vertex_hash_map;
+    /*!
+     * An entry of the vertex hash table: a vertex and the cell of the vertex meld grid its location falls in.
+     */
+    struct VertexHashEntry
+    {
+        Point3 cell;
+        uint32_t vertex_idx; //!< \ref Mesh::empty_vertex_hash_entry for a free slot
+    };
+    static constexpr uint32_t empty_vertex_hash_entry = std::numeric_limits<uint32_t>::max();
+
+    /*!
+     * Flat open-addressing (linear probing) table with an entry for each vertex, keyed on the meld grid cell of its location.
+     * Allows for quick retrieval of points with the same location.
+     * The entries of a cell are found along its probe sequence in the order in which the vertices were added.
+     * The size is zero or a power of two and at most half of the entries are used.
+     */
+    std::vector<VertexHashEntry> vertex_hash_table;
     AABB3D aabb;
 public:
     std::vector<MeshVertex> vertices;//!< list of all vertices in the mesh
@@ -67,7 +84,7 @@ public:
 
     void addFace(Point3& v0, Point3& v1, Point3& v2); //!< add a face to the mesh without settings it's connected_faces.
     void clear(); //!< clears all data
-    void finish(); //!< complete the model : set the connected_face_index fields of the faces.
+    void finish(); //!< complete the model : set the connected_faces of the vertices and the connected_face_index fields of the faces.
 
     Point3 min() const; //!< min (in x,y and z) vertex of the bounding box
     Point3 max() const; //!< max (in x,y and z) vertex of the bounding box
@@ -89,6 +106,10 @@ public:
 private:
     int findIndexOfVertex(const Point3& v); //!< find index of vertex close to the given point, or create a new vertex and return its index.
 
+    void insertVertexHashEntry(const Point3& cell, uint32_t vertex_idx); //!< add an entry to the vertex hash table, which must have a free slot
+
+    void growVertexHashTable(); //!< double the size of the vertex hash table and reinsert all vertices in order
+
     /*!
      * Get the index of the face connected to the face with index \p notFaceIdx, via vertices \p idx0 and \p idx1.
      * 
@@ -1,13 +1,259 @@
 /** Copyright (C) 2013 David Braam - Released under terms of the AGPLv3 License */
 #include "pathOrderOptimizer.h"
+
+#include <algorithm> // sort, unique, reverse
+#include <cmath> // sqrt
+
 #include "utils/logoutput.h"
 #include "utils/SparsePointGridInclusive.h"
 #include "utils/linearAlg2D.h"
+#include "utils/gettime.h"
 
 #define INLINE static inline
 
 namespace cura {
 
+/*!
+ * Get a grid cell size for which there are about as many cells as \p points in their bounding box.
+ */
+INLINE coord_t getCellSizeForPoints(const std::vector<Point>& points)
+{
+    constexpr coord_t min_cell_size = 1000;
+    if (points.empty())
+    {
+        return min_cell_size;
+    }
+    Point min = points[0];
+    Point max = points[0];
+    for (const Point& point : points)
+    {
+        min.X = std::min(min.X, point.X);
+        min.Y = std::min(min.Y, point.Y);
+        max.X = std::max(max.X, point.X);
+        max.Y = std::max(max.Y, point.Y);
+    }
+    const double area = double(max.X - min.X + 1) * double(max.Y - min.Y + 1);
+    return std::max(min_cell_size, coord_t(std::sqrt(area / points.size())));
+}
+
+/*!
+ * Whether searching the grid cells within \p radius takes longer than checking all \p candidate_count candidates.
+ */
+INLINE bool isGridSearchTooLarge(coord_t radius, coord_t cell_size, unsigned int candidate_count)
+{
+    const int64_t cells_per_side = 2 * radius / cell_size + 2;
+    return cells_per_side * cells_per_side > int64_t(candidate_count);
+}
+
+constexpr int64_t PathOrderImprover::min_gain;
+
+PathOrderImprover::PathOrderImprover(Point start_point, const std::vector<Point>& first_ends, const std::vector<Point>& second_ends, coord_t cell_size)
+: start_point(start_point)
+, first_ends(first_ends)
+, second_ends(second_ends)
+, end_grid(cell_size)
+{
+}
+
+void PathOrderImprover::improve(std::vector<int>& order, std::vector<bool>& reversed, double& time_budget)
+{
+    const double start_time = getTime();
+    this->order = order;
+    this->reversed.assign(first_ends.size(), false);
+    positions.assign(first_ends.size(), 0);
+    for (unsigned int pos = 0; pos < order.size(); pos++)
+    {
+        const int path_idx = order[pos];
+        positions[path_idx] = pos;
+        end_grid.insert(first_ends[path_idx], path_idx);
+        if (second_ends[path_idx] != first_ends[path_idx])
+        {
+            end_grid.insert(second_ends[path_idx], path_idx);
+        }
+    }
+
+    const double end_time = start_time + time_budget;
+    bool improved = true;
+    while (improved)
+    {
+        improved = false;
+        for (unsigned int pos = 0; pos < this->order.size(); pos++)
+        {
+            if (improveAt(pos))
+            {
+                improved = true;
+            }
+            if (pos % 64 == 0 && getTime() > end_time)
+            {
+                improved = false;
+                break;
+            }
+        }
+    }
+
+    order = this->order;
+    reversed = this->reversed;
+    time_budget -= getTime() - start_time;
+}
+
+Point PathOrderImprover::getEntry(unsigned int pos) const
+{
+    const int path_idx = order[pos];
+    return reversed[path_idx] ? second_ends[path_idx] : first_ends[path_idx];
+}
+
+Point PathOrderImprover::getExit(unsigned int pos) const
+{
+    const int path_idx = order[pos];
+    return reversed[path_idx] ? first_ends[path_idx] : second_ends[path_idx];
+}
+
+Point PathOrderImprover::getBefore(unsigned int pos) const
+{
+    return (pos == 0) ? start_point : getExit(pos - 1);
+}
+
+int64_t PathOrderImprover::getReversalGain(unsigned int first, unsigned int last) const
+{
+    const Point before = getBefore(first);
+    int64_t gain = vSize(getEntry(first) - before) - vSize(getExit(last) - before);
+    if (last + 1 < order.size())
+    { // the travel after the stretch changes as well
+        const Point after = getEntry(last + 1);
+        gain += vSize(after - getExit(last)) - vSize(after - getEntry(first));
+    }
+    return gain;
+}
+
+void PathOrderImprover::reverse(unsigned int first, unsigned int last)
+{
+    std::reverse(order.begin() + first, order.begin() + last + 1);
+    for (unsigned int pos = first; pos <= last; pos++)
+    {
+        reversed[order[pos]] = !reversed[order[pos]];
+        positions[order[pos]] = pos;
+    }
+}
+
+int64_t PathOrderImprover::getMoveGain(unsigned int first, unsigned int last, unsigned int gap, bool reverse_stretch) const
+{
+    const Point before = getBefore(first);
+    const Point stretch_entry = getEntry(first);
+    const Point stretch_exit = getExit(last);
+    int64_t gain = vSize(stretch_entry - before);
+    if (last + 1 < order.size())
+    { // the paths before and after the stretch get connected
+        const Point after = getEntry(last + 1);
+        gain += vSize(after - stretch_exit) - vSize(after - before);
+    }
+    const Point gap_before = getBefore(gap);
+    gain -= vSize((reverse_stretch ? stretch_exit : stretch_entry) - gap_before);
+    if (gap < order.size())
+    { // the stretch is inserted in between two paths rather than at the end
+        const Point gap_after = getEntry(gap);
+        gain += vSize(gap_after - gap_before) - vSize(gap_after - (reverse_stretch ? stretch_entry : stretch_exit));
+    }
+    return gain;
+}
+
+void PathOrderImprover::move(unsigned int first, unsigned int last, unsigned int gap, bool reverse_stretch)
+{
+    std::vector<int> stretch(order.begin() + first, order.begin() + last + 1);
+    if (reverse_stretch)
+    {
+        std::reverse(stretch.begin(), stretch.end());
+        for (int path_idx : stretch)
+        {
+            reversed[path_idx] = !reversed[path_idx];
+        }
+    }
+    order.erase(order.begin() + first, order.begin() + last + 1);
+    const unsigned int insert_pos = (gap < first) ? gap : gap - stretch.size();
+    order.insert(order.begin() + insert_pos, stretch.begin(), stretch.end());
+    for (unsigned int pos = std::min(first, gap); pos < std::min(std::max(last + 1, gap), (unsigned int)order.size()); pos++)
+    {
+        positions[order[pos]] = pos;
+    }
+}
+
+bool PathOrderImprover::improveAt(unsigned int pos)
+{
+    constexpr unsigned int max_stretch_size = 3;
+    const Point before = getBefore(pos);
+    const coord_t radius = std::min(coord_t(vSize(getEntry(pos) - before)), 2 * end_grid.getCellSize());
+    if (radius < min_gain)
+    {
+        return false;
+    }
+    std::vector<unsigned int> candidates; // the positions of the paths with an end close to where the travel to pos starts
+    auto process_func = [this, &candidates](const SparsePointGridInclusiveImpl::SparsePointGridInclusiveElem<unsigned int>& elem)
+        {
+            candidates.push_back(positions[elem.val]);
+        };
+    end_grid.processNearby(before, radius, process_func);
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    // a move is either a reversal, which is stored with gap == NO_INDEX, or a move of a stretch
+    int64_t best_gain = min_gain;
+    unsigned int best_first = NO_INDEX;
+    unsigned int best_last = NO_INDEX;
+    unsigned int best_gap = NO_INDEX;
+    bool best_reverse_stretch = false;
+    auto consider = [&](int64_t gain, unsigned int first, unsigned int last, unsigned int gap, bool reverse_stretch)
+        {
+            if (gain > best_gain)
+            {
+                best_gain = gain;
+                best_first = first;
+                best_last = last;
+                best_gap = gap;
+                best_reverse_stretch = reverse_stretch;
+            }
+        };
+    for (unsigned int candidate : candidates)
+    {
+        if (candidate >= pos)
+        { // travel from before to the exit of the candidate
+            consider(getReversalGain(pos, candidate), pos, candidate, NO_INDEX, false);
+        }
+        else if (candidate + 1 < pos)
+        { // travel from the exit of the candidate to before
+            consider(getReversalGain(candidate + 1, pos - 1), candidate + 1, pos - 1, NO_INDEX, false);
+        }
+        for (unsigned int stretch_size = 1; stretch_size <= max_stretch_size; stretch_size++)
+        {
+            const unsigned int last = candidate + stretch_size - 1;
+            if (last < order.size() && (pos < candidate || pos > last + 1))
+            { // travel from before to the entry of the candidate
+                consider(getMoveGain(candidate, last, pos, false), candidate, last, pos, false);
+            }
+            if (candidate + 1 >= stretch_size)
+            {
+                const unsigned int first = candidate + 1 - stretch_size;
+                if (pos < first || pos > candidate + 1)
+                { // travel from before to the exit of the candidate
+                    consider(getMoveGain(first, candidate, pos, true), first, candidate, pos, true);
+                }
+            }
+        }
+    }
+
+    if (best_first == NO_INDEX)
+    {
+        return false;
+    }
+    if (best_gap == NO_INDEX)
+    {
+        reverse(best_first, best_last);
+    }
+    else
+    {
+        move(best_first, best_last, best_gap, best_reverse_stretch);
+    }
+    return true;
+}
+
 /**
 *
 */
@@ -36,31 +282,31 @@ void PathOrderOptimizer::optimize()
     }
 
 
-    Point prev_point = startPoint;
-    for (unsigned int poly_order_idx = 0; poly_order_idx < polygons.size(); poly_order_idx++) /// actual path order optimizer
+    std::vector<Point> start_points(polygons.size());
+    std::vector<Point> nonempty_start_points;
+    for (unsigned int poly_idx = 0; poly_idx < polygons.size(); poly_idx++)
     {
-        int best_poly_idx = -1;
-        float bestDist = std::numeric_limits<float>::infinity();
-
-
-        for (unsigned int poly_idx = 0; poly_idx < polygons.size(); poly_idx++)
+        if (polygons[poly_idx].size() > 0)
         {
-            if (picked[poly_idx] || polygons[poly_idx].size() < 1) /// skip single-point-polygons
-            {
-                continue;
-            }
-
-            assert (polygons[poly_idx].size() != 2);
-
-            float dist = vSize2f(polygons[poly_idx][polyStart[poly_idx]] - prev_point);
-            if (dist < bestDist)
-            {
-                best_poly_idx = poly_idx;
-                bestDist = dist;
-            }
-
+            start_points[poly_idx] = polygons[poly_idx][polyStart[poly_idx]];
+            nonempty_start_points.push_back(start_points[poly_idx]);
         }
+    }
+    const coord_t cell_size = getCellSizeForPoints(nonempty_start_points);
+    SparsePointGridInclusive<unsigned int> start_point_grid(cell_size);
+    for (unsigned int poly_idx = 0; poly_idx < polygons.size(); poly_idx++)
+    {
+        if (polygons[poly_idx].size() > 0)
+        {
+            start_point_grid.insert(start_points[poly_idx], poly_idx);
+        }
+    }
+    unsigned int unpicked_count = nonempty_start_points.size();
 
+    Point prev_point = startPoint;
+    for (unsigned int poly_order_idx = 0; poly_order_idx < polygons.size(); poly_order_idx++) /// actual path order optimizer
+    {
+        int best_poly_idx = findClosestUnpickedPolygon(start_point_grid, prev_point, picked, unpicked_count);
 
         if (best_poly_idx > -1) /// should always be true; we should have been able to identify the best next polygon
         {
@@ -69,6 +315,7 @@ void PathOrderOptimizer::optimize()
             prev_point = polygons[best_poly_idx][polyStart[best_poly_idx]];
 
             picked[best_poly_idx] = true;
+            unpicked_count--;
             polyOrder.push_back(best_poly_idx);
         }
         else
@@ -77,6 +324,13 @@ void PathOrderOptimizer::optimize()
         }
     }
 
+    if (improvement_time_budget > 0 && polyOrder.size() > 2)
+    { // a polygon is entered and left at its starting point
+        PathOrderImprover improver(startPoint, start_points, start_points, cell_size);
+        std::vector<bool> reversed;
+        improver.improve(polyOrder, reversed, improvement_time_budget);
+    }
+
     prev_point = startPoint;
     for (unsigned int order_idx = 0; order_idx < polyOrder.size(); order_idx++) /// decide final starting points in each polygon
     {
@@ -88,6 +342,55 @@ void PathOrderOptimizer::optimize()
     }
 }
 
+int PathOrderOptimizer::findClosestUnpickedPolygon(const SparsePointGridInclusive<unsigned int>& start_point_grid, Point prev_point, const bool* picked, unsigned int unpicked_count)
+{
+    // search ever larger squares until the closest polygon is within the square
+    const coord_t cell_size = start_point_grid.getCellSize();
+    for (coord_t radius = cell_size; !isGridSearchTooLarge(radius, cell_size, unpicked_count); radius *= 2)
+    {
+        int best_poly_idx = -1;
+        float bestDist = std::numeric_limits<float>::infinity();
+        auto process_func = [&](const SparsePointGridInclusiveImpl::SparsePointGridInclusiveElem<unsigned int>& elem)
+            {
+                if (picked[elem.val])
+                {
+                    return;
+                }
+                float dist = vSize2f(elem.point - prev_point);
+                if (dist < bestDist || (dist == bestDist && int(elem.val) < best_poly_idx)) // of equally close polygons the first one is the closest
+                {
+                    best_poly_idx = elem.val;
+                    bestDist = dist;
+                }
+            };
+        start_point_grid.processNearby(prev_point, radius, process_func);
+        if (best_poly_idx > -1 && bestDist < float(radius) * float(radius) * 0.999f) // margin for rounding errors in the float distances
+        {
+            return best_poly_idx;
+        }
+    }
+
+    int best_poly_idx = -1;
+    float bestDist = std::numeric_limits<float>::infinity();
+    for (unsigned int poly_idx = 0; poly_idx < polygons.size(); poly_idx++)
+    {
+        if (picked[poly_idx] || polygons[poly_idx].size() < 1) /// skip single-point-polygons
+        {
+            continue;
+        }
+
+        assert (polygons[poly_idx].size() != 2);
+
+        float dist = vSize2f(polygons[poly_idx][polyStart[poly_idx]] - prev_point);
+        if (dist < bestDist)
+        {
+            best_poly_idx = poly_idx;
+            bestDist = dist;
+        }
+    }
+    return best_poly_idx;
+}
+
 int PathOrderOptimizer::getPolyStart(Point prev_point, int poly_idx)
 {
     switch (type)
@@ -181,6 +484,15 @@ void LineOrderOptimizer::optimize()
     }
 
 
+    unsigned int unpicked_count = 0;
+    for (PolygonRef line : polygons)
+    {
+        if (line.size() > 0)
+        {
+            unpicked_count++;
+        }
+    }
+
     Point incoming_perpundicular_normal(0, 0);
     Point prev_point = startPoint;
     for (unsigned int order_idx = 0; order_idx < polygons.size(); order_idx++) /// actual path order optimizer
@@ -202,17 +514,7 @@ void LineOrderOptimizer::optimize()
 
         if (best_line_idx == -1) /// if single-line-polygon hasn't been found yet
         {
-            for (unsigned int poly_idx = 0; poly_idx < polygons.size(); poly_idx++)
-            {
-                if (picked[poly_idx] || polygons[poly_idx].size() < 1) /// skip single-point-polygons
-                {
-                    continue;
-                }
-                assert(polygons[poly_idx].size() == 2);
-
-                updateBestLine(poly_idx, best_line_idx, best_score, prev_point, incoming_perpundicular_normal);
-
-            }
+            best_line_idx = findBestUnpickedLine(line_bucket_grid, picked, unpicked_count, prev_point, incoming_perpundicular_normal);
         }
 
         if (best_line_idx > -1) /// should always be true; we should have been able to identify the best next polygon
@@ -228,6 +530,7 @@ void LineOrderOptimizer::optimize()
             incoming_perpundicular_normal = turn90CCW(normal(line_end - line_start, 1000));
 
             picked[best_line_idx] = true;
+            unpicked_count--;
             polyOrder.push_back(best_line_idx);
         }
         else
@@ -235,6 +538,74 @@ void LineOrderOptimizer::optimize()
             logError("Failed to find next closest line.\n");
         }
     }
+
+    if (improvement_time_budget > 0 && polyOrder.size() > 2)
+    {
+        std::vector<Point> line_starts(polygons.size());
+        std::vector<Point> line_ends(polygons.size());
+        for (int line_idx : polyOrder)
+        {
+            line_starts[line_idx] = polygons[line_idx][polyStart[line_idx]];
+            line_ends[line_idx] = polygons[line_idx][1 - polyStart[line_idx]];
+        }
+        PathOrderImprover improver(startPoint, line_starts, line_ends, gridSize);
+        std::vector<bool> reversed;
+        improver.improve(polyOrder, reversed, improvement_time_budget);
+        for (int line_idx : polyOrder)
+        {
+            if (reversed[line_idx])
+            {
+                polyStart[line_idx] = 1 - polyStart[line_idx];
+            }
+        }
+    }
+}
+
+int LineOrderOptimizer::findBestUnpickedLine(const SparsePointGridInclusive<unsigned int>& line_bucket_grid, const bool* picked, unsigned int unpicked_count, Point prev_point, Point incoming_perpundicular_normal)
+{
+    constexpr float max_angle_score = 200; // larger than the absolute value of any LineOrderOptimizer::getAngleScore
+    // search ever larger squares until the best line is within the square
+    const coord_t cell_size = line_bucket_grid.getCellSize();
+    std::vector<unsigned int> close_lines;
+    for (coord_t radius = cell_size; !isGridSearchTooLarge(radius, cell_size, unpicked_count); radius *= 2)
+    {
+        close_lines.clear();
+        auto process_func = [&](const SparsePointGridInclusiveImpl::SparsePointGridInclusiveElem<unsigned int>& elem)
+            {
+                if (!picked[elem.val])
+                {
+                    close_lines.push_back(elem.val);
+                }
+            };
+        line_bucket_grid.processNearby(prev_point, radius, process_func);
+        // check the lines in order, so that of equally good lines the same one is chosen as when checking all lines
+        std::sort(close_lines.begin(), close_lines.end());
+        close_lines.erase(std::unique(close_lines.begin(), close_lines.end()), close_lines.end());
+        int best_line_idx = -1;
+        float best_score = std::numeric_limits<float>::infinity();
+        for (unsigned int line_idx : close_lines)
+        {
+            updateBestLine(line_idx, best_line_idx, best_score, prev_point, incoming_perpundicular_normal);
+        }
+        if (best_line_idx > -1 && best_score < float(radius) * float(radius) * 0.999f - max_angle_score) // margin for rounding errors in the float distances
+        {
+            return best_line_idx;
+        }
+    }
+
+    int best_line_idx = -1;
+    float best_score = std::numeric_limits<float>::infinity();
+    for (unsigned int poly_idx = 0; poly_idx < polygons.size(); poly_idx++)
+    {
+        if (picked[poly_idx] || polygons[poly_idx].size() < 1) /// skip single-point-polygons
+        {
+            continue;
+        }
+        assert(polygons[poly_idx].size() == 2);
+
+        updateBestLine(poly_idx, best_line_idx, best_score, prev_point, incoming_perpundicular_normal);
+    }
+    return best_line_idx;
 }
 
 inline void LineOrderOptimizer::updateBestLine(unsigned int poly_idx, int& best, float& best_score, Point prev_point, Point incoming_perpundicular_normal)
@@ -4,15 +4,97 @@
 
 #include <stdint.h>
 #include "utils/polygon.h"
+#include "utils/SparsePointGridInclusive.h"
 #include "settings/settings.h"
 
 namespace cura {
+
+/*!
+ * Shortens the travel between paths which are printed in a given order, by 2-opt and Or-opt moves.
+ * 
+ * Each path is entered at one end and left at the other end; for a polygon both ends are the same point.
+ * A 2-opt move reverses a stretch of the order, which also prints each path in it the other way around.
+ * An Or-opt move moves a stretch of up to three paths to elsewhere in the order, possibly reversed.
+ * Only moves which connect ends close to each other are tried, which are looked up in a SparsePointGridInclusive.
+ * 
+ * Moves are made until none of them shortens the travel or until the time budget has been spent.
+ */
+class PathOrderImprover
+{
+public:
+    /*!
+     * \param start_point Where the travel starts
+     * \param first_ends For each path the end where it is entered when it isn't reversed
+     * \param second_ends For each path the end where it is left when it isn't reversed
+     * \param cell_size The cell size of the grid with the ends, typically about the distance between neighbouring paths
+     */
+    PathOrderImprover(Point start_point, const std::vector<Point>& first_ends, const std::vector<Point>& second_ends, coord_t cell_size);
+
+    /*!
+     * Improve an order of the paths.
+     * 
+     * \param[in,out] order The order in which to print the paths, as indices of the paths
+     * \param[out] reversed For each path whether it should be printed from its second end to its first end
+     * \param[in,out] time_budget The time in seconds which may be spent, which is reduced by the time spent
+     */
+    void improve(std::vector<int>& order, std::vector<bool>& reversed, double& time_budget);
+
+private:
+    static constexpr int64_t min_gain = 10; //!< The minimal travel distance a move should save, which is larger than the rounding errors in the distances
+
+    Point start_point;
+    std::vector<Point> first_ends;
+    std::vector<Point> second_ends;
+    SparsePointGridInclusive<unsigned int> end_grid; //!< The ends of all paths in the order, with the index of the path
+    std::vector<int> order; //!< The current order
+    std::vector<bool> reversed; //!< For each path whether it is currently reversed
+    std::vector<unsigned int> positions; //!< For each path its index in PathOrderImprover::order
+
+    Point getEntry(unsigned int pos) const; //!< Where the path at a position in the order is entered
+    Point getExit(unsigned int pos) const; //!< Where the path at a position in the order is left
+    Point getBefore(unsigned int pos) const; //!< Where the travel to the path at a position in the order starts
+
+    /*!
+     * How much shorter the travel gets by reversing the paths from \p first to \p last, both inclusive.
+     */
+    int64_t getReversalGain(unsigned int first, unsigned int last) const;
+
+    /*!
+     * Reverse the paths from \p first to \p last, both inclusive.
+     */
+    void reverse(unsigned int first, unsigned int last);
+
+    /*!
+     * How much shorter the travel gets by moving the paths from \p first to \p last to before the path at position \p gap.
+     * 
+     * \param first The first path of the moved stretch
+     * \param last The last path of the moved stretch
+     * \param gap The position before which to insert the stretch, outside of [\p first, \p last + 1]; the size of the order to append it
+     * \param reverse_stretch Whether to reverse the stretch
+     */
+    int64_t getMoveGain(unsigned int first, unsigned int last, unsigned int gap, bool reverse_stretch) const;
+
+    /*!
+     * Move the paths from \p first to \p last to before the path at position \p gap, see PathOrderImprover::getMoveGain.
+     */
+    void move(unsigned int first, unsigned int last, unsigned int gap, bool reverse_stretch);
+
+    /*!
+     * Make the best move which replaces the travel to the path at position \p pos by a travel to a path close to its start.
+     * 
+     * \return Whether a move has been made
+     */
+    bool improveAt(unsigned int pos);
+};
  
 /*!
  * Parts order optimization class.
  * 
  * Utility class for optimizing the path order by minimizing the distance traveled between printing different parts in the layer.
  * The order of polygons is optimized and the startingpoint within each polygon is chosen.
+ * 
+ * The order is found by going to the closest polygon each time, which is looked up in a SparsePointGridInclusive.
+ * Optionally the order is improved afterwards, see PathOrderImprover.
  */
 class PathOrderOptimizer
 {
@@ -22,10 +104,12 @@ public:
     std::vector<PolygonRef> polygons; //!< the parts of the layer (in arbitrary order)
     std::vector<int> polyStart; //!< polygons[i][polyStart[i]] = point of polygon i which is to be the starting point in printing the polygon
     std::vector<int> polyOrder; //!< the optimized order as indices in #polygons
+    double improvement_time_budget; //!< The time in seconds which may be spent on improving the order. Reduced by the time #optimize spends on the improvement, so that the rest can be passed on to the next optimizer of the layer
 
-    PathOrderOptimizer(Point startPoint, EZSeamType type = EZSeamType::SHORTEST)
+    PathOrderOptimizer(Point startPoint, EZSeamType type = EZSeamType::SHORTEST, double improvement_time_budget = 0.0)
     : type(type)
     , startPoint(startPoint)
+    , improvement_time_budget(improvement_time_budget)
     {
     }
 
@@ -48,11 +132,23 @@ private:
     int getFarthestPointInPolygon(int poly_idx); //!< return the index to the point farthest from the front (highest y)
     int getRandomPointInPolygon(int poly_idx);
 
-
+    /*!
+     * Find the closest polygon which hasn't been picked yet, like checking all of them in order.
+     * 
+     * \param start_point_grid The grid containing the starting point of each non-empty polygon
+     * \param prev_point The point from which to find the closest polygon
+     * \param picked For each polygon whether it has been picked already
+     * \param unpicked_count The number of non-empty polygons which haven't been picked yet
+     * \return The index of the closest polygon, or -1 if there's none left
+     */
+    int findClosestUnpickedPolygon(const SparsePointGridInclusive<unsigned int>& start_point_grid, Point prev_point, const bool* picked, unsigned int unpicked_count);
 };
 //! Line path order optimization class.
 /*!
 * Utility class for optimizing the path order by minimizing the distance traveled between printing different lines within a part.
+* 
+* When there are no lines close to the previous line, the closest line is looked up by searching ever larger areas of a SparsePointGridInclusive.
+* Optionally the order is improved afterwards, see PathOrderImprover.
 */
 class LineOrderOptimizer
 {
@@ -61,8 +157,10 @@ public:
     std::vector<PolygonRef> polygons; //!< the parts of the layer (in arbitrary order)
     std::vector<int> polyStart; //!< polygons[i][polyStart[i]] = point of polygon i which is to be the starting point in printing the polygon
     std::vector<int> polyOrder; //!< the optimized order as indices in #polygons
+    double improvement_time_budget; //!< The time in seconds which may be spent on improving the order. Reduced by the time #optimize spends on the improvement, so that the rest can be passed on to the next optimizer of the layer
 
-    LineOrderOptimizer(Point startPoint)
+    LineOrderOptimizer(Point startPoint, double improvement_time_budget = 0.0)
+    : improvement_time_budget(improvement_time_budget)
     {
         this->startPoint = startPoint;
     }
@@ -98,6 +196,18 @@ private:
      */
     void updateBestLine(unsigned int poly_idx, int& best, float& best_score, Point prev_point, Point incoming_perpundicular_normal);
 
+    /*!
+     * Find the best next line of all lines which haven't been picked yet, like calling LineOrderOptimizer::updateBestLine on all of them in order.
+     * 
+     * \param line_bucket_grid The grid containing both ends of each line
+     * \param picked For each line whether it has been picked already
+     * \param unpicked_count The number of non-empty lines which haven't been picked yet
+     * \param prev_point The previous point from which to find the next best line
+     * \param incoming_perpundicular_normal The direction of movement when the print head arrived at \p prev_point, turned 90 degrees CCW
+     * \return The index of the best line, or -1 if there's none left
+     */
+    int findBestUnpickedLine(const SparsePointGridInclusive<unsigned int>& line_bucket_grid, const bool* picked, unsigned int unpicked_count, Point prev_point, Point incoming_perpundicular_normal);
+
     /*!
      * Get a score to modify the distance score for measuring how good two lines follow each other.
      * 
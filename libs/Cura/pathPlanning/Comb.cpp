@@ -31,6 +31,34 @@ SparseLineGrid<PolygonsPointIndex, PolygonsPointIndexSegmentLocator>& Comb::getO
     return *outside_loc_to_line;
 }
 
+const PolygonsSegmentGrid& Comb::getBoundaryOutsideGrid()
+{
+    if (!boundary_outside_grid)
+    {
+        boundary_outside_grid = new PolygonsSegmentGrid(getBoundaryOutside());
+    }
+    return *boundary_outside_grid;
+}
+
+const PolygonsSegmentGrid& Comb::getBoundaryInsideGrid()
+{
+    if (!boundary_inside_grid)
+    {
+        boundary_inside_grid = new PolygonsSegmentGrid(boundary_inside);
+    }
+    return *boundary_inside_grid;
+}
+
+const Comb::InsidePart& Comb::getInsidePart(unsigned int part_idx)
+{
+    std::unique_ptr<InsidePart>& part = inside_parts[part_idx];
+    if (!part)
+    {
+        part.reset(new InsidePart(partsView_inside.assemblePart(part_idx)));
+    }
+    return *part;
+}
+
   
 Comb::Comb(SliceDataStorage& storage, int layer_nr, Polygons& comb_boundary_inside, int64_t comb_boundary_offset, bool travel_avoid_other_parts, int64_t travel_avoid_distance)
 : storage(storage)
@@ -45,7 +73,10 @@ Comb::Comb(SliceDataStorage& storage, int layer_nr, Polygons& comb_boundary_insi
 , boundary_inside( comb_boundary_inside )
 , boundary_outside(nullptr)
 , outside_loc_to_line(nullptr)
+, boundary_outside_grid(nullptr)
 , partsView_inside( boundary_inside.splitIntoPartsView() ) // !! changes the order of boundary_inside !!
+, boundary_inside_grid(nullptr)
+, inside_parts(partsView_inside.size())
 {
 }
 
@@ -59,6 +90,14 @@ Comb::~Comb()
     {
         delete outside_loc_to_line;
     }
+    if (boundary_outside_grid)
+    {
+        delete boundary_outside_grid;
+    }
+    if (boundary_inside_grid)
+    {
+        delete boundary_inside_grid;
+    }
 }
 
 bool Comb::calc(Point startPoint, Point endPoint, CombPaths& combPaths, bool _startInside, bool _endInside, int64_t max_comb_distance_ignored, bool via_outside_makes_combing_fail, bool fail_on_unavoidable_obstacles)
@@ -82,9 +121,9 @@ bool Comb::calc(Point startPoint, Point endPoint, CombPaths& combPaths, bool _st
     
     if (startInside && endInside && start_part_idx == end_part_idx)
     { // normal combing within part
-        PolygonsPart part = partsView_inside.assemblePart(start_part_idx);
+        const InsidePart& part = getInsidePart(start_part_idx);
         combPaths.emplace_back();
-        return LinePolygonsCrossings::comb(part, startPoint, endPoint, combPaths.back(), -offset_dist_to_get_from_on_the_polygon_to_outside, max_comb_distance_ignored, fail_on_unavoidable_obstacles);
+        return LinePolygonsCrossings::comb(part.grid, startPoint, endPoint, combPaths.back(), -offset_dist_to_get_from_on_the_polygon_to_outside, max_comb_distance_ignored, fail_on_unavoidable_obstacles);
     }
     else 
     { // comb inside part to edge (if needed) >> move through air avoiding other parts >> comb inside end part upto the endpoint (if needed) 
@@ -103,8 +142,8 @@ bool Comb::calc(Point startPoint, Point endPoint, CombPaths& combPaths, bool _st
         Crossing end_crossing(endPoint, endInside, end_part_idx, end_part_boundary_poly_idx, boundary_inside);
 
         { // find crossing over the in-between area between inside and outside
-            start_crossing.findCrossingInOrMid(partsView_inside, endPoint);
-            end_crossing.findCrossingInOrMid(partsView_inside, start_crossing.in_or_mid);
+            start_crossing.findCrossingInOrMid(*this, endPoint);
+            end_crossing.findCrossingInOrMid(*this, start_crossing.in_or_mid);
         }
 
         bool avoid_other_parts_now = avoid_other_parts;
@@ -134,9 +173,9 @@ bool Comb::calc(Point startPoint, Point endPoint, CombPaths& combPaths, bool _st
         if (startInside)
         {
             // start to boundary
-            assert(start_crossing.dest_part.size() > 0 && "The part we start inside when combing should have been computed already!");
+            assert(start_crossing.dest_part && "The part we start inside when combing should have been computed already!");
             combPaths.emplace_back();
-            bool combing_succeeded = LinePolygonsCrossings::comb(start_crossing.dest_part, startPoint, start_crossing.in_or_mid, combPaths.back(), -offset_dist_to_get_from_on_the_polygon_to_outside, max_comb_distance_ignored, fail_on_unavoidable_obstacles);
+            bool combing_succeeded = LinePolygonsCrossings::comb(start_crossing.dest_part->grid, startPoint, start_crossing.in_or_mid, combPaths.back(), -offset_dist_to_get_from_on_the_polygon_to_outside, max_comb_distance_ignored, fail_on_unavoidable_obstacles);
             if (!combing_succeeded)
             { // Couldn't comb between start point and computed crossing from the start part! Happens for very thin parts when the offset_to_get_off_boundary moves points to outside the polygon
                 return false;
@@ -155,7 +194,7 @@ bool Comb::calc(Point startPoint, Point endPoint, CombPaths& combPaths, bool _st
             }
             else
             {
-                bool combing_succeeded = LinePolygonsCrossings::comb(getBoundaryOutside(), start_crossing.out, end_crossing.out, combPaths.back(), offset_dist_to_get_from_on_the_polygon_to_outside, max_comb_distance_ignored, fail_on_unavoidable_obstacles);
+                bool combing_succeeded = LinePolygonsCrossings::comb(getBoundaryOutsideGrid(), start_crossing.out, end_crossing.out, combPaths.back(), offset_dist_to_get_from_on_the_polygon_to_outside, max_comb_distance_ignored, fail_on_unavoidable_obstacles);
                 if (!combing_succeeded)
                 {
                     return false;
@@ -174,10 +213,10 @@ bool Comb::calc(Point startPoint, Point endPoint, CombPaths& combPaths, bool _st
         if (endInside)
         {
             // boundary to end
-            assert(end_crossing.dest_part.size() > 0 && "The part we end up inside when combing should have been computed already!");
+            assert(end_crossing.dest_part && "The part we end up inside when combing should have been computed already!");
             combPaths.emplace_back();
             
-            bool combing_succeeded = LinePolygonsCrossings::comb(end_crossing.dest_part, end_crossing.in_or_mid, endPoint, combPaths.back(), -offset_dist_to_get_from_on_the_polygon_to_outside, max_comb_distance_ignored, fail_on_unavoidable_obstacles);
+            bool combing_succeeded = LinePolygonsCrossings::comb(end_crossing.dest_part->grid, end_crossing.in_or_mid, endPoint, combPaths.back(), -offset_dist_to_get_from_on_the_polygon_to_outside, max_comb_distance_ignored, fail_on_unavoidable_obstacles);
             if (!combing_succeeded)
             { // Couldn't comb between end point and computed crossing to the end part! Happens for very thin parts when the offset_to_get_off_boundary moves points to outside the polygon
                 return false;
@@ -190,6 +229,7 @@ bool Comb::calc(Point startPoint, Point endPoint, CombPaths& combPaths, bool _st
 
 Comb::Crossing::Crossing(const Point& dest_point, const bool dest_is_inside, const unsigned int dest_part_idx, const unsigned int dest_part_boundary_crossing_poly_idx, const Polygons& boundary_inside)
 : dest_is_inside(dest_is_inside)
+, dest_part(nullptr)
 , dest_crossing_poly(boundary_inside[dest_part_boundary_crossing_poly_idx]) // initialize with most obvious poly, cause mostly a combing move will move outside the part, rather than inside a hole in the part
 , dest_point(dest_point)
 , dest_part_idx(dest_part_idx)
@@ -201,7 +241,8 @@ bool Comb::moveInside(bool is_inside, Point& dest_point, unsigned int& inside_po
 {
     if (is_inside)
     {
-        ClosestPolygonPoint cpp = PolygonUtils::ensureInsideOrOutside(boundary_inside, dest_point, offset_extra_start_end, max_moveInside_distance2);
+        const ClosestPolygonPoint closest = getBoundaryInsideGrid().findClosest(dest_point);
+        ClosestPolygonPoint cpp = PolygonUtils::ensureInsideOrOutside(boundary_inside, dest_point, closest, offset_extra_start_end, max_moveInside_distance2);
         if (cpp.point_idx == NO_INDEX)
         {
             return false;
@@ -215,17 +256,17 @@ bool Comb::moveInside(bool is_inside, Point& dest_point, unsigned int& inside_po
     return false;
 }
 
-void Comb::Crossing::findCrossingInOrMid(const PartsView& partsView_inside, const Point close_to)
+void Comb::Crossing::findCrossingInOrMid(Comb& comber, const Point close_to)
 {
     if (dest_is_inside)
     { // in-case
         // find the point on the start inside-polygon closest to the endpoint, but also kind of close to the start point
         Point _dest_point(dest_point); // copy to local variable for lambda capture
         std::function<int(Point)> close_towards_start_penalty_function([_dest_point](Point candidate){ return vSize2((candidate - _dest_point) / 10); });
-        dest_part = partsView_inside.assemblePart(dest_part_idx);
+        dest_part = &comber.getInsidePart(dest_part_idx);
         Point result(close_to);
         int64_t max_dist2 = std::numeric_limits<int64_t>::max();
-        ClosestPolygonPoint crossing_1_in_cp = PolygonUtils::ensureInsideOrOutside(dest_part, result, offset_dist_to_get_from_on_the_polygon_to_outside, max_dist2, close_towards_start_penalty_function);
+        ClosestPolygonPoint crossing_1_in_cp = PolygonUtils::ensureInsideOrOutside(dest_part->polygons, result, offset_dist_to_get_from_on_the_polygon_to_outside, max_dist2, close_towards_start_penalty_function);
         if (crossing_1_in_cp.point_idx != NO_INDEX)
         {
             dest_crossing_poly = crossing_1_in_cp.poly;
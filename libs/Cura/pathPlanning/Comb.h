@@ -2,9 +2,11 @@
 #ifndef PATH_PLANNING_COMB_H
 #define PATH_PLANNING_COMB_H
 
-#include <memory> // shared_ptr
+#include <memory> // shared_ptr, unique_ptr
+#include <vector>
 
 #include "../utils/polygon.h"
+#include "../utils/PolygonsSegmentGrid.h"
 #include "../utils/SparsePointGridInclusive.h"
 #include "../utils/polygonUtils.h"
 
@@ -29,11 +31,28 @@ class SliceDataStorage;
  * 
  * As an optimization, the combing paths inside are calculated on specifically those PolygonsParts within which to comb, while the coundary_outside isn't split into outside parts, 
  * because generally there is only one outside part; encapsulated holes occur less often.
+ * 
+ * The boundaries, the assembled inside parts and the PolygonsSegmentGrid over each of them are computed once for the layer, when they are first needed.
  */
 class Comb 
 {
     friend class LinePolygonsCrossings;
 private:
+    /*!
+     * An assembled part of the inside boundary along with the grid over its line segments.
+     */
+    struct InsidePart
+    {
+        PolygonsPart polygons; //!< The polygons of the part
+        PolygonsSegmentGrid grid; //!< The grid over the line segments of InsidePart::polygons
+
+        InsidePart(const PolygonsPart& polygons)
+        : polygons(polygons)
+        , grid(this->polygons)
+        {
+        }
+    };
+
     /*!
      * A crossing from the inside boundary to the outside boundary.
      * 
@@ -45,7 +64,7 @@ private:
         bool dest_is_inside; //!< Whether the startPoint or endPoint is inside the inside boundary
         Point in_or_mid; //!< The point on the inside boundary, or in between the inside and outside boundary if the start/end point isn't inside the inside boudary
         Point out; //!< The point on the outside boundary
-        PolygonsPart dest_part; //!< The assembled inside-boundary PolygonsPart in which the dest_point lies. (will only be initialized when Crossing::dest_is_inside holds)
+        const InsidePart* dest_part; //!< The assembled inside-boundary part in which the dest_point lies. (will only be initialized when Crossing::dest_is_inside holds)
         PolygonRef dest_crossing_poly; //!< The polygon of the part in which dest_point lies, which will be crossed (often will be the outside polygon)
 
         /*!
@@ -62,10 +81,10 @@ private:
         /*!
          * Find the not-outside location (Combing::in_or_mid) of the crossing between to the outside boundary
          * 
-         * \param partsView_inside Structured indices onto Comb::boundary_inside which shows which polygons belong to which part. 
+         * \param comber[in] The combing calculator which holds the assembled parts of Comb::boundary_inside
          * \param close_to[in] Try to get a crossing close to this point
          */
-        void findCrossingInOrMid(const PartsView& partsView_inside, const Point close_to);
+        void findCrossingInOrMid(Comb& comber, const Point close_to);
 
         /*!
          * Find the outside location (Combing::out)
@@ -114,7 +133,10 @@ private:
     Polygons& boundary_inside; //!< The boundary within which to comb.
     Polygons* boundary_outside; //!< The boundary outside of which to stay to avoid collision with other layer parts. This is a pointer cause we only compute it when we move outside the boundary (so not when there is only a single part in the layer)
     SparseLineGrid<PolygonsPointIndex, PolygonsPointIndexSegmentLocator>* outside_loc_to_line; //!< The SparsePointGridInclusive mapping locations to line segments of the outside boundary.
+    PolygonsSegmentGrid* boundary_outside_grid; //!< The grid over the line segments of the outside boundary. This is a pointer cause we only compute it when we comb through air.
     PartsView partsView_inside; //!< Structured indices onto boundary_inside which shows which polygons belong to which part. 
+    PolygonsSegmentGrid* boundary_inside_grid; //!< The grid over the line segments of Comb::boundary_inside, computed when first needed.
+    std::vector<std::unique_ptr<InsidePart>> inside_parts; //!< For each part in Comb::partsView_inside the assembled part, or nullptr when it hasn't been needed yet.
 
     /*!
      * Get the boundary_outside, which is an offset from the outlines of all meshes in the layer. Calculate it when it hasn't been calculated yet.
@@ -126,6 +148,23 @@ private:
      */
     SparseLineGrid<PolygonsPointIndex, PolygonsPointIndexSegmentLocator>& getOutsideLocToLine();
 
+    /*!
+     * Get the grid over the line segments of the outside boundary. Calculate it when it hasn't been calculated yet.
+     */
+    const PolygonsSegmentGrid& getBoundaryOutsideGrid();
+
+    /*!
+     * Get the grid over the line segments of Comb::boundary_inside. Calculate it when it hasn't been calculated yet.
+     */
+    const PolygonsSegmentGrid& getBoundaryInsideGrid();
+
+    /*!
+     * Get an assembled part of Comb::boundary_inside. Assemble it when it hasn't been assembled yet.
+     * 
+     * \param part_idx The index of the part in Comb::partsView_inside
+     */
+    const InsidePart& getInsidePart(unsigned int part_idx);
+
     /*!
      * Move the startPoint or endPoint inside when it should be inside
      * \param is_inside[in] Whether the \p dest_point should be inside
@@ -16,19 +16,22 @@ bool LinePolygonsCrossings::calcScanlineCrossings(bool fail_on_unavoidable_obsta
     min_crossing_idx = NO_INDEX;
     max_crossing_idx = NO_INDEX;
 
-    for(unsigned int poly_idx = 0; poly_idx < boundary.size(); poly_idx++)
+    std::vector<PolygonsSegmentGrid::Segment> segments; // sorted by polygon, so that each polygon is handled at once
+    boundary_grid.getSegmentsNearLine(startPoint, endPoint, segments);
+    for (unsigned int segment_idx = 0; segment_idx < segments.size(); )
     {
+        const unsigned int poly_idx = segments[segment_idx].poly_idx;
         PolyCrossings minMax(poly_idx); 
-        PolygonRef poly = boundary[poly_idx];
-        Point p0 = transformation_matrix.apply(poly[poly.size() - 1]);
-        for(unsigned int point_idx = 0; point_idx < poly.size(); point_idx++)
+        const PolygonRef poly = boundary[poly_idx];
+        for (; segment_idx < segments.size() && segments[segment_idx].poly_idx == poly_idx; segment_idx++)
         {
-            Point p1 = transformation_matrix.apply(poly[point_idx]);
+            const unsigned int point_idx = (segments[segment_idx].point_idx + 1) % poly.size(); // the index of the end of the segment
+            const Point p0 = transformation_matrix.apply(poly[segments[segment_idx].point_idx]);
+            const Point p1 = transformation_matrix.apply(poly[point_idx]);
             if ((p0.Y >= transformed_startPoint.Y && p1.Y <= transformed_startPoint.Y) || (p1.Y >= transformed_startPoint.Y && p0.Y <= transformed_startPoint.Y))
             { // if line segment crosses the line through the transformed start and end point (aka scanline)
                 if (p1.Y == p0.Y) //Line segment is parallel with the scanline. That means that both endpoints lie on the scanline, so they will have intersected with the adjacent line.
                 {
-                    p0 = p1;
                     continue;
                 }
                 int64_t x = p0.X + (p1.X - p0.X) * (transformed_startPoint.Y - p0.Y) / (p1.Y - p0.Y); // intersection point between line segment and the scanline
@@ -40,20 +43,20 @@ bool LinePolygonsCrossings::calcScanlineCrossings(bool fail_on_unavoidable_obsta
                         // \/ will be no crossings and /\ two, but most importantly | will be one crossing.
                         minMax.n_crossings++;
                     }
-                    if(x < minMax.min.x) //For the leftmost intersection, move x left to stay outside of the border.
-                                         //Note: The actual distance from the intersection to the border is almost always less than dist_to_move_boundary_point_outside, since it only moves along the direction of the scanline.
+                    // the segments aren't visited in the order of the polygon, so of equal crossings the one with the lowest point_idx is used
+                    if (x < minMax.min.x || (x == minMax.min.x && point_idx < minMax.min.point_idx)) //For the leftmost intersection, move x left to stay outside of the border.
+                                                                                                     //Note: The actual distance from the intersection to the border is almost always less than dist_to_move_boundary_point_outside, since it only moves along the direction of the scanline.
                     {
                         minMax.min.x = x;
                         minMax.min.point_idx = point_idx;
                     }
-                    if(x > minMax.max.x) //For the rightmost intersection, move x right to stay outside of the border.
+                    if (x > minMax.max.x || (x == minMax.max.x && point_idx < minMax.max.point_idx)) //For the rightmost intersection, move x right to stay outside of the border.
                     {
                         minMax.max.x = x;
                         minMax.max.point_idx = point_idx;
                     }
                 }
             }
-            p0 = p1;
         }
 
         if (fail_on_unavoidable_obstacles && minMax.n_crossings % 2 == 1)
@@ -79,27 +82,26 @@ bool LinePolygonsCrossings::lineSegmentCollidesWithBoundary()
     transformed_startPoint = transformation_matrix.apply(startPoint);
     transformed_endPoint = transformation_matrix.apply(endPoint);
 
-    for(PolygonRef poly : boundary)
+    std::vector<PolygonsSegmentGrid::Segment> segments;
+    boundary_grid.getSegmentsNearLine(startPoint, endPoint, segments);
+    for (const PolygonsSegmentGrid::Segment& segment : segments)
     {
-        Point p0 = transformation_matrix.apply(poly.back());
-        for(Point p1_ : poly)
+        const PolygonRef poly = boundary[segment.poly_idx];
+        const Point p0 = transformation_matrix.apply(poly[segment.point_idx]);
+        const Point p1 = transformation_matrix.apply(poly[(segment.point_idx + 1) % poly.size()]);
+        // when the boundary just touches the line don't disambiguate between the boundary moving on to actually cross the line
+        // and the boundary bouncing back, resulting in not a real collision - to keep the algorithm simple.
+        //
+        // disregard overlapping line segments; probably the next or previous line segment is not overlapping, but will give a collision
+        // when the boundary line segment fully overlaps with the line segment this edge case is not viewed as a collision
+        if (p1.Y != p0.Y && ((p0.Y >= transformed_startPoint.Y && p1.Y <= transformed_startPoint.Y) || (p1.Y >= transformed_startPoint.Y && p0.Y <= transformed_startPoint.Y)))
         {
-            Point p1 = transformation_matrix.apply(p1_);
-            // when the boundary just touches the line don't disambiguate between the boundary moving on to actually cross the line
-            // and the boundary bouncing back, resulting in not a real collision - to keep the algorithm simple.
-            //
-            // disregard overlapping line segments; probably the next or previous line segment is not overlapping, but will give a collision
-            // when the boundary line segment fully overlaps with the line segment this edge case is not viewed as a collision
-            if (p1.Y != p0.Y && ((p0.Y >= transformed_startPoint.Y && p1.Y <= transformed_startPoint.Y) || (p1.Y >= transformed_startPoint.Y && p0.Y <= transformed_startPoint.Y)))
-            {
-                int64_t x = p0.X + (p1.X - p0.X) * (transformed_startPoint.Y - p0.Y) / (p1.Y - p0.Y);
+            int64_t x = p0.X + (p1.X - p0.X) * (transformed_startPoint.Y - p0.Y) / (p1.Y - p0.Y);
 
-                if (x > transformed_startPoint.X && x < transformed_endPoint.X)
-                {
-                    return true;
-                }
+            if (x > transformed_startPoint.X && x < transformed_endPoint.X)
+            {
+                return true;
             }
-            p0 = p1;
         }
     }
     
@@ -144,7 +146,7 @@ void LinePolygonsCrossings::getBasicCombingPath(CombPath& combPath)
 
 void LinePolygonsCrossings::getBasicCombingPath(PolyCrossings& polyCrossings, CombPath& combPath) 
 {
-    PolygonRef poly = boundary[polyCrossings.poly_idx];
+    const PolygonRef poly = boundary[polyCrossings.poly_idx];
     combPath.push_back(transformation_matrix.unapply(Point(polyCrossings.min.x - dist_to_move_boundary_point_outside, transformed_startPoint.Y)));
     if ( ( polyCrossings.max.point_idx - polyCrossings.min.point_idx + poly.size() ) % poly.size() 
         < poly.size() / 2 )
@@ -194,9 +196,9 @@ bool LinePolygonsCrossings::optimizePath(CombPath& comb_path, CombPath& optimize
             continue;
         }
         Point& current_point = optimized_comb_path.back();
-        if (PolygonUtils::polygonCollidesWithlineSegment(boundary, current_point, comb_path[point_idx]))
+        if (boundary_grid.collidesWithLineSegment(current_point, comb_path[point_idx]))
         {
-            if (PolygonUtils::polygonCollidesWithlineSegment(boundary, current_point, comb_path[point_idx - 1]))
+            if (boundary_grid.collidesWithLineSegment(current_point, comb_path[point_idx - 1]))
             {
                 comb_path.cross_boundary = true;
             }
@@ -209,7 +211,7 @@ bool LinePolygonsCrossings::optimizePath(CombPath& comb_path, CombPath& optimize
             // TODO: add the below extra optimization? (+/- 7% extra computation time, +/- 2% faster print for Dual_extrusion_support_generation.stl)
             while (optimized_comb_path.size() > 1)
             {
-                if (PolygonUtils::polygonCollidesWithlineSegment(boundary, optimized_comb_path[optimized_comb_path.size() - 2], comb_path[point_idx]))
+                if (boundary_grid.collidesWithLineSegment(optimized_comb_path[optimized_comb_path.size() - 2], comb_path[point_idx]))
                 {
                     break;
                 }
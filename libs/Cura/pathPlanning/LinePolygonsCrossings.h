@@ -3,6 +3,7 @@
 #define PATH_PLANNING_LINE_POLYGONS_CROSSINGS_H
 
 #include "../utils/polygon.h"
+#include "../utils/PolygonsSegmentGrid.h"
 
 #include "CombPath.h"
 
@@ -21,6 +22,8 @@ namespace cura
  * The path is offsetted from the polygons, so that it doesn't intersect with them.
  * 
  * Next the basic path is optimized by taking shortcuts where possible. Only shortcuts which skip a single point are considered, in order to reduce computational complexity.
+ * 
+ * Only the boundary segments near the lines under consideration are checked, which are looked up in a PolygonsSegmentGrid over the boundary.
  */
 class LinePolygonsCrossings
 {
@@ -79,7 +82,8 @@ private:
     unsigned int min_crossing_idx; //!< The index into LinePolygonsCrossings::crossings to the crossing with the minimal PolyCrossings::min crossing of all PolyCrossings's.
     unsigned int max_crossing_idx; //!< The index into LinePolygonsCrossings::crossings to the crossing with the maximal PolyCrossings::max crossing of all PolyCrossings's.
     
-    Polygons& boundary; //!< The boundary not to cross during combing.
+    const PolygonsSegmentGrid& boundary_grid; //!< The grid over the line segments of LinePolygonsCrossings::boundary
+    const Polygons& boundary; //!< The boundary not to cross during combing.
     Point startPoint; //!< The start point of the scanline.
     Point endPoint; //!< The end point of the scanline.
     
@@ -158,13 +162,13 @@ private:
     
     /*!
      * Create a LinePolygonsCrossings with minimal initialization.
-     * \param boundary The boundary which not to cross during combing
+     * \param boundary_grid The grid over the boundary which not to cross during combing
      * \param start the starting point
      * \param end the end point
      * \param dist_to_move_boundary_point_outside Distance used to move a point from a boundary so that it doesn't intersect with it anymore. (Precision issue)
      */
-    LinePolygonsCrossings(Polygons& boundary, Point& start, Point& end, int64_t dist_to_move_boundary_point_outside)
-    : boundary(boundary), startPoint(start), endPoint(end), dist_to_move_boundary_point_outside(dist_to_move_boundary_point_outside)
+    LinePolygonsCrossings(const PolygonsSegmentGrid& boundary_grid, Point& start, Point& end, int64_t dist_to_move_boundary_point_outside)
+    : boundary_grid(boundary_grid), boundary(boundary_grid.getPolygons()), startPoint(start), endPoint(end), dist_to_move_boundary_point_outside(dist_to_move_boundary_point_outside)
     {
     }
     
@@ -172,16 +176,16 @@ public:
     
     /*!
      * The main function of this class: calculate one combing path within the boundary.
-     * \param boundary The polygons to follow when calculating the basic combing path
+     * \param boundary_grid The grid over the polygons to follow when calculating the basic combing path
      * \param startPoint From where to start the combing move.
      * \param endPoint Where to end the combing move.
      * \param combPath Output parameter: the combing path generated.
      * \param fail_on_unavoidable_obstacles When moving over other parts is inavoidable, stop calculation early and return false.
      * \return Whether combing succeeded, i.e. we didn't cross any gaps/other parts
      */
-    static bool comb(Polygons& boundary, Point startPoint, Point endPoint, CombPath& combPath, int64_t dist_to_move_boundary_point_outside, int64_t max_comb_distance_ignored, bool fail_on_unavoidable_obstacles)
+    static bool comb(const PolygonsSegmentGrid& boundary_grid, Point startPoint, Point endPoint, CombPath& combPath, int64_t dist_to_move_boundary_point_outside, int64_t max_comb_distance_ignored, bool fail_on_unavoidable_obstacles)
     {
-        LinePolygonsCrossings linePolygonsCrossings(boundary, startPoint, endPoint, dist_to_move_boundary_point_outside);
+        LinePolygonsCrossings linePolygonsCrossings(boundary_grid, startPoint, endPoint, dist_to_move_boundary_point_outside);
         return linePolygonsCrossings.getCombingPath(combPath, max_comb_distance_ignored, fail_on_unavoidable_obstacles);
     };
 };
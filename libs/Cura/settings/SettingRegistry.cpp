@@ -222,6 +222,7 @@ int SettingRegistry::loadJSONsettingsFromDoc(rapidjson::Document& json_document,
     {
         std::list<std::string> path;
         handleChildren(json_document["settings"], path, settings_base, warn_duplicates);
+        loadEngineSettings(settings_base);
     }
     
     if (json_document.HasMember("overrides"))
@@ -315,6 +316,18 @@ void SettingRegistry::handleSetting(const rapidjson::Value::ConstMemberIterator&
     }
 }
 
+void SettingRegistry::loadEngineSettings(SettingsBase* settings_base)
+{
+    if (!settingExists("path_order_improvement_time"))
+    { // the order of the paths is only improved when asked for, because it costs slicing time and makes the output depend on the speed of the machine
+        SettingConfig& config = addSetting("path_order_improvement_time", "Path Order Improvement Time");
+        config.setType("float");
+        config.setUnit("s");
+        config.setDefault("0");
+        settings_base->_setSetting(config.getKey(), config.getDefaultValue());
+    }
+}
+
 SettingConfig& SettingRegistry::addSetting(std::string name, std::string label)
 {
     SettingConfig* config = setting_definitions.addChild(name, label);
@@ -148,6 +148,15 @@ private:
      */
     int loadJSONsettingsFromDoc(rapidjson::Document& json_document, SettingsBase* settings_base, bool warn_duplicates);
 
+    /*!
+     * Register the settings which the engine reads but which the json files don't define, with their default values.
+     * 
+     * Settings defined by the json files keep their definition.
+     * 
+     * \param settings_base The settings base where to store the default values.
+     */
+    void loadEngineSettings(SettingsBase* settings_base);
+
     /*!
      * Create a new SettingConfig and add it to the registry.
      * 
@@ -41,6 +41,108 @@ std::string toString(EGCodeFlavor flavor)
     }
 }
 
+namespace
+{
+
+/*!
+ * Interpret a setting value as a boolean.
+ */
+bool parseBoolean(const std::string& value)
+{
+    if (value == "on")
+        return true;
+    if (value == "yes")
+        return true;
+    if (value == "true" or value == "True") //Python uses "True"
+        return true;
+    int num = atoi(value.c_str());
+    return num != 0;
+}
+
+ParsedSetting parseSetting(const std::string& value)
+{
+    ParsedSetting parsed;
+    parsed.number = atof(value.c_str());
+    parsed.integer = atoi(value.c_str());
+    parsed.boolean = parseBoolean(value);
+    return parsed;
+}
+
+}//anonymous namespace
+
+SettingKey::SettingKey(std::string key)
+: setting_name(key)
+{
+    // Function local so that keys can be interned during static initialization of other translation units
+    static std::mutex intern_mutex;
+    static std::unordered_map<std::string, unsigned int> interned_ids;
+
+    std::lock_guard<std::mutex> lock(intern_mutex);
+    auto interned = interned_ids.emplace(key, interned_ids.size());
+    setting_id = interned.first->second;
+    if (interned.second && setting_id >= capacity)
+    {
+        cura::logWarning("Setting key %s is not cached, because more than %u keys are interned\n", key.c_str(), capacity);
+    }
+}
+
+constexpr unsigned int SettingKey::capacity;
+
+std::atomic<unsigned int> SettingValueCache::current_version(1);
+constexpr unsigned int SettingValueCache::storing;
+
+SettingValueCache::SettingValueCache()
+: entries(new Entry[SettingKey::capacity])
+{
+}
+
+SettingValueCache& SettingValueCache::operator=(const SettingValueCache&)
+{
+    for (unsigned int id = 0; id < SettingKey::capacity; id++)
+    {
+        entries[id].version = 0;
+    }
+    return *this;
+}
+
+bool SettingValueCache::get(unsigned int id, ParsedSetting& value) const
+{
+    if (id >= SettingKey::capacity)
+    {
+        return false;
+    }
+    const Entry& entry = entries[id];
+    const unsigned int version = entry.version.load(std::memory_order_acquire);
+    if (version != current_version.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+    value.number = entry.number.load(std::memory_order_relaxed);
+    value.integer = entry.integer.load(std::memory_order_relaxed);
+    value.boolean = entry.boolean.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return entry.version.load(std::memory_order_relaxed) == version; // otherwise the value was overwritten while it was read
+}
+
+void SettingValueCache::put(unsigned int id, unsigned int version, const ParsedSetting& value)
+{
+    if (id >= SettingKey::capacity)
+    {
+        return;
+    }
+    Entry& entry = entries[id];
+    unsigned int old_version = entry.version.load(std::memory_order_relaxed);
+    if (old_version == storing || !entry.version.compare_exchange_strong(old_version, storing, std::memory_order_relaxed))
+    {
+        return; // another thread is storing it
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.number.store(value.number, std::memory_order_relaxed);
+    entry.integer.store(value.integer, std::memory_order_relaxed);
+    entry.boolean.store(value.boolean, std::memory_order_relaxed);
+    entry.version.store(version, std::memory_order_release);
+}
+
 SettingsBaseVirtual::SettingsBaseVirtual()
 : parent(NULL)
 {
@@ -69,6 +171,7 @@ SettingsMessenger::SettingsMessenger(SettingsBaseVirtual* parent)
 void SettingsBase::_setSetting(std::string key, std::string value)
 {
     setting_values[key] = value;
+    SettingValueCache::invalidateAll();
 }
 
 
@@ -88,6 +191,7 @@ void SettingsBase::setSetting(std::string key, std::string value)
 void SettingsBase::setSettingInheritBase(std::string key, const SettingsBaseVirtual& parent)
 {
     setting_inherit_base.emplace(key, &parent);
+    SettingValueCache::invalidateAll();
 }
 
 
@@ -111,6 +215,20 @@ std::string SettingsBase::getSettingString(std::string key) const
     return "";
 }
 
+ParsedSetting SettingsBase::getParsedSetting(const SettingKey& key) const
+{
+    ParsedSetting value;
+    if (setting_value_cache.get(key.id(), value))
+    {
+        return value;
+    }
+    // Read the version before the lookup, so that a setting changed meanwhile leaves a stale entry behind rather than a wrong one
+    const unsigned int version = SettingValueCache::currentVersion();
+    value = parseSetting(getSettingString(key.name()));
+    setting_value_cache.put(key.id(), version, value);
+    return value;
+}
+
 void SettingsMessenger::setSetting(std::string key, std::string value)
 {
     parent->setSetting(key, value);
@@ -127,6 +245,16 @@ std::string SettingsMessenger::getSettingString(std::string key) const
     return parent->getSettingString(key);
 }
 
+ParsedSetting SettingsMessenger::getParsedSetting(const SettingKey& key) const
+{
+    return parent->getParsedSetting(key);
+}
+
+ParsedSetting SettingsBaseVirtual::getParsedSetting(const SettingKey& key) const
+{
+    return parseSetting(getSettingString(key.name()));
+}
+
 int SettingsBaseVirtual::getSettingAsIndex(std::string key) const
 {
     std::string value = getSettingString(key);
@@ -175,15 +303,7 @@ double SettingsBaseVirtual::getSettingInAngleRadians(std::string key) const
 
 bool SettingsBaseVirtual::getSettingBoolean(std::string key) const
 {
-    std::string value = getSettingString(key);
-    if (value == "on")
-        return true;
-    if (value == "yes")
-        return true;
-    if (value == "true" or value == "True") //Python uses "True"
-        return true;
-    int num = atoi(value.c_str());
-    return num != 0;
+    return parseBoolean(getSettingString(key));
 }
 
 double SettingsBaseVirtual::getSettingInDegreeCelsius(std::string key) const
@@ -216,6 +336,66 @@ double SettingsBaseVirtual::getSettingInSeconds(std::string key) const
     return std::max(0.0, atof(value.c_str()));
 }
 
+int SettingsBaseVirtual::getSettingAsIndex(const SettingKey& key) const
+{
+    return getParsedSetting(key).integer;
+}
+
+int SettingsBaseVirtual::getSettingAsCount(const SettingKey& key) const
+{
+    return getParsedSetting(key).integer;
+}
+
+double SettingsBaseVirtual::getSettingInMillimeters(const SettingKey& key) const
+{
+    return getParsedSetting(key).number;
+}
+
+int SettingsBaseVirtual::getSettingInMicrons(const SettingKey& key) const
+{
+    return getSettingInMillimeters(key) * 1000.0;
+}
+
+double SettingsBaseVirtual::getSettingInAngleDegrees(const SettingKey& key) const
+{
+    return getParsedSetting(key).number;
+}
+
+double SettingsBaseVirtual::getSettingInAngleRadians(const SettingKey& key) const
+{
+    return getParsedSetting(key).number / 180.0 * M_PI;
+}
+
+bool SettingsBaseVirtual::getSettingBoolean(const SettingKey& key) const
+{
+    return getParsedSetting(key).boolean;
+}
+
+double SettingsBaseVirtual::getSettingInDegreeCelsius(const SettingKey& key) const
+{
+    return getParsedSetting(key).number;
+}
+
+double SettingsBaseVirtual::getSettingInMillimetersPerSecond(const SettingKey& key) const
+{
+    return std::max(0.0, getParsedSetting(key).number);
+}
+
+double SettingsBaseVirtual::getSettingInCubicMillimeters(const SettingKey& key) const
+{
+    return std::max(0.0, getParsedSetting(key).number);
+}
+
+double SettingsBaseVirtual::getSettingInPercentage(const SettingKey& key) const
+{
+    return std::max(0.0, getParsedSetting(key).number);
+}
+
+double SettingsBaseVirtual::getSettingInSeconds(const SettingKey& key) const
+{
+    return std::max(0.0, getParsedSetting(key).number);
+}
+
 DraftShieldHeightLimitation SettingsBaseVirtual::getSettingAsDraftShieldHeightLimitation(const std::string key) const
 {
     const std::string value = getSettingString(key);
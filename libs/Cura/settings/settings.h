@@ -2,6 +2,9 @@
 #ifndef SETTINGS_SETTINGS_H
 #define SETTINGS_SETTINGS_H
 
+#include <atomic>
+#include <memory> // unique_ptr
+#include <mutex>
 #include <vector>
 #include <map>
 #include <unordered_map>
@@ -175,6 +178,99 @@ enum class SupportDistPriority
     
 class SettingsBase;
 
+/*!
+ * The name of a setting interned to a small dense id.
+ * 
+ * Looking a setting up by its key costs a hash of the key, a walk up the inheritance and a parse of the value string.
+ * The typed getters which take a SettingKey instead only pay this the first time;
+ * after that they index the typed-value cache of the settings object with the id.
+ * 
+ * Construct keys once and reuse them, e.g. as file scope constants in code which queries settings per layer or per path.
+ */
+class SettingKey
+{
+public:
+    explicit SettingKey(std::string key); //!< Interns \p key, the same key always gets the same id
+    
+    unsigned int id() const { return setting_id; }
+    const std::string& name() const { return setting_name; }
+
+    /*!
+     * The number of keys with an entry in every SettingValueCache, fixed so that static caches don't depend on the order of static initialization.
+     * Interning more keys than this logs a warning; the keys beyond it still work, but their values are never cached.
+     */
+    static constexpr unsigned int capacity = 128;
+private:
+    unsigned int setting_id;
+    std::string setting_name;
+};
+
+/*!
+ * A setting value parsed once into each of the numeric representations used by the typed getters.
+ */
+struct ParsedSetting
+{
+    double number; //!< The value as parsed by atof
+    int integer; //!< The value as parsed by atoi
+    bool boolean; //!< The value as interpreted by \ref SettingsBaseVirtual::getSettingBoolean
+};
+
+/*!
+ * Typed values of settings, indexed by \ref SettingKey::id.
+ * 
+ * An entry is only valid while the global settings version it was stored with is current,
+ * so changing any setting invalidates the entries of all settings objects.
+ * This is needed because a value may have been inherited from another settings object.
+ * 
+ * The layers of a slice query the settings of the same objects from many threads,
+ * so the entries are lock free: each one is a seqlock around the atomic fields of its value.
+ * A reader which sees an entry while it is being stored treats it as missing,
+ * and a thread which finds another thread storing an entry leaves it to that thread.
+ * There is an entry for each of the first \ref SettingKey::capacity keys, so that it doesn't matter
+ * whether a file scope key is interned before or after a static settings object is constructed.
+ * Copies start out empty.
+ */
+class SettingValueCache
+{
+public:
+    SettingValueCache();
+    SettingValueCache(const SettingValueCache&) : SettingValueCache() {}
+    SettingValueCache& operator=(const SettingValueCache&);
+    
+    /*!
+     * Get a cached value.
+     * 
+     * \param id The id of the setting
+     * \param[out] value The cached value, if any
+     * \return Whether there was a valid entry for \p id
+     */
+    bool get(unsigned int id, ParsedSetting& value) const;
+    
+    /*!
+     * Store a value.
+     * 
+     * \param id The id of the setting
+     * \param version The global settings version from before \p value was looked up
+     * \param value The value
+     */
+    void put(unsigned int id, unsigned int version, const ParsedSetting& value);
+    
+    static unsigned int currentVersion() { return current_version; }
+    static void invalidateAll() { current_version++; } //!< Called whenever a setting or the inheritance of settings changes
+private:
+    struct Entry
+    {
+        std::atomic<unsigned int> version; //!< Version 0 is never current, \ref SettingValueCache::storing while the value is stored
+        std::atomic<double> number;
+        std::atomic<int> integer;
+        std::atomic<bool> boolean;
+        Entry() : version(0) {}
+    };
+    static constexpr unsigned int storing = ~0u; //!< Never a current version either
+    std::unique_ptr<Entry[]> entries; //!< \ref SettingKey::capacity entries
+    static std::atomic<unsigned int> current_version; //!< The global settings version
+};
+
 /*!
  * An abstract class for classes that can provide setting values.
  * These are: SettingsBase, which contains setting information 
@@ -198,12 +294,19 @@ public:
      */
     virtual void setSettingInheritBase(std::string key, const SettingsBaseVirtual& parent) = 0;
 
+    /*!
+     * Get a setting parsed into its numeric representations.
+     * 
+     * The default implementation parses \ref SettingsBaseVirtual::getSettingString every time.
+     */
+    virtual ParsedSetting getParsedSetting(const SettingKey& key) const;
+
     virtual ~SettingsBaseVirtual() {}
     
     SettingsBaseVirtual(); //!< SettingsBaseVirtual without a parent settings object
     SettingsBaseVirtual(SettingsBaseVirtual* parent); //!< construct a SettingsBaseVirtual with a parent settings object
     
-    void setParent(SettingsBaseVirtual* parent) { this->parent = parent; }
+    void setParent(SettingsBaseVirtual* parent) { this->parent = parent; SettingValueCache::invalidateAll(); }
     SettingsBaseVirtual* getParent() { return parent; }
     
     int getSettingAsIndex(std::string key) const;
@@ -230,6 +333,22 @@ public:
     double getSettingInPercentage(std::string key) const;
     double getSettingInSeconds(std::string key) const;
 
+    /*
+     * The same getters for interned keys, which are served from the typed-value cache.
+     */
+    int getSettingAsIndex(const SettingKey& key) const;
+    int getSettingAsCount(const SettingKey& key) const;
+    double getSettingInAngleDegrees(const SettingKey& key) const;
+    double getSettingInAngleRadians(const SettingKey& key) const;
+    double getSettingInMillimeters(const SettingKey& key) const;
+    int getSettingInMicrons(const SettingKey& key) const;
+    bool getSettingBoolean(const SettingKey& key) const;
+    double getSettingInDegreeCelsius(const SettingKey& key) const;
+    double getSettingInMillimetersPerSecond(const SettingKey& key) const;
+    double getSettingInCubicMillimeters(const SettingKey& key) const;
+    double getSettingInPercentage(const SettingKey& key) const;
+    double getSettingInSeconds(const SettingKey& key) const;
+
     FlowTempGraph getSettingAsFlowTempGraph(std::string key) const;
     FMatrix3x3 getSettingAsPointMatrix(std::string key) const;
 
@@ -262,6 +381,8 @@ private:
      * Mapping for each setting which must inherit from a different setting base than \ref SettingsBaseVirtual::parent
      */
     std::unordered_map<std::string, const SettingsBaseVirtual*> setting_inherit_base;
+
+    mutable SettingValueCache setting_value_cache; //!< Parsed values of the settings queried by SettingKey, whether set here or inherited
 public:
     SettingsBase(); //!< SettingsBase without a parent settings object
     SettingsBase(SettingsBaseVirtual* parent); //!< construct a SettingsBase with a parent settings object
@@ -274,6 +395,7 @@ public:
     void setSetting(std::string key, std::string value);
     void setSettingInheritBase(std::string key, const SettingsBaseVirtual& parent); //!< See \ref SettingsBaseVirtual::setSettingInheritBase
     std::string getSettingString(std::string key) const; //!< Get a setting from this SettingsBase (or any ancestral SettingsBase)
+    ParsedSetting getParsedSetting(const SettingKey& key) const; //!< Get a setting from the typed-value cache, see \ref SettingsBaseVirtual::getParsedSetting
     
     std::string getAllLocalSettingsString() const
     {
@@ -315,6 +437,7 @@ public:
     void setSetting(std::string key, std::string value); //!< Set a setting of the parent SettingsBase to a given value
     void setSettingInheritBase(std::string key, const SettingsBaseVirtual& parent); //!< See \ref SettingsBaseVirtual::setSettingInheritBase
     std::string getSettingString(std::string key) const; //!< Get a setting from the parent SettingsBase (or any further ancestral SettingsBase)
+    ParsedSetting getParsedSetting(const SettingKey& key) const; //!< Get a parsed setting from the parent SettingsBase
 };
 
 
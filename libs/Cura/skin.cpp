@@ -4,16 +4,111 @@
 #include "skin.h"
 #include "utils/math.h"
 #include "utils/polygonUtils.h"
+#include "utils/ThreadPool.h"
 
 #define MIN_AREA_SIZE (0.4 * 0.4) 
 
 namespace cura 
 {
 
-        
-void generateSkins(int layerNr, SliceMeshStorage& mesh, int downSkinCount, int upSkinCount, int wall_line_count, int innermost_wall_line_width, int insetCount, bool no_small_gaps_heuristic)
+/*!
+ * The area inside the walls of each of the lowest \p layer_count layers of a mesh.
+ */
+static std::vector<Polygons> getInsideAreas(const SliceMeshStorage& mesh, int wall_line_count, size_t layer_count)
+{
+    std::vector<Polygons> inside_areas(layer_count);
+    ThreadPool::getInstance().parallel_for(0, layer_count, [&](unsigned int layer_nr)
+        {
+            for (const SliceLayerPart& part : mesh.layers[layer_nr].parts)
+            {
+                if (part.insets.empty())
+                {
+                    continue;
+                }
+                unsigned int wall_idx = std::max(0, std::min(wall_line_count, (int) part.insets.size()) - 1);
+                inside_areas[layer_nr].add(part.insets[wall_idx]);
+            }
+        });
+    return inside_areas;
+}
+
+SkinNotAir::SkinNotAir(const SliceMeshStorage& mesh, int downSkinCount, int upSkinCount, int wall_line_count, unsigned int skin_layer_count)
+: SkinNotAir(getInsideAreas(mesh, wall_line_count, std::min(mesh.layers.size(), static_cast<size_t>(skin_layer_count + upSkinCount))), downSkinCount, upSkinCount) // the top skin range of the highest layer with skin reaches the layers above it
 {
-    generateSkinAreas(layerNr, mesh, innermost_wall_line_width, downSkinCount, upSkinCount, wall_line_count, no_small_gaps_heuristic);
+}
+
+SkinNotAir::SkinNotAir(const std::vector<Polygons>& inside_areas, int downSkinCount, int upSkinCount)
+: below(std::make_shared<BlockIntersections>(inside_areas, downSkinCount))
+, above((upSkinCount == downSkinCount) ? below : std::make_shared<BlockIntersections>(inside_areas, upSkinCount)) // top and bottom skin are often equally thick
+{
+}
+
+Polygons SkinNotAir::getBelow(int layer_nr) const
+{
+    return below->getRange(layer_nr - below->range_size);
+}
+
+Polygons SkinNotAir::getAbove(int layer_nr) const
+{
+    return above->getRange(layer_nr + 1);
+}
+
+SkinNotAir::BlockIntersections::BlockIntersections(const std::vector<Polygons>& inside_areas, int range_size)
+: range_size(range_size)
+{
+    if (range_size <= 0)
+    {
+        return;
+    }
+    const int layer_count = inside_areas.size();
+    up_to.resize(layer_count);
+    from.resize(layer_count);
+    const int block_count = (layer_count + range_size - 1) / range_size;
+    ThreadPool::getInstance().parallel_for(0, block_count, [&](unsigned int block_idx)
+        {
+            const int block_start = block_idx * range_size;
+            const int block_end = std::min(block_start + range_size, layer_count);
+            up_to[block_start] = inside_areas[block_start];
+            for (int layer_nr = block_start + 1; layer_nr < block_end; layer_nr++)
+            {
+                up_to[layer_nr] = up_to[layer_nr - 1].intersection(inside_areas[layer_nr]);
+            }
+            from[block_end - 1] = inside_areas[block_end - 1];
+            for (int layer_nr = block_end - 2; layer_nr >= block_start; layer_nr--)
+            {
+                from[layer_nr] = inside_areas[layer_nr].intersection(from[layer_nr + 1]);
+            }
+        });
+
+#ifdef DEBUG
+    // The blocks intersect the layers of a range in another order than intersecting the range on its own,
+    // so Clipper rounds some vertices differently, but only by about a micron per intersection.
+    for (int first_layer_nr = 0; first_layer_nr + range_size <= layer_count; first_layer_nr++)
+    {
+        Polygons range = inside_areas[first_layer_nr];
+        for (int layer_nr = first_layer_nr + 1; layer_nr < first_layer_nr + range_size; layer_nr++)
+        {
+            range = range.intersection(inside_areas[layer_nr]);
+        }
+        assert(getRange(first_layer_nr).xorPolygons(range).offset(-range_size).size() == 0 && "The intersection of the blocks should only differ from the intersection of the range by rounding.");
+    }
+#endif // DEBUG
+}
+
+Polygons SkinNotAir::BlockIntersections::getRange(int first_layer_nr) const
+{
+    const int last_layer_nr = first_layer_nr + range_size - 1;
+    assert(first_layer_nr >= 0 && last_layer_nr < static_cast<int>(up_to.size()) && "The range should be within the mesh.");
+    if (first_layer_nr % range_size == 0)
+    { // the range is a single block
+        return up_to[last_layer_nr];
+    }
+    return from[first_layer_nr].intersection(up_to[last_layer_nr]);
+}
+
+void generateSkins(int layerNr, SliceMeshStorage& mesh, int downSkinCount, int upSkinCount, int wall_line_count, int innermost_wall_line_width, int insetCount, bool no_small_gaps_heuristic, const SkinNotAir* not_air)
+{
+    generateSkinAreas(layerNr, mesh, innermost_wall_line_width, downSkinCount, upSkinCount, wall_line_count, no_small_gaps_heuristic, not_air);
 
     SliceLayer* layer = &mesh.layers[layerNr];
     for(unsigned int partNr=0; partNr<layer->parts.size(); partNr++)
@@ -23,7 +118,7 @@ void generateSkins(int layerNr, SliceMeshStorage& mesh, int downSkinCount, int u
     }
 }
 
-void generateSkinAreas(int layer_nr, SliceMeshStorage& mesh, const int innermost_wall_line_width, int downSkinCount, int upSkinCount, int wall_line_count, bool no_small_gaps_heuristic)
+void generateSkinAreas(int layer_nr, SliceMeshStorage& mesh, const int innermost_wall_line_width, int downSkinCount, int upSkinCount, int wall_line_count, bool no_small_gaps_heuristic, const SkinNotAir* not_air)
 {
     SliceLayer& layer = mesh.layers[layer_nr];
     
@@ -73,24 +168,15 @@ void generateSkinAreas(int layer_nr, SliceMeshStorage& mesh, const int innermost
         }
         else 
         {
+            assert(not_air && "The areas inside the walls of the skin ranges are needed without the small gaps heuristic.");
             if (layer_nr >= downSkinCount && downSkinCount > 0)
             {
-                Polygons not_air = getInsidePolygons(mesh.layers[layer_nr - 1]);
-                for (int downskin_layer_nr = layer_nr - downSkinCount; downskin_layer_nr < layer_nr - 1; downskin_layer_nr++)
-                {
-                    not_air = not_air.intersection(getInsidePolygons(mesh.layers[downskin_layer_nr]));
-                }
-                downskin = downskin.difference(not_air); // skin overlaps with the walls
+                downskin = downskin.difference(not_air->getBelow(layer_nr)); // skin overlaps with the walls
             }
             
             if (layer_nr < static_cast<int>(mesh.layers.size()) - 1 - upSkinCount && upSkinCount > 0)
             {
-                Polygons not_air = getInsidePolygons(mesh.layers[layer_nr + 1]);
-                for (int upskin_layer_nr = layer_nr + 2; upskin_layer_nr < layer_nr + upSkinCount + 1; upskin_layer_nr++)
-                {
-                    not_air = not_air.intersection(getInsidePolygons(mesh.layers[upskin_layer_nr]));
-                }
-                upskin = upskin.difference(not_air); // skin overlaps with the walls
+                upskin = upskin.difference(not_air->getAbove(layer_nr)); // skin overlaps with the walls
             }
         }
         
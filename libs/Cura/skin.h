@@ -2,10 +2,82 @@
 #ifndef SKIN_H
 #define SKIN_H
 
+#include <memory> // shared_ptr
+
 #include "sliceDataStorage.h"
 
 namespace cura 
 {
+
+/*!
+ * The areas inside the walls on all layers of the bottom and top skin ranges of each layer of a mesh.
+ * 
+ * Wherever one of the layers in the range below (or above) a layer is air, that layer gets bottom (or top) skin.
+ * Intersecting all layers of a range for each layer separately takes a number of Clipper operations proportional to the skin thickness.
+ * Instead, the layers are divided into blocks of as many layers as a range,
+ * and for each layer the intersection from the start of its block up to it and from it up to the end of its block is computed.
+ * Every range covers the end of one block and the start of the next, so a single intersection gives the intersection of the whole range.
+ * Clipper rounds the vertices of every intersection, so the edges of the skin can be a few microns off from those of intersecting each range on its own.
+ */
+class SkinNotAir
+{
+public:
+    /*!
+     * Compute the intersections for all layers which get skin at once.
+     * 
+     * The walls should already be generated.
+     * 
+     * \param mesh The mesh with the walls
+     * \param downSkinCount The number of layers of bottom skin
+     * \param upSkinCount The number of layers of top skin
+     * \param wall_line_count The number of walls, i.e. the number of the wall from which to offset.
+     * \param skin_layer_count The number of layers from the bottom of the mesh for which skin is generated
+     */
+    SkinNotAir(const SliceMeshStorage& mesh, int downSkinCount, int upSkinCount, int wall_line_count, unsigned int skin_layer_count);
+
+    /*!
+     * The area inside the walls on all \p downSkinCount layers directly below a layer.
+     * 
+     * \param layer_nr The layer, which should be at least \p downSkinCount
+     */
+    Polygons getBelow(int layer_nr) const;
+
+    /*!
+     * The area inside the walls on all \p upSkinCount layers directly above a layer.
+     * 
+     * \param layer_nr The layer, which should have at least \p upSkinCount layers above it
+     */
+    Polygons getAbove(int layer_nr) const;
+
+private:
+    /*!
+     * The intersections within the blocks of a single range size.
+     */
+    struct BlockIntersections
+    {
+        int range_size;
+        std::vector<Polygons> up_to; //!< For each layer the intersection from the start of its block up to and including that layer
+        std::vector<Polygons> from; //!< For each layer the intersection from that layer to the end of its block
+
+        BlockIntersections(const std::vector<Polygons>& inside_areas, int range_size);
+
+        /*!
+         * Get the intersection of \ref BlockIntersections::range_size layers.
+         * 
+         * \param first_layer_nr The lowest layer of the range
+         */
+        Polygons getRange(int first_layer_nr) const;
+    };
+
+    std::shared_ptr<const BlockIntersections> below;
+    std::shared_ptr<const BlockIntersections> above; //!< The same intersections as \ref SkinNotAir::below when top and bottom skin are equally thick
+
+    /*!
+     * \param inside_areas The area inside the walls of each layer
+     */
+    SkinNotAir(const std::vector<Polygons>& inside_areas, int downSkinCount, int upSkinCount);
+};
+
 /*!
  * Generate the skin areas and its insets.
  * 
@@ -17,8 +89,9 @@ namespace cura
  * \param innermost_wall_line_width The line width of the inner most wall
  * \param insetCount The number of perimeters to surround the skin
  * \param no_small_gaps_heuristic A heuristic which assumes there will be no small gaps between bottom and top skin with a z size smaller than the skin size itself
+ * \param not_air The areas inside the walls on the skin ranges of all layers, only needed without \p no_small_gaps_heuristic
  */
-void generateSkins(int layerNr, SliceMeshStorage& mesh, int downSkinCount, int upSkinCount, int wall_line_count, int innermost_wall_line_width, int insetCount, bool no_small_gaps_heuristic);
+void generateSkins(int layerNr, SliceMeshStorage& mesh, int downSkinCount, int upSkinCount, int wall_line_count, int innermost_wall_line_width, int insetCount, bool no_small_gaps_heuristic, const SkinNotAir* not_air);
 
 /*!
  * Generate the skin areas (outlines)
@@ -35,8 +108,10 @@ void generateSkins(int layerNr, SliceMeshStorage& mesh, int downSkinCount, int u
  * \param no_small_gaps_heuristic A heuristic which assumes there will be no
  * small gaps between bottom and top skin with a z size smaller than the skin
  * size itself.
+ * \param not_air The areas inside the walls on the skin ranges of all layers,
+ * only needed without \p no_small_gaps_heuristic.
  */
-void generateSkinAreas(int layerNr, SliceMeshStorage& mesh, const int innermost_wall_line_width, int downSkinCount, int upSkinCount, int wall_line_count, bool no_small_gaps_heuristic);
+void generateSkinAreas(int layerNr, SliceMeshStorage& mesh, const int innermost_wall_line_width, int downSkinCount, int upSkinCount, int wall_line_count, bool no_small_gaps_heuristic, const SkinNotAir* not_air);
 
 /*!
  * Generate the skin insets.
@@ -6,6 +6,7 @@
 #include "utils/gettime.h"
 #include "utils/logoutput.h"
 #include "utils/SparsePointGridInclusive.h"
+#include "utils/ThreadPool.h"
 
 #include "slicer.h"
 
@@ -734,7 +735,7 @@ ClosePolygonResult SlicerLayer::findPolygonPointClosestTo(Point input)
     return ret;
 }
 
-void SlicerLayer::makePolygons(const Mesh* mesh, bool keep_none_closed, bool extensive_stitching)
+void SlicerLayer::makePolygons(const Mesh* mesh, bool keep_none_closed, bool extensive_stitching, bool stitch_open_polylines, int xy_offset)
 {
     Polygons open_polylines;
 
@@ -744,7 +745,7 @@ void SlicerLayer::makePolygons(const Mesh* mesh, bool keep_none_closed, bool ext
 
     // TODO: (?) for mesh surface mode: connect open polygons. Maybe the above algorithm can create two open polygons which are actually connected when the starting segment is in the middle between the two open polygons.
 
-    if (mesh->getSettingAsSurfaceMode("magic_mesh_surface_mode") == ESurfaceMode::NORMAL)
+    if (stitch_open_polylines)
     { // don't stitch when using (any) mesh surface mode, i.e. also don't stitch when using mixed mesh surface and closed polygons, because then polylines which are supposed to be open will be closed
         stitch(open_polylines);
     }
@@ -779,7 +780,6 @@ void SlicerLayer::makePolygons(const Mesh* mesh, bool keep_none_closed, bool ext
 
     polygons.removeDegenerateVerts(); // remove verts connected to overlapping line segments
 
-    int xy_offset = mesh->getSettingInMicrons("xy_offset");
     if (xy_offset != 0)
     {
         polygons = polygons.offset(xy_offset);
@@ -802,7 +802,53 @@ Slicer::Slicer(Mesh* mesh, int initial, int thickness, int slice_layer_count, bo
         layers[layer_nr].z = initial + thickness * layer_nr;
     }
 
-    for(unsigned int mesh_idx = 0; mesh_idx < mesh->faces.size(); mesh_idx++)
+    // Cut the faces in one contiguous range per thread, each range collecting its own segments
+    ThreadPool& thread_pool = ThreadPool::getInstance();
+    const unsigned int face_count = mesh->faces.size();
+    const unsigned int range_count = std::max(1U, std::min(thread_pool.getThreadCount(), face_count));
+    std::vector<FaceRangeSegments> range_segments(range_count);
+    thread_pool.parallel_for(0, range_count, [&](size_t range_idx)
+        {
+            const unsigned int face_begin = static_cast<uint64_t>(face_count) * range_idx / range_count;
+            const unsigned int face_end = static_cast<uint64_t>(face_count) * (range_idx + 1) / range_count;
+            sliceFaceRange(face_begin, face_end, initial, thickness, range_segments[range_idx]);
+        });
+    log("slice of mesh took %.3f seconds\n",slice_timer.restart());
+
+    const bool stitch_open_polylines = mesh->getSettingAsSurfaceMode("magic_mesh_surface_mode") == ESurfaceMode::NORMAL;
+    const int xy_offset = mesh->getSettingInMicrons("xy_offset");
+    thread_pool.parallel_for(0, layers.size(), [&](size_t layer_nr)
+        {
+            // Concatenating the ranges in order gives the same segment order as a serial pass over all faces
+            SlicerLayer& layer = layers[layer_nr];
+            size_t segment_count = 0;
+            for (const FaceRangeSegments& range : range_segments)
+            {
+                segment_count += range.layer_start[layer_nr + 1] - range.layer_start[layer_nr];
+            }
+            layer.segments.reserve(segment_count);
+            for (const FaceRangeSegments& range : range_segments)
+            {
+                for (size_t segment_idx = range.layer_start[layer_nr]; segment_idx < range.layer_start[layer_nr + 1]; segment_idx++)
+                {
+                    const SlicerSegment& segment = range.segments[segment_idx];
+                    layer.face_idx_to_segment_idx.insert(std::make_pair(segment.faceIndex, layer.segments.size()));
+                    layer.segments.push_back(segment);
+                }
+            }
+
+            layer.makePolygons(mesh, keep_none_closed, extensive_stitching, stitch_open_polylines, xy_offset);
+        });
+    mesh->expandXY(xy_offset);
+    log("slice make polygons took %.3f seconds\n",slice_timer.restart());
+}
+
+void Slicer::sliceFaceRange(unsigned int face_begin, unsigned int face_end, int initial, int thickness, FaceRangeSegments& result) const
+{
+    const int32_t layer_count = layers.size();
+    std::vector<std::pair<int32_t, SlicerSegment>> found; // the layer and segment of each cut, in face order
+
+    for(unsigned int mesh_idx = face_begin; mesh_idx < face_end; mesh_idx++)
     {
         const MeshFace& face = mesh->faces[mesh_idx];
         const MeshVertex& v0 = mesh->vertices[face.vertex_index[0]];
@@ -823,6 +869,7 @@ Slicer::Slicer(Mesh* mesh, int initial, int thickness, int slice_layer_count, bo
             int32_t z = layer_nr * thickness + initial;
             if (z < minZ) continue;
             if (layer_nr < 0) continue;
+            if (layer_nr >= layer_count) break;
 
             SlicerSegment s;
             s.endVertex = nullptr;
@@ -879,20 +926,29 @@ Slicer::Slicer(Mesh* mesh, int initial, int thickness, int slice_layer_count, bo
                 //  on the slice would create two segments
                 continue;
             }
-            layers[layer_nr].face_idx_to_segment_idx.insert(std::make_pair(mesh_idx, layers[layer_nr].segments.size()));
             s.faceIndex = mesh_idx;
             s.endOtherFaceIdx = face.connected_face_index[end_edge_idx];
             s.addedToPolygon = false;
-            layers[layer_nr].segments.push_back(s);
+            found.emplace_back(layer_nr, s);
         }
     }
-    log("slice of mesh took %.3f seconds\n",slice_timer.restart());
-    for(unsigned int layer_nr=0; layer_nr<layers.size(); layer_nr++)
+
+    // Stable counting sort by layer, which keeps the face order within each layer
+    result.layer_start.assign(layer_count + 1, 0);
+    for (const std::pair<int32_t, SlicerSegment>& layer_and_segment : found)
     {
-        layers[layer_nr].makePolygons(mesh, keep_none_closed, extensive_stitching);
+        result.layer_start[layer_and_segment.first + 1]++;
+    }
+    for (int32_t layer_nr = 0; layer_nr < layer_count; layer_nr++)
+    {
+        result.layer_start[layer_nr + 1] += result.layer_start[layer_nr];
+    }
+    std::vector<size_t> insert_idx(result.layer_start.begin(), result.layer_start.end() - 1);
+    result.segments.resize(found.size());
+    for (const std::pair<int32_t, SlicerSegment>& layer_and_segment : found)
+    {
+        result.segments[insert_idx[layer_and_segment.first]++] = layer_and_segment.second;
     }
-    mesh->expandXY(mesh->getSettingInMicrons("xy_offset"));
-    log("slice make polygons took %.3f seconds\n",slice_timer.restart());
 }
 
 }//namespace cura
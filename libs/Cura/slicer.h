@@ -59,8 +59,12 @@ public:
      * \param[in] mesh The mesh data for which we are connecting sliced segments (The face data is used)
      * \param keepNoneClosed Whether to throw away the data for segments which we couldn't stitch into a polygon
      * \param extensiveStitching Whether to perform extra work to try and close polylines into polygons when there are large gaps
+     * \param stitchOpenPolylines Whether to stitch open polylines at all, which is not done in any mesh surface mode
+     * \param xyOffset The offset to apply to the resulting polygons (xy_offset)
+     *
+     * The settings are passed in rather than read from \p mesh so that layers can be processed in parallel.
      */
-    void makePolygons(const Mesh* mesh, bool keepNoneClosed, bool extensiveStitching);
+    void makePolygons(const Mesh* mesh, bool keepNoneClosed, bool extensiveStitching, bool stitchOpenPolylines, int xyOffset);
 
 protected:
     /*!
@@ -519,6 +523,28 @@ public:
     }
 
     void dumpSegmentsToHTML(const char* filename);
+
+private:
+    /*!
+     * The segments cut from a contiguous range of faces by every layer,
+     * ordered by layer and within a layer by face index, i.e. in the order in which a serial pass over the faces finds them.
+     */
+    struct FaceRangeSegments
+    {
+        std::vector<SlicerSegment> segments;
+        std::vector<size_t> layer_start; //!< For each layer the index in \ref FaceRangeSegments::segments of its first segment, plus the total number of segments
+    };
+
+    /*!
+     * Cut the faces [\p face_begin, \p face_end) of the mesh by every layer.
+     *
+     * \param face_begin The first face of the range
+     * \param face_end One past the last face of the range
+     * \param initial The height of the first layer
+     * \param thickness The distance between layers
+     * \param[out] result The segments of the range
+     */
+    void sliceFaceRange(unsigned int face_begin, unsigned int face_end, int initial, int thickness, FaceRangeSegments& result) const;
 };
 
 }//namespace cura
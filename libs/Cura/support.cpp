@@ -1,12 +1,13 @@
 /** Copyright (C) 2013 David Braam - Released under terms of the AGPLv3 License */
+#include <cassert>
 #include <cmath> // sqrt
 #include <utility> // pair
-#include <deque>
 #include <cmath> // round
 
 #include "support.h"
 
 #include "utils/math.h"
+#include "utils/ThreadPool.h"
 #include "progress/Progress.h"
 
 namespace cura 
@@ -93,17 +94,19 @@ void AreaSupport::generateSupportAreas(SliceDataStorage& storage, unsigned int l
         }
     }
     
-    for (unsigned int layer_idx = 0; layer_idx < layer_count ; layer_idx++)
-    {
-        Polygons& support_areas = storage.support.supportLayers[layer_idx].supportAreas;
-        support_areas = support_areas.unionPolygons();
-    }
+    ThreadPool::getInstance().parallel_for(0, layer_count, [&](unsigned int layer_idx)
+        {
+            Polygons& support_areas = storage.support.supportLayers[layer_idx].supportAreas;
+            support_areas = support_areas.unionPolygons();
+        });
 }
 
 /* 
  * Algorithm:
- * From top layer to bottom layer:
+ * For all layers at once:
  * - find overhang by looking at the difference between two consucutive layers
+ * - compute the areas which are too close to the model in X/Y direction
+ * From top layer to bottom layer:
  * - join with support areas from layer above
  * - subtract current layer
  * - use the result for the next lower support layer (without doing XY-distance and Z bottom distance, so that a single support beam may move around the model a bit => more stability)
@@ -206,39 +209,82 @@ void AreaSupport::generateSupportAreas(SliceDataStorage& storage, unsigned int m
     std::vector<std::pair<int, std::vector<Polygons>>> overhang_points; // stores overhang_points along with the layer index at which the overhang point occurs
     AreaSupport::detectOverhangPoints(storage, mesh, overhang_points, layer_count, supportMinAreaSqrt);
 
-    std::deque<std::pair<Polygons, Polygons>> basic_and_full_overhang_above;
-    for (unsigned int layer_idx = support_layer_count - 1; layer_idx != support_layer_count - 1 - layerZdistanceTop ; layer_idx--)
+    ThreadPool& thread_pool = ThreadPool::getInstance();
+
+    // the overhang of each layer only depends on the model
+    std::vector<std::pair<Polygons, Polygons>> basic_and_full_overhang(support_layer_count);
+    std::vector<Polygons> layer_outlines(support_layer_count);
+    thread_pool.parallel_for(0, support_layer_count, [&](unsigned int layer_idx)
+        {
+            basic_and_full_overhang[layer_idx] = computeBasicAndFullOverhang(storage, mesh, layer_idx, max_dist_from_lower_layer);
+            layer_outlines[layer_idx] = storage.getLayerOutlines(layer_idx, false);
+        });
+
+    // the overhang which is supported on each layer, placed [layerZdistanceTop] layers below the overhang itself
+    const unsigned int overhang_layer_count = support_layer_count - layerZdistanceTop;
+    std::vector<Polygons> overhang_per_layer(overhang_layer_count);
+    thread_pool.parallel_for(0, overhang_layer_count, [&](unsigned int layer_idx)
+        {
+            Polygons& overhang = overhang_per_layer[layer_idx];
+            overhang = basic_and_full_overhang[layer_idx + layerZdistanceTop].second;
+            if (extension_offset)
+            {
+                overhang = overhang.offset(extension_offset);
+            }
+            if (supportMinAreaSqrt > 0)
+            {
+                // handle straight walls
+                AreaSupport::handleWallStruts(overhang, supportMinAreaSqrt, supportTowerDiameter);
+            }
+        });
+
+    // support only ends up below the highest overhang or tower
+    int highest_support_layer_idx = -1;
+    for (int layer_idx = overhang_layer_count - 1; layer_idx >= 0; layer_idx--)
     {
-        basic_and_full_overhang_above.push_front(computeBasicAndFullOverhang(storage, mesh, layer_idx, max_dist_from_lower_layer));
+        if (overhang_per_layer[layer_idx].size() > 0)
+        {
+            highest_support_layer_idx = layer_idx;
+            break;
+        }
+    }
+    if (supportMinAreaSqrt > 0 && !overhang_points.empty())
+    {
+        highest_support_layer_idx = std::max(highest_support_layer_idx, overhang_points.back().first - z_layer_distance_tower);
     }
+    highest_support_layer_idx = std::min(highest_support_layer_idx, int(overhang_layer_count) - 1);
 
+    // the areas too close to the model in X/Y direction
+    std::vector<Polygons> xy_disallowed_per_layer(overhang_layer_count);
+    thread_pool.parallel_for(0, highest_support_layer_idx + 1, [&](unsigned int layer_idx)
+        {
+            const Polygons& outlines = layer_outlines[layer_idx];
+            if (use_support_xy_distance_overhang)
+            {
+                const Polygons& basic_overhang = basic_and_full_overhang[layer_idx].first; // basic overhang on this layer
+                Polygons xy_overhang_disallowed = basic_overhang.offset(supportZDistanceTop * tanAngle);
+                Polygons xy_non_overhang_disallowed = outlines.difference(basic_overhang.offset(supportXYDistance)).offset(supportXYDistance);
+
+                xy_disallowed_per_layer[layer_idx] = xy_overhang_disallowed.unionPolygons(xy_non_overhang_disallowed.unionPolygons(outlines.offset(support_xy_distance_overhang)));
+            }
+            else
+            {
+                xy_disallowed_per_layer[layer_idx] = outlines.offset(supportXYDistance);
+            }
+        });
+
+    // propagating support downward is sequential
     bool still_in_upper_empty_layers = true;
     int overhang_points_pos = overhang_points.size() - 1;
     Polygons supportLayer_last;
     std::vector<Polygons> towerRoofs;
 
-    for (unsigned int layer_idx = support_layer_count - 1 - layerZdistanceTop; layer_idx != (unsigned int) -1 ; layer_idx--)
+    for (unsigned int layer_idx = overhang_layer_count - 1; layer_idx != (unsigned int) -1 ; layer_idx--)
     {
-        basic_and_full_overhang_above.push_front(computeBasicAndFullOverhang(storage, mesh, layer_idx, max_dist_from_lower_layer));
-        
-        Polygons overhang;
-        {
-            // compute basic overhang and put in right layer ([layerZdistanceTOp] layers below)
-            overhang = basic_and_full_overhang_above.back().second;
-            basic_and_full_overhang_above.pop_back();
-        }
-
-        Polygons& supportLayer_this = overhang; 
-
-        if (extension_offset)
-        {
-            supportLayer_this = supportLayer_this.offset(extension_offset);
-        }
+        Polygons& supportLayer_this = overhang_per_layer[layer_idx];
 
         if (supportMinAreaSqrt > 0)
         {
-            // handle straight walls
-            AreaSupport::handleWallStruts(supportLayer_this, supportMinAreaSqrt, supportTowerDiameter);
             // handle towers
             AreaSupport::handleTowers(supportLayer_this, towerRoofs, overhang_points, overhang_points_pos, layer_idx, towerRoofExpansionDistance, supportTowerDiameter, supportMinAreaSqrt, layer_count, z_layer_distance_tower);
         }
@@ -254,7 +300,7 @@ void AreaSupport::generateSupportAreas(SliceDataStorage& storage, unsigned int m
         {
             int stepHeight = support_bottom_stair_step_height / supportLayerThickness + 1;
             int bottomLayer = ((layer_idx - layerZdistanceBottom) / stepHeight) * stepHeight;
-            supportLayer_this = supportLayer_this.difference(storage.getLayerOutlines(bottomLayer, false));
+            supportLayer_this = supportLayer_this.difference(layer_outlines[bottomLayer]);
         }
         
         
@@ -264,21 +310,8 @@ void AreaSupport::generateSupportAreas(SliceDataStorage& storage, unsigned int m
         // inset using X/Y distance
         if (supportLayer_this.size() > 0)
         {
-            Polygons& basic_overhang = basic_and_full_overhang_above.front().first; // basic overhang on this layer
-            Polygons outlines = storage.getLayerOutlines(layer_idx, false);
-
-            if (use_support_xy_distance_overhang)
-            {
-                Polygons xy_overhang_disallowed = basic_overhang.offset(supportZDistanceTop * tanAngle);
-                Polygons xy_non_overhang_disallowed = outlines.difference(basic_overhang.offset(supportXYDistance)).offset(supportXYDistance);
-
-                Polygons xy_disallowed = xy_overhang_disallowed.unionPolygons(xy_non_overhang_disallowed.unionPolygons(outlines.offset(support_xy_distance_overhang)));
-                supportLayer_this = supportLayer_this.difference(xy_disallowed);
-            }
-            else
-            {
-                supportLayer_this = supportLayer_this.difference(storage.getLayerOutlines(layer_idx, false).offset(supportXYDistance));
-            }
+            assert(int(layer_idx) <= highest_support_layer_idx && "The X/Y distance must have been computed for all layers with support.");
+            supportLayer_this = supportLayer_this.difference(xy_disallowed_per_layer[layer_idx]);
         }
 
         supportAreas[layer_idx] = supportLayer_this;
@@ -372,33 +405,35 @@ void AreaSupport::detectOverhangPoints(
 {
     ExtruderTrain* infill_extr = storage.meshgroup->getExtruderTrain(storage.getSettingAsIndex("support_infill_extruder_nr"));
     const unsigned int support_line_width = infill_extr->getSettingInMicrons("support_line_width");
-    for (int layer_idx = 0; layer_idx < layer_count; layer_idx++)
-    {
-        SliceLayer& layer = mesh.layers[layer_idx];
-        for (SliceLayerPart& part : layer.parts)
+    std::vector<std::vector<Polygons>> small_part_polys_per_layer(std::max(layer_count, 0));
+    ThreadPool::getInstance().parallel_for(0, small_part_polys_per_layer.size(), [&](unsigned int layer_idx)
         {
-            if (part.outline.outerPolygon().area() < supportMinAreaSqrt * supportMinAreaSqrt) 
+            SliceLayer& layer = mesh.layers[layer_idx];
+            for (SliceLayerPart& part : layer.parts)
             {
-                Polygons part_poly_computed;
-                Polygons& part_poly = (part.insets.size() > 0) ? part.insets[0] : part_poly_computed; // don't copy inset if its already computed
-                if (part.insets.size() == 0)
-                {
-                    part_poly_computed = part.outline.offset(-support_line_width / 2);
-                }
-                
-                if (part_poly.size() > 0)
+                if (part.outline.outerPolygon().area() < supportMinAreaSqrt * supportMinAreaSqrt) 
                 {
-                    if (overhang_points.size() > 0 && overhang_points.back().first == layer_idx)
-                        overhang_points.back().second.push_back(part_poly);
-                    else 
+                    Polygons part_poly_computed;
+                    Polygons& part_poly = (part.insets.size() > 0) ? part.insets[0] : part_poly_computed; // don't copy inset if its already computed
+                    if (part.insets.size() == 0)
                     {
-                        std::vector<Polygons> small_part_polys;
-                        small_part_polys.push_back(part_poly);
-                        overhang_points.emplace_back<std::pair<int, std::vector<Polygons>>>(std::make_pair(layer_idx, small_part_polys));
+                        part_poly_computed = part.outline.offset(-support_line_width / 2);
                     }
+                    
+                    if (part_poly.size() > 0)
+                    {
+                        small_part_polys_per_layer[layer_idx].push_back(part_poly);
+                    }
+                    
                 }
-                
             }
+        });
+    for (int layer_idx = 0; layer_idx < layer_count; layer_idx++)
+    {
+        std::vector<Polygons>& small_part_polys = small_part_polys_per_layer[layer_idx];
+        if (!small_part_polys.empty())
+        {
+            overhang_points.emplace_back(layer_idx, std::move(small_part_polys));
         }
     }
 }
@@ -418,6 +453,7 @@ void AreaSupport::handleTowers(
     int z_layer_distance_tower
 )
 {
+    PolygonsBatch batch; // the towers are many small polygons
     // handle new tower roof tops
     int layer_overhang_point =  layer_idx + z_layer_distance_tower;
     if (overhang_points_pos >= 0 && layer_overhang_point < layer_count && 
@@ -432,7 +468,7 @@ void AreaSupport::handleTowers(
                 {
                     for (Polygons& poly_below : overhang_points_below)
                     {
-                        poly_here = poly_here.difference(poly_below.offset(supportMinAreaSqrt*2));
+                        poly_here = batch.difference(poly_here, batch.offset(poly_below, supportMinAreaSqrt*2));
                     }
                 }
             }
@@ -447,12 +483,12 @@ void AreaSupport::handleTowers(
     //for (Polygons& tower_roof : towerRoofs)
     for (unsigned int r = 0; r < towerRoofs.size(); r++)
     {
-        supportLayer_this = supportLayer_this.unionPolygons(towerRoofs[r]);
+        supportLayer_this = batch.unionPolygons(supportLayer_this, towerRoofs[r]);
         
         Polygons& tower_roof = towerRoofs[r];
         if (tower_roof.size() > 0 && tower_roof[0].area() < supportTowerDiameter * supportTowerDiameter)
         {
-            towerRoofs[r] = tower_roof.offset(towerRoofExpansionDistance);
+            towerRoofs[r] = batch.offset(tower_roof, towerRoofExpansionDistance);
         }
     }
 }
@@ -516,51 +552,52 @@ void AreaSupport::generateSupportInterface(SliceDataStorage& storage, const Slic
     const int interface_line_width = storage.meshgroup->getExtruderTrain(storage.getSettingAsIndex("support_interface_extruder_nr"))->getSettingInMicrons("support_interface_line_width");
 
     std::vector<SupportLayer>& supportLayers = storage.support.supportLayers;
-    for (unsigned int layer_idx = 0; layer_idx < layer_count; layer_idx++)
-    {
-        SupportLayer& layer = supportLayers[layer_idx];
-
-        const unsigned int top_layer_idx_above = layer_idx + roof_layer_count + z_distance_top;
-        const unsigned int bottom_layer_idx_below = std::max(0, int(layer_idx) - int(bottom_layer_count) - int(z_distance_bottom));
-        if (top_layer_idx_above < supportLayers.size())
+    // every layer only reads the model and its own support areas
+    ThreadPool::getInstance().parallel_for(0, layer_count, [&](unsigned int layer_idx)
         {
-            Polygons roofs;
-            if (roof_layer_count > 0)
+            SupportLayer& layer = supportLayers[layer_idx];
+
+            const unsigned int top_layer_idx_above = layer_idx + roof_layer_count + z_distance_top;
+            const unsigned int bottom_layer_idx_below = std::max(0, int(layer_idx) - int(bottom_layer_count) - int(z_distance_bottom));
+            if (top_layer_idx_above < supportLayers.size())
             {
-                Polygons model;
-                const unsigned int n_scans = std::max(1u, (roof_layer_count - 1) / skip_layer_count);
-                const float z_skip = std::max(1.0f, float(roof_layer_count - 1) / float(n_scans));
-                for (float layer_idx_above = top_layer_idx_above; layer_idx_above > layer_idx + z_distance_top; layer_idx_above -= z_skip)
+                Polygons roofs;
+                if (roof_layer_count > 0)
                 {
-                    const Polygons outlines_above = mesh.layers[std::round(layer_idx_above)].getOutlines();
-                    model = model.unionPolygons(outlines_above);
+                    Polygons model;
+                    const unsigned int n_scans = std::max(1u, (roof_layer_count - 1) / skip_layer_count);
+                    const float z_skip = std::max(1.0f, float(roof_layer_count - 1) / float(n_scans));
+                    for (float layer_idx_above = top_layer_idx_above; layer_idx_above > layer_idx + z_distance_top; layer_idx_above -= z_skip)
+                    {
+                        const Polygons outlines_above = mesh.layers[std::round(layer_idx_above)].getOutlines();
+                        model = model.unionPolygons(outlines_above);
+                    }
+                    roofs = support_areas[layer_idx].intersection(model);
                 }
-                roofs = support_areas[layer_idx].intersection(model);
-            }
-            Polygons bottoms;
-            if (bottom_layer_count > 0)
-            {
-                Polygons model;
-                const unsigned int n_scans = std::max(1u, (bottom_layer_count - 1) / skip_layer_count);
-                const float z_skip = std::max(1.0f, float(bottom_layer_count - 1) / float(n_scans));
-                for (float layer_idx_below = bottom_layer_idx_below; std::round(layer_idx_below) < (int)(layer_idx - z_distance_bottom); layer_idx_below += z_skip)
+                Polygons bottoms;
+                if (bottom_layer_count > 0)
                 {
-                    const Polygons outlines_below = mesh.layers[std::round(layer_idx_below)].getOutlines();
-                    model = model.unionPolygons(outlines_below);
+                    Polygons model;
+                    const unsigned int n_scans = std::max(1u, (bottom_layer_count - 1) / skip_layer_count);
+                    const float z_skip = std::max(1.0f, float(bottom_layer_count - 1) / float(n_scans));
+                    for (float layer_idx_below = bottom_layer_idx_below; std::round(layer_idx_below) < (int)(layer_idx - z_distance_bottom); layer_idx_below += z_skip)
+                    {
+                        const Polygons outlines_below = mesh.layers[std::round(layer_idx_below)].getOutlines();
+                        model = model.unionPolygons(outlines_below);
+                    }
+                    bottoms = support_areas[layer_idx].intersection(model);
                 }
-                bottoms = support_areas[layer_idx].intersection(model);
+                // expand skin a bit so that we're sure it's not too thin to be printed.
+                Polygons skin = roofs.unionPolygons(bottoms).offset(interface_line_width).intersection(support_areas[layer_idx]);
+                skin.removeSmallAreas(1.0);
+                layer.skin.add(skin);
+                layer.supportAreas.add(support_areas[layer_idx].difference(layer.skin));
             }
-            // expand skin a bit so that we're sure it's not too thin to be printed.
-            Polygons skin = roofs.unionPolygons(bottoms).offset(interface_line_width).intersection(support_areas[layer_idx]);
-            skin.removeSmallAreas(1.0);
-            layer.skin.add(skin);
-            layer.supportAreas.add(support_areas[layer_idx].difference(layer.skin));
-        }
-        else 
-        {
-            layer.skin.add(support_areas[layer_idx]);
-        }
-    }
+            else 
+            {
+                layer.skin.add(support_areas[layer_idx]);
+            }
+        });
 }
 
 
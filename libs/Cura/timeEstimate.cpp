@@ -12,6 +12,9 @@ namespace cura
 
 #define MINIMUM_PLANNER_SPEED 0.05// (mm/sec)
 
+constexpr unsigned int TimeEstimateCalculator::lookahead_size;
+constexpr unsigned int TimeEstimateCalculator::finalize_batch_size;
+
 void TimeEstimateCalculator::setFirmwareDefaults(const SettingsBaseVirtual* settings_base)
 {
     max_feedrate[X_AXIS] = settings_base->getSettingInMillimetersPerSecond("machine_max_feedrate_x");
@@ -59,6 +62,31 @@ void TimeEstimateCalculator::reset()
 {
     extra_time = 0.0;
     blocks.clear();
+    final_count = 0;
+    has_previous_block = false;
+    finalized_time = 0.0;
+}
+
+double TimeEstimateCalculator::getRunningTime() const
+{
+    return extra_time + finalized_time;
+}
+
+void TimeEstimateCalculator::TrapezoidBatch::resize(unsigned int new_size)
+{
+    size = new_size;
+    if (size <= nominal_feedrate.size())
+    { // the arrays only grow, so that they aren't resized for every batch
+        return;
+    }
+    nominal_feedrate.resize(size);
+    acceleration.resize(size);
+    distance.resize(size);
+    entry_factor.resize(size);
+    exit_factor.resize(size);
+    acceleration_time.resize(size);
+    plateau_time.resize(size);
+    deceleration_time.resize(size);
 }
 
 // Calculates the maximum allowable speed at this point when you must be able to reach target_velocity using the 
@@ -69,10 +97,8 @@ static inline double max_allowable_speed(double acceleration, double target_velo
 }
 
 // Calculates the distance (not time) it takes to accelerate from initial_rate to target_rate using the given acceleration:
-static inline float estimate_acceleration_distance(float initial_rate, float target_rate, float acceleration)
+static inline double estimate_acceleration_distance(double initial_rate, double target_rate, double acceleration)
 {
-    if (acceleration == 0)
-        return 0.0;
     return (square(target_rate)-square(initial_rate)) / (2.0*acceleration);
 }
 
@@ -82,8 +108,6 @@ static inline float estimate_acceleration_distance(float initial_rate, float tar
 // deceleration in the cases where the trapezoid has no plateau (i.e. never reaches maximum speed)
 static inline double intersection_distance(double initial_rate, double final_rate, double acceleration, double distance) 
 {
-    if (acceleration == 0.0)
-        return 0.0;
     return (2.0*acceleration*distance-square(initial_rate)+square(final_rate)) / (4.0*acceleration);
 }
 
@@ -97,35 +121,49 @@ static inline double acceleration_time_from_distance(double initial_feedrate, do
     return (-initial_feedrate + sqrt(discriminant)) / acceleration;
 }
     
-// Calculates trapezoid parameters so that the entry- and exit-speed is compensated by the provided factors.
-void TimeEstimateCalculator::calculate_trapezoid_for_block(Block *block, double entry_factor, double exit_factor)
+// Calculates trapezoid parameters so that the entry- and exit-speed is compensated by the provided factors, and the time spent accelerating, cruising and decelerating.
+// The helpers above don't branch on the acceleration, since every block has a positive acceleration.
+// The arrays are restricted parameters, so that the compiler knows that storing the times doesn't change the speeds without checking it at runtime.
+static void trapezoid_times(const unsigned int size, const double* __restrict nominal_feedrates, const double* __restrict accelerations, const double* __restrict distances, const double* __restrict entry_factors, const double* __restrict exit_factors, double* __restrict acceleration_times, double* __restrict plateau_times, double* __restrict deceleration_times)
 {
-    double initial_feedrate = block->nominal_feedrate*entry_factor;
-    double final_feedrate = block->nominal_feedrate*exit_factor;
-
-    double acceleration = block->acceleration;
-    double accelerate_distance = estimate_acceleration_distance(initial_feedrate, block->nominal_feedrate, acceleration);
-    double decelerate_distance = estimate_acceleration_distance(block->nominal_feedrate, final_feedrate, -acceleration);
-
-    // Calculate the size of Plateau of Nominal Rate.
-    double plateau_distance = block->distance-accelerate_distance - decelerate_distance;
-
-    // Is the Plateau of Nominal Rate smaller than nothing? That means no cruising, and we will
-    // have to use intersection_distance() to calculate when to abort acceleration and start braking
-    // in order to reach the final_rate exactly at the end of this block.
-    if (plateau_distance < 0)
+    for (unsigned int n = 0; n < size; n++)
     {
-        accelerate_distance = intersection_distance(initial_feedrate, final_feedrate, acceleration, block->distance);
-        accelerate_distance = std::max(accelerate_distance, 0.0); // Check limits due to numerical round-off
-        accelerate_distance = std::min(accelerate_distance, block->distance);//(We can cast here to unsigned, because the above line ensures that we are above zero)
-        plateau_distance = 0;
+        double nominal_feedrate = nominal_feedrates[n];
+        double initial_feedrate = nominal_feedrate * entry_factors[n];
+        double final_feedrate = nominal_feedrate * exit_factors[n];
+
+        double acceleration = accelerations[n];
+        double distance = distances[n];
+        double accelerate_distance = estimate_acceleration_distance(initial_feedrate, nominal_feedrate, acceleration);
+        double decelerate_distance = estimate_acceleration_distance(nominal_feedrate, final_feedrate, -acceleration);
+
+        // Calculate the size of Plateau of Nominal Rate.
+        double plateau_distance = distance - accelerate_distance - decelerate_distance;
+
+        // Is the Plateau of Nominal Rate smaller than nothing? That means no cruising, and we will
+        // have to use intersection_distance() to calculate when to abort acceleration and start braking
+        // in order to reach the final_rate exactly at the end of this block.
+        double intersection_accelerate_distance = intersection_distance(initial_feedrate, final_feedrate, acceleration, distance);
+        intersection_accelerate_distance = std::max(intersection_accelerate_distance, 0.0); // Check limits due to numerical round-off
+        intersection_accelerate_distance = std::min(intersection_accelerate_distance, distance);
+        const bool has_plateau = plateau_distance >= 0;
+        accelerate_distance = has_plateau ? accelerate_distance : intersection_accelerate_distance;
+        plateau_distance = has_plateau ? plateau_distance : 0;
+
+        double accelerate_until = accelerate_distance;
+        double decelerate_after = accelerate_distance + plateau_distance;
+
+        acceleration_times[n] = acceleration_time_from_distance(initial_feedrate, accelerate_until, acceleration);
+        plateau_times[n] = (decelerate_after - accelerate_until) / nominal_feedrate;
+        deceleration_times[n] = acceleration_time_from_distance(final_feedrate, (distance - decelerate_after), acceleration);
     }
+}
 
-    block->accelerate_until = accelerate_distance;
-    block->decelerate_after = accelerate_distance+plateau_distance;
-    block->initial_feedrate = initial_feedrate;
-    block->final_feedrate = final_feedrate;
-}                    
+void TimeEstimateCalculator::calculate_trapezoid_times()
+{
+    TrapezoidBatch& batch = trapezoid_batch;
+    trapezoid_times(batch.size, batch.nominal_feedrate.data(), batch.acceleration.data(), batch.distance.data(), batch.entry_factor.data(), batch.exit_factor.data(), batch.acceleration_time.data(), batch.plateau_time.data(), batch.deceleration_time.data());
+}
 
 void TimeEstimateCalculator::plan(Position newPos, double feedrate)
 {
@@ -184,9 +222,8 @@ void TimeEstimateCalculator::plan(Position newPos, double feedrate)
     if(current_abs_feedrate[E_AXIS] > max_e_jerk/2)
         vmax_junction = std::min(vmax_junction, max_e_jerk/2);
     vmax_junction = std::min(vmax_junction, block.nominal_feedrate);
-    double safe_speed = vmax_junction;
     
-    if ((blocks.size() > 0) && (previous_nominal_feedrate > 0.0001))
+    if ((blocks.size() > 0 || has_previous_block) && (previous_nominal_feedrate > 0.0001))
     {
         double xy_jerk = sqrt(square(current_feedrate[X_AXIS]-previous_feedrate[X_AXIS])+square(current_feedrate[Y_AXIS]-previous_feedrate[Y_AXIS]));
         vmax_junction = block.nominal_feedrate;
@@ -207,35 +244,75 @@ void TimeEstimateCalculator::plan(Position newPos, double feedrate)
     double v_allowable = max_allowable_speed(-block.acceleration, MINIMUM_PLANNER_SPEED, block.distance);
     block.entry_speed = std::min(vmax_junction, v_allowable);
     block.nominal_length_flag = block.nominal_feedrate <= v_allowable;
-    block.recalculate_flag = true; // Always calculate trapezoid for new block
 
     previous_feedrate = current_feedrate;
     previous_nominal_feedrate = block.nominal_feedrate;
 
     currentPosition = newPos;
 
-    calculate_trapezoid_for_block(&block, block.entry_speed/block.nominal_feedrate, safe_speed/block.nominal_feedrate);
-    
     blocks.push_back(block);
+
+    // A block which can always reach its maximum entry speed ends the reverse pass, whatever follows it,
+    // so the blocks before it are final once it has a next block.
+    if (blocks.size() >= 2)
+    {
+        const Block& before_new = blocks[blocks.size() - 2];
+        if (before_new.nominal_length_flag || before_new.entry_speed == before_new.max_entry_speed)
+        {
+            final_count = blocks.size() - 2;
+        }
+    }
+    if (final_count >= finalize_batch_size)
+    {
+        finalizeBlocks(final_count);
+    }
+    else if (blocks.size() >= lookahead_size)
+    {
+        finalizeBlocks(std::max(final_count, static_cast<unsigned int>(blocks.size() / 2)));
+    }
 }
 
 double TimeEstimateCalculator::calculate()
 {
+    finalizeBlocks(blocks.size());
+    return extra_time + finalized_time;
+}
+
+void TimeEstimateCalculator::finalizeBlocks(unsigned int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
     reverse_pass();
-    forward_pass();
-    recalculate_trapezoids();
-    
-    double totalTime = extra_time;
-    for(unsigned int n=0; n<blocks.size(); n++)
+    forward_pass(count);
+
+    trapezoid_batch.resize(count);
+    for (unsigned int n = 0; n < count; n++)
     {
-        Block& block = blocks[n];
-        double plateau_distance = block.decelerate_after - block.accelerate_until;
-        
-        totalTime += acceleration_time_from_distance(block.initial_feedrate, block.accelerate_until, block.acceleration);
-        totalTime += plateau_distance / block.nominal_feedrate;
-        totalTime += acceleration_time_from_distance(block.final_feedrate, (block.distance - block.decelerate_after), block.acceleration);
+        const Block& block = blocks[n];
+        // Last/newest block in buffer. Exit speed is set with MINIMUM_PLANNER_SPEED.
+        const double exit_speed = (n + 1 < blocks.size()) ? blocks[n + 1].entry_speed : MINIMUM_PLANNER_SPEED;
+        // NOTE: Entry and exit factors always > 0 by all previous logic operations.
+        trapezoid_batch.nominal_feedrate[n] = block.nominal_feedrate;
+        trapezoid_batch.acceleration[n] = block.acceleration;
+        trapezoid_batch.distance[n] = block.distance;
+        trapezoid_batch.entry_factor[n] = block.entry_speed / block.nominal_feedrate;
+        trapezoid_batch.exit_factor[n] = exit_speed / block.nominal_feedrate;
     }
-    return totalTime;
+    calculate_trapezoid_times();
+    for (unsigned int n = 0; n < count; n++)
+    { // summed in order, so that the total doesn't depend on how the blocks are split into batches
+        finalized_time += trapezoid_batch.acceleration_time[n];
+        finalized_time += trapezoid_batch.plateau_time[n];
+        finalized_time += trapezoid_batch.deceleration_time[n];
+    }
+
+    previous_block = blocks[count - 1];
+    has_previous_block = true;
+    // The first block staying in the window keeps the entry speed with which the last finalized block ends, as the reverse pass doesn't change the first block.
+    blocks.erase(blocks.begin(), blocks.begin() + count);
+    final_count = 0;
 }
 
 // The kernel called by accelerationPlanner::calculate() when scanning the plan from last to first entry.
@@ -258,7 +335,6 @@ void TimeEstimateCalculator::planner_reverse_pass_kernel(Block *previous, Block
         } else {
             current->entry_speed = current->max_entry_speed;
         }
-        current->recalculate_flag = true;
     }
 }
 
@@ -295,53 +371,19 @@ void TimeEstimateCalculator::planner_forward_pass_kernel(Block *previous, Block
             if (current->entry_speed != entry_speed)
             {
                 current->entry_speed = entry_speed;
-                current->recalculate_flag = true;
             }
         }
     }
 }
 
-void TimeEstimateCalculator::forward_pass()
-{
-    Block* block[3] = {nullptr, nullptr, nullptr};
-    for(unsigned int n=0; n<blocks.size(); n++)
-    {
-        block[0]= block[1];
-        block[1]= block[2];
-        block[2] = &blocks[n];
-        planner_forward_pass_kernel(block[0], block[1], block[2]);
-    }
-    planner_forward_pass_kernel(block[1], block[2], nullptr);
-}
-
-// Recalculates the trapezoid speed profiles for all blocks in the plan according to the 
-// entry_factor for each junction. Must be called by planner_recalculate() after 
-// updating the blocks.
-void TimeEstimateCalculator::recalculate_trapezoids()
+void TimeEstimateCalculator::forward_pass(unsigned int count)
 {
-    Block *current;
-    Block *next = nullptr;
-
-    for(unsigned int n=0; n<blocks.size(); n++)
-    {
-        current = next;
-        next = &blocks[n];
-        if (current)
-        {
-            // Recalculate if current block entry or exit junction speed has changed.
-            if (current->recalculate_flag || next->recalculate_flag)
-            {
-                // NOTE: Entry and exit factors always > 0 by all previous logic operations.
-                calculate_trapezoid_for_block(current, current->entry_speed/current->nominal_feedrate, next->entry_speed/current->nominal_feedrate);
-                current->recalculate_flag = false; // Reset current only to ensure next trapezoid is computed
-            }
-        }
-    }
-    // Last/newest block in buffer. Exit speed is set with MINIMUM_PLANNER_SPEED. Always recalculated.
-    if(next != nullptr)
+    Block* previous = has_previous_block ? &previous_block : nullptr;
+    const unsigned int end = std::min(count + 1, static_cast<unsigned int>(blocks.size()));
+    for(unsigned int n=0; n<end; n++)
     {
-        calculate_trapezoid_for_block(next, next->entry_speed/next->nominal_feedrate, MINIMUM_PLANNER_SPEED/next->nominal_feedrate);
-        next->recalculate_flag = false;
+        planner_forward_pass_kernel(previous, &blocks[n], nullptr);
+        previous = &blocks[n];
     }
 }
 
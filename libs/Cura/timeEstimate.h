@@ -12,6 +12,11 @@ class SettingsBaseVirtual;
 /*!
  *  The TimeEstimateCalculator class generates a estimate of printing time calculated with acceleration in mind.
  *  Some of this code has been adapted from the Marlin sources.
+ *
+ *  Like the planner of a firmware, only a limited number of planned moves is kept to look ahead at.
+ *  The speeds of the oldest moves are fixed and their time is added to the total once later moves can't change them any more,
+ *  i.e. after a move which can always reach its maximum entry speed and has a next move, in batches of at least \ref TimeEstimateCalculator::finalize_batch_size moves,
+ *  or else when the lookahead window is full.
  */
 
 class TimeEstimateCalculator
@@ -37,13 +42,6 @@ public:
     class Block
     {
     public:
-        bool recalculate_flag;
-        
-        double accelerate_until;
-        double decelerate_after;
-        double initial_feedrate;
-        double final_feedrate;
-
         double entry_speed;
         double max_entry_speed;
         bool nominal_length_flag;
@@ -56,7 +54,39 @@ public:
         Position absDelta;
     };
 
+    /*!
+     * The maximum number of planned blocks of which the speeds may still change.
+     * When the window is full, the speeds of its older half are fixed assuming that the newest block ends at standstill.
+     */
+    static constexpr unsigned int lookahead_size = 256;
+
 private:
+    /*!
+     * The number of blocks of which the speeds are final that are collected before they leave the lookahead window,
+     * so that the planner passes and the trapezoids run once for the batch rather than once per planned block.
+     */
+    static constexpr unsigned int finalize_batch_size = 64;
+
+    /*!
+     * The speeds of a number of blocks which leave the lookahead window, as separate arrays,
+     * so that the trapezoids of all of them are computed in a single loop without branches or aliasing.
+     * GCC vectorizes that loop at -O3 when sqrt doesn't have to set errno, i.e. with -fno-math-errno.
+     */
+    struct TrapezoidBatch
+    {
+        unsigned int size = 0; //!< The number of blocks in the batch, which may be less than the size of the arrays
+        std::vector<double> nominal_feedrate;
+        std::vector<double> acceleration;
+        std::vector<double> distance;
+        std::vector<double> entry_factor; //!< The entry speed as a factor of the nominal feedrate
+        std::vector<double> exit_factor; //!< The exit speed as a factor of the nominal feedrate
+        std::vector<double> acceleration_time;
+        std::vector<double> plateau_time;
+        std::vector<double> deceleration_time;
+
+        void resize(unsigned int new_size); //!< Set the number of blocks in the batch, only growing the arrays
+    };
+
     double max_feedrate[NUM_AXIS] = {600, 600, 40, 25};
     double minimumfeedrate = 0.01;
     double acceleration = 3000;
@@ -71,7 +101,12 @@ private:
 
     Position currentPosition;
 
-    std::vector<Block> blocks;
+    std::vector<Block> blocks; //!< The lookahead window: the planned blocks of which the speeds may still change. The first one has the entry speed with which the last finalized block ends.
+    unsigned int final_count = 0; //!< The number of oldest blocks in the lookahead window of which the speeds can't change any more
+    Block previous_block; //!< The last block which left the lookahead window, with its final entry speed
+    bool has_previous_block = false; //!< Whether a block has left the lookahead window since the last reset
+    double finalized_time = 0.0; //!< The time of the blocks which left the lookahead window since the last reset
+    TrapezoidBatch trapezoid_batch; //!< Reused for every batch of blocks leaving the lookahead window
 public:
     /*!
      * Set the movement configuration of the firmware.
@@ -87,14 +122,37 @@ public:
     void setMaxZFeedrate(double max_z_feedrate); //!< Set the maximal feedrate in the z direction to \p max_z_feedrate
 
     void reset();
-    
+
+    /*!
+     * Fix the speeds of all planned blocks, ending at standstill, and get the total time since the last reset.
+     */
     double calculate();
+
+    /*!
+     * Get the time of the blocks which have left the lookahead window and the added time since the last reset.
+     *
+     * The at most \ref TimeEstimateCalculator::lookahead_size blocks still in the window are not included until \ref TimeEstimateCalculator::calculate is called.
+     */
+    double getRunningTime() const;
 private:
+    /*!
+     * Fix the speeds of the oldest blocks in the lookahead window, add their time to \ref TimeEstimateCalculator::finalized_time and remove them from the window.
+     *
+     * The speeds are exact if a later block in the window has a next block and can always reach its maximum entry speed,
+     * or if \p count is the number of blocks in the window and the last one ends at standstill.
+     *
+     * \param count The number of blocks to remove from the window
+     */
+    void finalizeBlocks(unsigned int count);
+
     void reverse_pass();
-    void forward_pass();
-    void recalculate_trapezoids();
-    
-    void calculate_trapezoid_for_block(Block *block, double entry_factor, double exit_factor);
+    void forward_pass(unsigned int count); //!< Run the forward pass over the first \p count blocks of the window and the block after them
+
+    /*!
+     * Compute the trapezoid of each block in \ref TimeEstimateCalculator::trapezoid_batch and the time spent in each of its phases.
+     */
+    void calculate_trapezoid_times();
+
     void planner_reverse_pass_kernel(Block *previous, Block *current, Block *next);
     void planner_forward_pass_kernel(Block *previous, Block *current, Block *next);
 };
@@ -0,0 +1,54 @@
+/** Copyright (C) 2017 Ultimaker - Released under terms of the AGPLv3 License */
+#include "ClipperPool.h"
+
+#include <vector>
+
+namespace cura
+{
+
+namespace
+{
+thread_local std::vector<std::unique_ptr<ClipperLib::Clipper>> free_clippers; //!< The engines of this thread which aren't leased
+thread_local std::vector<std::unique_ptr<ClipperLib::ClipperOffset>> free_offsetters; //!< The offset engines of this thread which aren't leased
+}//anonymous namespace
+
+PooledClipper::PooledClipper(int init_options)
+{
+    if (free_clippers.empty())
+    {
+        clipper.reset(new ClipperLib::Clipper(init_options));
+        return;
+    }
+    clipper = std::move(free_clippers.back());
+    free_clippers.pop_back();
+    clipper->ReverseSolution((init_options & ClipperLib::ioReverseSolution) != 0);
+    clipper->StrictlySimple((init_options & ClipperLib::ioStrictlySimple) != 0);
+    clipper->PreserveCollinear((init_options & ClipperLib::ioPreserveCollinear) != 0);
+}
+
+PooledClipper::~PooledClipper()
+{
+    clipper->Clear();
+    free_clippers.push_back(std::move(clipper));
+}
+
+PooledClipperOffset::PooledClipperOffset(double miter_limit, double arc_tolerance)
+{
+    if (free_offsetters.empty())
+    {
+        offsetter.reset(new ClipperLib::ClipperOffset(miter_limit, arc_tolerance));
+        return;
+    }
+    offsetter = std::move(free_offsetters.back());
+    free_offsetters.pop_back();
+    offsetter->MiterLimit = miter_limit;
+    offsetter->ArcTolerance = arc_tolerance;
+}
+
+PooledClipperOffset::~PooledClipperOffset()
+{
+    offsetter->Clear();
+    free_offsetters.push_back(std::move(offsetter));
+}
+
+}//namespace cura
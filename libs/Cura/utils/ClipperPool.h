@@ -0,0 +1,71 @@
+/** Copyright (C) 2017 Ultimaker - Released under terms of the AGPLv3 License */
+#ifndef UTILS_CLIPPER_POOL_H
+#define UTILS_CLIPPER_POOL_H
+
+#include <memory> // unique_ptr
+
+#include "../../clipper/clipper.hpp"
+#include "NoCopy.h"
+
+namespace cura
+{
+
+/*!
+ * A Clipper engine leased from a pool of the current thread for the lifetime of this object.
+ *
+ * The engines keep the memory of their edges, output points and internal vectors between operations,
+ * so that the many boolean operations of a slice don't allocate it again for each of them.
+ * Leases may be nested: a lease taken while another one is held on the same thread gets another engine.
+ *
+ * The engine is cleared when the lease ends, so each lease starts without any paths.
+ */
+class PooledClipper : NoCopy
+{
+public:
+    /*!
+     * \param init_options The ClipperLib::InitOptions with which the engine would have been constructed
+     */
+    PooledClipper(int init_options = 0);
+    ~PooledClipper();
+
+    ClipperLib::Clipper& operator*()
+    {
+        return *clipper;
+    }
+    ClipperLib::Clipper* operator->()
+    {
+        return clipper.get();
+    }
+private:
+    std::unique_ptr<ClipperLib::Clipper> clipper;
+};
+
+/*!
+ * A ClipperOffset engine leased from a pool of the current thread for the lifetime of this object.
+ *
+ * \see PooledClipper
+ */
+class PooledClipperOffset : NoCopy
+{
+public:
+    /*!
+     * \param miter_limit The ClipperLib::ClipperOffset::MiterLimit
+     * \param arc_tolerance The ClipperLib::ClipperOffset::ArcTolerance
+     */
+    PooledClipperOffset(double miter_limit = 2.0, double arc_tolerance = 0.25);
+    ~PooledClipperOffset();
+
+    ClipperLib::ClipperOffset& operator*()
+    {
+        return *offsetter;
+    }
+    ClipperLib::ClipperOffset* operator->()
+    {
+        return offsetter.get();
+    }
+private:
+    std::unique_ptr<ClipperLib::ClipperOffset> offsetter;
+};
+
+}//namespace cura
+#endif//UTILS_CLIPPER_POOL_H
@@ -0,0 +1,239 @@
+/** Copyright (C) 2017 Ultimaker - Released under terms of the AGPLv3 License */
+#include "EncodingOutputStream.h"
+
+#include "logoutput.h"
+
+namespace cura
+{
+
+GzipEncoder::GzipEncoder()
+: is_finished(false)
+{
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    constexpr int window_bits = 15 + 16; // the largest window, with a gzip header and trailer instead of a zlib one
+    constexpr int memory_level = 8; // zlib's default
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, memory_level, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        logError("Failed to initialize gzip compression.\n");
+        is_finished = true;
+    }
+}
+
+GzipEncoder::~GzipEncoder()
+{
+    if (!is_finished)
+    {
+        deflateEnd(&stream);
+    }
+}
+
+void GzipEncoder::encode(const char* data, size_t size, std::string& output)
+{
+    compress(data, size, Z_NO_FLUSH, output);
+}
+
+void GzipEncoder::flush(std::string& output)
+{
+    compress(nullptr, 0, Z_SYNC_FLUSH, output);
+}
+
+void GzipEncoder::finish(std::string& output)
+{
+    compress(nullptr, 0, Z_FINISH, output);
+    if (!is_finished)
+    {
+        deflateEnd(&stream);
+        is_finished = true;
+    }
+}
+
+void GzipEncoder::compress(const char* data, size_t size, int flush_mode, std::string& output)
+{
+    if (is_finished)
+    {
+        return;
+    }
+    constexpr size_t chunk_size = 1 << 16;
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = size;
+    do
+    {
+        const size_t output_size = output.size();
+        output.resize(output_size + chunk_size);
+        stream.next_out = reinterpret_cast<Bytef*>(&output[output_size]);
+        stream.avail_out = chunk_size;
+        const int result = deflate(&stream, flush_mode);
+        output.resize(output_size + chunk_size - stream.avail_out);
+        if (result == Z_STREAM_ERROR)
+        {
+            logError("Gzip compression failed.\n");
+            return;
+        }
+    } while (stream.avail_out == 0);
+}
+
+constexpr size_t EncodingOutputStream::BlockBuffer::block_size;
+constexpr size_t EncodingOutputStream::BlockBuffer::max_queued_blocks;
+
+EncodingOutputStream::EncodingOutputStream(std::ostream* target, std::vector<std::unique_ptr<StreamEncoder>>&& encoders)
+: std::ostream(nullptr) // the buffer doesn't exist yet when the base class is constructed
+, buffer(target, std::move(encoders))
+{
+    rdbuf(&buffer);
+}
+
+EncodingOutputStream::~EncodingOutputStream()
+{
+    finish();
+}
+
+void EncodingOutputStream::finish()
+{
+    buffer.finish();
+}
+
+EncodingOutputStream::BlockBuffer::BlockBuffer(std::ostream* target, std::vector<std::unique_ptr<StreamEncoder>>&& encoders)
+: target(target)
+, encoders(std::move(encoders))
+, block(block_size)
+, is_encoding(false)
+, is_finished(false)
+{
+    setp(block.data(), block.data() + block.size());
+    encoder_thread = std::thread(&BlockBuffer::encoderMain, this);
+}
+
+EncodingOutputStream::BlockBuffer::~BlockBuffer()
+{
+    finish();
+}
+
+void EncodingOutputStream::BlockBuffer::finish()
+{
+    if (is_finished)
+    {
+        return;
+    }
+    queueBlock(Action::FINISH);
+    encoder_thread.join();
+    is_finished = true;
+    setp(nullptr, nullptr); // let further writes fail
+}
+
+EncodingOutputStream::BlockBuffer::int_type EncodingOutputStream::BlockBuffer::overflow(int_type character)
+{
+    if (is_finished)
+    {
+        return traits_type::eof();
+    }
+    queueBlock(Action::ENCODE);
+    if (!traits_type::eq_int_type(character, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(character);
+        pbump(1);
+    }
+    return traits_type::not_eof(character);
+}
+
+int EncodingOutputStream::BlockBuffer::sync()
+{
+    if (is_finished)
+    {
+        return 0;
+    }
+    queueBlock(Action::FLUSH);
+    waitUntilEncoded();
+    return target->good() ? 0 : -1;
+}
+
+void EncodingOutputStream::BlockBuffer::queueBlock(Action action)
+{
+    Block next;
+    next.size = pptr() - pbase();
+    next.action = action;
+    next.data.swap(block);
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_changed.wait(lock, [this]() { return queue.size() < max_queued_blocks; });
+        queue.push_back(std::move(next));
+        if (!free_blocks.empty())
+        {
+            block.swap(free_blocks.back());
+            free_blocks.pop_back();
+        }
+    }
+    queue_changed.notify_all();
+    if (block.empty())
+    { // all other blocks are still queued or being encoded
+        block.resize(block_size);
+    }
+    setp(block.data(), block.data() + block.size());
+}
+
+void EncodingOutputStream::BlockBuffer::waitUntilEncoded()
+{
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    queue_changed.wait(lock, [this]() { return queue.empty() && !is_encoding; });
+}
+
+void EncodingOutputStream::BlockBuffer::encoderMain()
+{
+    while (true)
+    {
+        Block next;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_changed.wait(lock, [this]() { return !queue.empty(); });
+            next = std::move(queue.front());
+            queue.pop_front();
+            is_encoding = true;
+        }
+        queue_changed.notify_all(); // there is room in the queue again
+
+        encodeBlock(next);
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            is_encoding = false;
+            free_blocks.push_back(std::move(next.data));
+        }
+        queue_changed.notify_all();
+        if (next.action == Action::FINISH)
+        {
+            return;
+        }
+    }
+}
+
+void EncodingOutputStream::BlockBuffer::encodeBlock(const Block& queued_block)
+{
+    const char* data = queued_block.data.data();
+    size_t size = queued_block.size;
+    std::string input;
+    std::string output;
+    for (std::unique_ptr<StreamEncoder>& encoder : encoders)
+    {
+        output.clear();
+        encoder->encode(data, size, output);
+        if (queued_block.action == Action::FLUSH)
+        {
+            encoder->flush(output);
+        }
+        else if (queued_block.action == Action::FINISH)
+        {
+            encoder->finish(output);
+        }
+        input.swap(output); // the output of this encoder is the input of the next one
+        data = input.data();
+        size = input.size();
+    }
+    target->write(data, size);
+    if (queued_block.action != Action::ENCODE)
+    {
+        target->flush();
+    }
+}
+
+}//namespace cura
@@ -0,0 +1,188 @@
+/** Copyright (C) 2017 Ultimaker - Released under terms of the AGPLv3 License */
+#ifndef UTILS_ENCODING_OUTPUT_STREAM_H
+#define UTILS_ENCODING_OUTPUT_STREAM_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <zlib.h>
+
+#include "NoCopy.h"
+
+namespace cura
+{
+
+/*!
+ * Converts a stream of data into another stream piece by piece, e.g. by compressing it.
+ */
+class StreamEncoder
+{
+public:
+    virtual ~StreamEncoder()
+    {
+    }
+
+    /*!
+     * Encode the next part of the stream.
+     *
+     * An encoder may keep part of the data to itself until more data comes in.
+     *
+     * \param data The next part of the data to encode
+     * \param size The number of bytes in \p data
+     * \param[out] output Where to append the encoded data
+     */
+    virtual void encode(const char* data, size_t size, std::string& output) = 0;
+
+    /*!
+     * Output all data held back so far, so that everything encoded up to now can be decoded.
+     *
+     * \param[out] output Where to append the encoded data
+     */
+    virtual void flush(std::string& output) = 0;
+
+    /*!
+     * Output all data held back and whatever is needed to end the encoded stream.
+     *
+     * \param[out] output Where to append the encoded data
+     */
+    virtual void finish(std::string& output) = 0;
+};
+
+/*!
+ * Compresses a stream into the gzip format with zlib.
+ */
+class GzipEncoder : public StreamEncoder, NoCopy
+{
+public:
+    GzipEncoder();
+
+    ~GzipEncoder();
+
+    void encode(const char* data, size_t size, std::string& output);
+
+    void flush(std::string& output);
+
+    void finish(std::string& output);
+
+private:
+    z_stream stream;
+    bool is_finished; //!< Whether the stream has been ended and zlib has been cleaned up
+
+    /*!
+     * Feed data to zlib and append everything it outputs.
+     *
+     * \param flush_mode What zlib should do with the data it holds back, e.g. Z_NO_FLUSH to keep it as long as it likes
+     */
+    void compress(const char* data, size_t size, int flush_mode, std::string& output);
+};
+
+/*!
+ * An output stream which encodes everything written to it on a background thread before writing it to another stream.
+ *
+ * Data is handed to the background thread in large blocks, so encoding overlaps with whatever produces the data.
+ * Flushing this stream waits until everything written so far has been encoded, written and flushed to the target stream.
+ * The encoded stream is ended by \ref EncodingOutputStream::finish or the destructor, after which nothing more can be written.
+ */
+class EncodingOutputStream : public std::ostream, NoCopy
+{
+public:
+    /*!
+     * Start the background thread.
+     *
+     * \param target The stream to write the encoded data to
+     * \param encoders The encoders to apply, in order: the output of each encoder is the input of the next one
+     */
+    EncodingOutputStream(std::ostream* target, std::vector<std::unique_ptr<StreamEncoder>>&& encoders);
+
+    ~EncodingOutputStream(); //!< Finishes the encoded stream
+
+    /*!
+     * Encode all data written so far, end the encoded stream and stop the background thread.
+     */
+    void finish();
+
+private:
+    /*!
+     * Collects the data written to the stream in blocks and hands them to the background thread.
+     */
+    class BlockBuffer : public std::streambuf
+    {
+    public:
+        static constexpr size_t block_size = 1 << 20; //!< The number of bytes collected before they are handed to the background thread
+        static constexpr size_t max_queued_blocks = 4; //!< The number of blocks which may wait for the background thread before writing to the stream blocks
+
+        BlockBuffer(std::ostream* target, std::vector<std::unique_ptr<StreamEncoder>>&& encoders);
+
+        ~BlockBuffer(); //!< Finishes the encoded stream
+
+        /*!
+         * Hand the remaining data to the background thread, let it end the encoded stream and wait for the thread to stop.
+         */
+        void finish();
+
+    protected:
+        int_type overflow(int_type character);
+
+        int sync();
+
+    private:
+        enum class Action
+        {
+            ENCODE, //!< Just encode the data of the block
+            FLUSH, //!< Flush the encoders and the target stream after encoding the block
+            FINISH //!< End the encoded stream after encoding the block
+        };
+
+        struct Block
+        {
+            std::vector<char> data; //!< A whole block of memory, of which only the first \p size bytes were written
+            size_t size;
+            Action action;
+        };
+
+        std::ostream* target;
+        std::vector<std::unique_ptr<StreamEncoder>> encoders;
+        std::vector<char> block; //!< The block currently being written to, used as the put area of the buffer
+
+        std::thread encoder_thread;
+        std::mutex queue_mutex; //!< Guards the members below
+        std::condition_variable queue_changed;
+        std::deque<Block> queue; //!< The blocks which haven't been encoded yet
+        std::vector<std::vector<char>> free_blocks; //!< Memory of blocks which have been encoded, to be written to again
+        bool is_encoding; //!< Whether the background thread is busy with a block it took from the queue
+        bool is_finished;
+
+        /*!
+         * Hand the data written to the current block to the background thread and start a new block.
+         *
+         * The block itself is handed over rather than a copy of its data,
+         * and the new block reuses the memory of a block which has already been encoded.
+         *
+         * Waits if the background thread is too far behind.
+         *
+         * \param action What to do after encoding the block
+         */
+        void queueBlock(Action action);
+
+        void waitUntilEncoded(); //!< Wait until the background thread has handled every block in the queue
+
+        void encoderMain(); //!< Encodes the blocks in the queue until the encoded stream is finished
+
+        /*!
+         * Run a block through all encoders and write the result to the target stream.
+         */
+        void encodeBlock(const Block& queued_block);
+    };
+
+    BlockBuffer buffer;
+};
+
+}//namespace cura
+#endif//UTILS_ENCODING_OUTPUT_STREAM_H
@@ -0,0 +1,80 @@
+/** Copyright (C) 2017 Ultimaker - Released under terms of the AGPLv3 License */
+#include "MappedFile.h"
+
+#include <stdio.h>
+
+#ifndef __WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace cura
+{
+
+MappedFile::MappedFile(const char* filename)
+{
+#ifndef __WIN32
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        return;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0)
+    {
+        close(fd);
+        return;
+    }
+    file_size = file_stat.st_size;
+    if (file_size > 0)
+    {
+        void* mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED)
+        {
+            madvise(mapping, file_size, MADV_SEQUENTIAL);
+            file_data = static_cast<const char*>(mapping);
+            is_mapped = true;
+        }
+    }
+    close(fd);
+    if (is_mapped || file_size == 0)
+    {
+        is_open = true;
+        return;
+    }
+#endif // __WIN32
+
+    // Fall back to reading the whole file, e.g. for files which can't be mapped such as pipes
+    FILE* f = fopen(filename, "rb");
+    if (f == nullptr)
+    {
+        return;
+    }
+    char chunk[65536];
+    size_t read_count;
+    while ((read_count = fread(chunk, 1, sizeof(chunk), f)) > 0)
+    {
+        read_buffer.insert(read_buffer.end(), chunk, chunk + read_count);
+    }
+    fclose(f);
+    file_size = read_buffer.size();
+    if (file_size > 0)
+    {
+        file_data = read_buffer.data();
+    }
+    is_open = true;
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef __WIN32
+    if (is_mapped)
+    {
+        munmap(const_cast<char*>(file_data), file_size);
+    }
+#endif // __WIN32
+}
+
+}//namespace cura
@@ -0,0 +1,56 @@
+/** Copyright (C) 2017 Ultimaker - Released under terms of the AGPLv3 License */
+#ifndef UTILS_MAPPED_FILE_H
+#define UTILS_MAPPED_FILE_H
+
+#include <cstddef>
+#include <vector>
+
+#include "NoCopy.h"
+
+namespace cura
+{
+
+/*!
+ * The contents of a file mapped read-only into memory.
+ *
+ * Lets parsers of large files work on the whole file at once without copying it through small buffers,
+ * and lets several threads decode different parts of it.
+ * Where memory mapping isn't available the file is read into a buffer instead.
+ */
+class MappedFile : NoCopy
+{
+public:
+    /*!
+     * Map a file.
+     *
+     * \param filename The file to map. Check \ref MappedFile::isOpen for whether this succeeded.
+     */
+    MappedFile(const char* filename);
+
+    ~MappedFile(); //!< Unmaps the file
+
+    bool isOpen() const
+    {
+        return is_open;
+    }
+
+    const char* data() const
+    {
+        return file_data;
+    }
+
+    size_t size() const
+    {
+        return file_size;
+    }
+
+private:
+    bool is_open = false;
+    const char* file_data = ""; //!< Not null for empty files, so there is always a valid end pointer
+    size_t file_size = 0;
+    bool is_mapped = false; //!< Whether file_data is a memory mapping, as opposed to pointing into read_buffer
+    std::vector<char> read_buffer; //!< The contents of the file if it couldn't be mapped
+};
+
+}//namespace cura
+#endif//UTILS_MAPPED_FILE_H
@@ -0,0 +1,64 @@
+/** Copyright (C) 2017 Ultimaker - Released under terms of the AGPLv3 License */
+#include "OutputBuffer.h"
+
+#include <cstdio> // snprintf
+
+namespace cura
+{
+
+constexpr size_t OutputBuffer::block_size;
+constexpr size_t OutputBuffer::max_number_length;
+
+OutputBuffer::OutputBuffer(std::ostream* stream)
+: stream(stream)
+, block(block_size)
+, used(0)
+{
+}
+
+OutputBuffer::~OutputBuffer()
+{
+    writeBlock();
+}
+
+void OutputBuffer::setOutputStream(std::ostream* stream)
+{
+    writeBlock();
+    this->stream = stream;
+}
+
+void OutputBuffer::flush()
+{
+    writeBlock();
+    stream->flush();
+}
+
+OutputBuffer& OutputBuffer::operator<<(const double value)
+{
+    char* buffer = reserve(max_number_length);
+    const int char_count = snprintf(buffer, max_number_length, "%f", value);
+    if (char_count <= 0)
+    {
+        return *this;
+    }
+    if (char_count >= static_cast<int>(max_number_length))
+    { // didn't fit in the reserved room, which only happens for huge values
+        std::string text(char_count + 1, '\0');
+        snprintf(&text[0], text.size(), "%f", value);
+        append(text.data(), char_count);
+        return *this;
+    }
+    used += char_count;
+    return *this;
+}
+
+void OutputBuffer::writeBlock()
+{
+    if (used > 0)
+    {
+        stream->write(block.data(), used);
+        used = 0;
+    }
+}
+
+}//namespace cura
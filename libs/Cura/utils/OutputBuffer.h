@@ -0,0 +1,126 @@
+/** Copyright (C) 2017 Ultimaker - Released under terms of the AGPLv3 License */
+#ifndef UTILS_OUTPUT_BUFFER_H
+#define UTILS_OUTPUT_BUFFER_H
+
+#include <cstddef>
+#include <cstring> // memcpy, strlen
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "NoCopy.h"
+#include "string.h" // MMtoStream, PrecisionedDouble
+
+namespace cura
+{
+
+/*!
+ * Collects text in a large block of memory and writes it to an output stream a whole block at a time.
+ *
+ * Numbers are formatted by the functions in utils/string.h rather than by the stream,
+ * so the output is the same as that of writing them to a stream set to std::fixed, but without the per number overhead of iostreams.
+ *
+ * Text is only written to the stream when the block is full or on \ref OutputBuffer::flush,
+ * so anyone reading the stream directly has to flush this buffer first.
+ */
+class OutputBuffer : NoCopy
+{
+public:
+    static constexpr size_t block_size = 1 << 20; //!< The number of characters collected before they are written to the stream
+
+    /*!
+     * \param stream The stream to write to
+     */
+    OutputBuffer(std::ostream* stream);
+
+    ~OutputBuffer(); //!< Writes the text which is still in the buffer to the stream
+
+    /*!
+     * Write everything collected so far to the current stream and continue with another stream.
+     */
+    void setOutputStream(std::ostream* stream);
+
+    /*!
+     * Write everything collected so far to the stream and flush the stream.
+     */
+    void flush();
+
+    OutputBuffer& operator<<(const char* text)
+    {
+        append(text, strlen(text));
+        return *this;
+    }
+
+    OutputBuffer& operator<<(const std::string& text)
+    {
+        append(text.data(), text.size());
+        return *this;
+    }
+
+    OutputBuffer& operator<<(const char character)
+    {
+        reserve(1)[0] = character;
+        used++;
+        return *this;
+    }
+
+    OutputBuffer& operator<<(const int value)
+    {
+        used += writeIntToBuffer(value, reserve(max_number_length));
+        return *this;
+    }
+
+    /*!
+     * Write a double with six digits after the decimal dot, the same as std::fixed with the default precision.
+     */
+    OutputBuffer& operator<<(const double value);
+
+    OutputBuffer& operator<<(const MMtoStream coord)
+    {
+        used += writeInt2mmToBuffer(coord.value, reserve(max_number_length));
+        return *this;
+    }
+
+    OutputBuffer& operator<<(const PrecisionedDouble precision_and_input)
+    {
+        used += writeDoubleToBuffer(precision_and_input.precision, precision_and_input.value, reserve(max_number_length));
+        return *this;
+    }
+
+private:
+    static constexpr size_t max_number_length = 32; //!< Room reserved for writing a single number
+
+    std::ostream* stream;
+    std::vector<char> block;
+    size_t used; //!< The number of characters in the block which haven't been written to the stream yet
+
+    /*!
+     * Get a pointer to where the next \p length characters can be written, writing out the block first if they don't fit.
+     * Doesn't increase \ref OutputBuffer::used.
+     */
+    char* reserve(const size_t length)
+    {
+        if (used + length > block_size)
+        {
+            writeBlock();
+        }
+        return &block[used];
+    }
+
+    void append(const char* text, const size_t length)
+    {
+        if (length > block_size)
+        { // doesn't fit in the block at all
+            writeBlock();
+            stream->write(text, length);
+            return;
+        }
+        memcpy(reserve(length), text, length);
+        used += length;
+    }
+
+    void writeBlock(); //!< Write the collected text to the stream without flushing the stream
+};
+
+}//namespace cura
+#endif//UTILS_OUTPUT_BUFFER_H
@@ -3,129 +3,150 @@
 #include <sstream> // ostream
 
 #include "PolygonProximityLinker.h"
+#include "PolygonsSegmentGrid.h"
 #include "linearAlg2D.h"
 
 #include "AABB.h" // for debug output svg html
 #include "SVG.h"
 
-namespace cura 
+namespace cura
 {
 
-PolygonProximityLinker::PolygonProximityLinker(Polygons& polygons, int proximity_distance)
- : polygons(polygons)
- , proximity_distance(proximity_distance)
+constexpr unsigned int PolygonProximityLinker::no_link;
+
+static constexpr unsigned int no_first_point = std::numeric_limits<unsigned int>::max(); //!< The first point of a polygon without points
+
+PolygonProximityLinker::PolygonProximityLinker(const Polygons& input_polygons, int proximity_distance)
+ : proximity_distance(proximity_distance)
  , proximity_distance_2(proximity_distance * proximity_distance)
- , line_grid(proximity_distance, polygons.pointCount(), 3.0f)
 {
-    // heuristic reserve a good amount of elements
-    proximity_point_links.reserve(polygons.pointCount()); // When the whole model consists of thin walls, there will generally be a link for every point, plus some endings minus some points which map to eachother
+    // store the polygons as linked rings for insertion of points
+    addPolygonPoints(input_polygons);
 
-    // convert to list polygons for insertion of points
-    ListPolyIt::convertPolygonsToLists(polygons, list_polygons); 
+    // heuristic reserve a good amount of elements
+    // When the whole model consists of thin walls, there will generally be a link for every point, plus some endings minus some points which map to eachother
+    size_t table_size = 64;
+    while (table_size < points.size() * 2)
+    {
+        table_size *= 2;
+    }
+    resizeLinkTables(table_size);
 
     // link each corner to itself
     addSharpCorners();
 
     // map each vertex onto nearby line segments
-    findProximatePoints();
+    findProximatePoints(input_polygons);
 
     // add links where line segments diverge from below the proximity distance to over the proximity distance
     addProximityEndings();
 
-    // convert list polygons back
-    ListPolyIt::convertListPolygonsToPolygons(list_polygons, polygons);
+    // convert the rings back to polygons
+    createPolygons();
 //     proximity2HTML("linker.html");
 }
 
-bool PolygonProximityLinker::isLinked(Point from)
+uint32_t PolygonProximityLinker::pointHash(const Point& p)
 {
-    return point_to_link.find(from) != point_to_link.end();
+    return (uint32_t(p.X) * 73856093u) ^ (uint32_t(p.Y) * 19349663u);
 }
 
+uint32_t PolygonProximityLinker::pointPairHash(unsigned int a, unsigned int b)
+{
+    return (uint32_t(std::min(a, b)) * 73856093u) ^ (uint32_t(std::max(a, b)) * 19349663u);
+}
 
-std::pair<PolygonProximityLinker::Point2Link::iterator, PolygonProximityLinker::Point2Link::iterator> PolygonProximityLinker::getLinks(Point from)
+bool PolygonProximityLinker::isLinked(Point from) const
 {
-    std::pair<Point2Link::iterator, Point2Link::iterator> from_link_pair = point_to_link.equal_range(from);
-#ifdef DEBUG
-    for (Point2Link::iterator it = from_link_pair.first; it != from_link_pair.second; ++it)
+    const size_t mask = point_link_table.size() - 1;
+    for (size_t slot = pointHash(from) & mask; point_link_table[slot].link_idx != no_link; slot = (slot + 1) & mask)
     {
-        if (!(it->second.a.p() == from || it->second.b.p() == from))
+        if (point_link_table[slot].p == from)
         {
-            std::cerr << " ERROR!\n" << it->first << " == " << from << "\n";
-            std::cerr << "should be either " << it->second.a.p() << " or " << it->second.b.p() << "\n";
-            std::cerr << (from_link_pair.first == from_link_pair.second) << " ; " << (from_link_pair.first == point_to_link.end()) << " ; " << (from_link_pair.second == point_to_link.end()) << "\n";
-            std::cerr << std::hash<Point>()(from) << " hashes " << std::hash<Point>()(it->second.a.p()) << " or " << std::hash<Point>()(it->second.b.p()) << "\n";
-//             std::cerr << "ERROR! some point got mapped to a link which doesn't have the point as one of the end points!\n";
-            
-            std::cerr << "\n all links:\n";
-            for (std::pair<const Point, const ProximityPointLink> pair : point_to_link)
-            {
-                std::cerr << pair.first << " : " << pair.second.a.p() << "-" <<pair.second.b.p() << "\n";
-            }
-            
-            std::cerr << "\n link set \n";
-            for (const ProximityPointLink link : proximity_point_links)
-            {
-                std::cerr << link.a.p() << "-" << link.b.p() << " hashes as " << std::hash<ProximityPointLink>()(link) << "\n";
-            }
-            assert(false && "some point got mapped to a link which doesn't have the point as one of the end points!");
+            return true;
         }
     }
-#endif
-    return from_link_pair;
+    return false;
 }
 
-void PolygonProximityLinker::createLineGrid()
+void PolygonProximityLinker::addPolygonPoints(const Polygons& input_polygons)
 {
-    for (unsigned int poly_idx = 0; poly_idx < list_polygons.size(); poly_idx++)
+    points.reserve(input_polygons.pointCount() * 2); // leave room for the inserted points
+    for (unsigned int poly_idx = 0; poly_idx < input_polygons.size(); poly_idx++)
     {
-        ListPolygon& poly = list_polygons[poly_idx];
-        for (ListPolygon::iterator it = poly.begin(); it != poly.end(); ++it)
+        const PolygonRef poly = input_polygons[poly_idx];
+        const unsigned int first_idx = points.size();
+        const unsigned int size = poly.size();
+        poly_first_point.push_back((size > 0)? first_idx : no_first_point);
+        for (unsigned int point_idx = 0; point_idx < size; point_idx++)
         {
-            ListPolyIt point_it(poly, it);
-            line_grid.insert(point_it);
+            PolyPoint point;
+            point.p = poly[point_idx];
+            point.prev = first_idx + (point_idx + size - 1) % size;
+            point.next = first_idx + (point_idx + 1) % size;
+            point.poly_idx = poly_idx;
+            point.is_new = false;
+            points.push_back(point);
         }
     }
 }
 
-void PolygonProximityLinker::findProximatePoints()
+void PolygonProximityLinker::addSegmentPoints(const unsigned int segment_start_idx, std::vector<unsigned int>& result) const
 {
-    createLineGrid();
+    // the points inserted on the segment lie between its start and the next point which was there from the start
+    unsigned int point_idx = segment_start_idx;
+    do
+    {
+        result.push_back(point_idx);
+        point_idx = points[point_idx].next;
+    } while (points[point_idx].is_new);
+}
 
-    for (unsigned int poly_idx = 0; poly_idx < list_polygons.size(); poly_idx++)
+void PolygonProximityLinker::findProximatePoints(const Polygons& input_polygons)
+{
+    const PolygonsSegmentGrid line_grid(input_polygons);
+    std::vector<unsigned int> input_poly_start; // the index of the first point of each input polygon
+    for (unsigned int poly_idx = 0, start_idx = 0; poly_idx < input_polygons.size(); poly_idx++)
     {
-        ListPolygon& poly = list_polygons[poly_idx];
-        for (ListPolygon::iterator it = poly.begin(); it != poly.end(); ++it)
+        input_poly_start.push_back(start_idx);
+        start_idx += input_polygons[poly_idx].size();
+    }
+    std::vector<PolygonsSegmentGrid::Segment> nearby_segments;
+    std::vector<unsigned int> nearby_lines; // the start points of the line segments near a point
+    auto findNearbyLines = [&](Point location)
         {
-            ListPolyIt point_it(poly, it);
-            if (new_points.find(point_it) == new_points.end())
+            line_grid.getSegmentsNear(location, proximity_distance, nearby_segments);
+            nearby_lines.clear();
+            for (const PolygonsSegmentGrid::Segment& segment : nearby_segments)
             {
-                // handle new_points separately
-                // to prevent this:
-                //  1    3   5   7
-                //  o<-.
-                //  :   'o<-.
-                //  :   /:   o<.
-                //  :  / :  /:  'o<.
-                //  : /  : / : / :
-                //  :/   :/  :/  :   etc.
-                //  o--->o-->o-->o->
-                //  2    4   6   8
-                std::unordered_set<ListPolyIt> nearby_lines;
-                auto process_func = [&nearby_lines](const ListPolyIt& elem)
-                {
-                    nearby_lines.emplace(elem);
-                };
-                line_grid.processNearby(point_it.p(), proximity_distance, process_func);
-                for (const ListPolyIt& nearby_line : nearby_lines)
-                {
-                    findProximatePoints(point_it, *nearby_line.poly, nearby_line, nearby_line.next());
-                }
+                // the line segments of the input polygons may have been split up by inserted points
+                addSegmentPoints(input_poly_start[segment.poly_idx] + segment.point_idx, nearby_lines);
             }
+        };
+
+    const unsigned int input_point_count = points.size();
+    for (unsigned int point_idx = 0; point_idx < input_point_count; point_idx++)
+    {
+        // handle new_points separately
+        // to prevent this:
+        //  1    3   5   7
+        //  o<-.
+        //  :   'o<-.
+        //  :   /:   o<.
+        //  :  / :  /:  'o<.
+        //  : /  : / : / :
+        //  :/   :/  :/  :   etc.
+        //  o--->o-->o-->o->
+        //  2    4   6   8
+        findNearbyLines(points[point_idx].p);
+        for (const unsigned int nearby_line : nearby_lines)
+        {
+            findProximatePoints(point_idx, nearby_line, points[nearby_line].next);
         }
     }
 
-    for (const ListPolyIt& new_point_it : new_points)
+    const unsigned int point_count = points.size();
+    for (unsigned int new_point_idx = input_point_count; new_point_idx < point_count; new_point_idx++)
     {
         // link with existing points, but don't introduce new points for line segments
         // to prevent this:
@@ -138,50 +159,45 @@ void PolygonProximityLinker::findProximatePoints()
         //  :/   :/  :/  :   etc.
         //  o--->o-->o-->o->
         //  2    4   6   8
-        std::unordered_set<ListPolyIt> nearby_vert_its;
-        auto process_func = [&nearby_vert_its](const ListPolyIt& elem)
-        {
-            nearby_vert_its.emplace(elem);
-        };
-        line_grid.processNearby(new_point_it.p(), proximity_distance, process_func);
+        const Point new_point = points[new_point_idx].p;
+        findNearbyLines(new_point);
         // because we use the same line_grid as before the resulting nearby_points
         // will also have points which are not nearby, (But when the line segment *is* nearby.)
-        // but at least we don't have to create a whole new SparsePointGrid
-        for (const ListPolyIt& nearby_vert_it : nearby_vert_its)
+        // but at least we don't have to create a whole new grid
+        for (const unsigned int nearby_vert_idx : nearby_lines)
         {
-            Point new_point = new_point_it.p();
-            Point nearby_vert = nearby_vert_it.p();
+            const Point nearby_vert = points[nearby_vert_idx].p;
             int64_t dist2 = vSize2(new_point - nearby_vert);
             if (dist2 < proximity_distance_2
                 && new_point != nearby_vert // not the same point
             )
             {
-                addProximityLink(new_point_it, nearby_vert_it, sqrt(dist2), ProximityPointLinkType::NORMAL);
+                addProximityLink(new_point_idx, nearby_vert_idx, sqrt(dist2), ProximityPointLinkType::NORMAL);
             }
         }
     }
 }
 
-void PolygonProximityLinker::findProximatePoints(const ListPolyIt a_point_it, ListPolygon& to_list_poly, const ListPolyIt b_from_it, const ListPolyIt b_to_it)
+void PolygonProximityLinker::findProximatePoints(const unsigned int a_point_idx, const unsigned int b_from_idx, const unsigned int b_to_idx)
 {
-    const Point& a_point = a_point_it.p();
-
-    const Point& b_from = b_from_it.p();
-    const Point& b_to = b_to_it.p();
-
-    if (a_point_it == b_from_it || a_point_it == b_to_it) // we currently consider a linesegment directly connected to [from]
+    if (a_point_idx == b_from_idx || a_point_idx == b_to_idx) // we currently consider a linesegment directly connected to [from]
     {
         return;
     }
 
-    Point closest = LinearAlg2D::getClosestOnLineSegment(a_point, b_from, b_to);
+    // copies, because inserting a point may move the points
+    const PolyPoint a_point = points[a_point_idx];
+    const Point b_from = points[b_from_idx].p;
+    const Point b_to = points[b_to_idx].p;
+
+    Point closest = LinearAlg2D::getClosestOnLineSegment(a_point.p, b_from, b_to);
 
-    int64_t dist2 = vSize2(closest - a_point);
+    int64_t dist2 = vSize2(closest - a_point.p);
 
     if (dist2 > proximity_distance_2
-        || (a_point_it.poly == &to_list_poly
-            && dot(a_point_it.next().p() - a_point, b_to - b_from) > 0 
-            && dot(a_point - a_point_it.prev().p(), b_to - b_from) > 0  ) // line segments are likely connected, because the winding order is in the same general direction
+        || (a_point.poly_idx == points[b_from_idx].poly_idx
+            && dot(points[a_point.next].p - a_point.p, b_to - b_from) > 0
+            && dot(a_point.p - points[a_point.prev].p, b_to - b_from) > 0  ) // line segments are likely connected, because the winding order is in the same general direction
     )
     { // line segment too far away to be proximate
         return;
@@ -191,15 +207,15 @@ void PolygonProximityLinker::findProximatePoints(const ListPolyIt a_point_it, Li
 
     if (shorterThen(closest - b_from, 10))
     {
-        addProximityLink(a_point_it, b_from_it, dist, ProximityPointLinkType::NORMAL);
+        addProximityLink(a_point_idx, b_from_idx, dist, ProximityPointLinkType::NORMAL);
     }
     else if (shorterThen(closest - b_to, 10))
     {
-        addProximityLink(a_point_it, b_to_it, dist, ProximityPointLinkType::NORMAL);
+        addProximityLink(a_point_idx, b_to_idx, dist, ProximityPointLinkType::NORMAL);
     }
-    else 
+    else
     {
-        if (new_points.find(a_point_it) == new_points.end())
+        if (!a_point.is_new)
         {
             // don't introduce new points for newly introduced points
             // to prevent this:
@@ -212,73 +228,98 @@ void PolygonProximityLinker::findProximatePoints(const ListPolyIt a_point_it, Li
             //  :/   :/  :/  :   etc.
             //  o--->o-->o-->o->
             //  2    4   6   8
-            ListPolyIt new_it = addNewPolyPoint(closest, b_from_it, b_to_it, b_to_it);
-            addProximityLink(a_point_it, new_it, dist, ProximityPointLinkType::NORMAL);
+            unsigned int new_idx = addNewPolyPoint(closest, b_from_idx, b_to_idx, b_to_idx);
+            addProximityLink(a_point_idx, new_idx, dist, ProximityPointLinkType::NORMAL);
         }
     }
 }
 
-
-
-bool PolygonProximityLinker::addProximityLink(ListPolyIt from, ListPolyIt to, int64_t dist, const ProximityPointLinkType type)
+bool PolygonProximityLinker::addProximityLink(unsigned int from, unsigned int to, int64_t dist, const ProximityPointLinkType type)
 {
-    std::pair<ProximityPointLinks::iterator, bool> result =
-        proximity_point_links.emplace(from, to, dist, type);
-
-    if (!result.second)
+    if (findLink(from, to) != no_link)
     { // links was already made!
         return false;
     }
-    ProximityPointLinks::iterator it = result.first;
-    assert(it->a == from);
-    assert(it->b == to);
-    assert(it->a.p() == from.p());
-    assert(it->b.p() == to.p());
-    addToPoint2LinkMap(from.p(), it);
-    addToPoint2LinkMap(to.p(), it);
-
-    return result.second;
+    if ((links.size() + 1) * 2 > link_table.size())
+    {
+        resizeLinkTables(link_table.size() * 2);
+    }
+    links.emplace_back(from, to, dist, type);
+    insertLinkTableEntries(links.size() - 1);
+    return true;
 }
 
-bool PolygonProximityLinker::addCornerLink(ListPolyIt corner_point, const ProximityPointLinkType type)
+bool PolygonProximityLinker::addCornerLink(unsigned int corner_point, const ProximityPointLinkType type)
 {
     constexpr int dist = 0;
-    std::pair<ProximityPointLinks::iterator, bool> result =
-        proximity_point_links.emplace(corner_point, corner_point, dist, type);
+    return addProximityLink(corner_point, corner_point, dist, type);
+}
 
-    if (!result.second)
-    { // links was already made!
-        return false;
+void PolygonProximityLinker::insertLinkTableEntries(unsigned int link_idx)
+{
+    const ProximityPointLink& link = links[link_idx];
+    {
+        const size_t mask = link_table.size() - 1;
+        size_t slot = pointPairHash(link.a, link.b) & mask;
+        while (link_table[slot] != no_link)
+        {
+            slot = (slot + 1) & mask;
+        }
+        link_table[slot] = link_idx;
+    }
+    auto insertPointLinkEntry = [this, link_idx](const Point& p)
+        {
+            const size_t mask = point_link_table.size() - 1;
+            size_t slot = pointHash(p) & mask;
+            while (point_link_table[slot].link_idx != no_link)
+            {
+                slot = (slot + 1) & mask;
+            }
+            point_link_table[slot].p = p;
+            point_link_table[slot].link_idx = link_idx;
+        };
+    insertPointLinkEntry(points[link.a].p);
+    if (link.b != link.a)
+    { // a link of a point to itself is only stored once
+        insertPointLinkEntry(points[link.b].p);
     }
-    ProximityPointLinks::iterator it = result.first;
-    assert(it->a == corner_point);
-    assert(it->b == corner_point);
-    addToPoint2LinkMap(corner_point.p(), it);
+}
 
-    return result.second;
+void PolygonProximityLinker::resizeLinkTables(size_t size)
+{
+    link_table.assign(size, no_link);
+    PointLinkEntry empty_entry;
+    empty_entry.p = Point(0, 0);
+    empty_entry.link_idx = no_link;
+    point_link_table.assign(size * 2, empty_entry); // an entry for both ends of each link
+    // Reinserting in link order keeps the entries of each location in the order in which the links were created
+    for (unsigned int link_idx = 0; link_idx < links.size(); link_idx++)
+    {
+        insertLinkTableEntries(link_idx);
+    }
 }
 
 void PolygonProximityLinker::addProximityEndings()
 {
-    ProximityPointLinks new_links; // Where to store the new links temporarily (Don't add them to the map we are iterating over!)
-    for (const ProximityPointLink& link : proximity_point_links)
+    std::vector<ProximityPointLink> new_links; // Where to store the new links temporarily (Don't add them to the links we are iterating over!)
+    const unsigned int link_count = links.size();
+    for (unsigned int link_idx = 0; link_idx < link_count; link_idx++)
     {
+        const ProximityPointLink& link = links[link_idx];
         if (link.dist == proximity_distance)
         { // its ending itself
             continue;
         }
-        const ListPolyIt& a_1 = link.a;
-        const ListPolyIt& b_1 = link.b;
         // an overlap segment can be an ending in two directions
-        { 
-            ListPolyIt a_2 = a_1.next();
-            ListPolyIt b_2 = b_1.prev();
-            addProximityEnding(link, a_2, b_2, a_2, b_1, new_links);
+        {
+            const unsigned int a_2 = points[link.a].next;
+            const unsigned int b_2 = points[link.b].prev;
+            addProximityEnding(link, a_2, b_2, a_2, link.b, new_links);
         }
-        { 
-            ListPolyIt a_2 = a_1.prev();
-            ListPolyIt b_2 = b_1.next();
-            addProximityEnding(link, a_2, b_2, a_1, b_2, new_links);
+        {
+            const unsigned int a_2 = points[link.a].prev;
+            const unsigned int b_2 = points[link.b].next;
+            addProximityEnding(link, a_2, b_2, link.a, b_2, new_links);
         }
     }
     for (const ProximityPointLink& link : new_links)
@@ -287,16 +328,17 @@ void PolygonProximityLinker::addProximityEndings()
     }
 }
 
-void PolygonProximityLinker::addProximityEnding(const ProximityPointLink& link, const ListPolyIt& a2_it, const ListPolyIt& b2_it, const ListPolyIt& a_after_middle, const ListPolyIt& b_after_middle, ProximityPointLinks& result)
+void PolygonProximityLinker::addProximityEnding(const ProximityPointLink& link, const unsigned int a2_idx, const unsigned int b2_idx, const unsigned int a_after_middle, const unsigned int b_after_middle, std::vector<ProximityPointLink>& result)
 {
-    Point& a1 = link.a.p();
-    Point& a2 = a2_it.p();
-    Point& b1 = link.b.p();
-    Point& b2 = b2_it.p();
+    // copies, because inserting a point may move the points
+    const Point a1 = points[link.a].p;
+    const Point a2 = points[a2_idx].p;
+    const Point b1 = points[link.b].p;
+    const Point b2 = points[b2_idx].p;
     Point a = a2 - a1;
     Point b = b2 - b1;
 
-    if (isLinked(a2_it.p()) && isLinked(b2_it.p())) // overlap area stops at one side
+    if (isLinked(a2) && isLinked(b2)) // overlap area stops at one side
     {
         // TODO: add proximity endings between point and line ?
         // would be good for:
@@ -307,7 +349,7 @@ void PolygonProximityLinker::addProximityEnding(const ProximityPointLink& link,
         //  ----+-+-----
         return;
     }
-    if (isLinked(a2_it, link.b) || isLinked(b2_it, link.a))
+    if (isLinked(a2_idx, link.b) || isLinked(b2_idx, link.a))
     { // other side of ending continues to overlap with the same ending
         //     link considered
         //     *
@@ -319,14 +361,14 @@ void PolygonProximityLinker::addProximityEnding(const ProximityPointLink& link,
         //     0
         return;
     }
-    if (a2_it == b2_it)
+    if (a2_idx == b2_idx)
     { // overlap ends in pointy end
         //  o-->o-->o
         //  :   :   : \,
         //  :   :   :  o  wasn't linked yet because it's connected to the upper and lower part
         //  :   :   :,/
         //  o<--o<--o
-        result.emplace(ProximityPointLink(a2_it, a2_it, 0, ProximityPointLinkType::ENDING_CORNER));
+        result.emplace_back(a2_idx, a2_idx, 0, ProximityPointLinkType::ENDING_CORNER);
         return;
     }
 
@@ -341,27 +383,27 @@ void PolygonProximityLinker::addProximityEnding(const ProximityPointLink& link,
         if (a_length2 < b_length2)
         {
             Point b_p = b1 + normal(b, dist);
-            ListPolyIt new_b = addNewPolyPoint(b_p, link.b, b2_it, b_after_middle);
-            result.emplace(ProximityPointLink(a2_it, new_b, proximity_distance, ProximityPointLinkType::ENDING));
+            unsigned int new_b = addNewPolyPoint(b_p, link.b, b2_idx, b_after_middle);
+            result.emplace_back(a2_idx, new_b, proximity_distance, ProximityPointLinkType::ENDING);
         }
         else if (b_length2 < a_length2)
         {
             Point a_p = a1 + normal(a, dist);
-            ListPolyIt new_a = addNewPolyPoint(a_p, link.a, a2_it, a_after_middle);
-            result.emplace(ProximityPointLink(new_a, b2_it, proximity_distance, ProximityPointLinkType::ENDING));
+            unsigned int new_a = addNewPolyPoint(a_p, link.a, a2_idx, a_after_middle);
+            result.emplace_back(new_a, b2_idx, proximity_distance, ProximityPointLinkType::ENDING);
         }
         else // equal
         {
-            result.emplace(ProximityPointLink(a2_it, b2_it, proximity_distance, ProximityPointLinkType::ENDING));
+            result.emplace_back(a2_idx, b2_idx, proximity_distance, ProximityPointLinkType::ENDING);
         }
     }
     else if (dist > 0)
     {
         Point a_p = a1 + normal(a, dist);
-        ListPolyIt new_a = addNewPolyPoint(a_p, link.a, a2_it, a_after_middle);
+        unsigned int new_a = addNewPolyPoint(a_p, link.a, a2_idx, a_after_middle);
         Point b_p = b1 + normal(b, dist);
-        ListPolyIt new_b = addNewPolyPoint(b_p, link.b, b2_it, b_after_middle);
-        result.emplace(ProximityPointLink(new_a, new_b, proximity_distance, ProximityPointLinkType::ENDING));
+        unsigned int new_b = addNewPolyPoint(b_p, link.b, b2_idx, b_after_middle);
+        result.emplace_back(new_a, new_b, proximity_distance, ProximityPointLinkType::ENDING);
     }
     else if (dist == 0)
     {
@@ -370,33 +412,42 @@ void PolygonProximityLinker::addProximityEnding(const ProximityPointLink& link,
     }
 }
 
-ListPolyIt PolygonProximityLinker::addNewPolyPoint(const Point point, const ListPolyIt line_start, const ListPolyIt line_end, const ListPolyIt before_this)
+unsigned int PolygonProximityLinker::addNewPolyPoint(const Point point, const unsigned int line_start, const unsigned int line_end, const unsigned int before_this)
 {
-    if (point == line_start.p())
+    if (point == points[line_start].p)
     {
         return line_start;
     }
-    if (point == line_end.p())
+    if (point == points[line_end].p)
     {
         return line_end;
     }
-    ListPolygon::iterator new_p = before_this.poly->insert(before_this.it, point);
-    ListPolyIt lpi(*before_this.poly, new_p);
-    line_grid.insert(lpi);
-    // TODO: remove new part of old segment from the line_grid (?)
-    new_points.emplace(lpi);
-    return lpi;
+    const unsigned int new_idx = points.size();
+    PolyPoint new_point;
+    new_point.p = point;
+    new_point.prev = points[before_this].prev;
+    new_point.next = before_this;
+    new_point.poly_idx = points[before_this].poly_idx;
+    new_point.is_new = true;
+    points.push_back(new_point);
+    points[new_point.prev].next = new_idx;
+    points[before_this].prev = new_idx;
+    if (poly_first_point[new_point.poly_idx] == before_this)
+    { // a point inserted before the start of a polygon becomes its start
+        poly_first_point[new_point.poly_idx] = new_idx;
+    }
+    return new_idx;
 }
 
-int64_t PolygonProximityLinker::proximityEndingDistance(Point& a1, Point& a2, Point& b1, Point& b2, int a1b1_dist)
+int64_t PolygonProximityLinker::proximityEndingDistance(const Point& a1, const Point& a2, const Point& b1, const Point& b2, int a1b1_dist)
 {
     int overlap = proximity_distance - a1b1_dist;
     Point a = a2-a1;
     Point b = b2-b1;
     double cos_angle = INT2MM2(dot(a, b)) / vSizeMM(a) / vSizeMM(b);
-    // result == .5*overlap / tan(.5*angle) == .5*overlap / tan(.5*acos(cos_angle)) 
+    // result == .5*overlap / tan(.5*angle) == .5*overlap / tan(.5*acos(cos_angle))
     // [wolfram alpha] == 0.5*overlap * sqrt(cos_angle+1)/sqrt(1-cos_angle)
-    // [assuming positive x] == 0.5*overlap / sqrt( 2 / (cos_angle + 1) - 1 ) 
+    // [assuming positive x] == 0.5*overlap / sqrt( 2 / (cos_angle + 1) - 1 )
     if (cos_angle <= 0
         || ! std::isfinite(cos_angle) )
     {
@@ -415,85 +466,93 @@ int64_t PolygonProximityLinker::proximityEndingDistance(Point& a1, Point& a2, Po
 
 void PolygonProximityLinker::addSharpCorners()
 {
-    for (ListPolygon& poly : list_polygons)
+    for (const unsigned int first_idx : poly_first_point)
     {
-        ListPolyIt here(poly, --poly.end());
-        ListPolyIt prev = here.prev();
-        for (ListPolygon::iterator it = poly.begin(); it != poly.end(); ++it)
+        if (first_idx == no_first_point)
         {
-            ListPolyIt next(poly, it);
-
-            if (LinearAlg2D::isAcuteCorner(prev.p(), here.p(), next.p()) > 0)
+            continue;
+        }
+        // start at the last point, like the polygon is walked from its first point with the corner lagging one point behind
+        unsigned int here = points[first_idx].prev;
+        unsigned int next = first_idx;
+        do
+        {
+            if (LinearAlg2D::isAcuteCorner(points[points[here].prev].p, points[here].p, points[next].p) > 0)
             {
                 addCornerLink(here, ProximityPointLinkType::SHARP_CORNER);
             }
-
-            prev = here;
             here = next;
-        }
+            next = points[next].next;
+        } while (next != first_idx);
     }
 }
 
-void PolygonProximityLinker::addToPoint2LinkMap(Point p, ProximityPointLinks::iterator it)
+void PolygonProximityLinker::createPolygons()
 {
-    const ProximityPointLink& link = *it;
-    point_to_link.emplace(p, link); // copy element from proximity_point_links set to Point2Link map
-    assert(p == link.a.p() || p == link.b.p());
+    for (const unsigned int first_idx : poly_first_point)
+    {
+        PolygonRef poly = polygons.newPoly();
+        if (first_idx == no_first_point)
+        {
+            continue;
+        }
+        unsigned int point_idx = first_idx;
+        do
+        {
+            poly.add(points[point_idx].p);
+            point_idx = points[point_idx].next;
+        } while (point_idx != first_idx);
+    }
 }
 
-
 void PolygonProximityLinker::proximity2HTML(const char* filename) const
 {
-    PolygonProximityLinker copy = *this; // copy, cause getFlow might change the state of the overlap computation!
-
-    AABB aabb(copy.polygons);
+    AABB aabb(polygons);
 
     aabb.expand(200);
 
     SVG svg(filename, aabb, Point(1024 * 2, 1024 * 2));
 
 
-    svg.writeAreas(copy.polygons);
+    svg.writeAreas(polygons);
 
     { // output points and coords
-        for (ListPolygon poly : copy.list_polygons)
+        for (const PolyPoint& point : points)
         {
-            for (Point& p : poly)
-            {
-                svg.writePoint(p, true);
-            }
+            svg.writePoint(point.p, true);
         }
     }
 
     { // output links
         // output normal links
-        for (const ProximityPointLink& link : copy.proximity_point_links)
+        for (const ProximityPointLink& link : links)
         {
-            svg.writePoint(link.a.p(), false, 3, SVG::Color::GRAY);
-            svg.writePoint(link.b.p(), false, 3, SVG::Color::GRAY);
-            Point a = svg.transform(link.a.p());
-            Point b = svg.transform(link.b.p());
+            svg.writePoint(points[link.a].p, false, 3, SVG::Color::GRAY);
+            svg.writePoint(points[link.b].p, false, 3, SVG::Color::GRAY);
+            Point a = svg.transform(points[link.a].p);
+            Point b = svg.transform(points[link.b].p);
             svg.printf("<line x1=\"%lli\" y1=\"%lli\" x2=\"%lli\" y2=\"%lli\" style=\"stroke:rgb(%d,%d,0);stroke-width:1\" />", a.X, a.Y, b.X, b.Y, link.dist == proximity_distance? 0 : 255, link.dist==proximity_distance? 255 : 0);
         }
     }
 }
 
-bool PolygonProximityLinker::isLinked(ListPolyIt a, ListPolyIt b)
+bool PolygonProximityLinker::isLinked(unsigned int a, unsigned int b) const
 {
-    ProximityPointLink test_link(a, b, 0, ProximityPointLinkType::NORMAL);
-    return proximity_point_links.find(test_link) != proximity_point_links.end();
+    return findLink(a, b) != no_link;
 }
 
-const ProximityPointLink* PolygonProximityLinker::getLink(ListPolyIt a, ListPolyIt b)
+unsigned int PolygonProximityLinker::findLink(unsigned int a, unsigned int b) const
 {
-    ProximityPointLink test_link(a, b, 0, ProximityPointLinkType::NORMAL);
-    ProximityPointLinks::const_iterator found = proximity_point_links.find(test_link);
-
-    if (found != proximity_point_links.end())
+    const size_t mask = link_table.size() - 1;
+    for (size_t slot = pointPairHash(a, b) & mask; link_table[slot] != no_link; slot = (slot + 1) & mask)
     {
-        return &*found;
+        const ProximityPointLink& link = links[link_table[slot]];
+        if ((link.a == a && link.b == b) || (link.a == b && link.b == a))
+        {
+            return link_table[slot];
+        }
     }
-    return nullptr;
+    return no_link;
 }
 
-}//namespace cura 
+}//namespace cura
@@ -2,217 +2,279 @@
 #ifndef UTILS_POLYGON_PROXIMITY_LINKER_H
 #define UTILS_POLYGON_PROXIMITY_LINKER_H
 
+#include <limits> // numeric_limits
+#include <stdint.h>
 #include <vector>
-#include <unordered_map>
-#include <unordered_set>
-#include <list>
-#include <utility> // pair
-
-#include <functional> // hash function object
 
 #include "intpoint.h"
 #include "polygon.h"
 
-#include "ListPolyIt.h"
 #include "ProximityPointLink.h"
-#include "SparseLineGrid.h"
 
-namespace cura 
+namespace cura
 {
 
 /*!
  * Class for computing which parts of polygons are close to which other parts of polygons
  * A link always occurs between a point already on a polygon and either another point of a polygon or a point on a line segment of a polygon.
- * 
+ *
  * In the latter case we insert the point into the polygon so that we can later look up by how much to reduce the extrusion at the corresponding line segment.
- * This is the reason that the polygons are converted to (linked) lists before the proximity linking computation takes place, after which they are converted back.
- * 
+ * This is the reason that the polygons are stored as rings of points linked by index in a single vector while the proximity linking computation takes place,
+ * after which they are converted to PolygonProximityLinker::polygons.
+ *
  * At the end of a sequence of proximity links the polygon segments diverge away from each other.
  * Therefore points are introduced on the line segments involved and a link is created with a link distance of exactly the PolygonProximityLinker::proximity_distance.
- * 
- * We end up with links which include a boolean field to represent whether the link is already processed from outside.
- * This is used by functions which use the PolygonProximityLinker class when there is being looped over points in a polygon, which by definition loops over all links twice.
- * 
+ *
  * Each point on the polygons maps to a link, so that we can easily look up which links corresponds to the current line segment being handled when compensating for wall overlaps for example.
- * 
+ *
  * The main functionality of this class is performed by the constructor.
+ * An instance only uses its own data, so several polygons can be linked on different threads at the same time.
  */
 class PolygonProximityLinker
 {
 public:
-    typedef std::unordered_set<ProximityPointLink> ProximityPointLinks; //!< The type of PolygonProximityLinker::overlap_point_links
-    typedef std::unordered_multimap<Point, ProximityPointLink> Point2Link; //!< The type of PolygonProximityLinker::point_to_link
+    static constexpr unsigned int no_link = std::numeric_limits<unsigned int>::max(); //!< The link index returned when two points aren't linked
+
+    /*!
+     * A point of the polygons being linked.
+     */
+    struct PolyPoint
+    {
+        Point p;
+        unsigned int prev; //!< The index of the previous point of the polygon in PolygonProximityLinker::points
+        unsigned int next; //!< The index of the next point of the polygon in PolygonProximityLinker::points
+        unsigned int poly_idx; //!< The polygon the point belongs to
+        bool is_new; //!< Whether the point has been inserted on a line segment by the linker
+    };
 
 private:
-    /////////////////////////////////////////////////////////////////////////////////////////////
     /*!
-     * Locator to retrieve line segment data from a \ref ListPolyIt
+     * An entry of PolygonProximityLinker::point_link_table: a link and one of the locations it connects.
      */
-    struct ListPolyItSegmentLocator
+    struct PointLinkEntry
     {
-        std::pair<Point, Point> operator()(const ListPolyIt& val) const
-        {
-            return std::pair<Point, Point>(val.p(), val.next().p());
-        }
+        Point p;
+        unsigned int link_idx; //!< \ref PolygonProximityLinker::no_link for a free slot
     };
 
-    Polygons& polygons; //!< The polygons for which to compensate overlapping walls for
-    ListPolygons list_polygons; //!< The PolygonProximityLinker::polygons converted
+    Polygons polygons; //!< The polygons with the points inserted by the linker
 
     int proximity_distance; //!< The line width of the walls
     int proximity_distance_2; //!< The squared line width of the walls
 
-    SparseLineGrid<ListPolyIt, ListPolyItSegmentLocator> line_grid; //!< Mapping from locations to lines
+    std::vector<PolyPoint> points; //!< The points of all polygons; first the points of the input polygons in order, followed by the newly inserted points
+    std::vector<unsigned int> poly_first_point; //!< For each polygon the index of the point at which it starts
 
-    std::unordered_set<ListPolyIt> new_points; //!< The newly inserted points to create new links.
+    std::vector<ProximityPointLink> links; //!< All links in the order in which they were created
 
-    ProximityPointLinks proximity_point_links; //!< mapping from each link to its attributes
+    /*!
+     * Flat open-addressing (linear probing) table with an entry for each link, keyed on the (unordered) pair of points it connects.
+     * The size is a power of two and at most half of the entries are used.
+     */
+    std::vector<unsigned int> link_table;
 
-    Point2Link point_to_link; //!< mapping from each point to the/a corresponding link (collisions are ignored as of yet)
+    /*!
+     * Flat open-addressing (linear probing) table with an entry for each end of each link, keyed on the location of the end.
+     * The entries of a location are found along its probe sequence in the order in which the links were created.
+     * The size is a power of two and at most half of the entries are used.
+     */
+    std::vector<PointLinkEntry> point_link_table;
 
     /*!
-     * Create the initial \ref PolygonProximityLinker::line_grid
-     * 
-     * Map locations where line segments of the input polygons occur to iterators pointing to the start of those line segments.
-     * 
-     * Note that when points are introduced which split line segments in two,
-     * the line_grid maps locations to segments which are not close any more.
+     * Store the input polygons in PolygonProximityLinker::points.
      */
-    void createLineGrid();
+    void addPolygonPoints(const Polygons& input_polygons);
 
-    void findProximatePoints(); //!< find the basic proximity links (for trapezoids) and record them into PolygonProximityLinker::overlap_point_links
+    /*!
+     * Find the basic proximity links (for trapezoids) and record them into PolygonProximityLinker::links
+     *
+     * \param input_polygons The polygons as they were given to the constructor, to look up which line segments are nearby
+     */
+    void findProximatePoints(const Polygons& input_polygons);
 
     /*!
      * Find the basic proximity link (for a trapezoid) between a given point and a line segment
-     * and record them into PolygonProximityLinker::overlap_point_links
-     * 
-     * \param a_point_it Iterator to the point from which to check for proximity
-     * \param to_list_poly The polygon in which the line segment occurs
-     * \param b_from_it iterator to the one end point of the line segment
-     * \param b_to_it iterator to the other end point of the line segment
+     * and record them into PolygonProximityLinker::links
+     *
+     * \param a_point_idx The point from which to check for proximity
+     * \param b_from_idx The one end point of the line segment
+     * \param b_to_idx The other end point of the line segment
+     */
+    void findProximatePoints(const unsigned int a_point_idx, const unsigned int b_from_idx, const unsigned int b_to_idx);
+
+    /*!
+     * Get the points of all line segments into which the linker has split the line segment of the input polygons starting at \p segment_start_idx.
+     *
+     * \param segment_start_idx The start of a line segment of the input polygons
+     * \param[out] result Where to append the start point of each of the line segments
      */
-    void findProximatePoints(const ListPolyIt a_point_it, ListPolygon& to_list_poly, const ListPolyIt b_from_it, const ListPolyIt b_to_it);
+    void addSegmentPoints(const unsigned int segment_start_idx, std::vector<unsigned int>& result) const;
 
     /*!
      * Add a new point to the polygon on a line segment between \p line_start and \p line_end
-     * 
+     *
      * Don't add the point if it's already the same as either of the end points of the line segment.
-     * 
+     *
      * \param point The point to insert
      * \param line_start The start of the line segment on which to insert
      * \param line_end The end of the line segment on which to insert
      * \param before_this Either \p line_start or \p line_end such that inserting the new point before \p before_this results in the point being in between the two
-     * \return An iterator to the newly inserted point, or an existing point if \p coincided with either end point of the line
+     * \return The index of the newly inserted point, or an existing point if \p coincided with either end point of the line
      */
-    ListPolyIt addNewPolyPoint(const Point point, const ListPolyIt line_start, const ListPolyIt line_end, const ListPolyIt before_this);
+    unsigned int addNewPolyPoint(const Point point, const unsigned int line_start, const unsigned int line_end, const unsigned int before_this);
 
     /*!
-     * Add a link between \p from and \p to to PolygonProximityLinker::overlap_point_links and add the appropriate mappings to PolygonProximityLinker::point_to_link
-     * 
+     * Add a link between \p from and \p to to PolygonProximityLinker::links and add the appropriate entries to PolygonProximityLinker::point_link_table
+     *
      * \param from The one point of the link
      * \param to The other point of the link
      * \param dist The distance between the two points
      * \param type The type of the link being introduced
      * \return Whether the point has been added
      */
-    bool addProximityLink(ListPolyIt from, ListPolyIt to, int64_t dist, const ProximityPointLinkType type);
-
+    bool addProximityLink(unsigned int from, unsigned int to, int64_t dist, const ProximityPointLinkType type);
 
     /*!
-     * Add a link for the corner at \p corner_point to PolygonProximityLinker::overlap_point_links and add the appropriate mappings to PolygonProximityLinker::point_to_link
-     * 
+     * Add a link for the corner at \p corner_point to PolygonProximityLinker::links and add the appropriate entry to PolygonProximityLinker::point_link_table
+     *
      * This is done by adding a link between the point and itself.
-     * 
+     *
      * \param corner_point The one point of the link
      * \param type The type of the link being introduced
      * \return Whether the point has been added
      */
-    bool addCornerLink(ListPolyIt corner_point, const ProximityPointLinkType type);
+    bool addCornerLink(unsigned int corner_point, const ProximityPointLinkType type);
 
     /*!
      * Add links for the ending points of proximity regions, supporting the residual triangles.
+     *
+     * The points inserted for one ending become the neighbours seen by the links processed after it,
+     * so where endings meet (e.g. the small polygons of the extra bottom insets of a spiralized print) the result depends on the order of the links.
+     * The links are processed in the order in which they were created, which doesn't depend on the size of any hash table.
      */
     void addProximityEndings();
 
     /*!
      * Add a link for the ending point of a given proximity region, if it is an ending.
-     * 
-     * \param link_pair The link which might be an ending
-     * \param a_next The next point from ListPolyIt::a of \p link 
-     * \param b_next The next point from ListPolyIt::b of \p link (in the opposite direction of \p a_next)
-     * \param a_before_middle Where to insert a new point for a if this is indeed en ending
-     * \param b_before_middle Where to insert a new point for b if this is indeed en ending
+     *
+     * \param link The link which might be an ending
+     * \param a2_idx The next point from ProximityPointLink::a of \p link
+     * \param b2_idx The next point from ProximityPointLink::b of \p link (in the opposite direction of \p a2_idx)
+     * \param a_after_middle Where to insert a new point for a if this is indeed en ending
+     * \param b_after_middle Where to insert a new point for b if this is indeed en ending
      * \param[out] result Where to store a link if a new one has been generated
      */
-    void addProximityEnding(const ProximityPointLink& link, const ListPolyIt& a_next, const ListPolyIt& b_next, const ListPolyIt& a_before_middle, const ListPolyIt& b_before_middle, ProximityPointLinks& result);
+    void addProximityEnding(const ProximityPointLink& link, const unsigned int a2_idx, const unsigned int b2_idx, const unsigned int a_after_middle, const unsigned int b_after_middle, std::vector<ProximityPointLink>& result);
 
     /*!
      * Compute the distance between the points of the last link and the points introduced to account for the proximity endings.
      */
-    int64_t proximityEndingDistance(Point& a1, Point& a2, Point& b1, Point& b2, int a1b1_dist);
+    int64_t proximityEndingDistance(const Point& a1, const Point& a2, const Point& b1, const Point& b2, int a1b1_dist);
 
     /*!
      * Add proximity links for sharp corners, so that the proximity of two consecutive line segments is compensated for.
-     * 
-     * Currently UNIMPLEMENTED.
      */
     void addSharpCorners();
 
     /*!
-     * Map a point to a link in PolygonProximityLinker::point_to_link
-     * 
-     * \param p The key
-     * \param it The value
+     * Convert the rings of PolygonProximityLinker::points into PolygonProximityLinker::polygons.
+     */
+    void createPolygons();
+
+    /*!
+     * Add an entry for \p link_idx to PolygonProximityLinker::link_table and PolygonProximityLinker::point_link_table, which must have free slots.
      */
-    void addToPoint2LinkMap(Point p, ProximityPointLinks::iterator it);
+    void insertLinkTableEntries(unsigned int link_idx);
+
+    /*!
+     * Resize PolygonProximityLinker::link_table and PolygonProximityLinker::point_link_table and insert the entries of all links again.
+     *
+     * \param size The new size of PolygonProximityLinker::link_table, a power of two
+     */
+    void resizeLinkTables(size_t size);
+
+    static uint32_t pointHash(const Point& p);
+    static uint32_t pointPairHash(unsigned int a, unsigned int b); //!< Symmetric in \p a and \p b
 
 public:
     void proximity2HTML(const char* filename) const; //!< debug
 
     /*!
      * Computes the neccesary priliminaries in order to efficiently compute the flow when generatign gcode paths.
-     * \param polygons The wall polygons for which to compute the overlaps
+     * \param input_polygons The wall polygons for which to compute the overlaps
+     * \param proximity_distance The distance below which line segments are linked
+     */
+    PolygonProximityLinker(const Polygons& input_polygons, int proximity_distance);
+
+    /*!
+     * The input polygons with the points inserted by the linker.
+     */
+    Polygons& getPolygons()
+    {
+        return polygons;
+    }
+
+    /*!
+     * Get a point of the polygons.
+     * \param point_idx The index of the point, as stored in the links
+     */
+    const PolyPoint& getPoint(unsigned int point_idx) const
+    {
+        return points[point_idx];
+    }
+
+    /*!
+     * Get a link by its index.
      */
-    PolygonProximityLinker(Polygons& polygons, int proximity_distance);
+    const ProximityPointLink& getLink(unsigned int link_idx) const
+    {
+        return links[link_idx];
+    }
 
     /*!
      * Check whether a point has any links
      * \param from the point for which to check whether it has any links
      * \return Whether a link has been created between the point and another point
      */
-    bool isLinked(Point from);
+    bool isLinked(Point from) const;
 
     /*!
-     * Get all links connected to a given point.
-     * 
-     * The returned pair is an iterator range;
-     * The first is the starting iterator (inclusive)
-     * and the second is the end iterator (exclusive).
-     * 
-     * Note that the returned iterators point to a pair,
-     * for which the second is the actual link.
-     * The first is \p from
-     * 
-     * \param from The point to get all connected links for
-     * \return a pair containing two iterators
+     * Call \p process_func with the index of every link connected to a given location, in the order in which the links were created.
+     *
+     * A link between two different points which are both at \p from is processed twice.
+     *
+     * \param from The location to get all connected links for
+     * \param process_func The function to call with each link index
      */
-    std::pair<PolygonProximityLinker::Point2Link::iterator, PolygonProximityLinker::Point2Link::iterator> getLinks(Point from);
+    template<typename Function>
+    void processLinks(Point from, Function process_func) const
+    {
+        const size_t mask = point_link_table.size() - 1;
+        for (size_t slot = pointHash(from) & mask; point_link_table[slot].link_idx != no_link; slot = (slot + 1) & mask)
+        {
+            const PointLinkEntry& entry = point_link_table[slot];
+            if (entry.p == from)
+            {
+                process_func(entry.link_idx);
+            }
+        }
+    }
 
     /*!
      * Check whether two points are linked
-     * \param a an iterator to the first point (in \ref PolygonProximityLinker::list_polygons)
-     * \param b an iterator to the second point (in \ref PolygonProximityLinker::list_polygons)
+     * \param a the index of the first point
+     * \param b the index of the second point
      * \return Whether a link has been created between the two points
      */
-    bool isLinked(ListPolyIt a, ListPolyIt b);
+    bool isLinked(unsigned int a, unsigned int b) const;
 
     /*!
      * Get the link between two points if they are linked already
-     * \param a an iterator to the first point (in \ref PolygonProximityLinker::list_polygons)
-     * \param b an iterator to the second point (in \ref PolygonProximityLinker::list_polygons)
-     * \return The link between the two points, or nullptr
+     * \param a the index of the first point
+     * \param b the index of the second point
+     * \return The index of the link between the two points, or PolygonProximityLinker::no_link
      */
-    const ProximityPointLink* getLink(ListPolyIt a, ListPolyIt b);
+    unsigned int findLink(unsigned int a, unsigned int b) const;
 };
 
 
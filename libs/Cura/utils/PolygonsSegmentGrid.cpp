@@ -0,0 +1,221 @@
+/** Copyright (C) 2017 Ultimaker - Released under terms of the AGPLv3 License */
+#include "PolygonsSegmentGrid.h"
+
+#include <algorithm> // sort, unique
+#include <cmath> // sqrt
+
+#include "AABB.h"
+#include "linearAlg2D.h"
+
+namespace cura
+{
+
+PolygonsSegmentGrid::PolygonsSegmentGrid(const Polygons& polygons)
+: polygons(polygons)
+, grid_min(0, 0)
+, cell_size(1)
+, width(0)
+, height(0)
+{
+    size_t segment_count = 0;
+    for (unsigned int poly_idx = 0; poly_idx < polygons.size(); poly_idx++)
+    {
+        segment_count += polygons[poly_idx].size();
+    }
+    if (segment_count == 0)
+    {
+        cell_starts.push_back(0);
+        return;
+    }
+
+    const AABB aabb(polygons);
+    const coord_t size_x = aabb.max.X - aabb.min.X;
+    const coord_t size_y = aabb.max.Y - aabb.min.Y;
+    constexpr coord_t min_cell_size = 100; // much larger than the rounding errors of the queries
+    cell_size = std::max(min_cell_size, coord_t(std::sqrt(double(std::max(size_x, coord_t(1))) * double(std::max(size_y, coord_t(1))) / segment_count)));
+    grid_min = aabb.min;
+    width = size_x / cell_size + 1;
+    height = size_y / cell_size + 1;
+
+    // count the segments in each cell and then fill the cells, so that all cells are stored in a single vector
+    cell_starts.assign(size_t(width) * height + 1, 0);
+    auto forEachCell = [this](const PolygonRef poly, unsigned int point_idx, std::function<void(unsigned int)> cell_function)
+        {
+            const Point& start = poly[point_idx];
+            const Point& end = poly[(point_idx + 1) % poly.size()];
+            const int min_x = toCellX(std::min(start.X, end.X));
+            const int max_x = toCellX(std::max(start.X, end.X));
+            const int min_y = toCellY(std::min(start.Y, end.Y));
+            const int max_y = toCellY(std::max(start.Y, end.Y));
+            for (int y = min_y; y <= max_y; y++)
+            {
+                for (int x = min_x; x <= max_x; x++)
+                {
+                    cell_function(y * width + x);
+                }
+            }
+        };
+    for (unsigned int poly_idx = 0; poly_idx < polygons.size(); poly_idx++)
+    {
+        const PolygonRef poly = polygons[poly_idx];
+        for (unsigned int point_idx = 0; point_idx < poly.size(); point_idx++)
+        {
+            forEachCell(poly, point_idx, [this](unsigned int cell_idx) { cell_starts[cell_idx + 1]++; });
+        }
+    }
+    for (size_t cell_idx = 1; cell_idx < cell_starts.size(); cell_idx++)
+    {
+        cell_starts[cell_idx] += cell_starts[cell_idx - 1];
+    }
+    cell_segments.resize(cell_starts.back());
+    std::vector<unsigned int> cell_fill(cell_starts.begin(), cell_starts.end() - 1);
+    for (unsigned int poly_idx = 0; poly_idx < polygons.size(); poly_idx++)
+    {
+        const PolygonRef poly = polygons[poly_idx];
+        for (unsigned int point_idx = 0; point_idx < poly.size(); point_idx++)
+        {
+            const Segment segment{poly_idx, point_idx};
+            forEachCell(poly, point_idx, [this, &cell_fill, segment](unsigned int cell_idx) { cell_segments[cell_fill[cell_idx]++] = segment; });
+        }
+    }
+}
+
+int PolygonsSegmentGrid::toCellX(coord_t x) const
+{
+    const coord_t offset = x - grid_min.X;
+    return (offset < 0) ? -1 : std::min(coord_t(width), offset / cell_size);
+}
+
+int PolygonsSegmentGrid::toCellY(coord_t y) const
+{
+    const coord_t offset = y - grid_min.Y;
+    return (offset < 0) ? -1 : std::min(coord_t(height), offset / cell_size);
+}
+
+void PolygonsSegmentGrid::addCellSegments(int min_x, int min_y, int max_x, int max_y, std::vector<Segment>& result) const
+{
+    min_x = std::max(min_x, 0);
+    min_y = std::max(min_y, 0);
+    max_x = std::min(max_x, width - 1);
+    max_y = std::min(max_y, height - 1);
+    for (int y = min_y; y <= max_y; y++)
+    {
+        const unsigned int row_start = cell_starts[y * width + min_x];
+        const unsigned int row_end = cell_starts[y * width + max_x + 1]; // the cells of a row are stored next to each other
+        result.insert(result.end(), cell_segments.begin() + row_start, cell_segments.begin() + row_end);
+    }
+}
+
+void PolygonsSegmentGrid::sortUnique(std::vector<Segment>& segments)
+{
+    std::sort(segments.begin(), segments.end());
+    segments.erase(std::unique(segments.begin(), segments.end()), segments.end());
+}
+
+void PolygonsSegmentGrid::getSegmentsNear(Point location, coord_t radius, std::vector<Segment>& result) const
+{
+    result.clear();
+    if (cell_segments.empty())
+    {
+        return;
+    }
+    addCellSegments(toCellX(location.X - radius), toCellY(location.Y - radius), toCellX(location.X + radius), toCellY(location.Y + radius), result);
+    sortUnique(result);
+}
+
+void PolygonsSegmentGrid::getSegmentsNearLine(Point a, Point b, std::vector<Segment>& result) const
+{
+    result.clear();
+    if (cell_segments.empty())
+    {
+        return;
+    }
+    if (b.X < a.X)
+    {
+        std::swap(a, b);
+    }
+    // for each column the line passes through, visit the rows between the Y coordinates of the line at both sides of the column
+    const int first_x = toCellX(a.X) - 1;
+    const int last_x = toCellX(b.X) + 1;
+    for (int x = std::max(first_x, 0); x <= std::min(last_x, width - 1); x++)
+    {
+        const coord_t column_start = std::min(b.X, std::max(a.X, grid_min.X + x * cell_size));
+        const coord_t column_end = std::max(a.X, std::min(b.X, grid_min.X + (x + 1) * cell_size));
+        coord_t y_start = a.Y;
+        coord_t y_end = b.Y;
+        if (b.X != a.X)
+        {
+            y_start = a.Y + (b.Y - a.Y) * (column_start - a.X) / (b.X - a.X);
+            y_end = a.Y + (b.Y - a.Y) * (column_end - a.X) / (b.X - a.X);
+        }
+        addCellSegments(x, toCellY(std::min(y_start, y_end)) - 1, x, toCellY(std::max(y_start, y_end)) + 1, result);
+    }
+    sortUnique(result);
+}
+
+bool PolygonsSegmentGrid::collidesWithLineSegment(Point start_point, Point end_point) const
+{
+    const PointMatrix transformation_matrix(end_point - start_point);
+    const Point transformed_start_point = transformation_matrix.apply(start_point);
+    const Point transformed_end_point = transformation_matrix.apply(end_point);
+
+    std::vector<Segment> segments;
+    getSegmentsNearLine(start_point, end_point, segments);
+    for (const Segment& segment : segments)
+    {
+        const PolygonRef poly = polygons[segment.poly_idx];
+        const Point p0 = transformation_matrix.apply(poly[segment.point_idx]);
+        const Point p1 = transformation_matrix.apply(poly[(segment.point_idx + 1) % poly.size()]);
+        if (PolygonUtils::segmentCollidesWithTransformedLine(p0, p1, transformed_start_point, transformed_end_point))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+ClosestPolygonPoint PolygonsSegmentGrid::findClosest(Point from) const
+{
+    if (polygons.size() == 0 || polygons[0].size() == 0)
+    {
+        return PolygonUtils::findClosest(from, polygons);
+    }
+
+    // search ever larger squares until the closest segment is within the square
+    std::vector<Segment> segments;
+    for (coord_t radius = cell_size; ; radius *= 2)
+    {
+        const int min_x = toCellX(from.X - radius);
+        const int min_y = toCellY(from.Y - radius);
+        const int max_x = toCellX(from.X + radius);
+        const int max_y = toCellY(from.Y + radius);
+        segments.clear();
+        addCellSegments(min_x, min_y, max_x, max_y, segments);
+
+        bool found = false;
+        Segment best{0, 0};
+        Point best_location;
+        int64_t best_dist2 = std::numeric_limits<int64_t>::max();
+        for (const Segment& segment : segments)
+        {
+            const PolygonRef poly = polygons[segment.poly_idx];
+            const Point closest_here = LinearAlg2D::getClosestOnLineSegment(from, poly[segment.point_idx], poly[(segment.point_idx + 1) % poly.size()]);
+            const int64_t dist2 = vSize2(from - closest_here);
+            // of equally close segments, the one which comes first in the polygons is the closest, like when checking all segments in order
+            if (dist2 < best_dist2 || (dist2 == best_dist2 && segment < best))
+            {
+                found = true;
+                best = segment;
+                best_location = closest_here;
+                best_dist2 = dist2;
+            }
+        }
+        const bool covers_grid = min_x <= 0 && min_y <= 0 && max_x >= width - 1 && max_y >= height - 1;
+        if ((found && best_dist2 <= radius * radius) || covers_grid)
+        { // all segments at least as close as the best one overlap the square
+            return ClosestPolygonPoint(best_location, best.point_idx, polygons[best.poly_idx], best.poly_idx);
+        }
+    }
+}
+
+}//namespace cura
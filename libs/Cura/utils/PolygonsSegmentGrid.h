@@ -0,0 +1,118 @@
+/** Copyright (C) 2017 Ultimaker - Released under terms of the AGPLv3 License */
+#ifndef UTILS_POLYGONS_SEGMENT_GRID_H
+#define UTILS_POLYGONS_SEGMENT_GRID_H
+
+#include <vector>
+
+#include "polygon.h"
+#include "polygonUtils.h" // ClosestPolygonPoint
+#include "NoCopy.h"
+
+namespace cura
+{
+
+/*!
+ * A uniform grid over the line segments of some polygons, to find the segments near a location or a line without looking at all of them.
+ *
+ * Each segment is stored in all cells overlapping its bounding box.
+ * Queries visit the cells around the queried location or line, widened by a cell in each direction,
+ * so that segments which only touch the line because of rounding errors are found as well.
+ *
+ * The queries give exactly the same results as the corresponding functions of \ref PolygonUtils which look at all segments.
+ *
+ * The polygons should not change while the grid is used.
+ */
+class PolygonsSegmentGrid : NoCopy
+{
+public:
+    /*!
+     * A line segment from a point of a polygon to the next point.
+     */
+    struct Segment
+    {
+        unsigned int poly_idx;
+        unsigned int point_idx; //!< The index of the start of the segment
+
+        bool operator<(const Segment& other) const
+        {
+            return poly_idx < other.poly_idx || (poly_idx == other.poly_idx && point_idx < other.point_idx);
+        }
+        bool operator==(const Segment& other) const
+        {
+            return poly_idx == other.poly_idx && point_idx == other.point_idx;
+        }
+    };
+
+    /*!
+     * Insert all segments of \p polygons in a grid with about as many cells as segments.
+     *
+     * \param polygons The polygons, which should outlive the grid
+     */
+    PolygonsSegmentGrid(const Polygons& polygons);
+
+    const Polygons& getPolygons() const
+    {
+        return polygons;
+    }
+
+    /*!
+     * Get all segments which may be within \p radius of a location, sorted by polygon and point index.
+     *
+     * \param location The location around which to look
+     * \param radius The distance from \p location within which all segments are found
+     * \param[out] result Where to put the segments
+     */
+    void getSegmentsNear(Point location, coord_t radius, std::vector<Segment>& result) const;
+
+    /*!
+     * Get all segments which may be close to a line segment, sorted by polygon and point index.
+     *
+     * \param a One end of the line segment
+     * \param b The other end of the line segment
+     * \param[out] result Where to put the segments
+     */
+    void getSegmentsNearLine(Point a, Point b, std::vector<Segment>& result) const;
+
+    /*!
+     * Whether the line segment collides with the polygons.
+     *
+     * Same as \ref PolygonUtils::polygonCollidesWithlineSegment on all polygons.
+     */
+    bool collidesWithLineSegment(Point start_point, Point end_point) const;
+
+    /*!
+     * Find the closest point on the polygons.
+     *
+     * Same as \ref PolygonUtils::findClosest on all polygons without a penalty function.
+     *
+     * \param from The location to find the closest point to
+     */
+    ClosestPolygonPoint findClosest(Point from) const;
+
+private:
+    const Polygons& polygons;
+    Point grid_min; //!< The lower corner of the first cell
+    coord_t cell_size;
+    int width; //!< The number of cells in X direction
+    int height; //!< The number of cells in Y direction
+    std::vector<unsigned int> cell_starts; //!< For each cell the index of its first segment in PolygonsSegmentGrid::cell_segments, followed by the end of the last cell
+    std::vector<Segment> cell_segments; //!< The segments of all cells one after the other
+
+    int toCellX(coord_t x) const; //!< The column containing an X coordinate, which may lie outside the grid
+    int toCellY(coord_t y) const; //!< The row containing a Y coordinate, which may lie outside the grid
+
+    /*!
+     * Add the segments of the cells in a rectangle of cells to \p result.
+     *
+     * The rectangle is clipped to the grid.
+     */
+    void addCellSegments(int min_x, int min_y, int max_x, int max_y, std::vector<Segment>& result) const;
+
+    /*!
+     * Sort segments and remove duplicates.
+     */
+    static void sortUnique(std::vector<Segment>& segments);
+};
+
+}//namespace cura
+#endif//UTILS_POLYGONS_SEGMENT_GRID_H
@@ -4,7 +4,7 @@
 namespace cura 
 {
 
-ProximityPointLink::ProximityPointLink(const ListPolyIt a, const ListPolyIt b, int dist, const ProximityPointLinkType type)
+ProximityPointLink::ProximityPointLink(const unsigned int a, const unsigned int b, int dist, const ProximityPointLinkType type)
 : a(a)
 , b(b)
 , dist(dist)
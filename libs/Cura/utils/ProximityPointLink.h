@@ -2,21 +2,6 @@
 #ifndef PROXIMITY_POINT_LINK_H
 #define PROXIMITY_POINT_LINK_H
 
-#include <vector>
-#include <unordered_map>
-#include <unordered_set>
-#include <list>
-#include <utility> // pair
-
-#include <functional> // hash function object
-
-#include "intpoint.h"
-#include "polygon.h"
-#include "linearAlg2D.h"
-#include "optional.h"
-
-#include "ListPolyIt.h"
-
 namespace cura 
 {
 
@@ -37,27 +22,14 @@ enum class ProximityPointLinkType
  */
 struct ProximityPointLink
 {
-    const ListPolyIt a; //!< the one point (invalidated after list_polygons have been cleared!)
-    const ListPolyIt b; //!< the other point (invalidated after list_polygons have been cleared!)
+    const unsigned int a; //!< the index of the one point in PolygonProximityLinker::points
+    const unsigned int b; //!< the index of the other point in PolygonProximityLinker::points
     const int dist; //!< The distance between the two points
     const ProximityPointLinkType type; //!< The type of link; why/how it was created
-    ProximityPointLink(const ListPolyIt a, const ListPolyIt b, int dist, const ProximityPointLinkType type);
+    ProximityPointLink(const unsigned int a, const unsigned int b, int dist, const ProximityPointLinkType type);
     bool operator==(const ProximityPointLink& other) const;
 };
 
 }//namespace cura
 
-namespace std
-{
-template <>
-struct hash<cura::ProximityPointLink>
-{
-    size_t operator()(const cura::ProximityPointLink & pp) const
-    { // has to be symmetric wrt a and b!
-        return std::hash<cura::Point>()(pp.a.p()) + std::hash<cura::Point>()(pp.b.p());
-    }
-};
-}//namespace std
-
-
 #endif//PROXIMITY_POINT_LINK_H
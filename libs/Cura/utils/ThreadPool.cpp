@@ -0,0 +1,205 @@
+/** Copyright (C) 2017 Ultimaker - Released under terms of the AGPLv3 License */
+#include "ThreadPool.h"
+
+#include <algorithm> // min
+
+namespace cura
+{
+
+namespace
+{
+thread_local bool inside_loop = false; //!< Whether this thread is a worker or is running a loop, in which case nested loops run serially
+}//anonymous namespace
+
+ThreadPool::ThreadPool(unsigned int thread_count)
+: next_index(0)
+{
+    if (thread_count == 0)
+    {
+        thread_count = std::max(1U, std::thread::hardware_concurrency());
+    }
+    for (unsigned int worker_idx = 1; worker_idx < thread_count; worker_idx++)
+    {
+        workers.emplace_back(&ThreadPool::workerMain, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        stopping = true;
+    }
+    loop_started.notify_all();
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::getInstance()
+{
+    static ThreadPool instance(0);
+    return instance;
+}
+
+void ThreadPool::parallel_for(size_t begin, size_t end, const std::function<void(size_t)>& body, size_t chunk_size)
+{
+    if (begin >= end)
+    {
+        return;
+    }
+    std::unique_lock<std::mutex> loop_lock(loop_mutex, std::defer_lock);
+    if (workers.empty() || inside_loop || end - begin <= chunk_size || !loop_lock.try_lock())
+    {
+        for (size_t index = begin; index < end; index++)
+        {
+            body(index);
+        }
+        return;
+    }
+
+    startLoop(begin, end, body, chunk_size);
+
+    inside_loop = true;
+    runIterations();
+    inside_loop = false;
+
+    std::exception_ptr loop_error = finishLoop();
+    if (loop_error)
+    {
+        std::rethrow_exception(loop_error);
+    }
+}
+
+void ThreadPool::startLoop(size_t begin, size_t end, const std::function<void(size_t)>& body, size_t chunk_size)
+{
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        this->body = &body;
+        next_index = begin;
+        end_index = end;
+        this->chunk_size = std::max(size_t(1), chunk_size);
+        error = nullptr;
+        busy_workers = workers.size();
+        loop_generation++;
+    }
+    loop_started.notify_all();
+}
+
+std::exception_ptr ThreadPool::finishLoop()
+{
+    std::unique_lock<std::mutex> lock(state_mutex);
+    loop_finished.wait(lock, [this]() { return busy_workers == 0; });
+    this->body = nullptr;
+    return error;
+}
+
+ThreadPool::BackgroundLoop::BackgroundLoop(ThreadPool& pool, size_t begin, size_t end, std::function<void(size_t)> body, size_t chunk_size)
+: body(std::move(body))
+, loop_lock(pool.loop_mutex, std::defer_lock)
+{
+    if (begin >= end)
+    {
+        return;
+    }
+    if (pool.workers.empty() || inside_loop || !loop_lock.try_lock())
+    {
+        for (size_t index = begin; index < end; index++)
+        {
+            this->body(index);
+        }
+        return;
+    }
+    this->pool = &pool;
+    pool.startLoop(begin, end, this->body, chunk_size);
+    inside_loop = true; // loops started meanwhile by this thread can't use the workers
+}
+
+ThreadPool::BackgroundLoop::~BackgroundLoop()
+{
+    try
+    {
+        wait();
+    }
+    catch (...)
+    {
+    }
+}
+
+void ThreadPool::BackgroundLoop::wait()
+{
+    if (!pool)
+    {
+        return;
+    }
+    std::exception_ptr loop_error = pool->finishLoop();
+    pool = nullptr;
+    inside_loop = false;
+    loop_lock.unlock();
+    if (loop_error)
+    {
+        std::rethrow_exception(loop_error);
+    }
+}
+
+void ThreadPool::workerMain()
+{
+    inside_loop = true;
+    unsigned int seen_generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(state_mutex);
+            loop_started.wait(lock, [this, seen_generation]() { return stopping || loop_generation != seen_generation; });
+            if (stopping)
+            {
+                return;
+            }
+            seen_generation = loop_generation;
+        }
+
+        runIterations();
+
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            busy_workers--;
+            if (busy_workers == 0)
+            {
+                loop_finished.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::runIterations()
+{
+    while (true)
+    {
+        const size_t chunk_begin = next_index.fetch_add(chunk_size);
+        if (chunk_begin >= end_index)
+        {
+            return;
+        }
+        const size_t chunk_end = std::min(chunk_begin + chunk_size, end_index);
+        try
+        {
+            for (size_t index = chunk_begin; index < chunk_end; index++)
+            {
+                (*body)(index);
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+            next_index = end_index; // don't start any more iterations
+            return;
+        }
+    }
+}
+
+}//namespace cura
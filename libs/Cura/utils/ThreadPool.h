@@ -0,0 +1,137 @@
+/** Copyright (C) 2017 Ultimaker - Released under terms of the AGPLv3 License */
+#ifndef UTILS_THREAD_POOL_H
+#define UTILS_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "NoCopy.h"
+
+namespace cura
+{
+
+/*!
+ * A fixed set of worker threads which run the iterations of parallel loops.
+ *
+ * The thread calling \ref ThreadPool::parallel_for takes part in the loop and the call only returns once every iteration has finished,
+ * so the loop body may refer to local variables of the caller.
+ * Iterations are handed out in increasing order but may finish in any order,
+ * so a body should only write to data owned by its own index and results which have to be deterministic should be combined afterwards.
+ *
+ * A parallel_for called from within a loop body, or while another thread is running a loop on the same pool, runs serially on the calling thread.
+ *
+ * A \ref ThreadPool::BackgroundLoop runs its iterations on the workers only, so that the calling thread can do other work meanwhile.
+ */
+class ThreadPool : NoCopy
+{
+public:
+    /*!
+     * Start the worker threads.
+     *
+     * \param thread_count The number of threads running iterations, including the thread calling parallel_for. Zero means the number of hardware threads.
+     */
+    ThreadPool(unsigned int thread_count);
+
+    ~ThreadPool(); //!< Stops the worker threads
+
+    /*!
+     * The number of threads which run iterations, including the calling thread.
+     *
+     * Useful for splitting work into one range per thread.
+     */
+    unsigned int getThreadCount() const
+    {
+        return workers.size() + 1;
+    }
+
+    /*!
+     * Run \p body for every index in [\p begin, \p end) and wait for all of them to finish.
+     *
+     * If a body throws, no new iterations are started and the first exception is rethrown on the calling thread.
+     *
+     * \param begin The first index
+     * \param end One past the last index
+     * \param body The loop body, called with the index of the iteration
+     * \param chunk_size The number of consecutive iterations a thread takes at a time
+     */
+    void parallel_for(size_t begin, size_t end, const std::function<void(size_t)>& body, size_t chunk_size = 1);
+
+    /*!
+     * The pool shared by the engine, with a thread per hardware thread.
+     */
+    static ThreadPool& getInstance();
+
+    /*!
+     * A loop whose iterations are run by the worker threads, while the thread which started it goes on with other work.
+     *
+     * The loop is waited for at the latest when the object is destroyed, so the body may refer to local variables of the caller which outlive the object.
+     * Until then, loops started by the calling thread run serially on it, like nested loops.
+     * Without worker threads, when started from within a loop body, or while another thread is running a loop on the pool, the loop runs serially in the constructor.
+     */
+    class BackgroundLoop : NoCopy
+    {
+    public:
+        /*!
+         * Start the loop.
+         *
+         * \see ThreadPool::parallel_for
+         */
+        BackgroundLoop(ThreadPool& pool, size_t begin, size_t end, std::function<void(size_t)> body, size_t chunk_size = 1);
+
+        ~BackgroundLoop(); //!< Waits for the loop, an exception thrown by the body is lost unless \ref BackgroundLoop::wait was called
+
+        /*!
+         * Wait for all iterations to finish.
+         *
+         * If a body threw, the first exception is rethrown.
+         */
+        void wait();
+
+    private:
+        ThreadPool* pool = nullptr; //!< The pool running the loop, or nullptr once it is done
+        std::function<void(size_t)> body; //!< Kept here, since the workers refer to it
+        std::unique_lock<std::mutex> loop_lock; //!< Holds the \ref ThreadPool::loop_mutex of \ref BackgroundLoop::pool while the loop runs
+    };
+
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex loop_mutex; //!< Held by the thread running a loop on this pool
+    std::mutex state_mutex; //!< Guards the loop state below
+    std::condition_variable loop_started;
+    std::condition_variable loop_finished;
+
+    const std::function<void(size_t)>* body = nullptr; //!< The body of the current loop
+    std::atomic<size_t> next_index; //!< The next iteration to hand out
+    size_t end_index = 0;
+    size_t chunk_size = 1;
+    std::exception_ptr error; //!< The first exception thrown by the current loop
+    unsigned int loop_generation = 0; //!< Incremented for every loop, so workers can tell a new loop from a spurious wakeup
+    unsigned int busy_workers = 0; //!< The number of workers which haven't finished the current loop yet
+    bool stopping = false;
+
+    void workerMain(); //!< Runs the iterations of every loop until the pool is destroyed
+
+    /*!
+     * Hand out the iterations of a loop to the workers. The calling thread should hold \ref ThreadPool::loop_mutex.
+     */
+    void startLoop(size_t begin, size_t end, const std::function<void(size_t)>& body, size_t chunk_size);
+
+    /*!
+     * Wait for the workers to finish the current loop.
+     *
+     * \return The first exception thrown by the body, if any
+     */
+    std::exception_ptr finishLoop();
+
+    void runIterations(); //!< Runs chunks of the current loop until none are left
+};
+
+}//namespace cura
+#endif//UTILS_THREAD_POOL_H
@@ -58,18 +58,15 @@ Polygons Polygons::approxConvexHull(int extra_outset)
     constexpr int overshoot = 100000; //10cm (hard-coded value).
 
     Polygons convex_hull;
+    PolygonsBatch batch;
     //Perform the offset for each polygon one at a time.
     //This is necessary because the polygons may overlap, in which case the offset could end up in an infinite loop.
     //See http://www.angusj.com/delphi/clipper/documentation/Docs/Units/ClipperLib/Classes/ClipperOffset/_Body.htm
-    for (const ClipperLib::Path path : paths)
+    for (unsigned int poly_idx = 0; poly_idx < size(); poly_idx++)
     {
-        Polygons offset_result;
-        ClipperLib::ClipperOffset offsetter(1.2, 10.0);
-        offsetter.AddPath(path, ClipperLib::jtRound, ClipperLib::etClosedPolygon);
-        offsetter.Execute(offset_result.paths, overshoot);
-        convex_hull.add(offset_result);
+        convex_hull.add(batch.offset((*this)[poly_idx], overshoot, ClipperLib::jtRound));
     }
-    return convex_hull.unionPolygons().offset(-overshoot + extra_outset, ClipperLib::jtRound);
+    return batch.offset(batch.unionPolygons(convex_hull), -overshoot + extra_outset, ClipperLib::jtRound);
 }
 
 unsigned int Polygons::pointCount() const
@@ -176,22 +173,69 @@ unsigned int Polygons::findInside(Point p, bool border_result)
 }
 
 Polygons Polygons::offset(int distance, ClipperLib::JoinType join_type, double miter_limit) const
+{
+    return PolygonsBatch().offset(*this, distance, join_type, miter_limit);
+}
+
+Polygons PolygonRef::offset(int distance, ClipperLib::JoinType joinType, double miter_limit) const
+{
+    return PolygonsBatch().offset(*this, distance, joinType, miter_limit);
+}
+
+Polygons PolygonsBatch::difference(const Polygons& subject, const Polygons& clip)
 {
     Polygons ret;
-    ClipperLib::ClipperOffset clipper(miter_limit, 10.0);
-    clipper.AddPaths(unionPolygons().paths, join_type, ClipperLib::etClosedPolygon);
-    clipper.MiterLimit = miter_limit;
-    clipper.Execute(ret.paths, distance);
+    clipper->AddPaths(subject.paths, ClipperLib::ptSubject, true);
+    clipper->AddPaths(clip.paths, ClipperLib::ptClip, true);
+    clipper->Execute(ClipperLib::ctDifference, ret.paths);
+    clipper->Clear();
     return ret;
 }
 
-Polygons PolygonRef::offset(int distance, ClipperLib::JoinType joinType, double miter_limit) const
+Polygons PolygonsBatch::unionPolygons(const Polygons& subject, const Polygons& clip)
+{
+    Polygons ret;
+    clipper->AddPaths(subject.paths, ClipperLib::ptSubject, true);
+    clipper->AddPaths(clip.paths, ClipperLib::ptSubject, true);
+    clipper->Execute(ClipperLib::ctUnion, ret.paths, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    clipper->Clear();
+    return ret;
+}
+
+Polygons PolygonsBatch::unionPolygons(const Polygons& polygons)
+{
+    return unionPolygons(polygons, Polygons());
+}
+
+Polygons PolygonsBatch::intersection(const Polygons& subject, const Polygons& clip)
+{
+    Polygons ret;
+    clipper->AddPaths(subject.paths, ClipperLib::ptSubject, true);
+    clipper->AddPaths(clip.paths, ClipperLib::ptClip, true);
+    clipper->Execute(ClipperLib::ctIntersection, ret.paths);
+    clipper->Clear();
+    return ret;
+}
+
+Polygons PolygonsBatch::offset(const Polygons& polygons, int distance, ClipperLib::JoinType join_type, double miter_limit)
+{
+    Polygons ret;
+    offsetter->AddPaths(unionPolygons(polygons).paths, join_type, ClipperLib::etClosedPolygon);
+    offsetter->MiterLimit = miter_limit;
+    offsetter->ArcTolerance = 10.0;
+    offsetter->Execute(ret.paths, distance);
+    offsetter->Clear();
+    return ret;
+}
+
+Polygons PolygonsBatch::offset(const PolygonRef& polygon, int distance, ClipperLib::JoinType join_type, double miter_limit)
 {
     Polygons ret;
-    ClipperLib::ClipperOffset clipper(miter_limit, 10.0);
-    clipper.AddPath(*path, joinType, ClipperLib::etClosedPolygon);
-    clipper.MiterLimit = miter_limit;
-    clipper.Execute(ret.paths, distance);
+    offsetter->AddPath(*polygon.path, join_type, ClipperLib::etClosedPolygon);
+    offsetter->MiterLimit = miter_limit;
+    offsetter->ArcTolerance = 10.0;
+    offsetter->Execute(ret.paths, distance);
+    offsetter->Clear();
     return ret;
 }
 
@@ -443,11 +487,11 @@ void PolygonRef::simplify(int smallest_line_segment_squared, int allowed_error_d
 Polygons Polygons::getOutsidePolygons() const
 {
     Polygons ret;
-    ClipperLib::Clipper clipper(clipper_init);
+    PooledClipper clipper(clipper_init);
     ClipperLib::PolyTree poly_tree;
     constexpr bool paths_are_closed_polys = true;
-    clipper.AddPaths(paths, ClipperLib::ptSubject, paths_are_closed_polys);
-    clipper.Execute(ClipperLib::ctUnion, poly_tree);
+    clipper->AddPaths(paths, ClipperLib::ptSubject, paths_are_closed_polys);
+    clipper->Execute(ClipperLib::ctUnion, poly_tree);
 
     for (int outer_poly_idx = 0; outer_poly_idx < poly_tree.ChildCount(); outer_poly_idx++)
     {
@@ -460,11 +504,11 @@ Polygons Polygons::getOutsidePolygons() const
 Polygons Polygons::removeEmptyHoles() const
 {
     Polygons ret;
-    ClipperLib::Clipper clipper(clipper_init);
+    PooledClipper clipper(clipper_init);
     ClipperLib::PolyTree poly_tree;
     constexpr bool paths_are_closed_polys = true;
-    clipper.AddPaths(paths, ClipperLib::ptSubject, paths_are_closed_polys);
-    clipper.Execute(ClipperLib::ctUnion, poly_tree);
+    clipper->AddPaths(paths, ClipperLib::ptSubject, paths_are_closed_polys);
+    clipper->Execute(ClipperLib::ctUnion, poly_tree);
 
     bool remove_holes = true;
     removeEmptyHoles_processPolyTreeNode(poly_tree, remove_holes, ret);
@@ -474,11 +518,11 @@ Polygons Polygons::removeEmptyHoles() const
 Polygons Polygons::getEmptyHoles() const
 {
     Polygons ret;
-    ClipperLib::Clipper clipper(clipper_init);
+    PooledClipper clipper(clipper_init);
     ClipperLib::PolyTree poly_tree;
     constexpr bool paths_are_closed_polys = true;
-    clipper.AddPaths(paths, ClipperLib::ptSubject, paths_are_closed_polys);
-    clipper.Execute(ClipperLib::ctUnion, poly_tree);
+    clipper->AddPaths(paths, ClipperLib::ptSubject, paths_are_closed_polys);
+    clipper->Execute(ClipperLib::ctUnion, poly_tree);
 
     bool remove_holes = false;
     removeEmptyHoles_processPolyTreeNode(poly_tree, remove_holes, ret);
@@ -1104,13 +1148,13 @@ Polygons Polygons::smooth2(int remove_length, int min_area)
 std::vector<PolygonsPart> Polygons::splitIntoParts(bool unionAll) const
 {
     std::vector<PolygonsPart> ret;
-    ClipperLib::Clipper clipper(clipper_init);
+    PooledClipper clipper(clipper_init);
     ClipperLib::PolyTree resultPolyTree;
-    clipper.AddPaths(paths, ClipperLib::ptSubject, true);
+    clipper->AddPaths(paths, ClipperLib::ptSubject, true);
     if (unionAll)
-        clipper.Execute(ClipperLib::ctUnion, resultPolyTree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        clipper->Execute(ClipperLib::ctUnion, resultPolyTree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     else
-        clipper.Execute(ClipperLib::ctUnion, resultPolyTree);
+        clipper->Execute(ClipperLib::ctUnion, resultPolyTree);
 
     splitIntoParts_processPolyTreeNode(&resultPolyTree, ret);
     return ret;
@@ -1178,13 +1222,13 @@ PartsView Polygons::splitIntoPartsView(bool unionAll)
 {
     Polygons reordered;
     PartsView partsView(*this);
-    ClipperLib::Clipper clipper(clipper_init);
+    PooledClipper clipper(clipper_init);
     ClipperLib::PolyTree resultPolyTree;
-    clipper.AddPaths(paths, ClipperLib::ptSubject, true);
+    clipper->AddPaths(paths, ClipperLib::ptSubject, true);
     if (unionAll)
-        clipper.Execute(ClipperLib::ctUnion, resultPolyTree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        clipper->Execute(ClipperLib::ctUnion, resultPolyTree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     else
-        clipper.Execute(ClipperLib::ctUnion, resultPolyTree);
+        clipper->Execute(ClipperLib::ctUnion, resultPolyTree);
 
     splitIntoPartsView_processPolyTreeNode(partsView, reordered, &resultPolyTree);
     
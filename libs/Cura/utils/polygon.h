@@ -12,6 +12,8 @@
 #include <list>
 
 #include "intpoint.h"
+#include "ClipperPool.h"
+#include "NoCopy.h"
 
 //#define CHECK_POLY_ACCESS
 #ifdef CHECK_POLY_ACCESS
@@ -314,6 +316,7 @@ public:
 
     friend class Polygons;
     friend class Polygon;
+    friend class PolygonsBatch;
 
 private:
     /*!
@@ -391,10 +394,41 @@ public:
 
 class PolygonsPart;
 
+/*!
+ * Performs a series of boolean operations and offsets with the same pooled Clipper engines,
+ * e.g. for the many small polygons of a layer which are handled one by one.
+ *
+ * The operations give the same results as the corresponding functions of Polygons and PolygonRef,
+ * which perform a batch of a single operation.
+ * A batch should only be used on the thread which created it.
+ */
+class PolygonsBatch : NoCopy
+{
+public:
+    Polygons difference(const Polygons& subject, const Polygons& clip);
+    Polygons unionPolygons(const Polygons& subject, const Polygons& clip);
+    Polygons unionPolygons(const Polygons& polygons); //!< Union all polygons with each other
+    Polygons intersection(const Polygons& subject, const Polygons& clip);
+
+    /*!
+     * Offset the union of \p polygons.
+     */
+    Polygons offset(const Polygons& polygons, int distance, ClipperLib::JoinType join_type = ClipperLib::jtMiter, double miter_limit = 1.2);
+
+    /*!
+     * Offset a single polygon, without making it a union first.
+     */
+    Polygons offset(const PolygonRef& polygon, int distance, ClipperLib::JoinType join_type = ClipperLib::jtMiter, double miter_limit = 1.2);
+private:
+    PooledClipper clipper{clipper_init};
+    PooledClipperOffset offsetter;
+};
+
 class Polygons
 {
     friend class Polygon;
     friend class PolygonRef;
+    friend class PolygonsBatch;
 protected:
     ClipperLib::Paths paths;
 public:
@@ -482,45 +516,30 @@ public:
 
     Polygons difference(const Polygons& other) const
     {
-        Polygons ret;
-        ClipperLib::Clipper clipper(clipper_init);
-        clipper.AddPaths(paths, ClipperLib::ptSubject, true);
-        clipper.AddPaths(other.paths, ClipperLib::ptClip, true);
-        clipper.Execute(ClipperLib::ctDifference, ret.paths);
-        return ret;
+        return PolygonsBatch().difference(*this, other);
     }
     Polygons unionPolygons(const Polygons& other) const
     {
-        Polygons ret;
-        ClipperLib::Clipper clipper(clipper_init);
-        clipper.AddPaths(paths, ClipperLib::ptSubject, true);
-        clipper.AddPaths(other.paths, ClipperLib::ptSubject, true);
-        clipper.Execute(ClipperLib::ctUnion, ret.paths, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
-        return ret;
+        return PolygonsBatch().unionPolygons(*this, other);
     }
     /*!
      * Union all polygons with each other (When polygons.add(polygon) has been called for overlapping polygons)
      */
     Polygons unionPolygons() const
     {
-        return unionPolygons(Polygons());
+        return PolygonsBatch().unionPolygons(*this);
     }
     Polygons intersection(const Polygons& other) const
     {
-        Polygons ret;
-        ClipperLib::Clipper clipper(clipper_init);
-        clipper.AddPaths(paths, ClipperLib::ptSubject, true);
-        clipper.AddPaths(other.paths, ClipperLib::ptClip, true);
-        clipper.Execute(ClipperLib::ctIntersection, ret.paths);
-        return ret;
+        return PolygonsBatch().intersection(*this, other);
     }
     Polygons xorPolygons(const Polygons& other) const
     {
         Polygons ret;
-        ClipperLib::Clipper clipper(clipper_init);
-        clipper.AddPaths(paths, ClipperLib::ptSubject, true);
-        clipper.AddPaths(other.paths, ClipperLib::ptClip, true);
-        clipper.Execute(ClipperLib::ctXor, ret.paths);
+        PooledClipper clipper(clipper_init);
+        clipper->AddPaths(paths, ClipperLib::ptSubject, true);
+        clipper->AddPaths(other.paths, ClipperLib::ptClip, true);
+        clipper->Execute(ClipperLib::ctXor, ret.paths);
         return ret;
     }
 
@@ -530,10 +549,10 @@ public:
     {
         Polygons ret;
         double miterLimit = 1.2;
-        ClipperLib::ClipperOffset clipper(miterLimit, 10.0);
-        clipper.AddPaths(paths, joinType, ClipperLib::etOpenSquare);
-        clipper.MiterLimit = miterLimit;
-        clipper.Execute(ret.paths, distance);
+        PooledClipperOffset clipper(miterLimit, 10.0);
+        clipper->AddPaths(paths, joinType, ClipperLib::etOpenSquare);
+        clipper->MiterLimit = miterLimit;
+        clipper->Execute(ret.paths, distance);
         return ret;
     }
     
@@ -802,9 +821,9 @@ public:
     Polygons processEvenOdd() const
     {
         Polygons ret;
-        ClipperLib::Clipper clipper(clipper_init);
-        clipper.AddPaths(paths, ClipperLib::ptSubject, true);
-        clipper.Execute(ClipperLib::ctUnion, ret.paths);
+        PooledClipper clipper(clipper_init);
+        clipper->AddPaths(paths, ClipperLib::ptSubject, true);
+        clipper->Execute(ClipperLib::ctUnion, ret.paths);
         return ret;
     }
 
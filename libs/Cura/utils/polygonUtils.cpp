@@ -357,7 +357,13 @@ Point PolygonUtils::moveInside(const ClosestPolygonPoint& cpp, const int distanc
 
 ClosestPolygonPoint PolygonUtils::ensureInsideOrOutside(const Polygons& polygons, Point& from, int preferred_dist_inside, int64_t max_dist2, const std::function<int(Point)>& penalty_function)
 {
-    ClosestPolygonPoint closest_polygon_point = moveInside2(polygons, from, preferred_dist_inside, max_dist2, penalty_function);
+    const ClosestPolygonPoint closest_polygon_point = findClosest(from, polygons, penalty_function);
+    return ensureInsideOrOutside(polygons, from, closest_polygon_point, preferred_dist_inside, max_dist2, penalty_function);
+}
+
+ClosestPolygonPoint PolygonUtils::ensureInsideOrOutside(const Polygons& polygons, Point& from, const ClosestPolygonPoint& closest_on_polygons, int preferred_dist_inside, int64_t max_dist2, const std::function<int(Point)>& penalty_function)
+{
+    ClosestPolygonPoint closest_polygon_point = _moveInside2(closest_on_polygons, preferred_dist_inside, from, max_dist2);
     if (closest_polygon_point.point_idx == NO_INDEX)
     {
         return ClosestPolygonPoint(polygons[0]); // we couldn't move inside
@@ -849,20 +855,9 @@ bool PolygonUtils::polygonCollidesWithlineSegment(const PolygonRef poly, Point&
     for(Point p1_ : poly)
     {
         Point p1 = transformation_matrix.apply(p1_);
-        if ((p0.Y >= transformed_startPoint.Y && p1.Y <= transformed_startPoint.Y) || (p1.Y >= transformed_startPoint.Y && p0.Y <= transformed_startPoint.Y))
+        if (segmentCollidesWithTransformedLine(p0, p1, transformed_startPoint, transformed_endPoint))
         {
-            int64_t x;
-            if(p1.Y == p0.Y)
-            {
-                x = p0.X;
-            }
-            else
-            {
-                x = p0.X + (p1.X - p0.X) * (transformed_startPoint.Y - p0.Y) / (p1.Y - p0.Y);
-            }
-            
-            if (x >= transformed_startPoint.X && x <= transformed_endPoint.X)
-                return true;
+            return true;
         }
         p0 = p1;
     }
@@ -219,6 +219,14 @@ public:
      */
     static ClosestPolygonPoint ensureInsideOrOutside(const Polygons& polygons, Point& from, int preferred_dist_inside, int64_t max_dist2 = std::numeric_limits<int64_t>::max(), const std::function<int(Point)>& penalty_function = no_penalty_function);
 
+    /*!
+     * Same as \ref PolygonUtils::ensureInsideOrOutside above, with the point on the polygons closest to \p from already known,
+     * e.g. because it has been found with a grid.
+     * 
+     * \param closest_on_polygons The result of PolygonUtils::findClosest for \p from on \p polygons
+     */
+    static ClosestPolygonPoint ensureInsideOrOutside(const Polygons& polygons, Point& from, const ClosestPolygonPoint& closest_on_polygons, int preferred_dist_inside, int64_t max_dist2 = std::numeric_limits<int64_t>::max(), const std::function<int(Point)>& penalty_function = no_penalty_function);
+
     /*!
     * Find the two points in two polygons with the smallest distance.
     * 
@@ -422,6 +430,37 @@ public:
      */
     static bool polygonCollidesWithlineSegment(const Polygons& polys, Point& startPoint, Point& endPoint);
 
+    /*!
+     * Checks whether a single segment of a polygon collides with a line segment, see \ref PolygonUtils::polygonCollidesWithlineSegment.
+     * 
+     * \param p0 The start of the polygon segment, transformed like the line segment
+     * \param p1 The end of the polygon segment, transformed like the line segment
+     * \param transformed_startPoint The start point transformed such that it is
+     * on the same horizontal line as the end point
+     * \param transformed_endPoint The end point transformed such that it is on
+     * the same horizontal line as the start point
+     * \return whether the line segment collides with the polygon segment
+     */
+    static bool segmentCollidesWithTransformedLine(const Point p0, const Point p1, const Point& transformed_startPoint, const Point& transformed_endPoint)
+    {
+        if ((p0.Y >= transformed_startPoint.Y && p1.Y <= transformed_startPoint.Y) || (p1.Y >= transformed_startPoint.Y && p0.Y <= transformed_startPoint.Y))
+        {
+            int64_t x;
+            if(p1.Y == p0.Y)
+            {
+                x = p0.X;
+            }
+            else
+            {
+                x = p0.X + (p1.X - p0.X) * (transformed_startPoint.Y - p0.Y) / (p1.Y - p0.Y);
+            }
+            
+            if (x >= transformed_startPoint.X && x <= transformed_endPoint.X)
+                return true;
+        }
+        return false;
+    }
+
 private:
     /*!
      * Helper function for PolygonUtils::moveInside2: moves a point \p from which was moved onto \p closest_polygon_point towards inside/outside when it's not already inside/outside by enough distance.
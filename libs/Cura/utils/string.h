@@ -1,8 +1,11 @@
 #ifndef UTILS_STRING_H
 #define UTILS_STRING_H
 
+#include <algorithm> // min
+#include <cmath> // abs, floor, signbit
 #include <ctype.h>
-#include <cstdio> // sprintf
+#include <cstdint>
+#include <cstdio> // snprintf
 #include <sstream> // ostringstream
 
 namespace cura
@@ -21,59 +24,141 @@ static inline int stringcasecompare(const char* a, const char* b)
     return *a - *b;
 }
 
+/*!
+ * Write the decimal digits of an unsigned integer.
+ * 
+ * \param value The integer to write
+ * \param buffer Where to write the digits, with room for at least 20 characters
+ * \return The number of characters written
+ */
+static inline int writeUnsignedToBuffer(uint64_t value, char* buffer)
+{
+    char digits[20];
+    int digit_count = 0;
+    do
+    {
+        digits[digit_count++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    for (int digit_idx = 0; digit_idx < digit_count; digit_idx++)
+    {
+        buffer[digit_idx] = digits[digit_count - 1 - digit_idx];
+    }
+    return digit_count;
+}
+
+/*!
+ * Write an integer in decimal notation, the same as printf's "%d".
+ * 
+ * \param value The integer to write
+ * \param buffer Where to write the number, with room for at least 21 characters
+ * \return The number of characters written
+ */
+static inline int writeIntToBuffer(const int64_t value, char* buffer)
+{
+    if (value < 0)
+    {
+        buffer[0] = '-';
+        return 1 + writeUnsignedToBuffer(-static_cast<uint64_t>(value), buffer + 1);
+    }
+    return writeUnsignedToBuffer(value, buffer);
+}
+
+/*!
+ * Write a fixed point number with \p precision digits after the decimal dot, without trailing zeros.
+ * 
+ * E.g. 12340 with precision 3 is written as "12.34" and 12000 as "12".
+ * 
+ * \param value The number times 10^precision
+ * \param precision The number of digits after the decimal dot, up to 19
+ * \param buffer Where to write the number, with room for at least 21 characters
+ * \return The number of characters written
+ */
+static inline int writeFixedPointToBuffer(const uint64_t value, const unsigned int precision, char* buffer)
+{
+    uint64_t power_of_ten = 1;
+    for (unsigned int digit_idx = 0; digit_idx < precision; digit_idx++)
+    {
+        power_of_ten *= 10;
+    }
+    int pos = writeUnsignedToBuffer(value / power_of_ten, buffer);
+    uint64_t decimals = value % power_of_ten;
+    if (decimals == 0)
+    {
+        return pos;
+    }
+    buffer[pos++] = '.';
+    for (int digit_idx = precision - 1; digit_idx >= 0; digit_idx--)
+    {
+        buffer[pos + digit_idx] = '0' + decimals % 10;
+        decimals /= 10;
+    }
+    pos += precision;
+    while (buffer[pos - 1] == '0')
+    {
+        pos--;
+    }
+    return pos;
+}
+
 /*!
  * Efficient conversion of micron integer type to millimeter string.
  * 
+ * Writes the millimeters without leading zero and without trailing zeros after the decimal dot, e.g. -20 is written as "-.02".
+ * 
  * \param coord The micron unit to convert
- * \param ss The output stream to write the string to
+ * \param buffer Where to write the string, with room for at least 24 characters
+ * \return The number of characters written
  */
-static inline void writeInt2mm(const int64_t coord, std::ostream& ss)
+static inline int writeInt2mmToBuffer(const int64_t coord, char* buffer)
 {
-    char buffer[24];
-    int char_count = sprintf(buffer, "%ld", coord); // convert int to string
-    int end_pos = char_count; // the first character not to write any more
-    int trailing_zeros = 1;
-    while (trailing_zeros < 4 && buffer[char_count - trailing_zeros] == '0')
+    if (coord == 0)
+    { // zero has always been written like this
+        buffer[0] = '.';
+        buffer[1] = '0';
+        buffer[2] = '0';
+        return 3;
+    }
+    int pos = 0;
+    uint64_t micron = coord;
+    if (coord < 0)
+    {
+        buffer[pos++] = '-';
+        micron = -micron;
+    }
+    const uint64_t mm = micron / 1000;
+    const unsigned int decimals = micron % 1000;
+    if (mm > 0)
     {
-        trailing_zeros++;
+        pos += writeUnsignedToBuffer(mm, buffer + pos);
     }
-    trailing_zeros--;
-    end_pos = char_count - trailing_zeros;
-    if (trailing_zeros == 3)
+    if (decimals == 0)
     { // no need to write the decimal dot
-        buffer[char_count - trailing_zeros] = '\0';
-        ss << buffer;
-        return;
+        return pos;
     }
-    if (char_count <= 3)
+    buffer[pos++] = '.';
+    buffer[pos++] = '0' + decimals / 100;
+    if (decimals % 100 != 0)
     {
-        int start = 0; // where to start writing from the buffer
-        if (coord < 0)
+        buffer[pos++] = '0' + decimals / 10 % 10;
+        if (decimals % 10 != 0)
         {
-            ss << '-';
-            start = 1;
+            buffer[pos++] = '0' + decimals % 10;
         }
-        ss << '.';
-        for (int nulls = char_count - start; nulls < 3; nulls++)
-        { // fill up to 3 decimals with zeros
-            ss << '0';
-        }
-        buffer[char_count - trailing_zeros] = '\0';
-        ss << (static_cast<char*>(buffer) + start);
-    }
-    else
-    {
-        char prev = '.';
-        int pos;
-        for (pos = char_count - 3; pos <= end_pos; pos++)
-        { // shift all characters and insert the decimal dot
-            char next_prev = buffer[pos];
-            buffer[pos] = prev;
-            prev = next_prev;
-        }
-        buffer[pos] = '\0';
-        ss << buffer;
     }
+    return pos;
+}
+
+/*!
+ * Efficient conversion of micron integer type to millimeter string.
+ * 
+ * \param coord The micron unit to convert
+ * \param ss The output stream to write the string to
+ */
+static inline void writeInt2mm(const int64_t coord, std::ostream& ss)
+{
+    char buffer[24];
+    ss.write(buffer, writeInt2mmToBuffer(coord, buffer));
 }
 
 /*!
@@ -91,27 +176,54 @@ struct MMtoStream
 };
 
 /*!
- * Efficient writing of a double to a stringstream
+ * Efficient writing of a double
  * 
- * writes with \p precision digits after the decimal dot, but removes trailing zeros
+ * writes with \p precision digits after the decimal dot, but removes trailing zeros.
+ * The result is the same as that of printf's "%.xf" with x digits, including the rounding of values halfway between two outputs.
  * 
- * \warning only works with precision up to 9 and input up to 10^14
+ * Most values are converted using integer arithmetic.
+ * Values too close to halfway between two outputs to tell which way the exact value rounds, very large values, infinity and NaN are converted with snprintf.
+ * 
+ * \warning only works with precision up to 9
  * 
  * \param precision The number of (non-zero) digits after the decimal dot
  * \param coord double to output
- * \param ss The output stream to write the string to
+ * \param buffer Where to write the string, with room for at least 32 characters
+ * \return The number of characters written
  */
-static inline void writeDoubleToStream(const unsigned int precision, const double coord, std::ostream& ss)
+static inline int writeDoubleToBuffer(const unsigned int precision, const double coord, char* buffer)
 {
+    static const uint64_t powers_of_ten[10] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+    if (precision < 10)
+    {
+        const double scaled = std::abs(coord) * powers_of_ten[precision];
+        if (scaled < 1e15) // false for NaN
+        {
+            const double rounded_down = std::floor(scaled);
+            const double fraction = scaled - rounded_down;
+            // scaling is off by at most half a unit in the last place, which is less than scaled * 1e-15
+            if (std::abs(fraction - 0.5) > scaled * 1e-15)
+            {
+                const uint64_t fixed_point = static_cast<uint64_t>(rounded_down) + (fraction > 0.5);
+                int pos = 0;
+                if (std::signbit(coord))
+                { // printf writes the sign even if the value rounds to zero
+                    buffer[pos++] = '-';
+                }
+                return pos + writeFixedPointToBuffer(fixed_point, precision, buffer + pos);
+            }
+        }
+    }
+
     char format[5] = "%.xf"; // write a float with [x] digits after the dot
     format[2] = '0' + precision; // set [x]
-    char buffer[24];
-    int char_count = snprintf(buffer, 24, format, coord);
+    int char_count = snprintf(buffer, 32, format, coord);
     if (char_count <= 0)
     {
-        return;
+        return 0;
     }
-    if (buffer[char_count - precision - 1] == '.')
+    char_count = std::min(char_count, 31);
+    if (char_count > static_cast<int>(precision) && buffer[char_count - precision - 1] == '.')
     {
         int non_nul_pos = char_count - 1;
         while (buffer[non_nul_pos] == '0')
@@ -120,14 +232,31 @@ static inline void writeDoubleToStream(const unsigned int precision, const doubl
         }
         if (buffer[non_nul_pos] == '.')
         {
-            buffer[non_nul_pos] = '\0';
+            char_count = non_nul_pos;
         }
         else
         {
-            buffer[non_nul_pos + 1] = '\0';
+            char_count = non_nul_pos + 1;
         }
     }
-    ss << buffer;
+    return char_count;
+}
+
+/*!
+ * Efficient writing of a double to a stringstream
+ * 
+ * writes with \p precision digits after the decimal dot, but removes trailing zeros
+ * 
+ * \warning only works with precision up to 9
+ * 
+ * \param precision The number of (non-zero) digits after the decimal dot
+ * \param coord double to output
+ * \param ss The output stream to write the string to
+ */
+static inline void writeDoubleToStream(const unsigned int precision, const double coord, std::ostream& ss)
+{
+    char buffer[32];
+    ss.write(buffer, writeDoubleToBuffer(precision, coord, buffer));
 }
 
 /*!
@@ -10,7 +10,7 @@
 namespace cura 
 {
 
-WallOverlapComputation::WallOverlapComputation(Polygons& polygons, int line_width)
+WallOverlapComputation::WallOverlapComputation(const Polygons& polygons, int line_width)
 : overlap_linker(polygons, line_width)
 , line_width(line_width)
 { 
@@ -20,85 +20,86 @@ WallOverlapComputation::WallOverlapComputation(Polygons& polygons, int line_widt
 
 float WallOverlapComputation::getFlow(Point& from, Point& to)
 {
-    using Point2LinkIt = PolygonProximityLinker::Point2Link::iterator;
+    using PolyPoint = PolygonProximityLinker::PolyPoint;
 
     if (!overlap_linker.isLinked(from))
     { // [from] is not linked
         return 1;
     }
-    const std::pair<Point2LinkIt, Point2LinkIt> to_links = overlap_linker.getLinks(to);
-    if (to_links.first == to_links.second)
+    if (!overlap_linker.isLinked(to))
     { // [to] is not linked
         return 1;
     }
 
     int64_t overlap_area = 0;
     // note that we don't need to loop over all from_links, because they are handled in the previous getFlow(.) call (or in the very last)
-    for (Point2LinkIt to_link_it = to_links.first; to_link_it != to_links.second; ++to_link_it)
-    {
-        const ProximityPointLink& to_link = to_link_it->second;
-        ListPolyIt to_it = to_link.a;
-        ListPolyIt to_other_it = to_link.b;
-        if (to_link.a.p() != to)
-        {
-            assert(to_link.b.p() == to && "Either part of the link should be the point in the link!");
-            std::swap(to_it, to_other_it);
-        }
-        ListPolyIt from_it = to_it.prev();
-
-        if (from_it.p() != from)
+    auto process_func = [this, &from, &to, &overlap_area](unsigned int to_link_idx)
         {
-            logWarning("Polygon has multiple verts at the same place: (%lli, %lli); PolygonProximityLinker fails in such a case!\n", from.X, from.Y);
-        }
-
-        ListPolyIt to_other_next_it = to_other_it.next(); // move towards [from]; the lines on the other side move in the other direction
-        //           to  from
-        //   o<--o<--T<--F
-        //   |       :   :
-        //   v       :   :
-        //   o-->o-->o-->o
-        //           ,   ,
-        //           ;   to_other_next
-        //           to other
-
-        bool are_in_same_general_direction = dot(from - to, to_other_it.p() - to_other_next_it.p()) > 0;
-        // handle multiple points  linked to [to]
-        //   o<<<T<<<F
-        //     / |
-        //    /  |
-        //   o>>>o>>>o
-        //   ,   ,
-        //   ;   to other next
-        //   to other
-        if (!are_in_same_general_direction)
-        {
-            overlap_area += handlePotentialOverlap(to_it, to_it, to_link, to_other_next_it, to_other_it);
-        }
-
-        // handle multiple points  linked to [to_other]
-        //   o<<<T<<<F
-        //       |  /
-        //       | /
-        //   o>>>o>>>o
-        bool all_are_in_same_general_direction = are_in_same_general_direction && dot(from - to, to_other_it.prev().p() - to_other_it.p()) > 0;
-        if (!all_are_in_same_general_direction)
-        {
-            overlap_area += handlePotentialOverlap(from_it, to_it, to_link, to_other_it, to_other_it);
-        }
-
-        // handle normal case where the segment from-to overlaps with another segment
-        //   o<<<T<<<F
-        //       |   |
-        //       |   |
-        //   o>>>o>>>o
-        //       ,   ,
-        //       ;   to other next
-        //       to other
-        if (!are_in_same_general_direction)
-        {
-            overlap_area += handlePotentialOverlap(from_it, to_it, to_link, to_other_next_it, to_other_it);
-        }
-    }
+            const ProximityPointLink& to_link = overlap_linker.getLink(to_link_idx);
+            unsigned int to_idx = to_link.a;
+            unsigned int to_other_idx = to_link.b;
+            if (overlap_linker.getPoint(to_link.a).p != to)
+            {
+                assert(overlap_linker.getPoint(to_link.b).p == to && "Either part of the link should be the point in the link!");
+                std::swap(to_idx, to_other_idx);
+            }
+            const unsigned int from_idx = overlap_linker.getPoint(to_idx).prev;
+
+            if (overlap_linker.getPoint(from_idx).p != from)
+            {
+                logWarning("Polygon has multiple verts at the same place: (%lli, %lli); PolygonProximityLinker fails in such a case!\n", from.X, from.Y);
+            }
+
+            const PolyPoint& to_other = overlap_linker.getPoint(to_other_idx);
+            const unsigned int to_other_next_idx = to_other.next; // move towards [from]; the lines on the other side move in the other direction
+            //           to  from
+            //   o<--o<--T<--F
+            //   |       :   :
+            //   v       :   :
+            //   o-->o-->o-->o
+            //           ,   ,
+            //           ;   to_other_next
+            //           to other
+
+            bool are_in_same_general_direction = dot(from - to, to_other.p - overlap_linker.getPoint(to_other_next_idx).p) > 0;
+            // handle multiple points  linked to [to]
+            //   o<<<T<<<F
+            //     / |
+            //    /  |
+            //   o>>>o>>>o
+            //   ,   ,
+            //   ;   to other next
+            //   to other
+            if (!are_in_same_general_direction)
+            {
+                overlap_area += handlePotentialOverlap(to_idx, to_idx, to_link_idx, to_other_next_idx, to_other_idx);
+            }
+
+            // handle multiple points  linked to [to_other]
+            //   o<<<T<<<F
+            //       |  /
+            //       | /
+            //   o>>>o>>>o
+            bool all_are_in_same_general_direction = are_in_same_general_direction && dot(from - to, overlap_linker.getPoint(to_other.prev).p - to_other.p) > 0;
+            if (!all_are_in_same_general_direction)
+            {
+                overlap_area += handlePotentialOverlap(from_idx, to_idx, to_link_idx, to_other_idx, to_other_idx);
+            }
+
+            // handle normal case where the segment from-to overlaps with another segment
+            //   o<<<T<<<F
+            //       |   |
+            //       |   |
+            //   o>>>o>>>o
+            //       ,   ,
+            //       ;   to other next
+            //       to other
+            if (!are_in_same_general_direction)
+            {
+                overlap_area += handlePotentialOverlap(from_idx, to_idx, to_link_idx, to_other_next_idx, to_other_idx);
+            }
+        };
+    overlap_linker.processLinks(to, process_func);
 
     int64_t normal_area = vSize(from - to) * line_width;
     float ratio = float(normal_area - overlap_area) / normal_area;
@@ -107,23 +108,27 @@ float WallOverlapComputation::getFlow(Point& from, Point& to)
     return std::min(1.0f, std::max(0.0f, ratio));
 }
 
-int64_t WallOverlapComputation::handlePotentialOverlap(const ListPolyIt from_it, const ListPolyIt to_it, const ProximityPointLink& to_link, const ListPolyIt from_other_it, const ListPolyIt to_other_it)
+int64_t WallOverlapComputation::handlePotentialOverlap(const unsigned int from_idx, const unsigned int to_idx, const unsigned int to_link_idx, const unsigned int from_other_idx, const unsigned int to_other_idx)
 {
-    if (from_it == to_other_it && from_it == from_other_it)
+    if (from_idx == to_other_idx && from_idx == from_other_idx)
     { // don't compute overlap with a line and itself
         return 0;
     }
-    const ProximityPointLink* from_link = overlap_linker.getLink(from_it, from_other_it);
-    if (!from_link)
+    const unsigned int from_link_idx = overlap_linker.findLink(from_idx, from_other_idx);
+    if (from_link_idx == PolygonProximityLinker::no_link)
     {
         return 0;
     }
-    if (!getIsPassed(to_link, *from_link))
+    if (!getIsPassed(to_link_idx, from_link_idx))
     { // check whether the segment is already passed
-        setIsPassed(to_link, *from_link);
+        setIsPassed(to_link_idx, from_link_idx);
         return 0;
     }
-    return getApproxOverlapArea(from_it.p(), to_it.p(), to_link.dist, to_other_it.p(), from_other_it.p(), from_link->dist);
+    const Point from = overlap_linker.getPoint(from_idx).p;
+    const Point to = overlap_linker.getPoint(to_idx).p;
+    const Point to_other = overlap_linker.getPoint(to_other_idx).p;
+    const Point from_other = overlap_linker.getPoint(from_other_idx).p;
+    return getApproxOverlapArea(from, to, overlap_linker.getLink(to_link_idx).dist, to_other, from_other, overlap_linker.getLink(from_link_idx).dist);
 }
 
 int64_t WallOverlapComputation::getApproxOverlapArea(const Point from, const Point to, const int64_t to_dist, const Point other_from, const Point other_to, const int64_t from_dist)
@@ -213,12 +218,12 @@ int64_t WallOverlapComputation::getApproxOverlapArea(const Point from, const Poi
     return overlap_length_2 * overlap_width_2 / 4; //Area = width * height.
 }
 
-bool WallOverlapComputation::getIsPassed(const ProximityPointLink& link_a, const ProximityPointLink& link_b)
+bool WallOverlapComputation::getIsPassed(const unsigned int link_a, const unsigned int link_b)
 {
-    return passed_links.find(SymmetricPair<ProximityPointLink>(link_a, link_b)) != passed_links.end();
+    return passed_links.find(SymmetricPair<unsigned int>(link_a, link_b)) != passed_links.end();
 }
 
-void WallOverlapComputation::setIsPassed(const ProximityPointLink& link_a, const ProximityPointLink& link_b)
+void WallOverlapComputation::setIsPassed(const unsigned int link_a, const unsigned int link_b)
 {
     passed_links.emplace(link_a, link_b);
 }
@@ -2,12 +2,7 @@
 #ifndef WALL_OVERLAP_H
 #define WALL_OVERLAP_H
 
-#include <vector>
-#include <unordered_map>
 #include <unordered_set>
-#include <list>
-
-#include <functional> // hash function object
 
 #include "utils/intpoint.h"
 #include "utils/polygon.h"
@@ -49,7 +44,7 @@ class WallOverlapComputation
     PolygonProximityLinker overlap_linker;
     int64_t line_width;
 
-    std::unordered_set<SymmetricPair<ProximityPointLink>> passed_links;
+    std::unordered_set<SymmetricPair<unsigned int>> passed_links; //!< The pairs of indices of consecutive links between which the overlap area has been passed once
 public:
     /*!
      * Compute the flow for a given line segment in the wall.
@@ -66,14 +61,22 @@ public:
      * Computes the neccesary priliminaries in order to efficiently compute the flow when generatign gcode paths.
      * \param polygons The wall polygons for which to compute the overlaps
      */
-    WallOverlapComputation(Polygons& polygons, int lineWidth);
+    WallOverlapComputation(const Polygons& polygons, int lineWidth);
+
+    /*!
+     * The wall polygons with the points inserted where the overlap changes, which are the polygons to print with the computed flow.
+     */
+    Polygons& getPolygons()
+    {
+        return overlap_linker.getPolygons();
+    }
 
 private:
     /*!
-     * Check whether \p from_it and \p from_other_it are connected and if so,
-     * return the overlap area between those and the link \p to_link
+     * Check whether \p from_idx and \p from_other_idx are connected and if so,
+     * return the overlap area between those and the link \p to_link_idx
      * 
-     * This presupposes that \p to_link and the link from \p from_it to \p from_other_it forms a single overlap quadrilateral
+     * This presupposes that \p to_link_idx and the link from \p from_idx to \p from_other_idx forms a single overlap quadrilateral
      * 
      * from_other         to_other
      *          o<--------o
@@ -83,14 +86,14 @@ private:
      *          o-------->o
      *       from         to
      * 
-     * \param from_it The first point possibly invovled in the second link
-     * \param to_it The first point of \p to_link connected to \p from_it
-     * \param to_link The first link involved in the overlap: from \p from_it to \p to_it
-     * \param from_other_it The second point possibly involved in the second link
-     * \param to_other_it The second point of \p to_link connected to \p from_other_it
+     * \param from_idx The first point possibly invovled in the second link
+     * \param to_idx The first point of \p to_link_idx connected to \p from_idx
+     * \param to_link_idx The first link involved in the overlap: from \p from_idx to \p to_idx
+     * \param from_other_idx The second point possibly involved in the second link
+     * \param to_other_idx The second point of \p to_link_idx connected to \p from_other_idx
      * \return The overlap area between the two links, or zero if there was no such link
      */
-    int64_t handlePotentialOverlap(const ListPolyIt from_it, const ListPolyIt to_it, const ProximityPointLink& to_link, const ListPolyIt from_other_it, const ListPolyIt to_other_it);
+    int64_t handlePotentialOverlap(const unsigned int from_idx, const unsigned int to_idx, const unsigned int to_link_idx, const unsigned int from_other_idx, const unsigned int to_other_idx);
 
     /*!
      * Compute the approximate overlap area between two line segments
@@ -122,21 +125,21 @@ private:
      * 
      * \note \p link_a and \p link_b are assumed to be consecutive
      * 
-     * \param link_a the one link of the overlap area
-     * \param link_b the other link of the overlap area
+     * \param link_a the index of the one link of the overlap area
+     * \param link_b the index of the other link of the overlap area
      * \return whether the link has already been passed once
      */
-    bool getIsPassed(const ProximityPointLink& link_a, const ProximityPointLink& link_b);
+    bool getIsPassed(const unsigned int link_a, const unsigned int link_b);
 
     /*!
      * Mark an overlap area between two consecutive links as being passed once already.
      * 
      * \note \p link_a and \p link_b are assumed to be consecutive
      * 
-     * \param link_a the one link of the overlap area
-     * \param link_b the other link of the overlap area
+     * \param link_a the index of the one link of the overlap area
+     * \param link_b the index of the other link of the overlap area
      */
-    void setIsPassed(const ProximityPointLink& link_a, const ProximityPointLink& link_b);
+    void setIsPassed(const unsigned int link_a, const unsigned int link_b);
 };
 
 
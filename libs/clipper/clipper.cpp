@@ -705,14 +705,8 @@ void ReversePolyPtLinks(OutPt *pp)
 
 void DisposeOutPts(OutPt*& pp)
 {
-  if (pp == 0) return;
-    pp->Prev->Next = 0;
-  while( pp )
-  {
-    OutPt *tmpPp = pp;
-    pp = pp->Next;
-    delete tmpPp;
-  }
+  //the points themselves are released along with the OutPt pool
+  pp = 0;
 }
 //------------------------------------------------------------------------------
 
@@ -1058,7 +1052,8 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
   if ((Closed && highI < 2) || (!Closed && highI < 1)) return false;
 
   //create a new edge array ...
-  TEdge *edges = new TEdge [highI +1];
+  //(an array which turns out not to be needed stays in the pool until Clear())
+  TEdge *edges = m_EdgePool.Alloc(highI +1);
 
   bool IsFlat = true;
   //1. Basic (first) edge initialization ...
@@ -1077,7 +1072,6 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
   }
   catch(...)
   {
-    delete [] edges;
     throw; //range test fails
   }
   TEdge *eStart = &edges[0];
@@ -1118,7 +1112,6 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
 
   if ((!Closed && (E == E->Next)) || (Closed && (E->Prev == E->Next)))
   {
-    delete [] edges;
     return false;
   }
 
@@ -1146,7 +1139,6 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
   {
     if (Closed) 
     {
-      delete [] edges;
       return false;
     }
     E->Prev->OutIdx = Skip;
@@ -1164,11 +1156,9 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
       E = E->Next;
     }
     m_MinimaList.push_back(locMin);
-    m_edges.push_back(edges);
 	  return true;
   }
 
-  m_edges.push_back(edges);
   bool leftBoundIsForward;
   TEdge* EMin = 0;
 
@@ -1233,12 +1223,7 @@ bool ClipperBase::AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed)
 void ClipperBase::Clear()
 {
   DisposeLocalMinimaList();
-  for (EdgeList::size_type i = 0; i < m_edges.size(); ++i)
-  {
-    TEdge* edges = m_edges[i];
-    delete [] edges;
-  }
-  m_edges.clear();
+  m_EdgePool.Reset();
   m_UseFullRange = false;
   m_HasOpenPaths = false;
 }
@@ -1250,7 +1235,7 @@ void ClipperBase::Reset()
   if (m_CurrentLM == m_MinimaList.end()) return; //ie nothing to process
   std::sort(m_MinimaList.begin(), m_MinimaList.end(), LocMinSorter());
 
-  m_Scanbeam = ScanbeamList(); //clears/resets priority_queue
+  m_Scanbeam.clear();
   //reset all edges ...
   for (MinimaList::iterator lm = m_MinimaList.begin(); lm != m_MinimaList.end(); ++lm)
   {
@@ -1334,16 +1319,20 @@ IntRect ClipperBase::GetBounds()
 
 void ClipperBase::InsertScanbeam(const cInt Y)
 {
-  m_Scanbeam.push(Y);
+  m_Scanbeam.push_back(Y);
+  std::push_heap(m_Scanbeam.begin(), m_Scanbeam.end());
 }
 //------------------------------------------------------------------------------
 
 bool ClipperBase::PopScanbeam(cInt &Y)
 {
   if (m_Scanbeam.empty()) return false;
-  Y = m_Scanbeam.top();
-  m_Scanbeam.pop();
-  while (!m_Scanbeam.empty() && Y == m_Scanbeam.top()) { m_Scanbeam.pop(); } // Pop duplicates.
+  Y = m_Scanbeam.front();
+  do // Pop duplicates.
+  {
+    std::pop_heap(m_Scanbeam.begin(), m_Scanbeam.end());
+    m_Scanbeam.pop_back();
+  } while (!m_Scanbeam.empty() && Y == m_Scanbeam.front());
   return true;
 }
 //------------------------------------------------------------------------------
@@ -1352,6 +1341,8 @@ void ClipperBase::DisposeAllOutRecs(){
   for (PolyOutList::size_type i = 0; i < m_PolyOuts.size(); ++i)
     DisposeOutRec(i);
   m_PolyOuts.clear();
+  m_OutRecPool.Reset();
+  m_OutPtPool.Reset();
 }
 //------------------------------------------------------------------------------
 
@@ -1359,7 +1350,6 @@ void ClipperBase::DisposeOutRec(PolyOutList::size_type index)
 {
   OutRec *outRec = m_PolyOuts[index];
   if (outRec->Pts) DisposeOutPts(outRec->Pts);
-  delete outRec;
   m_PolyOuts[index] = 0;
 }
 //------------------------------------------------------------------------------
@@ -1379,7 +1369,7 @@ void ClipperBase::DeleteFromAEL(TEdge *e)
 
 OutRec* ClipperBase::CreateOutRec()
 {
-  OutRec* result = new OutRec;
+  OutRec* result = m_OutRecPool.Alloc();
   result->IsHole = false;
   result->IsOpen = false;
   result->FirstLeft = 0;
@@ -1485,6 +1475,11 @@ Clipper::Clipper(int initOptions) : ClipperBase() //constructor
 }
 //------------------------------------------------------------------------------
 
+Clipper::~Clipper() //destructor
+{
+}
+//------------------------------------------------------------------------------
+
 #ifdef use_xyz  
 void Clipper::ZFillFunction(ZFillCallback zFillFunc)
 {  
@@ -1941,7 +1936,7 @@ void Clipper::CopyAELToSEL()
 
 void Clipper::AddJoin(OutPt *op1, OutPt *op2, const IntPoint OffPt)
 {
-  Join* j = new Join;
+  Join* j = m_JoinPool.Alloc();
   j->OutPt1 = op1;
   j->OutPt2 = op2;
   j->OffPt = OffPt;
@@ -1951,23 +1946,21 @@ void Clipper::AddJoin(OutPt *op1, OutPt *op2, const IntPoint OffPt)
 
 void Clipper::ClearJoins()
 {
-  for (JoinList::size_type i = 0; i < m_Joins.size(); i++)
-    delete m_Joins[i];
   m_Joins.resize(0);
+  m_JoinPool.Reset();
 }
 //------------------------------------------------------------------------------
 
 void Clipper::ClearGhostJoins()
 {
-  for (JoinList::size_type i = 0; i < m_GhostJoins.size(); i++)
-    delete m_GhostJoins[i];
   m_GhostJoins.resize(0);
+  m_GhostJoinPool.Reset();
 }
 //------------------------------------------------------------------------------
 
 void Clipper::AddGhostJoin(OutPt *op, const IntPoint OffPt)
 {
-  Join* j = new Join;
+  Join* j = m_GhostJoinPool.Alloc();
   j->OutPt1 = op;
   j->OutPt2 = 0;
   j->OffPt = OffPt;
@@ -2466,7 +2459,7 @@ OutPt* Clipper::AddOutPt(TEdge *e, const IntPoint &pt)
   {
     OutRec *outRec = CreateOutRec();
     outRec->IsOpen = (e->WindDelta == 0);
-    OutPt* newOp = new OutPt;
+    OutPt* newOp = m_OutPtPool.Alloc();
     outRec->Pts = newOp;
     newOp->Idx = outRec->Idx;
     newOp->Pt = pt;
@@ -2486,7 +2479,7 @@ OutPt* Clipper::AddOutPt(TEdge *e, const IntPoint &pt)
 	if (ToFront && (pt == op->Pt)) return op;
     else if (!ToFront && (pt == op->Prev->Pt)) return op->Prev;
 
-    OutPt* newOp = new OutPt;
+    OutPt* newOp = m_OutPtPool.Alloc();
     newOp->Idx = outRec->Idx;
     newOp->Pt = pt;
     newOp->Next = op;
@@ -2843,9 +2836,8 @@ bool Clipper::ProcessIntersections(const cInt topY)
 
 void Clipper::DisposeIntersectNodes()
 {
-  for (size_t i = 0; i < m_IntersectList.size(); ++i )
-    delete m_IntersectList[i];
   m_IntersectList.clear();
+  m_IntersectPool.Reset();
 }
 //------------------------------------------------------------------------------
 
@@ -2878,7 +2870,7 @@ void Clipper::BuildIntersectList(const cInt topY)
       {
         IntersectPoint(*e, *eNext, Pt);
         if (Pt.Y < topY) Pt = IntPoint(TopX(*e, topY), topY);
-        IntersectNode * newNode = new IntersectNode;
+        IntersectNode * newNode = m_IntersectPool.Alloc();
         newNode->Edge1 = e;
         newNode->Edge2 = eNext;
         newNode->Pt = Pt;
@@ -2908,9 +2900,9 @@ void Clipper::ProcessIntersectList()
       IntersectEdges( iNode->Edge1, iNode->Edge2, iNode->Pt);
       SwapPositionsInAEL( iNode->Edge1 , iNode->Edge2 );
     }
-    delete iNode;
   }
   m_IntersectList.clear();
+  m_IntersectPool.Reset();
 }
 //------------------------------------------------------------------------------
 
@@ -3119,7 +3111,6 @@ void Clipper::FixupOutPolyline(OutRec &outrec)
       OutPt *tmpPP = pp->Prev;
       tmpPP->Next = pp->Next;
       pp->Next->Prev = tmpPP;
-      delete pp;
       pp = tmpPP;
     }
   }
@@ -3157,11 +3148,9 @@ void Clipper::FixupOutPolygon(OutRec &outrec)
             (!preserveCol || !Pt2IsBetweenPt1AndPt3(pp->Prev->Pt, pp->Pt, pp->Next->Pt))))
         {
             lastOK = 0;
-            OutPt *tmp = pp;
             pp->Prev->Next = pp->Next;
             pp->Next->Prev = pp->Prev;
             pp = pp->Prev;
-            delete tmp;
         }
         else if (pp == lastOK) break;
         else
@@ -3195,17 +3184,17 @@ void Clipper::BuildResult(Paths &polys)
   for (PolyOutList::size_type i = 0; i < m_PolyOuts.size(); ++i)
   {
     if (!m_PolyOuts[i]->Pts) continue;
-    Path pg;
     OutPt* p = m_PolyOuts[i]->Pts->Prev;
     int cnt = PointCount(p);
     if (cnt < 2) continue;
+    polys.push_back(Path()); //fill the path in place rather than copying it
+    Path& pg = polys.back();
     pg.reserve(cnt);
     for (int i = 0; i < cnt; ++i)
     {
       pg.push_back(p->Pt);
       p = p->Prev;
     }
-    polys.push_back(pg);
   }
 }
 //------------------------------------------------------------------------------
@@ -3338,9 +3327,9 @@ void Clipper::InsertEdgeIntoAEL(TEdge *edge, TEdge* startEdge)
 }
 //----------------------------------------------------------------------
 
-OutPt* DupOutPt(OutPt* outPt, bool InsertAfter)
+OutPt* DupOutPt(OutPt* outPt, bool InsertAfter, ObjectPool<OutPt>& pool)
 {
-  OutPt* result = new OutPt;
+  OutPt* result = pool.Alloc();
   result->Pt = outPt->Pt;
   result->Idx = outPt->Idx;
   if (InsertAfter)
@@ -3362,7 +3351,7 @@ OutPt* DupOutPt(OutPt* outPt, bool InsertAfter)
 //------------------------------------------------------------------------------
 
 bool JoinHorz(OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
-  const IntPoint Pt, bool DiscardLeft)
+  const IntPoint Pt, bool DiscardLeft, ObjectPool<OutPt>& pool)
 {
   Direction Dir1 = (op1->Pt.X > op1b->Pt.X ? dRightToLeft : dLeftToRight);
   Direction Dir2 = (op2->Pt.X > op2b->Pt.X ? dRightToLeft : dLeftToRight);
@@ -3379,12 +3368,12 @@ bool JoinHorz(OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
       op1->Next->Pt.X >= op1->Pt.X && op1->Next->Pt.Y == Pt.Y)  
         op1 = op1->Next;
     if (DiscardLeft && (op1->Pt.X != Pt.X)) op1 = op1->Next;
-    op1b = DupOutPt(op1, !DiscardLeft);
+    op1b = DupOutPt(op1, !DiscardLeft, pool);
     if (op1b->Pt != Pt) 
     {
       op1 = op1b;
       op1->Pt = Pt;
-      op1b = DupOutPt(op1, !DiscardLeft);
+      op1b = DupOutPt(op1, !DiscardLeft, pool);
     }
   } 
   else
@@ -3393,12 +3382,12 @@ bool JoinHorz(OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
       op1->Next->Pt.X <= op1->Pt.X && op1->Next->Pt.Y == Pt.Y) 
         op1 = op1->Next;
     if (!DiscardLeft && (op1->Pt.X != Pt.X)) op1 = op1->Next;
-    op1b = DupOutPt(op1, DiscardLeft);
+    op1b = DupOutPt(op1, DiscardLeft, pool);
     if (op1b->Pt != Pt)
     {
       op1 = op1b;
       op1->Pt = Pt;
-      op1b = DupOutPt(op1, DiscardLeft);
+      op1b = DupOutPt(op1, DiscardLeft, pool);
     }
   }
 
@@ -3408,12 +3397,12 @@ bool JoinHorz(OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
       op2->Next->Pt.X >= op2->Pt.X && op2->Next->Pt.Y == Pt.Y)
         op2 = op2->Next;
     if (DiscardLeft && (op2->Pt.X != Pt.X)) op2 = op2->Next;
-    op2b = DupOutPt(op2, !DiscardLeft);
+    op2b = DupOutPt(op2, !DiscardLeft, pool);
     if (op2b->Pt != Pt)
     {
       op2 = op2b;
       op2->Pt = Pt;
-      op2b = DupOutPt(op2, !DiscardLeft);
+      op2b = DupOutPt(op2, !DiscardLeft, pool);
     };
   } else
   {
@@ -3421,12 +3410,12 @@ bool JoinHorz(OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
       op2->Next->Pt.X <= op2->Pt.X && op2->Next->Pt.Y == Pt.Y) 
         op2 = op2->Next;
     if (!DiscardLeft && (op2->Pt.X != Pt.X)) op2 = op2->Next;
-    op2b = DupOutPt(op2, DiscardLeft);
+    op2b = DupOutPt(op2, DiscardLeft, pool);
     if (op2b->Pt != Pt)
     {
       op2 = op2b;
       op2->Pt = Pt;
-      op2b = DupOutPt(op2, DiscardLeft);
+      op2b = DupOutPt(op2, DiscardLeft, pool);
     };
   };
 
@@ -3478,8 +3467,8 @@ bool Clipper::JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2)
     if (reverse1 == reverse2) return false;
     if (reverse1)
     {
-      op1b = DupOutPt(op1, false);
-      op2b = DupOutPt(op2, true);
+      op1b = DupOutPt(op1, false, m_OutPtPool);
+      op2b = DupOutPt(op2, true, m_OutPtPool);
       op1->Prev = op2;
       op2->Next = op1;
       op1b->Next = op2b;
@@ -3489,8 +3478,8 @@ bool Clipper::JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2)
       return true;
     } else
     {
-      op1b = DupOutPt(op1, true);
-      op2b = DupOutPt(op2, false);
+      op1b = DupOutPt(op1, true, m_OutPtPool);
+      op2b = DupOutPt(op2, false, m_OutPtPool);
       op1->Next = op2;
       op2->Prev = op1;
       op1b->Prev = op2b;
@@ -3546,7 +3535,7 @@ bool Clipper::JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2)
       Pt = op2b->Pt; DiscardLeftSide = (op2b->Pt.X > op2->Pt.X);
     }
     j->OutPt1 = op1; j->OutPt2 = op2;
-    return JoinHorz(op1, op1b, op2, op2b, Pt, DiscardLeftSide);
+    return JoinHorz(op1, op1b, op2, op2b, Pt, DiscardLeftSide, m_OutPtPool);
   } else
   {
     //nb: For non-horizontal joins ...
@@ -3582,8 +3571,8 @@ bool Clipper::JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2)
 
     if (Reverse1)
     {
-      op1b = DupOutPt(op1, false);
-      op2b = DupOutPt(op2, true);
+      op1b = DupOutPt(op1, false, m_OutPtPool);
+      op2b = DupOutPt(op2, true, m_OutPtPool);
       op1->Prev = op2;
       op2->Next = op1;
       op1b->Next = op2b;
@@ -3593,8 +3582,8 @@ bool Clipper::JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2)
       return true;
     } else
     {
-      op1b = DupOutPt(op1, true);
-      op2b = DupOutPt(op2, false);
+      op1b = DupOutPt(op1, true, m_OutPtPool);
+      op2b = DupOutPt(op2, false, m_OutPtPool);
       op1->Next = op2;
       op2->Prev = op1;
       op1b->Prev = op2b;
@@ -3787,23 +3776,38 @@ ClipperOffset::ClipperOffset(double miterLimit, double arcTolerance)
 ClipperOffset::~ClipperOffset()
 {
   Clear();
+  for (PolyNodes::size_type i = 0; i < m_SpareNodes.size(); ++i)
+    delete m_SpareNodes[i];
 }
 //------------------------------------------------------------------------------
 
 void ClipperOffset::Clear()
 {
+  //keep the nodes and the memory of their contours for the next paths ...
   for (int i = 0; i < m_polyNodes.ChildCount(); ++i)
-    delete m_polyNodes.Childs[i];
+  {
+    m_polyNodes.Childs[i]->Contour.clear();
+    m_SpareNodes.push_back(m_polyNodes.Childs[i]);
+  }
   m_polyNodes.Childs.clear();
   m_lowest.X = -1;
 }
 //------------------------------------------------------------------------------
 
+PolyNode* ClipperOffset::NewNode()
+{
+  if (m_SpareNodes.empty()) return new PolyNode();
+  PolyNode* result = m_SpareNodes.back();
+  m_SpareNodes.pop_back();
+  return result;
+}
+//------------------------------------------------------------------------------
+
 void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType)
 {
   int highI = (int)path.size() - 1;
   if (highI < 0) return;
-  PolyNode* newNode = new PolyNode();
+  PolyNode* newNode = NewNode();
   newNode->m_jointype = joinType;
   newNode->m_endtype = endType;
 
@@ -3824,7 +3828,8 @@ void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType
     }
   if (endType == etClosedPolygon && j < 2)
   {
-    delete newNode;
+    newNode->Contour.clear();
+    m_SpareNodes.push_back(newNode);
     return;
   }
   m_polyNodes.AddChild(*newNode);
@@ -3884,7 +3889,9 @@ void ClipperOffset::Execute(Paths& solution, double delta)
   DoOffset(delta);
   
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper& clpr = m_Clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
@@ -3914,7 +3921,9 @@ void ClipperOffset::Execute(PolyTree& solution, double delta)
   DoOffset(delta);
 
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper& clpr = m_Clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
@@ -57,7 +57,7 @@
 #include <cstdlib>
 #include <ostream>
 #include <functional>
-#include <queue>
+#include <algorithm>
 
 namespace ClipperLib {
 
@@ -212,6 +212,50 @@ typedef std::vector < IntersectNode* > IntersectList;
 
 //------------------------------------------------------------------------------
 
+//ObjectPool hands out objects from blocks which are kept when the pool is
+//reset, so that a Clipper which is used for many operations doesn't allocate
+//its internal structures again. Objects aren't freed one by one; all of them
+//become invalid at once when the pool is reset.
+template <typename T>
+class ObjectPool
+{
+public:
+  ObjectPool(): m_CurrBlock(0), m_Used(0) {};
+  ~ObjectPool()
+  {
+    for (typename BlockList::size_type i = 0; i < m_Blocks.size(); ++i)
+      delete [] m_Blocks[i].Items;
+  };
+  T* Alloc(size_t count = 1)
+  {
+    while (m_CurrBlock < m_Blocks.size() && m_Used + count > m_Blocks[m_CurrBlock].Size)
+    {
+      ++m_CurrBlock;
+      m_Used = 0;
+    }
+    if (m_CurrBlock == m_Blocks.size())
+    {
+      Block block;
+      block.Size = std::max(count, m_Blocks.empty() ? size_t(64) : 2 * m_Blocks.back().Size);
+      block.Items = new T [block.Size];
+      m_Blocks.push_back(block);
+    }
+    T* result = m_Blocks[m_CurrBlock].Items + m_Used;
+    m_Used += count;
+    return result;
+  };
+  void Reset() {m_CurrBlock = 0; m_Used = 0;};
+private:
+  struct Block { T* Items; size_t Size; };
+  typedef std::vector<Block> BlockList;
+  BlockList m_Blocks;
+  typename BlockList::size_type m_CurrBlock;
+  size_t m_Used; //number of objects handed out from the current block
+  ObjectPool(const ObjectPool&); //not copyable
+  ObjectPool& operator=(const ObjectPool&);
+};
+//------------------------------------------------------------------------------
+
 //ClipperBase is the ancestor to the Clipper class. It should not be
 //instantiated directly. This class simply abstracts the conversion of sets of
 //polygon coordinates into edge objects that are stored in a LocalMinima list.
@@ -247,14 +291,17 @@ protected:
   MinimaList           m_MinimaList;
 
   bool              m_UseFullRange;
-  EdgeList          m_edges;
+  ObjectPool<TEdge> m_EdgePool; //the edges of all paths added since the last Clear()
   bool              m_PreserveCollinear;
   bool              m_HasOpenPaths;
   PolyOutList       m_PolyOuts;
   TEdge           *m_ActiveEdges;
 
-  typedef std::priority_queue<cInt> ScanbeamList;
+  //a max-heap which keeps its memory when the Clipper is reused
+  typedef std::vector<cInt> ScanbeamList;
   ScanbeamList     m_Scanbeam;
+  ObjectPool<OutRec> m_OutRecPool; //the OutRecs and OutPts of the current Execute()
+  ObjectPool<OutPt>  m_OutPtPool;
 };
 //------------------------------------------------------------------------------
 
@@ -262,6 +309,7 @@ class Clipper : public virtual ClipperBase
 {
 public:
   Clipper(int initOptions = 0);
+  ~Clipper();
   bool Execute(ClipType clipType,
       Paths &solution,
       PolyFillType fillType = pftEvenOdd);
@@ -290,6 +338,9 @@ private:
   JoinList         m_Joins;
   JoinList         m_GhostJoins;
   IntersectList    m_IntersectList;
+  ObjectPool<Join> m_JoinPool;
+  ObjectPool<Join> m_GhostJoinPool;
+  ObjectPool<IntersectNode> m_IntersectPool;
   ClipType         m_ClipType;
   typedef std::list<cInt> MaximaList;
   MaximaList       m_Maxima;
@@ -376,6 +427,10 @@ private:
   double m_miterLim, m_StepsPerRad;
   IntPoint m_lowest;
   PolyNode m_polyNodes;
+  PolyNodes m_SpareNodes; //nodes of paths which have been cleared, kept to be reused
+  Clipper m_Clipper; //cleans up the offset paths, kept to be reused
+
+  PolyNode* NewNode();
 
   void FixOrientations();
   void DoOffset(double delta);
@@ -0,0 +1,64 @@
+//
+//  Arena.cpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#include "Arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace mapmqp;
+using namespace std;
+
+Arena::Arena(size_t blockSize) :
+m_blockSize(blockSize) { }
+
+/**
+ * Takes the next aligned bytes from the current block, moving on to the
+ * next kept block or a new block when it does not fit. Requests larger
+ * than the block size get a block of their own.
+ *
+ * @param bytes Number of bytes needed
+ * @param alignment Alignment of the returned address, a power of two
+ *
+ * @return Uninitialized memory
+ */
+void * Arena::allocateBytes(size_t bytes, size_t alignment) {
+    while (m_currentBlock < m_blocks.size()) {
+        Block & block = m_blocks[m_currentBlock];
+        uintptr_t address = reinterpret_cast<uintptr_t>(block.p_data.get()) + m_offset;
+        size_t padding = (alignment - (address % alignment)) % alignment;
+        if (m_offset + padding + bytes <= block.size) {
+            m_offset += padding + bytes;
+            return reinterpret_cast<void *>(address + padding);
+        }
+        m_currentBlock++;
+        m_offset = 0;
+    }
+
+    //no kept block has room, new blocks come from operator new[] and are aligned for any fundamental type
+    Block block;
+    block.size = max(m_blockSize, bytes + alignment);
+    block.p_data.reset(new char[block.size]);
+    m_capacity += block.size;
+    m_blocks.push_back(move(block));
+    m_currentBlock = m_blocks.size() - 1;
+
+    uintptr_t address = reinterpret_cast<uintptr_t>(m_blocks.back().p_data.get());
+    size_t padding = (alignment - (address % alignment)) % alignment;
+    m_offset = padding + bytes;
+    return reinterpret_cast<void *>(address + padding);
+}
+
+void Arena::reset() {
+    m_currentBlock = 0;
+    m_offset = 0;
+}
+
+size_t Arena::capacity() const {
+    return m_capacity;
+}
@@ -0,0 +1,83 @@
+//
+//  Arena.hpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#ifndef Arena_hpp
+#define Arena_hpp
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace mapmqp {
+    //fixed size view of values stored in an Arena, valid until the arena is reset or destroyed
+    template <typename T>
+    class ArenaArray {
+    public:
+        ArenaArray(T * p_data = nullptr, std::size_t size = 0) :
+        m_p_data(p_data), m_size(size) { }
+
+        T * begin() const { return m_p_data; }
+        T * end() const { return m_p_data + m_size; }
+        std::size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        T & operator[](std::size_t i) const { return m_p_data[i]; }
+
+    private:
+        T * m_p_data;
+        std::size_t m_size;
+    };
+
+    //monotonic allocator for data that is built and thrown away together, such as the islands of one slice
+    //nothing is freed individually and destructors are never run, so only trivially destructible types can be stored
+    class Arena {
+    public:
+        Arena(std::size_t blockSize = 64 * 1024);
+
+        //returns uninitialized space for count values of T
+        template <typename T>
+        T * allocate(std::size_t count) {
+            static_assert(std::is_trivially_destructible<T>::value, "Arena never runs destructors");
+            return static_cast<T *>(allocateBytes(count * sizeof(T), alignof(T)));
+        }
+
+        //copies values into the arena
+        template <typename T>
+        ArenaArray<const T> copy(const std::vector<T> & values) {
+            static_assert(std::is_trivially_copyable<T>::value, "Arena copies values with memcpy");
+            T * p_data = allocate<T>(values.size());
+            if (values.size() > 0) {
+                memcpy(p_data, values.data(), values.size() * sizeof(T));
+            }
+            return ArenaArray<const T>(p_data, values.size());
+        }
+
+        //releases everything allocated so far in constant time, blocks are kept for the next allocations
+        void reset();
+
+        //bytes held in blocks
+        std::size_t capacity() const;
+
+    private:
+        void * allocateBytes(std::size_t bytes, std::size_t alignment);
+
+        struct Block {
+            std::unique_ptr<char[]> p_data;
+            std::size_t size;
+        };
+
+        std::vector<Block> m_blocks;
+        std::size_t m_blockSize;
+        std::size_t m_currentBlock = 0; //index of block allocations are taken from
+        std::size_t m_offset = 0; //bytes used in current block
+        std::size_t m_capacity = 0;
+    };
+}
+
+#endif /* Arena_hpp */
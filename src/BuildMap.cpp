@@ -11,55 +11,51 @@
 #include <cmath>
 #include <vector>
 
+#include "Profiler.hpp"
+
 #define ELLIPSE_PRECISION 100
 
 using namespace mapmqp;
 using namespace std;
 using namespace ClipperLib;
 
-BuildMap::BuildMap(std::shared_ptr<Mesh> p_mesh) :
-m_p_mesh(p_mesh) { }
+BuildMap::BuildMap(std::shared_ptr<Mesh> p_mesh, const SlicerConfig & config) :
+m_p_mesh(p_mesh),
+m_config(config) { }
 
 bool BuildMap::solve() {
+    PROFILE_ZONE("BuildMap::solve");
     if (!m_solved) {
-        //all statics - should only be executed once
+        vector<pair<int, int>> ellipseCoors; //ellipse to remove from build map with center of v.theta() and v.phi()
         
-        static vector<pair<int, int>> ellipseCoors; //ellipse to remove from build map with center of v.theta() and v.phi()
-        static bool ellipseBuilt = false; //whether or not ellipse has been calculated
+        //use ceil() to over-estimate area
+        double deltaTheta = thetaToBAxisRange(m_config.thetaMax);
+        double deltaPhi = phiToAAxisRange(m_config.thetaMax);
         
-        if (!ellipseBuilt) {
-            //use ceil() to over-estimate area
-            double deltaTheta = thetaToBAxisRange(THETA_MAX);
-            double deltaPhi = phiToAAxisRange(THETA_MAX);
-            
-            //to overapproximate ellipse, we extend the radius by this constant
-            double radiusExtension = 1.0 / cos(M_PI / ELLIPSE_PRECISION);
+        //to overapproximate ellipse, we extend the radius by this constant
+        double radiusExtension = 1.0 / cos(M_PI / ELLIPSE_PRECISION);
+        
+        writeLog(INFO, "BUILD MAP - delta-theta: %f", deltaTheta);
+        writeLog(INFO, "BUILD MAP - delta-phi: %f", deltaPhi);
+        writeLog(INFO, "BUILD MAP - ellipse area: %f", M_PI * deltaTheta * deltaPhi);
+        writeLog(INFO, "BUILD MAP - radius extension: %f", radiusExtension);
+        
+        //polygon goes in clockwise form
+        for (unsigned int i = 0; i < ELLIPSE_PRECISION; i++) {
+            double angle = 2.0 * M_PI * static_cast<double>(i) / static_cast<double>(ELLIPSE_PRECISION);
             
-            writeLog(INFO, "BUILD MAP - delta-theta: %f", deltaTheta);
-            writeLog(INFO, "BUILD MAP - delta-phi: %f", deltaPhi);
-            writeLog(INFO, "BUILD MAP - ellipse area: %f", M_PI * deltaTheta * deltaPhi);
-            writeLog(INFO, "BUILD MAP - radius extension: %f", radiusExtension);
+            double xDouble = deltaTheta * radiusExtension * cos(angle);
+            double yDouble = deltaPhi * radiusExtension * sin(angle);
             
-            //polygon goes in clockwise form
-            for (unsigned int i = 0; i < ELLIPSE_PRECISION; i++) {
-                double angle = 2.0 * M_PI * static_cast<double>(i) / static_cast<double>(ELLIPSE_PRECISION);
-                
-                double xDouble = deltaTheta * radiusExtension * cos(angle);
-                double yDouble = deltaPhi * radiusExtension * sin(angle);
-                
-                int xInt = (xDouble > 0) ? ceil(xDouble) : floor(xDouble);
-                int yInt = (yDouble > 0) ? ceil(yDouble) : floor(yDouble);
-                
-                ellipseCoors.push_back(pair<int, int>(xInt, yInt));
-            }
+            int xInt = (xDouble > 0) ? ceil(xDouble) : floor(xDouble);
+            int yInt = (yDouble > 0) ? ceil(yDouble) : floor(yDouble);
             
-            ellipseBuilt = true;
+            ellipseCoors.push_back(pair<int, int>(xInt, yInt));
         }
         
-        //end static section
-        
         //remove all contraints from face normals
         Paths holes;
+        MEMORY_ACCOUNT(holesMemoryAccount, BUILD_MAP);
         for (vector<shared_ptr<Mesh::Face>>::const_iterator it = m_p_mesh->p_faces().begin(); it != m_p_mesh->p_faces().end(); it++) {
             Vector3D v = (*it)->normal();
             v = v * -1;
@@ -68,7 +64,7 @@ bool BuildMap::solve() {
                 m_phiZeroAvailable = false;
                 
                 Path hole;
-                hole << IntPoint(0, 0) << IntPoint(0, phiToAAxisRange(THETA_MAX)) << IntPoint(B_AXIS_DISCRETE_POINTS, phiToAAxisRange(THETA_MAX)) << IntPoint(B_AXIS_DISCRETE_POINTS, 0);
+                hole << IntPoint(0, 0) << IntPoint(0, phiToAAxisRange(m_config.thetaMax)) << IntPoint(m_config.bAxisDiscretePoints(), phiToAAxisRange(m_config.thetaMax)) << IntPoint(m_config.bAxisDiscretePoints(), 0);
                 
                 //union all holes into one polygon
                 Clipper holeClipper;
@@ -80,7 +76,7 @@ bool BuildMap::solve() {
                 }
             } else {
                 //if top point of build map is covered, set phiZeroAvailable to false
-                m_phiZeroAvailable &= (fabs(v.phi().val()) > THETA_MAX);
+                m_phiZeroAvailable &= (fabs(v.phi().val()) > m_config.thetaMax);
                 
                 int xCenter = thetaToBAxisRange(v.theta());
                 int yCenter = phiToAAxisRange(v.phi());
@@ -100,18 +96,18 @@ bool BuildMap::solve() {
                     hole << IntPoint(x, y);
                     
                     if (!wrapAroundThetaPos) {
-                        if (x > B_AXIS_DISCRETE_POINTS) {
+                        if (x > m_config.bAxisDiscretePoints()) {
                             wrapAroundThetaPos = true;
                         }
                     }
-                    holeWrapThetaPos << IntPoint(x - B_AXIS_DISCRETE_POINTS, y);
+                    holeWrapThetaPos << IntPoint(x - m_config.bAxisDiscretePoints(), y);
                     
                     if (!wrapAroundThetaNeg) {
                         if (x < 0) {
                             wrapAroundThetaNeg = true;
                         }
                     }
-                    holeWrapThetaNeg << IntPoint(x + B_AXIS_DISCRETE_POINTS, y);
+                    holeWrapThetaNeg << IntPoint(x + m_config.bAxisDiscretePoints(), y);
                 }
                 
                 //union all holes into one polygon
@@ -132,6 +128,8 @@ bool BuildMap::solve() {
                 }
             }
             
+            MEMORY_ACCOUNT_SET(holesMemoryAccount, MemoryTracker::heapBytes(holes));
+            
             //TODO will this be more efficient?
             //TODO check area of holes and if it's >= total build map area then we know the build map is empty and we can stop here
             
@@ -141,13 +139,14 @@ bool BuildMap::solve() {
         Clipper buildMapClipper;
         //set up subject (only look in this box)
         Path subject;
-        subject << IntPoint(0, 0) << IntPoint(0, A_AXIS_DISCRETE_POINTS) << IntPoint(B_AXIS_DISCRETE_POINTS, A_AXIS_DISCRETE_POINTS) << IntPoint(B_AXIS_DISCRETE_POINTS, 0);
+        subject << IntPoint(0, 0) << IntPoint(0, m_config.aAxisDiscretePoints()) << IntPoint(m_config.bAxisDiscretePoints(), m_config.aAxisDiscretePoints()) << IntPoint(m_config.bAxisDiscretePoints(), 0);
         buildMapClipper.AddPath(subject, ptSubject, true);
         buildMapClipper.AddPaths(holes, ptClip, true);
         if (!buildMapClipper.Execute(ctDifference, m_buildMap2D, pftNonZero, pftNonZero)) {
             writeLog(ERROR, "BUILD MAP - error taking difference of map and holes");
             return false;
         }
+        MEMORY_ACCOUNT_SET(m_memoryAccount, MemoryTracker::heapBytes(m_buildMap2D));
         m_solved = true;
     }
     
@@ -194,7 +193,7 @@ Vector3D BuildMap::findValidVector() const {
     
     //TODO can this just be done by grabbing a point from the outline of m_buildMap2D?
     
-    Vector3D v = findValidVectorUtil(0, 0, B_AXIS_DISCRETE_POINTS, A_AXIS_DISCRETE_POINTS);
+    Vector3D v = findValidVectorUtil(0, 0, m_config.bAxisDiscretePoints(), m_config.aAxisDiscretePoints());
     if (!checkVector(v)) {
         writeLog(ERROR, "BUILD MAP - arbitrary vector(%f, %f, %f) not in buildmap", v.x(), v.y(), v.z());
     }
@@ -206,7 +205,7 @@ Vector3D BuildMap::findValidVectorUtil(int xStart, int yStart, int width, int he
     //writeLog(INFO, "BUILD MAP - checking build map theta(%d-%d) phi(%d-%d)", xStart, xStart + width, yStart, yStart + height);
 #endif
     if ((width == 1) && (height == 1)) {
-        return Vector3D(BuildMap::bAxisValToTheta(xStart), BuildMap::aAxisValToPhi(yStart));
+        return Vector3D(bAxisValToTheta(xStart), aAxisValToPhi(yStart));
     }
     
     Clipper searchClipper;
@@ -241,6 +240,7 @@ Vector3D BuildMap::findValidVectorUtil(int xStart, int yStart, int width, int he
 }
 
 Vector3D BuildMap::findBestVector() const {
+    PROFILE_ZONE("BuildMap::findBestVector");
     if (!m_solved) {
         writeLog(WARNING, "BUILD MAP - finding best vector of unsolved build map");
         return Vector3D(0, 0, 0);
@@ -251,16 +251,16 @@ Vector3D BuildMap::findBestVector() const {
     Vector3D v = findValidVector();
     double heuristic = averageCuspHeight(v);
     
-    return findBestVectorUtil(thetaToBAxisRange(v.theta()), phiToAAxisRange(v.phi()), B_AXIS_DISCRETE_POINTS / 4, A_AXIS_DISCRETE_POINTS / 4, heuristic).first;
+    return findBestVectorUtil(thetaToBAxisRange(v.theta()), phiToAAxisRange(v.phi()), m_config.bAxisDiscretePoints() / 4, m_config.aAxisDiscretePoints() / 4, heuristic).first;
 }
 
 pair<Vector3D, double> BuildMap::findBestVectorUtil(int x, int y, int dx, int dy, double prevHeuristic) const {
     vector<pair<Vector3D, double>> options; //Vector3D with lowest heuristic in this vector is the best vector
     
-    double north = averageCuspHeight(Vector3D(bAxisValToTheta(x), aAxisValToPhi((y + dy) % A_AXIS_DISCRETE_POINTS)));
-    double south = averageCuspHeight(Vector3D(bAxisValToTheta(x), aAxisValToPhi((y - dy) % A_AXIS_DISCRETE_POINTS)));
-    double east = averageCuspHeight(Vector3D(bAxisValToTheta((x + dx) % B_AXIS_DISCRETE_POINTS), aAxisValToPhi(y)));
-    double west = averageCuspHeight(Vector3D(bAxisValToTheta((x - dx) % B_AXIS_DISCRETE_POINTS), aAxisValToPhi(y)));
+    double north = averageCuspHeight(Vector3D(bAxisValToTheta(x), aAxisValToPhi((y + dy) % m_config.aAxisDiscretePoints())));
+    double south = averageCuspHeight(Vector3D(bAxisValToTheta(x), aAxisValToPhi((y - dy) % m_config.aAxisDiscretePoints())));
+    double east = averageCuspHeight(Vector3D(bAxisValToTheta((x + dx) % m_config.bAxisDiscretePoints()), aAxisValToPhi(y)));
+    double west = averageCuspHeight(Vector3D(bAxisValToTheta((x - dx) % m_config.bAxisDiscretePoints()), aAxisValToPhi(y)));
     
     int newDx = ceil(static_cast<double>(dx) / 2.0);
     int newDy = ceil(static_cast<double>(dy) / 2.0);
@@ -273,16 +273,16 @@ pair<Vector3D, double> BuildMap::findBestVectorUtil(int x, int y, int dx, int dy
         }
     } else {
         if (north < prevHeuristic) {
-            options.push_back(findBestVectorUtil((x + newDx) % B_AXIS_DISCRETE_POINTS, y, newDx, newDy, north));
+            options.push_back(findBestVectorUtil((x + newDx) % m_config.bAxisDiscretePoints(), y, newDx, newDy, north));
         }
         if (south < prevHeuristic) {
-            options.push_back(findBestVectorUtil((x - newDx) % B_AXIS_DISCRETE_POINTS, y, newDx, newDy, south));
+            options.push_back(findBestVectorUtil((x - newDx) % m_config.bAxisDiscretePoints(), y, newDx, newDy, south));
         }
         if (east < prevHeuristic) {
-            options.push_back(findBestVectorUtil(x, (y + newDy) % A_AXIS_DISCRETE_POINTS, newDx, newDy, east));
+            options.push_back(findBestVectorUtil(x, (y + newDy) % m_config.aAxisDiscretePoints(), newDx, newDy, east));
         }
         if (west < prevHeuristic) {
-            options.push_back(findBestVectorUtil(x, (y + newDy) % A_AXIS_DISCRETE_POINTS, newDx, newDy, west));
+            options.push_back(findBestVectorUtil(x, (y + newDy) % m_config.aAxisDiscretePoints(), newDx, newDy, west));
         }
     }
     
@@ -309,7 +309,7 @@ double BuildMap::averageCuspHeight(const Vector3D & v) const {
     }
     
     double weight = 0;
-    double totalFaceArea;
+    double totalFaceArea = 0;
     for (vector<shared_ptr<Mesh::Face>>::const_iterator it = m_p_mesh->p_faces().begin(); it != m_p_mesh->p_faces().end(); it++) {
         shared_ptr<Mesh::Face> p_face = *it;
         
@@ -319,31 +319,35 @@ double BuildMap::averageCuspHeight(const Vector3D & v) const {
         
         totalFaceArea += p_face->area();
     }
-    weight *= SLICE_THICKNESS;
+    weight *= m_config.sliceThickness;
     weight /= totalFaceArea;
     return weight;
 }
 
-Vector3D BuildMap::mapToVector(int x, int y) {
+const SlicerConfig & BuildMap::config() const {
+    return m_config;
+}
+
+Vector3D BuildMap::mapToVector(int x, int y) const {
     return Vector3D(bAxisValToTheta(x), aAxisValToPhi(y));
 }
 
-std::pair<int, int> BuildMap::vector3DToMap(const Vector3D & v) {
+std::pair<int, int> BuildMap::vector3DToMap(const Vector3D & v) const {
     return pair<int, int>(thetaToBAxisRange(v.theta()), phiToAAxisRange(v.phi()));
 }
 
-int BuildMap::thetaToBAxisRange(const Angle & theta) {
-    return Angle::radiansToDegrees(theta.val()) / B_AXIS_PRECISION_DEGREES;
+int BuildMap::thetaToBAxisRange(const Angle & theta) const {
+    return Angle::radiansToDegrees(theta.val()) / m_config.bAxisPrecisionDegrees;
 }
 
-int BuildMap::phiToAAxisRange(const Angle & phi) {
-    return Angle::radiansToDegrees(phi.val()) / A_AXIS_PRECISION_DEGREES;
+int BuildMap::phiToAAxisRange(const Angle & phi) const {
+    return Angle::radiansToDegrees(phi.val()) / m_config.aAxisPrecisionDegrees;
 }
 
-Angle BuildMap::bAxisValToTheta(double bAxisVal) {
-    return Angle(Angle::degreesToRadians(bAxisVal * B_AXIS_PRECISION_DEGREES));
+Angle BuildMap::bAxisValToTheta(double bAxisVal) const {
+    return Angle(Angle::degreesToRadians(bAxisVal * m_config.bAxisPrecisionDegrees));
 }
 
-Angle BuildMap::aAxisValToPhi(double aAxisVal) {
-    return Angle(Angle::degreesToRadians(aAxisVal * A_AXIS_PRECISION_DEGREES));
+Angle BuildMap::aAxisValToPhi(double aAxisVal) const {
+    return Angle(Angle::degreesToRadians(aAxisVal * m_config.aAxisPrecisionDegrees));
 }
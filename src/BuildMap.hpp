@@ -17,11 +17,13 @@
 #include "Vector3D.hpp"
 #include "Angle.hpp"
 #include "Mesh.hpp"
+#include "SlicerConfig.hpp"
+#include "MemoryTracker.hpp"
 
 namespace mapmqp {
     class BuildMap {
     public:
-        BuildMap(std::shared_ptr<Mesh> p_mesh);
+        BuildMap(std::shared_ptr<Mesh> p_mesh, const SlicerConfig & config);
         
         bool solve();
         double area() const;
@@ -29,20 +31,23 @@ namespace mapmqp {
         Vector3D findValidVector() const;
         Vector3D findBestVector() const;
         double averageCuspHeight(const Vector3D & v) const;
+        const SlicerConfig & config() const;
         
-        static Vector3D mapToVector(int x, int y);
-        static std::pair<int, int> vector3DToMap(const Vector3D & v);
-        static int thetaToBAxisRange(const Angle & theta);
-        static int phiToAAxisRange(const Angle & phi);
-        static Angle bAxisValToTheta(double bAxisVal);
-        static Angle aAxisValToPhi(double aAxisVal);
+        Vector3D mapToVector(int x, int y) const;
+        std::pair<int, int> vector3DToMap(const Vector3D & v) const;
+        int thetaToBAxisRange(const Angle & theta) const;
+        int phiToAAxisRange(const Angle & phi) const;
+        Angle bAxisValToTheta(double bAxisVal) const;
+        Angle aAxisValToPhi(double aAxisVal) const;
         
     private:
         std::shared_ptr<Mesh> m_p_mesh;
+        SlicerConfig m_config;
         
         ClipperLib::Paths m_buildMap2D; //x->theta, y->phi
         bool m_solved = false;
         bool m_phiZeroAvailable = true; //whether or not the point at phi = 0 is true
+        MEMORY_ACCOUNT(m_memoryAccount, BUILD_MAP); //build map paths
         
         Vector3D findValidVectorUtil(int xStart, int yStart, int width, int height) const;
         std::pair<Vector3D, double> findBestVectorUtil(int x, int y, int dx, int dy, double prevHeuristic) const;
@@ -16,8 +16,10 @@ using namespace mapmqp;
 using namespace std;
 
 bool BuildMapToMATLAB::parse(string filePath, const BuildMap & buildMap, OutputType type, int precision) {
+    int aAxisDiscretePoints = buildMap.config().aAxisDiscretePoints();
+    int bAxisDiscretePoints = buildMap.config().bAxisDiscretePoints();
     double oldPrecision = precision;
-    precision = fmax(1, fmin(precision, fmin(A_AXIS_DISCRETE_POINTS, B_AXIS_DISCRETE_POINTS)));
+    precision = fmax(1, fmin(precision, fmin(aAxisDiscretePoints, bAxisDiscretePoints)));
     
     if (precision != oldPrecision) {
         writeLog(WARNING, "precision of BuildMap is out of range");
@@ -28,9 +30,9 @@ bool BuildMapToMATLAB::parse(string filePath, const BuildMap & buildMap, OutputT
     
     if (file.is_open()) {
         ostringstream xStr, yStr, zStr;
-        for (int y = 0; y <= A_AXIS_DISCRETE_POINTS; y += precision) {
-            for (int x = 0; x <= B_AXIS_DISCRETE_POINTS; x += precision) {
-                Vector3D v = BuildMap::mapToVector(x, y);
+        for (int y = 0; y <= aAxisDiscretePoints; y += precision) {
+            for (int x = 0; x <= bAxisDiscretePoints; x += precision) {
+                Vector3D v = buildMap.mapToVector(x, y);
                 bool valid = buildMap.checkVector(v);
                 double weight = valid ? buildMap.averageCuspHeight(v) : 0;
                 
@@ -8,13 +8,8 @@
 
 #include "Clock.hpp"
 
+#include <chrono>
 #include <ctime>
-#ifdef __APPLE__
-#include <sys/time.h>
-#endif
-#ifdef _WIN32
-#include <windows.h>
-#endif
 
 using namespace mapmqp;
 using namespace std;
@@ -36,10 +31,7 @@ Clock::Clock() {
  * @return A long giving the time elapsed (in milliseconds)
  */
 long int Clock::delta() {
-    long int currentTime = epochTime();
-    long int delta = currentTime - m_prevTime;
-    m_prevTime = currentTime;
-    return delta;
+    return deltaNanoseconds() / 1000000;
 }
 
 /**
@@ -51,7 +43,38 @@ long int Clock::delta() {
  * @return A long giving the time elapsed (in milliseconds)
  */
 long int Clock::split() const {
-    return epochTime() - m_prevTime;
+    return splitNanoseconds() / 1000000;
+}
+
+/**
+ * Same as delta(), in nanoseconds
+ *
+ * @return The time elapsed (in nanoseconds)
+ */
+int64_t Clock::deltaNanoseconds() {
+    int64_t currentTime = monotonicTime();
+    int64_t delta = currentTime - m_prevTime;
+    m_prevTime = currentTime;
+    return delta;
+}
+
+/**
+ * Same as split(), in nanoseconds
+ *
+ * @return The time elapsed (in nanoseconds)
+ */
+int64_t Clock::splitNanoseconds() const {
+    return monotonicTime() - m_prevTime;
+}
+
+/**
+ * Gets the time of a monotonic clock, which is not affected by changes
+ * to the system time and should be used for measuring durations
+ *
+ * @return The number of nanoseconds since an arbitrary point in time
+ */
+int64_t Clock::monotonicTime() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
 }
 
 /**
@@ -61,17 +84,7 @@ long int Clock::split() const {
  * @return A long giving the number of milliseconds since the epoch
  */
 long int Clock::epochTime() {
-#ifdef __APPLE__
-    timeval currentTime;
-    gettimeofday(&currentTime, nullptr);
-    return (currentTime.tv_sec * 1000) + (currentTime.tv_usec / 1000); //converts seconds and microseconds to milliseconds
-#elif _WIN32
-    SYSTEMTIME currentTime;
-    GetSystemTime(&currentTime);
-    return (currentTime.wSecond * 1000) + currentTime.wMilliseconds;
-#else
-    return 0;
-#endif
+    return chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
 }
 
 string Clock::wallTimeString(string dateSeparator, string dateTimeSeparator, string timeSeparator) {
@@ -9,6 +9,7 @@
 #ifndef Clock_hpp
 #define Clock_hpp
 
+#include <cstdint>
 #include <string>
 
 namespace mapmqp {
@@ -18,12 +19,15 @@ namespace mapmqp {
         
         long int delta(); 		// Returns number of milliseconds since last delta call (or constructor) and resets delta
         long int split() const; // Returns number of milliseconds since last delta call, without resetting delta
+        int64_t deltaNanoseconds(); // Same as delta() in nanoseconds
+        int64_t splitNanoseconds() const; // Same as split() in nanoseconds
         
+        static int64_t monotonicTime(); //returns number of nanoseconds from an arbitrary point, never goes backwards
         static long int epochTime(); //returns number of milliseconds from Jan 1, 1970, 00:00:00
         static std::string wallTimeString(std::string dateSeparator = "/", std::string dateTimeSeparator = " ", std::string timeSeparator = ":"); //returns current date and time in format DD/MM/YYYY HH:MM:SS, where "/", " ", and ":" are speficied in parameters
         
     private:
-        long int m_prevTime = 0; // Last delta() call in milliseconds
+        int64_t m_prevTime = 0; // Last delta() call in nanoseconds of monotonic time
     };
 }
 
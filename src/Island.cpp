@@ -13,57 +13,70 @@
 using namespace mapmqp;
 using namespace std;
 
-Island::Island(const Polygon & polygon, vector<shared_ptr<const Mesh::Face>> p_polygonMeshFaces, bool isHole) :
-m_polygon(polygon),
-m_p_mainPolygonMeshFaces(p_polygonMeshFaces),
+Island::Island(ArenaArray<const Vector3D> points, ArenaArray<const Mesh::Face * const> p_mainPolygonMeshFaces, bool isHole) :
+m_points(points),
+m_p_mainPolygonMeshFaces(p_mainPolygonMeshFaces),
 m_isHole(isHole) { }
 
-const Polygon & Island::polygon() const {
-    return m_polygon;
+const ArenaArray<const Vector3D> & Island::points() const {
+    return m_points;
 }
 
-const vector<shared_ptr<const Mesh::Face>> & Island::mainPolygonMeshFaces() const {
-    return m_p_mainPolygonMeshFaces;
+/**
+ * Builds a Polygon from the island's outline. The points are copied,
+ * so the polygon can outlive the slice.
+ *
+ * @return Polygon of the outline
+ */
+Polygon Island::polygon() const {
+    return Polygon(vector<Vector3D>(m_points.begin(), m_points.end()));
 }
 
-vector<shared_ptr<const Mesh::Face>> Island::allFaces() const {
-	vector<shared_ptr<const Mesh::Face>> faces;
+const ArenaArray<const Mesh::Face * const> & Island::mainPolygonMeshFaces() const {
+    return m_p_mainPolygonMeshFaces;
+}
 
-	// Copy in the top level faces of the island
-	for (shared_ptr<const Mesh::Face> p_face : m_p_mainPolygonMeshFaces) {
-		faces.push_back(p_face);
-	}
+vector<const Mesh::Face *> Island::allFaces() const {
+	vector<const Mesh::Face *> faces(m_p_mainPolygonMeshFaces.begin(), m_p_mainPolygonMeshFaces.end());
 
 	// Get the child faces
-	for (shared_ptr<Island> child : m_children) {
-		vector<shared_ptr<const Mesh::Face>> childFaces = child->allFaces();
-
-		for (shared_ptr<const Mesh::Face> p_childFace : childFaces) {
-			faces.push_back(p_childFace);
-		}
+	for (const Island * p_child = firstChild(); p_child; p_child = p_child->nextSibling()) {
+		vector<const Mesh::Face *> childFaces = p_child->allFaces();
+		faces.insert(faces.end(), childFaces.begin(), childFaces.end());
 	}
 
 	return faces;
 }
 
-const vector<shared_ptr<Island>> & Island::children() const {
-    return m_children;
+bool Island::isHole() const {
+    return m_isHole;
 }
 
-void Island::addChild(shared_ptr<Island> p_child) {
-    p_child->m_p_parentIsland = shared_ptr<const Island>(this);
-    m_children.push_back(p_child);
+const Island * Island::parent() const {
+    return link(m_parent);
 }
 
-/** 
+const Island * Island::firstChild() const {
+    return link(m_firstChild);
+}
+
+const Island * Island::nextSibling() const {
+    return link(m_nextSibling);
+}
+
+const Island * Island::link(int32_t index) const {
+    return (index == NONE) ? nullptr : m_p_layerIslands + index;
+}
+
+/**
  * Converts the Island into a Polygon that matches its shape
  *
  * @param allPolys A vector to store the polygons in
  */
 void Island::toPoly(vector<Polygon> & allPolys) const {
-	allPolys.push_back(m_polygon);
-	
-	for (shared_ptr<Island> child : m_children) {
-		child->toPoly(allPolys);
+	allPolys.push_back(polygon());
+
+	for (const Island * p_child = firstChild(); p_child; p_child = p_child->nextSibling()) {
+		p_child->toPoly(allPolys);
 	}
-}
\ No newline at end of file
+}
@@ -9,34 +9,47 @@
 #ifndef Island_hpp
 #define Island_hpp
 
+#include <cstdint>
 #include <vector>
-#include <memory>
 
+#include "Arena.hpp"
 #include "Polygon.hpp"
 #include "Mesh.hpp"
 
 namespace mapmqp {
+    //outline of one polygon of a slice, stored with the rest of its slice in the slice's Arena
+    //islands of a slice are kept in one array and linked to each other by indices into it
     class Island {
+        friend class Slicer;
     public:
-        Island(const Polygon & mainPolygon, std::vector<std::shared_ptr<const Mesh::Face>> p_mainPolygonMeshFaces, bool isHole = false);
-        
+        Island(ArenaArray<const Vector3D> points, ArenaArray<const Mesh::Face * const> p_mainPolygonMeshFaces, bool isHole = false);
+
         // Getters
-        const Polygon & polygon() const;
-        const std::vector<std::shared_ptr<const Mesh::Face>> & mainPolygonMeshFaces() const;
-        std::vector<std::shared_ptr<const Mesh::Face>> allFaces() const;
-        const std::vector<std::shared_ptr<Island>> & children() const;
-        
-        void addChild(std::shared_ptr<Island> p_child);
+        const ArenaArray<const Vector3D> & points() const;
+        Polygon polygon() const;
+        const ArenaArray<const Mesh::Face * const> & mainPolygonMeshFaces() const;
+        std::vector<const Mesh::Face *> allFaces() const;
+        bool isHole() const;
+
+        // Links to other islands of the slice, nullptr if there is none
+        const Island * parent() const;
+        const Island * firstChild() const;
+        const Island * nextSibling() const;
 
         void toPoly(std::vector<Polygon> & allPolys) const;
 
-        std::shared_ptr<const Island> m_p_parentIsland;
-        
     private:
-        Polygon m_polygon; //polygon that represents outline of island
-        std::vector<std::shared_ptr<const Mesh::Face>> m_p_mainPolygonMeshFaces; //ptr to Mesh::Face on each edge of mainPolygon_, i.e. p_mainPolygonMesh::Faces_[x] is the Mesh::Face that the xth edge of mainPolygon_ came from
-        
-        std::vector<std::shared_ptr<Island>> m_children;
+        static const int32_t NONE = -1;
+
+        const Island * link(int32_t index) const;
+
+        ArenaArray<const Vector3D> m_points; //outline of island
+        ArenaArray<const Mesh::Face * const> m_p_mainPolygonMeshFaces; //ptr to Mesh::Face on each edge of the outline, i.e. m_p_mainPolygonMeshFaces[x] is the Mesh::Face that the xth edge came from
+
+        const Island * m_p_layerIslands = nullptr; //array of all islands of the slice, the indices below point into it
+        int32_t m_parent = NONE;
+        int32_t m_firstChild = NONE;
+        int32_t m_nextSibling = NONE;
 
         bool m_isHole;
     };
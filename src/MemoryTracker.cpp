@@ -0,0 +1,116 @@
+//
+//  MemoryTracker.cpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#include "MemoryTracker.hpp"
+
+#ifdef PROFILING
+
+#include <atomic>
+
+using namespace mapmqp;
+using namespace std;
+
+namespace {
+    struct TagUsage {
+        atomic<int64_t> current;
+        atomic<int64_t> peak;
+        atomic<uint64_t> allocations;
+    };
+    
+    //zero initialized before any allocation can happen
+    TagUsage s_usage[MemoryTracker::TAG_COUNT];
+}
+
+void MemoryTracker::allocated(Tag tag, size_t bytes) {
+    TagUsage & usage = s_usage[tag];
+    int64_t current = usage.current.fetch_add(bytes) + bytes;
+    usage.allocations++;
+    
+    int64_t peak = usage.peak.load();
+    while ((current > peak) && !usage.peak.compare_exchange_weak(peak, current)) { }
+}
+
+void MemoryTracker::freed(Tag tag, size_t bytes) {
+    s_usage[tag].current -= bytes;
+}
+
+MemoryTracker::Usage MemoryTracker::usage(Tag tag) {
+    Usage usage;
+    usage.current = s_usage[tag].current.load();
+    usage.peak = s_usage[tag].peak.load();
+    usage.allocations = s_usage[tag].allocations.load();
+    return usage;
+}
+
+const char * MemoryTracker::tagName(Tag tag) {
+    switch (tag) {
+        case MESH:
+            return "mesh";
+        case SLICER:
+            return "slicer";
+        case BUILD_MAP:
+            return "build map";
+        case DECOMPOSER:
+            return "decomposer";
+        default:
+            return "unknown";
+    }
+}
+
+/**
+ * Writes the memory held by each subsystem to the log, meant to be called
+ * between the stages of the pipeline
+ *
+ * @param stage Name of the stage that just finished
+ */
+void MemoryTracker::report(const char * stage) {
+    writeLog(INFO, "memory after %s: subsystem, current MB, peak MB, allocations", stage);
+    for (int tag = 0; tag < TAG_COUNT; tag++) {
+        Usage tagUsage = usage(static_cast<Tag>(tag));
+        writeLog(INFO, "memory after %s: %s, %.3f, %.3f, %llu", stage, tagName(static_cast<Tag>(tag)), tagUsage.current / 1e6, tagUsage.peak / 1e6, static_cast<unsigned long long>(tagUsage.allocations));
+    }
+}
+
+MemoryTracker::Account::Account(Tag tag) :
+m_tag(tag) { }
+
+MemoryTracker::Account::Account(const Account & account) :
+m_tag(account.m_tag) {
+    set(account.m_bytes);
+}
+
+MemoryTracker::Account & MemoryTracker::Account::operator=(const Account & account) {
+    set(0);
+    m_tag = account.m_tag;
+    set(account.m_bytes);
+    return *this;
+}
+
+MemoryTracker::Account::~Account() {
+    set(0);
+}
+
+/**
+ * Sets the number of bytes the account holds, counting an allocation if it grew
+ *
+ * @param bytes Bytes held
+ */
+void MemoryTracker::Account::set(size_t bytes) {
+    if (bytes > m_bytes) {
+        allocated(m_tag, bytes - m_bytes);
+    } else if (bytes < m_bytes) {
+        freed(m_tag, m_bytes - bytes);
+    }
+    m_bytes = bytes;
+}
+
+void MemoryTracker::Account::add(size_t bytes) {
+    set(m_bytes + bytes);
+}
+
+#endif /* PROFILING */
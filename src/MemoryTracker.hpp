@@ -0,0 +1,141 @@
+//
+//  MemoryTracker.hpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#ifndef MemoryTracker_hpp
+#define MemoryTracker_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Utility.hpp"
+
+namespace mapmqp {
+    //counts the memory held by each subsystem when PROFILING is defined in Utility.hpp
+    //memory is reached through TrackedAllocator (for containers and allocate_shared) or through accounts
+    //(MEMORY_ACCOUNT) for storage whose allocator cannot be changed, such as Clipper paths
+    class MemoryTracker {
+    public:
+        enum Tag {
+            MESH,
+            SLICER,
+            BUILD_MAP,
+            DECOMPOSER,
+            TAG_COUNT
+        };
+        
+        //heap memory held by a vector, for accounts
+        template <typename T>
+        static std::size_t heapBytes(const std::vector<T> & v) {
+            return v.capacity() * sizeof(T);
+        }
+        
+        //heap memory held by a vector of vectors (e.g. ClipperLib::Paths), for accounts
+        template <typename T>
+        static std::size_t heapBytes(const std::vector<std::vector<T>> & v) {
+            std::size_t bytes = v.capacity() * sizeof(std::vector<T>);
+            for (typename std::vector<std::vector<T>>::const_iterator it = v.begin(); it != v.end(); it++) {
+                bytes += heapBytes(*it);
+            }
+            return bytes;
+        }
+        
+#ifdef PROFILING
+        struct Usage {
+            int64_t current;
+            int64_t peak;
+            uint64_t allocations;
+        };
+        
+        static void allocated(Tag tag, std::size_t bytes);
+        static void freed(Tag tag, std::size_t bytes);
+        static Usage usage(Tag tag);
+        static const char * tagName(Tag tag);
+        
+        //writes the current and peak usage of every subsystem to the log
+        static void report(const char * stage);
+        
+        //bytes held by an object through storage that is not allocated with a TrackedAllocator, released when the account is destroyed
+        class Account {
+        public:
+            Account(Tag tag);
+            Account(const Account & account);
+            Account & operator=(const Account & account);
+            ~Account();
+            
+            void set(std::size_t bytes);
+            void add(std::size_t bytes);
+            
+        private:
+            Tag m_tag;
+            std::size_t m_bytes = 0;
+        };
+#endif
+    };
+    
+#ifdef PROFILING
+    //std::allocator that counts its allocations against a subsystem
+    template <typename T, MemoryTracker::Tag TAG>
+    class TrackedAllocator {
+    public:
+        typedef T value_type;
+        
+        template <typename U>
+        struct rebind {
+            typedef TrackedAllocator<U, TAG> other;
+        };
+        
+        TrackedAllocator() { }
+        
+        template <typename U>
+        TrackedAllocator(const TrackedAllocator<U, TAG> &) { }
+        
+        T * allocate(std::size_t n) {
+            MemoryTracker::allocated(TAG, n * sizeof(T));
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+        
+        void deallocate(T * p, std::size_t n) {
+            MemoryTracker::freed(TAG, n * sizeof(T));
+            ::operator delete(p);
+        }
+    };
+    
+    template <typename T, typename U, MemoryTracker::Tag TAG>
+    bool operator==(const TrackedAllocator<T, TAG> &, const TrackedAllocator<U, TAG> &) {
+        return true;
+    }
+    
+    template <typename T, typename U, MemoryTracker::Tag TAG>
+    bool operator!=(const TrackedAllocator<T, TAG> &, const TrackedAllocator<U, TAG> &) {
+        return false;
+    }
+#else
+    template <typename T, MemoryTracker::Tag TAG>
+    using TrackedAllocator = std::allocator<T>;
+#endif
+}
+
+#ifdef PROFILING
+
+#define MEMORY_ACCOUNT(name, tag) mapmqp::MemoryTracker::Account name{mapmqp::MemoryTracker::tag}
+#define MEMORY_ACCOUNT_SET(name, bytes) name.set(bytes)
+#define MEMORY_ACCOUNT_ADD(name, bytes) name.add(bytes)
+#define MEMORY_REPORT(stage) mapmqp::MemoryTracker::report(stage)
+
+#else
+
+#define MEMORY_ACCOUNT(name, tag)
+#define MEMORY_ACCOUNT_SET(name, bytes)
+#define MEMORY_ACCOUNT_ADD(name, bytes)
+#define MEMORY_REPORT(stage)
+
+#endif /* PROFILING */
+
+#endif /* MemoryTracker_hpp */
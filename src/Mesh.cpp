@@ -8,6 +8,7 @@
 
 #include "Mesh.hpp"
 
+#include <algorithm>
 #include <stdlib.h>
 #include <iostream>
 #include <fstream>
@@ -16,9 +17,79 @@
 #include <math.h>
 
 #include "Utility.hpp"
+#include "Profiler.hpp"
+#include "Triangulation.hpp"
+
+#define CUT_PRECISION 10 //number of clipper units per mesh unit when triangulating the cap of a cut
+#define CUT_TOLERANCE 1e-6 //vertices closer than this to a cutting plane are considered on the plane
+#define NO_INDEX UINT32_MAX
 
 using namespace mapmqp;
 using namespace std;
+using namespace ClipperLib;
+
+namespace {
+    //a shell's vertices and faces are each allocated in one block
+    typedef vector<Mesh::Vertex, TrackedAllocator<Mesh::Vertex, MemoryTracker::MESH>> VertexBlock;
+    typedef vector<Mesh::Face, TrackedAllocator<Mesh::Face, MemoryTracker::MESH>> FaceBlock;
+    
+    //builds a table of the triangles that use each vertex, the triangles of vertex v are vertexTriangles[rowStart[v]..rowStart[v + 1]]
+    void buildVertexTriangleTable(size_t vertexCount, const vector<array<uint32_t, 3>> & triangles, vector<uint32_t> & rowStart, vector<uint32_t> & vertexTriangles) {
+        rowStart.assign(vertexCount + 1, 0);
+        for (vector<array<uint32_t, 3>>::const_iterator it = triangles.begin(); it != triangles.end(); it++) {
+            for (unsigned int i = 0; i < 3; i++) {
+                rowStart[(*it)[i] + 1]++;
+            }
+        }
+        for (size_t i = 1; i < rowStart.size(); i++) {
+            rowStart[i] += rowStart[i - 1];
+        }
+        vector<uint32_t> rowFill(rowStart.begin(), rowStart.end() - 1);
+        vertexTriangles.resize(triangles.size() * 3);
+        for (uint32_t t = 0; t < triangles.size(); t++) {
+            for (unsigned int i = 0; i < 3; i++) {
+                vertexTriangles[rowFill[triangles[t][i]]++] = t;
+            }
+        }
+    }
+    
+    //returns the triangle other than t that has the edge to->from, or NO_INDEX if there is none
+    uint32_t findNeighbor(uint32_t t, uint32_t from, uint32_t to, const vector<array<uint32_t, 3>> & triangles, const vector<uint32_t> & rowStart, const vector<uint32_t> & vertexTriangles) {
+        for (uint32_t r = rowStart[to]; r < rowStart[to + 1]; r++) {
+            uint32_t other = vertexTriangles[r];
+            for (unsigned int j = 0; (j < 3) && (other != t); j++) {
+                if ((triangles[other][j] == to) && (triangles[other][(j + 1) % 3] == from)) {
+                    return other;
+                }
+            }
+        }
+        return NO_INDEX;
+    }
+    
+    //vertices and triangles of one part of a cut mesh, vertices are referred to by id while cutting (original vertex index, or cut point index after the original vertices)
+    struct CutPart {
+        vector<Vector3D> vertices;
+        vector<array<uint32_t, 3>> triangles;
+        vector<uint32_t> ids; //id of each vertex
+        vector<uint32_t> indices; //index in vertices of each id, NO_INDEX if not used by this part
+        
+        uint32_t index(uint32_t id, const vector<Vector3D> & positions) {
+            if (id >= indices.size()) {
+                indices.resize(max<size_t>(id + 1, indices.size() * 2), NO_INDEX);
+            }
+            if (indices[id] == NO_INDEX) {
+                indices[id] = vertices.size();
+                vertices.push_back(positions[id]);
+                ids.push_back(id);
+            }
+            return indices[id];
+        }
+        
+        void addTriangle(uint32_t id0, uint32_t id1, uint32_t id2, const vector<Vector3D> & positions) {
+            triangles.push_back(array<uint32_t, 3>{{index(id0, positions), index(id1, positions), index(id2, positions)}});
+        }
+    };
+}
 
 //Mesh class functions
 
@@ -26,6 +97,26 @@ using namespace std;
 
 Mesh::Mesh() { }
 
+/**
+ * Faces point to their vertices and neighbors, and vertices to their faces,
+ * through shared pointers into the shell blocks, so every block keeps itself
+ * alive. Those links are cleared here so that the blocks are freed with the mesh.
+ */
+Mesh::~Mesh() {
+    for (vector<shared_ptr<Face>>::iterator it = m_p_faces.begin(); it != m_p_faces.end(); it++) {
+        if ((*it)->m_p_parent != this) {
+            continue;
+        }
+        for (unsigned int i = 0; i < 3; i++) {
+            (*it)->m_p_vertices[i].reset();
+            (*it)->m_p_faces[i].reset();
+        }
+    }
+    for (vector<shared_ptr<Vertex>>::iterator it = m_p_vertices.begin(); it != m_p_vertices.end(); it++) {
+        vector<shared_ptr<const Face>>().swap((*it)->m_p_faces);
+    }
+}
+
 const vector<shared_ptr<Mesh::Vertex>> & Mesh::p_vertices() const {
     return m_p_vertices;
 }
@@ -35,8 +126,11 @@ const vector<shared_ptr<Mesh::Face>> & Mesh::p_faces() const {
 }
 
 void Mesh::addVertex(shared_ptr<Mesh::Vertex> p_vertex) {
+    if ((p_vertex->m_index < m_p_vertices.size()) && (m_p_vertices[p_vertex->m_index] == p_vertex)) {
+        writeLog(WARNING, "adding vertex to Mesh that already contains vertex");
+    }
+    p_vertex->m_index = m_p_vertices.size();
     m_p_vertices.push_back(p_vertex);
-    m_vertexRoster.add(*p_vertex);
 }
 
 /**
@@ -45,9 +139,296 @@ void Mesh::addVertex(shared_ptr<Mesh::Vertex> p_vertex) {
  * @param face A pointer to the Mesh::Face to add
  */
 void Mesh::addFace(shared_ptr<Mesh::Face> p_face) {
-    p_face->m_p_parent = shared_ptr<const Mesh>(this);
+    if (p_face->m_p_parent == this) {
+        writeLog(WARNING, "adding face to Mesh that already contains face");
+    }
+    p_face->m_p_parent = this;
+    p_face->m_index = m_p_faces.size();
     m_p_faces.push_back(p_face);
-    m_faceRoster.add(*p_face);
+}
+
+/**
+ * Adds a closed shell of triangles to the mesh. Vertices are shared by index,
+ * so two triangles are connected along an edge when one of them uses the
+ * vertex pair (a, b) and the other uses (b, a). Neighbors are found through
+ * a vertex-to-triangle table built with a counting sort, so no hashing is
+ * needed and the whole shell is connected in linear time. The shell's
+ * vertices and faces are each allocated in one block that the returned
+ * pointers share ownership of.
+ *
+ * @param vertices Positions of the shell's vertices
+ * @param triangles Counter-clockwise triangles as indices into vertices
+ */
+void Mesh::addShell(const vector<Vector3D> & vertices, const vector<array<uint32_t, 3>> & triangles) {
+    PROFILE_ZONE("Mesh::addShell");
+    vector<uint32_t> rowStart, vertexTriangles;
+    buildVertexTriangleTable(vertices.size(), triangles, rowStart, vertexTriangles);
+    
+    shared_ptr<VertexBlock> p_vertexBlock = allocate_shared<VertexBlock>(TrackedAllocator<VertexBlock, MemoryTracker::MESH>());
+    p_vertexBlock->reserve(vertices.size());
+    vector<shared_ptr<Mesh::Vertex>> p_shellVertices;
+    p_shellVertices.reserve(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        p_vertexBlock->emplace_back(vertices[i]);
+        p_vertexBlock->back().m_p_faces.reserve(rowStart[i + 1] - rowStart[i]);
+        p_shellVertices.push_back(shared_ptr<Mesh::Vertex>(p_vertexBlock, &p_vertexBlock->back()));
+        addVertex(p_shellVertices.back());
+    }
+    
+    shared_ptr<FaceBlock> p_faceBlock = allocate_shared<FaceBlock>(TrackedAllocator<FaceBlock, MemoryTracker::MESH>());
+    p_faceBlock->reserve(triangles.size());
+    vector<shared_ptr<Mesh::Face>> p_shellFaces;
+    p_shellFaces.reserve(triangles.size());
+    m_p_faces.reserve(m_p_faces.size() + triangles.size());
+    for (vector<array<uint32_t, 3>>::const_iterator it = triangles.begin(); it != triangles.end(); it++) {
+        p_faceBlock->emplace_back(p_shellVertices[(*it)[0]], p_shellVertices[(*it)[1]], p_shellVertices[(*it)[2]]);
+        shared_ptr<Mesh::Face> p_face(p_faceBlock, &p_faceBlock->back());
+        for (unsigned int i = 0; i < 3; i++) {
+            p_shellVertices[(*it)[i]]->addConnectedFace(p_face);
+        }
+        p_shellFaces.push_back(p_face);
+        addFace(p_face);
+    }
+    
+    //edge i of a triangle goes from vertex i to vertex i + 1, its neighbor has the same edge reversed
+    unsigned int openEdgeCount = 0;
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+        for (unsigned int i = 0; i < 3; i++) {
+            uint32_t neighbor = findNeighbor(t, triangles[t][i], triangles[t][(i + 1) % 3], triangles, rowStart, vertexTriangles);
+            if (neighbor != NO_INDEX) {
+                p_shellFaces[t]->connect(p_shellFaces[neighbor], i);
+            } else {
+                openEdgeCount++;
+            }
+        }
+    }
+    if (openEdgeCount > 0) {
+        writeLog(WARNING, "shell added to mesh is not closed, %d face edges have no neighbor", openEdgeCount);
+    }    
+    //each face is referenced by the mesh and by its three vertices
+    MEMORY_ACCOUNT_SET(m_memoryAccount, (m_p_vertices.capacity() + m_p_faces.capacity() + 3 * m_p_faces.size()) * sizeof(shared_ptr<Mesh::Face>));
+}
+
+/**
+ * Cuts the mesh with a plane in a single pass over its faces. Each vertex's
+ * signed distance to the plane decides which part its faces go to; faces
+ * that straddle the plane are split at the points where their edges cross
+ * it, and those points are welded through a short list of cut edges kept per
+ * vertex so both faces sharing an edge use the same point. The open edges
+ * left on the plane are chained into loops and triangulated into a cap that
+ * closes both parts. Faces lying on the plane go to the part they face out
+ * of. The mesh must be closed and share its vertices between faces.
+ *
+ * @param plane The plane to cut along
+ *
+ * @return The closed part below the plane and the closed part above it
+ */
+pair<shared_ptr<Mesh>, shared_ptr<Mesh>> Mesh::cut(const Plane & plane) const {
+    PROFILE_ZONE("Mesh::cut");
+    size_t vertexCount = m_p_vertices.size();
+    
+    //positions of the original vertices followed by the cut points
+    Vector3D normal = plane.normal();
+    normal.normalize();
+    vector<Vector3D> positions;
+    positions.reserve(vertexCount);
+    vector<Plane::PLANE_POSITION> planePositions(vertexCount);
+    vector<double> distances(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++) {
+        positions.push_back(m_p_vertices[i]->m_vertex);
+        distances[i] = Vector3D::dotProduct(positions[i] - plane.origin(), normal);
+        if ((fabs(distances[i]) <= CUT_TOLERANCE) || (plane.pointOnPlane(positions[i]) == Plane::ON)) {
+            planePositions[i] = Plane::ON;
+            distances[i] = 0;
+        } else {
+            planePositions[i] = (distances[i] > 0) ? Plane::ABOVE : Plane::BELOW;
+        }
+    }
+    
+    CutPart below, above;
+    below.indices.assign(vertexCount, NO_INDEX);
+    above.indices.assign(vertexCount, NO_INDEX);
+    below.triangles.reserve(m_p_faces.size());
+    above.triangles.reserve(m_p_faces.size());
+    
+    //cut edges starting at each vertex (the edge's lower index), as a linked list through cutEdges
+    struct CutEdge {
+        uint32_t other;
+        uint32_t id;
+        uint32_t next;
+    };
+    vector<uint32_t> firstCutEdge(vertexCount, NO_INDEX);
+    vector<CutEdge> cutEdges;
+    auto cutPoint = [&](uint32_t a, uint32_t b) -> uint32_t {
+        if (a > b) {
+            swap(a, b);
+        }
+        for (uint32_t e = firstCutEdge[a]; e != NO_INDEX; e = cutEdges[e].next) {
+            if (cutEdges[e].other == b) {
+                return cutEdges[e].id;
+            }
+        }
+        
+        uint32_t id = positions.size();
+        double t = distances[a] / (distances[a] - distances[b]);
+        positions.push_back(positions[a] + (positions[b] - positions[a]) * t);
+        cutEdges.push_back(CutEdge{b, id, firstCutEdge[a]});
+        firstCutEdge[a] = cutEdges.size() - 1;
+        return id;
+    };
+    
+    for (vector<shared_ptr<Mesh::Face>>::const_iterator it = m_p_faces.begin(); it != m_p_faces.end(); it++) {
+        const Mesh::Face & face = **it;
+        uint32_t v[3];
+        Plane::PLANE_POSITION pos[3];
+        unsigned int belowCount = 0, aboveCount = 0;
+        for (unsigned int i = 0; i < 3; i++) {
+            v[i] = face.m_p_vertices[i]->m_index;
+            pos[i] = planePositions[v[i]];
+            belowCount += (pos[i] == Plane::BELOW);
+            aboveCount += (pos[i] == Plane::ABOVE);
+        }
+        
+        if ((belowCount == 0) && (aboveCount == 0)) { //face lies on plane, it belongs to the part it faces out of
+            CutPart & part = (Vector3D::dotProduct(face.m_normal, normal) > 0) ? below : above;
+            part.addTriangle(v[0], v[1], v[2], positions);
+        } else if (belowCount == 0) {
+            above.addTriangle(v[0], v[1], v[2], positions);
+        } else if (aboveCount == 0) {
+            below.addTriangle(v[0], v[1], v[2], positions);
+        } else {
+            //k is either the vertex on the plane or the vertex alone on its side of the plane
+            unsigned int k = 0;
+            while ((pos[k] != Plane::ON) && (pos[(k + 1) % 3] != pos[(k + 2) % 3])) {
+                k++;
+            }
+            unsigned int i = (k + 1) % 3, j = (k + 2) % 3;
+            
+            if (pos[k] == Plane::ON) { //plane splits face through vertex k
+                uint32_t c = cutPoint(v[i], v[j]);
+                ((pos[i] == Plane::BELOW) ? below : above).addTriangle(v[k], v[i], c, positions);
+                ((pos[j] == Plane::BELOW) ? below : above).addTriangle(v[k], c, v[j], positions);
+            } else { //plane cuts off the corner at vertex k
+                uint32_t c1 = cutPoint(v[k], v[i]);
+                uint32_t c2 = cutPoint(v[j], v[k]);
+                CutPart & corner = (pos[k] == Plane::BELOW) ? below : above;
+                CutPart & rest = (pos[k] == Plane::BELOW) ? above : below;
+                corner.addTriangle(v[k], c1, c2, positions);
+                rest.addTriangle(c1, v[i], v[j], positions);
+                rest.addTriangle(c1, v[j], c2, positions);
+            }
+        }
+    }
+    
+    //the open edges of the part below all lie on the plane, reversed they form the loops bounding the cap
+    vector<uint32_t> rowStart, vertexTriangles;
+    buildVertexTriangleTable(below.vertices.size(), below.triangles, rowStart, vertexTriangles);
+    vector<uint32_t> nextOnLoop(below.vertices.size(), NO_INDEX);
+    for (uint32_t t = 0; t < below.triangles.size(); t++) {
+        for (unsigned int i = 0; i < 3; i++) {
+            uint32_t from = below.triangles[t][i], to = below.triangles[t][(i + 1) % 3];
+            if (findNeighbor(t, from, to, below.triangles, rowStart, vertexTriangles) == NO_INDEX) {
+                if (nextOnLoop[to] != NO_INDEX) {
+                    writeLog(WARNING, "cut through non-manifold vertex, cap may be incomplete");
+                }
+                nextOnLoop[to] = from;
+            }
+        }
+    }
+    
+    //project loops onto the plane, the axes are right-handed with the plane's normal so the cap faces up
+    Vector3D axisX = Vector3D::crossProduct(normal, (fabs(normal.z()) < 0.9) ? Vector3D(0, 0, 1) : Vector3D(1, 0, 0));
+    axisX.normalize();
+    Vector3D axisY = Vector3D::crossProduct(normal, axisX);
+    
+    vector<IntPoint> capPoints(below.vertices.size());
+    vector<vector<uint32_t>> loops;
+    vector<Path> loopPaths;
+    vector<double> loopAreas;
+    for (uint32_t start = 0; start < nextOnLoop.size(); start++) {
+        if (nextOnLoop[start] == NO_INDEX) {
+            continue;
+        }
+        
+        vector<uint32_t> loop;
+        Path loopPath;
+        uint32_t current = start;
+        while (nextOnLoop[current] != NO_INDEX) {
+            const Vector3D & position = below.vertices[current];
+            capPoints[current] = IntPoint(llround(Vector3D::dotProduct(position, axisX) * CUT_PRECISION), llround(Vector3D::dotProduct(position, axisY) * CUT_PRECISION));
+            loop.push_back(current);
+            loopPath.push_back(capPoints[current]);
+            
+            uint32_t next = nextOnLoop[current];
+            nextOnLoop[current] = NO_INDEX;
+            current = next;
+        }
+        if ((current != start) || (loop.size() < 3)) {
+            writeLog(WARNING, "cut produced an open loop on the plane, mesh is not closed");
+            continue;
+        }
+        
+        loops.push_back(loop);
+        loopPaths.push_back(loopPath);
+        loopAreas.push_back(Area(loopPath));
+    }
+    
+    //counter-clockwise loops are outlines of the cap and clockwise loops are holes, each hole belongs to the smallest outline containing it
+    vector<unsigned int> outlines;
+    for (unsigned int l = 0; l < loops.size(); l++) {
+        if (loopAreas[l] > 0) {
+            outlines.push_back(l);
+        }
+    }
+    sort(outlines.begin(), outlines.end(), [&loopAreas](unsigned int l1, unsigned int l2) {
+        return loopAreas[l1] < loopAreas[l2];
+    });
+    vector<vector<vector<uint32_t>>> capPolygons(outlines.size());
+    for (unsigned int o = 0; o < outlines.size(); o++) {
+        capPolygons[o].push_back(loops[outlines[o]]);
+    }
+    for (unsigned int l = 0; l < loops.size(); l++) {
+        if (loopAreas[l] >= 0) {
+            continue;
+        }
+        
+        bool placed = false;
+        for (unsigned int o = 0; (o < outlines.size()) && !placed; o++) {
+            if (loopAreas[outlines[o]] < -loopAreas[l]) {
+                continue;
+            }
+            int inside = -1;
+            for (Path::iterator it = loopPaths[l].begin(); (it != loopPaths[l].end()) && (inside == -1); it++) {
+                inside = PointInPolygon(*it, loopPaths[outlines[o]]);
+            }
+            if (inside != 0) {
+                capPolygons[o].push_back(loops[l]);
+                placed = true;
+            }
+        }
+        if (!placed) {
+            writeLog(WARNING, "cut produced a hole outside of every outline on the plane");
+        }
+    }
+    
+    //cap faces up on the part below and down on the part above
+    vector<Triangulation::Triangle> capTriangles;
+    for (vector<vector<vector<uint32_t>>>::iterator it = capPolygons.begin(); it != capPolygons.end(); it++) {
+        Triangulation::triangulate(capPoints, *it, capTriangles);
+    }
+    for (vector<Triangulation::Triangle>::iterator it = capTriangles.begin(); it != capTriangles.end(); it++) {
+        below.triangles.push_back(*it);
+        above.addTriangle(below.ids[(*it)[0]], below.ids[(*it)[2]], below.ids[(*it)[1]], positions);
+    }
+    
+    shared_ptr<Mesh> p_below(new Mesh()), p_above(new Mesh());
+    if (below.triangles.size() > 0) {
+        p_below->addShell(below.vertices, below.triangles);
+    }
+    if (above.triangles.size() > 0) {
+        p_above->addShell(above.vertices, above.triangles);
+    }
+    return pair<shared_ptr<Mesh>, shared_ptr<Mesh>>(p_below, p_above);
 }
 
 /**
@@ -94,6 +475,10 @@ const vector<shared_ptr<const Mesh::Face>> & Mesh::Vertex::p_faces() const {
     return m_p_faces;
 }
 
+uint32_t Mesh::Vertex::index() const {
+    return m_index;
+}
+
 string Mesh::Vertex::toString() const {
     return m_vertex.toString();
 }
@@ -262,6 +647,10 @@ const shared_ptr<const Mesh::Face> Mesh::Face::p_connectedFace(uint16_t f) const
     return m_p_faces[f];
 }
 
+uint32_t Mesh::Face::index() const {
+    return m_index;
+}
+
 /**
  * Takes a face and adds it to this face at the index specified by the second
  * parameter. If an invalid edge index is given, this function does nothing.
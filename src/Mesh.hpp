@@ -9,16 +9,17 @@
 #ifndef Mesh_hpp
 #define Mesh_hpp
 
+#include <array>
 #include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <string>
 
-#include "Identifier.hpp"
 #include "Vector3D.hpp"
 #include "Plane.hpp"
 #include "Polygon.hpp"
+#include "MemoryTracker.hpp"
 
 namespace mapmqp {
     class Mesh {
@@ -29,6 +30,11 @@ namespace mapmqp {
         class Face;
 
         Mesh();
+        ~Mesh();
+        
+        //faces and vertices belong to exactly one mesh, which unlinks them when it is destroyed
+        Mesh(const Mesh & mesh) = delete;
+        Mesh & operator=(const Mesh & mesh) = delete;
         
         const std::vector<std::shared_ptr<Vertex>> & p_vertices() const;
         const std::vector<std::shared_ptr<Face>> & p_faces() const;
@@ -36,24 +42,29 @@ namespace mapmqp {
         void addVertex(std::shared_ptr<Vertex> p_vertex);
         void addFace(std::shared_ptr<Face> p_face);
         
+        //adds a closed shell of counter-clockwise triangles (indices into vertices) and connects the faces along their shared edges
+        void addShell(const std::vector<Vector3D> & vertices, const std::vector<std::array<uint32_t, 3>> & triangles);
+        
+        //splits the mesh along a plane into the closed parts below and above it (either part may have no faces)
+        std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Mesh>> cut(const Plane & plane) const;
+        
         //TODO test this
         void transform(void (*transformFnc)(Vector3D & v));
         
     private:
         std::vector<std::shared_ptr<Vertex>> m_p_vertices;
-        Identifier<Vertex>::Roster m_vertexRoster;
-        
         std::vector<std::shared_ptr<Face>> m_p_faces;
-        Identifier<Face>::Roster m_faceRoster;
         
         std::vector<std::shared_ptr<Vertex>> m_p_lowestVertices;
         
+        MEMORY_ACCOUNT(m_memoryAccount, MESH); //pointers to the mesh's vertices and faces, the vertices and faces themselves are in tracked blocks
+        
     public:
         //sub-class declarations
         
         // Mesh::Vertex class declaration
         
-        class Vertex : public Identifier<Vertex> {
+        class Vertex {
             friend class Mesh;
         public:
             Vertex(const Vector3D & vertex);
@@ -61,6 +72,7 @@ namespace mapmqp {
             // Getters
             Vector3D vertex() const;
             const std::vector<std::shared_ptr<const Face>> & p_faces() const;
+            uint32_t index() const; //index of vertex in its parent mesh's vector of vertices, for VisitedMarks
             
             // Adds a face to the vector of connected faces
             void addConnectedFace(std::shared_ptr<Face> p_face);
@@ -70,11 +82,12 @@ namespace mapmqp {
         private:
             Vector3D m_vertex;
             std::vector<std::shared_ptr<const Face>> m_p_faces; //all faces that have this vertex as a vertex
+            uint32_t m_index = 0; //index of vertex in its parent mesh's vector of vertices
         };
         
         // Mesh::Edge class declaration
         
-        class Edge : public Identifier<Edge> {
+        class Edge {
             friend class Mesh;
         public:
             Edge(std::shared_ptr<const Vertex> p_vertex1, std::shared_ptr<const Vertex> p_vertex2);
@@ -98,7 +111,7 @@ namespace mapmqp {
         
         //Mesh::Face declaration
         
-        class Face : public Identifier<Face> {
+        class Face {
             friend class Mesh;
         public:
             Face(std::shared_ptr<const Vertex> p_vertex1, std::shared_ptr<const Vertex> p_vertex2, std::shared_ptr<const Vertex> p_vertex3); //TODO add normal checking
@@ -106,6 +119,7 @@ namespace mapmqp {
             // Getters
             const std::shared_ptr<const Vertex> p_vertex(uint16_t v) const;
             const std::shared_ptr<const Face> p_connectedFace(uint16_t f) const;
+            uint32_t index() const; //index of face in its parent mesh's vector of faces, for VisitedMarks
             double area() const;
             const Vector3D & normal() const;
             
@@ -132,7 +146,8 @@ namespace mapmqp {
             
         private:
             //points to parent mesh of face (each face should have exactly one)
-            std::shared_ptr<const Mesh> m_p_parent = nullptr;
+            const Mesh * m_p_parent = nullptr;
+            uint32_t m_index = 0; //index of face in its parent mesh's vector of faces
             
             //x, y, z vertices in counter-clockwise order
             std::shared_ptr<const Vertex> m_p_vertices[3] = {nullptr, nullptr, nullptr};
@@ -0,0 +1,480 @@
+//
+//  MeshGenerator.cpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#include "MeshGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <unordered_set>
+
+#include "Profiler.hpp"
+#include "Utility.hpp"
+
+#define NO_INDEX UINT32_MAX
+#define GYROID_CALIBRATION_RESOLUTION 64 //first resolution tried when generating a gyroid, about 13 cells per period
+#define EDGE_VERTEX_MARGIN 0.05 //edge vertices are kept this fraction of a grid cell away from grid points so that they stay distinct after rounding
+
+using namespace mapmqp;
+using namespace std;
+
+namespace {
+    //vertices are rounded to microns so generated meshes match meshes read from STL files
+    inline Vector3D micronVertex(double x, double y, double z) {
+        return Vector3D(round(x), round(y), round(z));
+    }
+
+    //triangles in a perforated block with the given number of cells per side and layers, ignoring the outer walls
+    uint64_t perforatedBlockTriangles(uint64_t cells, unsigned int holeSides, unsigned int layers) {
+        return cells * cells * (2 * (holeSides + 6) + 2 * holeSides * layers);
+    }
+}
+
+const vector<string> & MeshGenerator::shapes() {
+    static const vector<string> names = {"sphere", "torus", "gyroid", "honeycomb", "perforated"};
+    return names;
+}
+
+/**
+ * Builds a shape at a fixed default size (a few centimeters) with a resolution
+ * chosen so that it has roughly the requested number of triangles
+ *
+ * @param shape One of shapes()
+ * @param triangleCount Approximate number of triangles wanted
+ * @param vertices Filled with the mesh's vertices
+ * @param triangles Filled with the mesh's triangles
+ *
+ * @return false if the shape is unknown
+ */
+bool MeshGenerator::generate(const string & shape, uint64_t triangleCount, vector<Vector3D> & vertices, vector<Triangle> & triangles) {
+    PROFILE_ZONE("MeshGenerator::generate");
+    if (shape == "sphere") {
+        sphere(25000, max(1u, static_cast<unsigned int>(round(sqrt(triangleCount / 12.0)))), vertices, triangles);
+    } else if (shape == "torus") {
+        double majorRadius = 30000, minorRadius = 10000;
+        unsigned int minorSegments = max(3u, static_cast<unsigned int>(round(sqrt(triangleCount / 2.0 * minorRadius / majorRadius))));
+        unsigned int majorSegments = max(3u, static_cast<unsigned int>(round(triangleCount / (2.0 * minorSegments))));
+        torus(majorRadius, minorRadius, majorSegments, minorSegments, vertices, triangles);
+    } else if (shape == "gyroid") {
+        //the number of triangles grows with the square of the resolution once the sheet is resolved, coarser grids need another try
+        double size = 50000, period = 10000, thickness = 0.5;
+        unsigned int resolution = GYROID_CALIBRATION_RESOLUTION;
+        gyroid(size, period, thickness, resolution, vertices, triangles);
+        for (unsigned int attempt = 0; (attempt < 8) && (fabs(static_cast<double>(triangles.size()) / triangleCount - 1) > 0.1); attempt++) {
+            double scale = sqrt(static_cast<double>(triangleCount) / max<size_t>(1, triangles.size()));
+            resolution = max(4u, static_cast<unsigned int>(round(resolution * scale)));
+            gyroid(size, period, thickness, resolution, vertices, triangles);
+        }
+    } else if ((shape == "honeycomb") || (shape == "perforated")) {
+        //a 100mm wide block, the number of cells grows with the triangle count so larger meshes also have more holes per layer
+        bool honeycomb = (shape == "honeycomb");
+        unsigned int holeSides = honeycomb ? 6 : 16;
+        unsigned int cells = 1;
+        while (perforatedBlockTriangles(cells, holeSides, honeycomb ? max(1u, cells / 4) : 2) < triangleCount) {
+            cells++;
+        }
+        double cellRadius = 100000 / (cells * sqrt(3.0));
+        perforatedBlock(cells, cells, cellRadius, cellRadius * (honeycomb ? 0.85 : 0.5), holeSides, honeycomb ? 20000 : 5000, honeycomb ? max(1u, cells / 4) : 2, vertices, triangles);
+    } else {
+        writeLog(ERROR, "unknown generated mesh shape %s", shape.c_str());
+        return false;
+    }
+
+    writeLog(INFO, "generated %s with %lu vertices and %lu triangles", shape.c_str(), vertices.size(), triangles.size());
+    return true;
+}
+
+/**
+ * Builds a sphere by subdividing each side of a cube into a grid and
+ * projecting the grid onto the sphere. Grid points are spaced by angle
+ * (tangent warp) so triangles are close to the same size everywhere.
+ *
+ * @param radius Radius of the sphere
+ * @param subdivisions Number of grid cells along each edge of the cube
+ * @param vertices Filled with the mesh's vertices
+ * @param triangles Filled with the mesh's triangles
+ */
+void MeshGenerator::sphere(double radius, unsigned int subdivisions, vector<Vector3D> & vertices, vector<Triangle> & triangles) {
+    uint32_t n = max(1u, subdivisions);
+
+    //surface points of the (n + 1)^3 lattice are numbered by x layer: the full bottom face, a ring of 4n points per inner layer, then the full top face
+    uint32_t topStart = (n + 1) * (n + 1) + (n - 1) * 4 * n;
+    auto index = [n, topStart](uint32_t i, uint32_t j, uint32_t k) -> uint32_t {
+        if (i == 0) {
+            return j * (n + 1) + k;
+        } else if (i == n) {
+            return topStart + j * (n + 1) + k;
+        }
+
+        uint32_t ringStart = (n + 1) * (n + 1) + (i - 1) * 4 * n;
+        if ((j == 0) && (k < n)) {
+            return ringStart + k;
+        } else if ((k == n) && (j < n)) {
+            return ringStart + n + j;
+        } else if ((j == n) && (k > 0)) {
+            return ringStart + 2 * n + (n - k);
+        }
+        return ringStart + 3 * n + (n - j);
+    };
+
+    vector<double> warp(n + 1);
+    for (uint32_t t = 0; t <= n; t++) {
+        warp[t] = tan((2.0 * t / n - 1) * M_PI / 4);
+    }
+
+    vertices.assign(topStart + (n + 1) * (n + 1), Vector3D());
+    for (uint32_t i = 0; i <= n; i++) {
+        for (uint32_t j = 0; j <= n; j++) {
+            for (uint32_t k = 0; k <= n; k++) {
+                if ((i != 0) && (i != n) && (j != 0) && (j != n) && (k != 0) && (k != n)) {
+                    continue;
+                }
+
+                Vector3D direction(warp[i], warp[j], warp[k]);
+                direction.normalize(radius);
+                vertices[index(i, j, k)] = micronVertex(direction.x(), direction.y(), direction.z());
+            }
+        }
+    }
+
+    //each side is walked along axes u and v with u x v pointing out of the cube, so grid cells are counter-clockwise from outside
+    triangles.clear();
+    triangles.reserve(12 * n * n);
+    const unsigned int sides[6][4] = {{0, 1, 2, 1}, {0, 2, 1, 0}, {1, 2, 0, 1}, {1, 0, 2, 0}, {2, 0, 1, 1}, {2, 1, 0, 0}}; //fixed axis, u axis, v axis, at n or at 0
+    for (unsigned int side = 0; side < 6; side++) {
+        for (uint32_t u = 0; u < n; u++) {
+            for (uint32_t v = 0; v < n; v++) {
+                uint32_t corners[4];
+                const uint32_t cornerOffsets[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+                for (unsigned int c = 0; c < 4; c++) {
+                    uint32_t lattice[3];
+                    lattice[sides[side][0]] = sides[side][3] ? n : 0;
+                    lattice[sides[side][1]] = u + cornerOffsets[c][0];
+                    lattice[sides[side][2]] = v + cornerOffsets[c][1];
+                    corners[c] = index(lattice[0], lattice[1], lattice[2]);
+                }
+                triangles.push_back(Triangle{{corners[0], corners[1], corners[2]}});
+                triangles.push_back(Triangle{{corners[0], corners[2], corners[3]}});
+            }
+        }
+    }
+}
+
+/**
+ * Builds a torus around the z axis from a grid wrapped in both directions
+ *
+ * @param majorRadius Distance from the z axis to the center of the tube
+ * @param minorRadius Radius of the tube
+ * @param majorSegments Number of segments around the z axis
+ * @param minorSegments Number of segments around the tube
+ * @param vertices Filled with the mesh's vertices
+ * @param triangles Filled with the mesh's triangles
+ */
+void MeshGenerator::torus(double majorRadius, double minorRadius, unsigned int majorSegments, unsigned int minorSegments, vector<Vector3D> & vertices, vector<Triangle> & triangles) {
+    uint32_t us = max(3u, majorSegments), vs = max(3u, minorSegments);
+
+    vertices.clear();
+    vertices.reserve(us * vs);
+    for (uint32_t u = 0; u < us; u++) {
+        double theta = 2 * M_PI * u / us;
+        for (uint32_t v = 0; v < vs; v++) {
+            double phi = 2 * M_PI * v / vs;
+            double r = majorRadius + minorRadius * cos(phi);
+            vertices.push_back(micronVertex(r * cos(theta), r * sin(theta), minorRadius * sin(phi)));
+        }
+    }
+
+    triangles.clear();
+    triangles.reserve(2 * us * vs);
+    for (uint32_t u = 0; u < us; u++) {
+        uint32_t nextU = (u + 1) % us;
+        for (uint32_t v = 0; v < vs; v++) {
+            uint32_t nextV = (v + 1) % vs;
+            uint32_t a = u * vs + v, b = nextU * vs + v, c = nextU * vs + nextV, d = u * vs + nextV;
+            triangles.push_back(Triangle{{a, b, c}});
+            triangles.push_back(Triangle{{a, c, d}});
+        }
+    }
+}
+
+/**
+ * Builds the part of a gyroid sheet (|sin x cos y + sin y cos z + sin z cos x| < thickness)
+ * that lies inside a cube, a lattice like the ones used for lightweight infill
+ *
+ * @param size Width of the cube
+ * @param period Length of one period of the gyroid
+ * @param thickness Half thickness of the sheet in units of the gyroid function (between 0 and 1.5)
+ * @param resolution Number of grid cells along the cube's width
+ * @param vertices Filled with the mesh's vertices
+ * @param triangles Filled with the mesh's triangles
+ */
+void MeshGenerator::gyroid(double size, double period, double thickness, unsigned int resolution, vector<Vector3D> & vertices, vector<Triangle> & triangles) {
+    unsigned int cells = max(1u, resolution);
+    double spacing = size / cells;
+    double frequency = 2 * M_PI / period;
+
+    //the grid has one extra point outside the cube on each side so the surface is closed
+    unsigned int pointCount = cells + 3;
+    Vector3D origin(-size / 2 - spacing, -size / 2 - spacing, -size / 2 - spacing);
+
+    //the gyroid function is separable, so sines and cosines are only evaluated once per grid coordinate
+    vector<double> sines(pointCount), cosines(pointCount), box(pointCount);
+    for (unsigned int i = 0; i < pointCount; i++) {
+        double coordinate = origin.x() + i * spacing;
+        sines[i] = sin(frequency * coordinate);
+        cosines[i] = cos(frequency * coordinate);
+        box[i] = frequency * (fabs(coordinate) - size / 2); //positive outside of the cube, scaled like the gyroid function
+    }
+
+    polygonize([&](unsigned int i, unsigned int j, unsigned int k) {
+        double gyroidValue = sines[i] * cosines[j] + sines[j] * cosines[k] + sines[k] * cosines[i];
+        return max(fabs(gyroidValue) - thickness, max(box[i], max(box[j], box[k])));
+    }, {{pointCount, pointCount, pointCount}}, origin, spacing, vertices, triangles);
+}
+
+/**
+ * Builds a block of hexagonal cells in staggered rows, each with a hole
+ * through it. The top and bottom of every cell are triangulated by zipping
+ * its hole to its hexagon, so any number of holes can be built without a
+ * general polygon triangulation.
+ *
+ * @param cellsX Number of cells in each row
+ * @param cellsY Number of rows
+ * @param cellRadius Distance from the center of a cell to its corners
+ * @param holeRadius Distance from the center of a hole to its corners, must leave a wall inside the cell
+ * @param holeSides Number of sides of each hole
+ * @param height Height of the block
+ * @param layers Number of rings of faces the walls are split into
+ * @param vertices Filled with the mesh's vertices
+ * @param triangles Filled with the mesh's triangles
+ */
+void MeshGenerator::perforatedBlock(unsigned int cellsX, unsigned int cellsY, double cellRadius, double holeRadius, unsigned int holeSides, double height, unsigned int layers, vector<Vector3D> & vertices, vector<Triangle> & triangles) {
+    uint32_t sides = max(3u, holeSides);
+    double apothem = cellRadius * sqrt(3.0) / 2;
+
+    vector<array<double, 2>> points;
+    vector<Triangle> regionTriangles;
+    map<pair<long long, long long>, uint32_t> cornerIndices; //cell corners are shared by up to three cells
+    for (unsigned int row = 0; row < cellsY; row++) {
+        for (unsigned int column = 0; column < cellsX; column++) {
+            double centerX = apothem * (2 * column + (row % 2)), centerY = 1.5 * cellRadius * row;
+
+            //both loops start at the same angle and go counter-clockwise
+            uint32_t corners[6];
+            for (unsigned int c = 0; c < 6; c++) {
+                double angle = M_PI / 6 + c * M_PI / 3;
+                array<double, 2> corner = {{centerX + cellRadius * cos(angle), centerY + cellRadius * sin(angle)}};
+                pair<map<pair<long long, long long>, uint32_t>::iterator, bool> inserted = cornerIndices.insert(make_pair(make_pair(llround(corner[0]), llround(corner[1])), points.size()));
+                if (inserted.second) {
+                    points.push_back(corner);
+                }
+                corners[c] = inserted.first->second;
+            }
+            uint32_t holeStart = points.size();
+            for (unsigned int h = 0; h < sides; h++) {
+                double angle = M_PI / 6 + h * 2 * M_PI / sides;
+                points.push_back(array<double, 2>{{centerX + holeRadius * cos(angle), centerY + holeRadius * sin(angle)}});
+            }
+
+            //zip the hole to the hexagon, always advancing along whichever loop has the next point at the smaller angle
+            for (uint32_t h = 0, c = 0; (h < sides) || (c < 6); ) {
+                if ((c == 6) || ((h < sides) && ((h + 1) * 6 <= (c + 1) * sides))) {
+                    regionTriangles.push_back(Triangle{{corners[c % 6], holeStart + (h + 1) % sides, holeStart + h}});
+                    h++;
+                } else {
+                    regionTriangles.push_back(Triangle{{corners[c], corners[(c + 1) % 6], holeStart + h % sides}});
+                    c++;
+                }
+            }
+        }
+    }
+
+    extrude(points, regionTriangles, height, layers, vertices, triangles);
+}
+
+/**
+ * Polygonizes the negative region of a field sampled on a grid with marching
+ * tetrahedra. Every grid cell is split into six tetrahedra around its main
+ * diagonal, which always gives a closed manifold surface. Grid edges are
+ * numbered by their start point and direction so vertices on them are shared
+ * between cells; only the edges of the two z layers being processed are kept.
+ *
+ * @param field Value of the field at a grid point, negative inside
+ * @param pointCounts Number of grid points along x, y and z
+ * @param origin Position of grid point (0, 0, 0)
+ * @param spacing Distance between grid points
+ * @param vertices Filled with the mesh's vertices
+ * @param triangles Filled with the mesh's triangles
+ */
+void MeshGenerator::polygonize(function<double(unsigned int, unsigned int, unsigned int)> field, const array<unsigned int, 3> & pointCounts, const Vector3D & origin, double spacing, vector<Vector3D> & vertices, vector<Triangle> & triangles) {
+    PROFILE_ZONE("MeshGenerator::polygonize");
+    //cell corners are numbered by bits: 1 for +x, 2 for +y and 4 for +z
+    const unsigned int tetrahedra[6][4] = {{0, 1, 3, 7}, {0, 1, 5, 7}, {0, 2, 3, 7}, {0, 2, 6, 7}, {0, 4, 5, 7}, {0, 4, 6, 7}};
+
+    unsigned int nx = pointCounts[0], ny = pointCounts[1], nz = pointCounts[2];
+    vector<double> values[2] = {vector<double>(nx * ny), vector<double>(nx * ny)}; //field at the bottom and top layer of the current cells
+    vector<uint32_t> edgeVertices[2] = {vector<uint32_t>(nx * ny * 7, NO_INDEX), vector<uint32_t>(nx * ny * 7, NO_INDEX)}; //vertex on each of the 7 edges starting at a grid point
+    for (unsigned int y = 0; y < ny; y++) {
+        for (unsigned int x = 0; x < nx; x++) {
+            values[0][y * nx + x] = field(x, y, 0);
+        }
+    }
+
+    vertices.clear();
+    triangles.clear();
+    for (unsigned int z = 0; z + 1 < nz; z++) {
+        for (unsigned int y = 0; y < ny; y++) {
+            for (unsigned int x = 0; x < nx; x++) {
+                values[1][y * nx + x] = field(x, y, z + 1);
+            }
+        }
+        fill(edgeVertices[1].begin(), edgeVertices[1].end(), NO_INDEX);
+
+        for (unsigned int y = 0; y + 1 < ny; y++) {
+            for (unsigned int x = 0; x + 1 < nx; x++) {
+                double cornerValues[8];
+                unsigned int insideCount = 0;
+                for (unsigned int c = 0; c < 8; c++) {
+                    cornerValues[c] = values[c >> 2][(y + ((c >> 1) & 1)) * nx + x + (c & 1)];
+                    insideCount += (cornerValues[c] < 0) ? 1 : 0;
+                }
+                if ((insideCount == 0) || (insideCount == 8)) {
+                    continue;
+                }
+
+                //vertex on the edge between two corners, where one corner's bits always contain the other's
+                auto edgeVertex = [&](unsigned int c1, unsigned int c2) -> uint32_t {
+                    if ((c1 & c2) != c1) {
+                        swap(c1, c2);
+                    }
+                    unsigned int direction = c1 ^ c2;
+                    unsigned int gx = x + (c1 & 1), gy = y + ((c1 >> 1) & 1);
+                    uint32_t & index = edgeVertices[c1 >> 2][(gy * nx + gx) * 7 + direction - 1];
+                    if (index == NO_INDEX) {
+                        double t = cornerValues[c1] / (cornerValues[c1] - cornerValues[c2]);
+                        t = min(1 - EDGE_VERTEX_MARGIN, max(EDGE_VERTEX_MARGIN, t));
+                        index = vertices.size();
+                        vertices.push_back(micronVertex(origin.x() + spacing * (gx + t * (direction & 1)),
+                                                        origin.y() + spacing * (gy + t * ((direction >> 1) & 1)),
+                                                        origin.z() + spacing * (z + (c1 >> 2) + t * ((direction >> 2) & 1))));
+                    }
+                    return index;
+                };
+
+                //orientation is decided on edge midpoints (in cell coordinates), which never give a degenerate triangle
+                auto addTriangle = [&](const unsigned int (*edges)[2]) {
+                    Vector3D midpoints[3];
+                    for (unsigned int e = 0; e < 3; e++) {
+                        midpoints[e] = Vector3D(((edges[e][0] & 1) + (edges[e][1] & 1)) / 2.0, (((edges[e][0] >> 1) & 1) + ((edges[e][1] >> 1) & 1)) / 2.0, ((edges[e][0] >> 2) + (edges[e][1] >> 2)) / 2.0);
+                    }
+                    Vector3D outward(static_cast<double>(edges[0][1] & 1) - (edges[0][0] & 1), static_cast<double>((edges[0][1] >> 1) & 1) - ((edges[0][0] >> 1) & 1), static_cast<double>(edges[0][1] >> 2) - (edges[0][0] >> 2)); //edges go from inside to outside
+                    Triangle triangle = {{edgeVertex(edges[0][0], edges[0][1]), edgeVertex(edges[1][0], edges[1][1]), edgeVertex(edges[2][0], edges[2][1])}};
+                    if (Vector3D::dotProduct(Vector3D::crossProduct(midpoints[1] - midpoints[0], midpoints[2] - midpoints[0]), outward) < 0) {
+                        swap(triangle[1], triangle[2]);
+                    }
+                    triangles.push_back(triangle);
+                };
+
+                for (unsigned int t = 0; t < 6; t++) {
+                    unsigned int inside[4], outside[4], insideTotal = 0, outsideTotal = 0;
+                    for (unsigned int c = 0; c < 4; c++) {
+                        unsigned int corner = tetrahedra[t][c];
+                        if (cornerValues[corner] < 0) {
+                            inside[insideTotal++] = corner;
+                        } else {
+                            outside[outsideTotal++] = corner;
+                        }
+                    }
+
+                    if (insideTotal == 1) {
+                        const unsigned int edges[3][2] = {{inside[0], outside[0]}, {inside[0], outside[1]}, {inside[0], outside[2]}};
+                        addTriangle(edges);
+                    } else if (insideTotal == 3) {
+                        const unsigned int edges[3][2] = {{inside[0], outside[0]}, {inside[1], outside[0]}, {inside[2], outside[0]}};
+                        addTriangle(edges);
+                    } else if (insideTotal == 2) {
+                        //the four edge vertices form a quad in this order
+                        const unsigned int edges1[3][2] = {{inside[0], outside[0]}, {inside[0], outside[1]}, {inside[1], outside[1]}};
+                        const unsigned int edges2[3][2] = {{inside[0], outside[0]}, {inside[1], outside[1]}, {inside[1], outside[0]}};
+                        addTriangle(edges1);
+                        addTriangle(edges2);
+                    }
+                }
+            }
+        }
+
+        values[0].swap(values[1]);
+        edgeVertices[0].swap(edgeVertices[1]);
+    }
+}
+
+/**
+ * Extrudes a triangulated 2D region into a prism. The region's triangles
+ * become the top and bottom, and every boundary edge (outline or hole)
+ * becomes a wall split into layers rings. Only boundary points get vertices
+ * in between the top and bottom.
+ *
+ * @param points 2D points of the region
+ * @param regionTriangles Counter-clockwise triangles of indices into points
+ * @param height Height of the prism
+ * @param layers Number of rings of faces the walls are split into
+ * @param vertices Filled with the mesh's vertices
+ * @param triangles Filled with the mesh's triangles
+ */
+void MeshGenerator::extrude(const vector<array<double, 2>> & points, const vector<Triangle> & regionTriangles, double height, unsigned int layers, vector<Vector3D> & vertices, vector<Triangle> & triangles) {
+    uint32_t levels = max(1u, layers);
+
+    //an edge is on the boundary if no triangle uses it in the opposite direction, it then has the region on its left
+    unordered_set<uint64_t> edges;
+    edges.reserve(regionTriangles.size() * 3);
+    for (vector<Triangle>::const_iterator it = regionTriangles.begin(); it != regionTriangles.end(); it++) {
+        for (unsigned int i = 0; i < 3; i++) {
+            edges.insert((static_cast<uint64_t>((*it)[i]) << 32) | (*it)[(i + 1) % 3]);
+        }
+    }
+    vector<pair<uint32_t, uint32_t>> boundaryEdges;
+    vector<bool> onBoundary(points.size(), false);
+    for (vector<Triangle>::const_iterator it = regionTriangles.begin(); it != regionTriangles.end(); it++) {
+        for (unsigned int i = 0; i < 3; i++) {
+            uint32_t from = (*it)[i], to = (*it)[(i + 1) % 3];
+            if (edges.find((static_cast<uint64_t>(to) << 32) | from) == edges.end()) {
+                boundaryEdges.push_back(make_pair(from, to));
+                onBoundary[from] = onBoundary[to] = true;
+            }
+        }
+    }
+
+    //each point gets a column of vertices, levels + 1 high on the boundary and only the bottom and top elsewhere
+    vector<uint32_t> columnStarts(points.size());
+    vertices.clear();
+    for (uint32_t p = 0; p < points.size(); p++) {
+        columnStarts[p] = vertices.size();
+        for (uint32_t level = 0; level <= levels; level++) {
+            if (onBoundary[p] || (level == 0) || (level == levels)) {
+                vertices.push_back(micronVertex(points[p][0], points[p][1], height * level / levels));
+            }
+        }
+    }
+    auto index = [&](uint32_t p, uint32_t level) -> uint32_t {
+        return columnStarts[p] + ((onBoundary[p] || (level == 0)) ? level : 1);
+    };
+
+    triangles.clear();
+    triangles.reserve(2 * regionTriangles.size() + 2 * levels * boundaryEdges.size());
+    for (vector<Triangle>::const_iterator it = regionTriangles.begin(); it != regionTriangles.end(); it++) {
+        triangles.push_back(Triangle{{index((*it)[0], levels), index((*it)[1], levels), index((*it)[2], levels)}});
+        triangles.push_back(Triangle{{index((*it)[0], 0), index((*it)[2], 0), index((*it)[1], 0)}});
+    }
+    for (vector<pair<uint32_t, uint32_t>>::iterator it = boundaryEdges.begin(); it != boundaryEdges.end(); it++) {
+        for (uint32_t level = 0; level < levels; level++) {
+            uint32_t a = index(it->first, level), b = index(it->second, level), c = index(it->second, level + 1), d = index(it->first, level + 1);
+            triangles.push_back(Triangle{{a, b, c}});
+            triangles.push_back(Triangle{{a, c, d}});
+        }
+    }
+}
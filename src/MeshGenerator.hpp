@@ -0,0 +1,56 @@
+//
+//  MeshGenerator.hpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#ifndef MeshGenerator_hpp
+#define MeshGenerator_hpp
+
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Vector3D.hpp"
+
+namespace mapmqp {
+    //builds closed, manifold synthetic meshes of any size for benchmarks and scaling tests
+    //meshes are returned as vertices (in microns, like meshes read from STL files) and outward facing
+    //counter-clockwise triangles of indices into vertices, ready for Mesh::addShell or ProcessSTL::writeSTL
+    class MeshGenerator {
+    public:
+        typedef std::array<uint32_t, 3> Triangle;
+
+        //names of the shapes generate() can build
+        static const std::vector<std::string> & shapes();
+
+        //builds one of shapes() at a default size with roughly triangleCount triangles
+        static bool generate(const std::string & shape, uint64_t triangleCount, std::vector<Vector3D> & vertices, std::vector<Triangle> & triangles);
+
+        //cube subdivided into a subdivisions x subdivisions grid on each side and projected onto a sphere, 12 * subdivisions^2 triangles
+        static void sphere(double radius, unsigned int subdivisions, std::vector<Vector3D> & vertices, std::vector<Triangle> & triangles);
+
+        //torus around the z axis, 2 * majorSegments * minorSegments triangles
+        static void torus(double majorRadius, double minorRadius, unsigned int majorSegments, unsigned int minorSegments, std::vector<Vector3D> & vertices, std::vector<Triangle> & triangles);
+
+        //gyroid sheet of the given thickness (in units of the gyroid function) filling a cube, polygonized on a grid of resolution^3 cells
+        static void gyroid(double size, double period, double thickness, unsigned int resolution, std::vector<Vector3D> & vertices, std::vector<Triangle> & triangles);
+
+        //block of cellsX x cellsY hexagonal cells, each with a hole through it, extruded with layers rings of wall faces
+        //holes with 6 sides give a honeycomb, holes with more sides give a plate perforated by round holes
+        static void perforatedBlock(unsigned int cellsX, unsigned int cellsY, double cellRadius, double holeRadius, unsigned int holeSides, double height, unsigned int layers, std::vector<Vector3D> & vertices, std::vector<Triangle> & triangles);
+
+    private:
+        //surface of the region where field is negative on a grid of pointCounts points spaced spacing apart, using marching tetrahedra
+        //field is indexed by grid point and must be positive on the border of the grid so that the surface is closed
+        static void polygonize(std::function<double(unsigned int, unsigned int, unsigned int)> field, const std::array<unsigned int, 3> & pointCounts, const Vector3D & origin, double spacing, std::vector<Vector3D> & vertices, std::vector<Triangle> & triangles);
+
+        //extrudes a counter-clockwise triangulated 2D region, walls are added along every edge used by only one triangle
+        static void extrude(const std::vector<std::array<double, 2>> & points, const std::vector<Triangle> & regionTriangles, double height, unsigned int layers, std::vector<Vector3D> & vertices, std::vector<Triangle> & triangles);
+    };
+}
+
+#endif /* MeshGenerator_hpp */
@@ -83,7 +83,7 @@ m_points(points) {
         if ((fabs(mappedPoint.x()) >= pow(2, 62) / s_mappedPointPrecision) || (fabs(mappedPoint.y()) >= pow(2, 62) / s_mappedPointPrecision)) {
             writeLog(WARNING, "mapping point from Polygon that excedes given range");
         }
-        m_polygonXYPlane << ClipperLib::IntPoint((int)(mappedPoint.x() * s_mappedPointPrecision), (int)(mappedPoint.y() * s_mappedPointPrecision));
+        m_polygonXYPlane << ClipperLib::IntPoint((ClipperLib::cInt)(mappedPoint.x() * s_mappedPointPrecision), (ClipperLib::cInt)(mappedPoint.y() * s_mappedPointPrecision));
     }
 }
 
@@ -134,7 +134,7 @@ double Polygon::area() const {
 
 bool Polygon::pointInPolygon(const Vector3D & point) const {
     Vector3D mappedPoint = mapPointToXYPlane(point);
-    return ClipperLib::PointInPolygon(ClipperLib::IntPoint((int)(mappedPoint.x() * s_mappedPointPrecision), (int)(mappedPoint.y() * s_mappedPointPrecision)), m_polygonXYPlane);
+    return ClipperLib::PointInPolygon(ClipperLib::IntPoint((ClipperLib::cInt)(mappedPoint.x() * s_mappedPointPrecision), (ClipperLib::cInt)(mappedPoint.y() * s_mappedPointPrecision)), m_polygonXYPlane);
 }
 
 uint64_t Polygon::mappedPointPrecision() {
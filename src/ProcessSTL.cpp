@@ -8,7 +8,10 @@
 
 #include "ProcessSTL.hpp"
 #include "Utility.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
 #include <fstream>
+#include <string.h>
 #include <math.h>
 
 using namespace mapmqp;
@@ -24,176 +27,157 @@ using namespace std;
  *		- The vector of Vertex objects of the Mesh::Face are arranged in counter-clockwise order
  *		- The connecting face 0 for each Mesh::Face is the one attached to the edge between vertex 0 and 1, etc.
  * This way, we have a graph of both vertices and faces we can use to navigate the object.
+ *
+ * The file is read into a list of triangle points, equal points are welded
+ * into shared vertices and the faces are then connected through Mesh::addShell.
  */
 shared_ptr<Mesh> ProcessSTL::constructMeshFromSTL(string stlFilePath) {
-    shared_ptr<Mesh> p_mesh(new Mesh());
-    unordered_map<Vector3D, shared_ptr<Mesh::Vertex>, ProcessSTL::Vector3DHash> mapped_p_vertices;
-    unordered_map<shared_ptr<Mesh::Edge>, shared_ptr<Mesh::Face>, ProcessSTL::MeshEdgePtrHash, ProcessSTL::MeshEdgePtrEquality> mapped_p_edges;
+    vector<Vector3D> points;
+    if (!readSTL(stlFilePath, points)) {
+        return nullptr;
+    }
     
-    vector<shared_ptr<Mesh::Vertex>> p_lowestVertices;
+    vector<Vector3D> vertices;
+    vector<array<uint32_t, 3>> triangles;
+    weldVertices(points, vertices, triangles);
     
+    shared_ptr<Mesh> p_mesh(new Mesh());
+    p_mesh->addShell(vertices, triangles);
+    
+    return p_mesh;
+}
+
+/**
+ * Reads a binary STL file, scaling its coordinates to integer microns
+ *
+ * @param stlFilePath Path of the STL file
+ * @param points Filled with three points per triangle, in the order of the file
+ *
+ * @return true if the file could be read
+ */
+bool ProcessSTL::readSTL(string stlFilePath, vector<Vector3D> & points) {
+    PROFILE_ZONE("ProcessSTL::readSTL");
     ifstream file;									// Our file handler
-    char *header = new char[80];					// The 80-char file header
+    char header[80];								// The 80-char file header
     unsigned int size;								// The number of triangles in the file
     
     writeLog(INFO, "parsing STL file %s...", stlFilePath.c_str());
-    if (getFileHandlerIn(file, stlFilePath)) {            // Check that we opened successfully
-        file.read(header, 80);							// Get the header
-        file.read((char*)&size, 4);						// Get the number of triangles
-        
-        writeLog(INFO, "number of triangles: %d", size);
-        
-        double lowestZVal = INFINITY;
+    if (!getFileHandlerIn(file, stlFilePath)) {            // Check that we opened successfully
+        writeLog(ERROR, "unable to open file %s [%s]", stlFilePath.c_str(), strerror(errno));
+        return false;
+    }
+    
+    file.read(header, 80);							// Get the header
+    file.read((char*)&size, 4);						// Get the number of triangles
+    
+    writeLog(INFO, "number of triangles: %d", size);
+    
+    points.clear();
+    points.reserve(size * 3);
+    for (unsigned int i = 0; i < size; ++i) {		// Loop through all triangles
+        float values[12] = { };						// 4 vectors * 3 points = 12 points, the normal is unused
+        short abc;									// Stores the attribute byte count
         
-        for (unsigned int i = 0; i < size; ++i) {		// Loop through all triangles
-            Vector3D norm, vertices[3];                 // Stores the three triangle points + normal vector
-            float points[12] = { };						// 4 vectors * 3 points = 12 points
-            short abc;									// Stores the attribute byte count
-            
-            for (unsigned int j = 0; j < 12; ++j) {		// Get all points from file
-                file.read((char*)(points + j), 4);
-                points[j] = floor((points[j] * 1000) + 0.5);    // TODO: why are we adding 0.5 again?
-                                                                // I remember now! It's an easy way to round up for >= 0.5, and down at < 0.5
-            }
-            file.read((char*)&abc, 2);
-            
-            norm = Vector3D(points[0], points[1], points[2]);           // Create normal vector
-            vertices[0] = Vector3D(points[3], points[4], points[5]);	// Get first point of triangle
-            vertices[1] = Vector3D(points[6], points[7], points[8]);	// Get second point of triangle
-            vertices[2] = Vector3D(points[9], points[10], points[11]);	// Get third point of triangle
-            
-            shared_ptr<Mesh::Vertex> p_meshVertices[3]; //Three Mesh::Vertex pointers
-            
-            // Process the three vertices of the triangle
-            for (unsigned int i = 0; i < 3; i++) {
-                shared_ptr<Mesh::Vertex> p_meshVertex(new Mesh::Vertex(vertices[i]));
-                p_meshVertices[i] = addMeshVertex(p_mesh, p_meshVertex, mapped_p_vertices);
-                
-                // If the lowestVertex was never set or the current vertex is lower than the lowestVertex, replace
-                // lowestVertex with the current vertex
-                if (p_meshVertices[i]->vertex().z() == lowestZVal) {
-                    p_lowestVertices.push_back(p_meshVertices[i]);
-                }
-                // If a lower vertex was encountered, reset the lowest vertices list
-                else if (p_meshVertices[i]->vertex().z() < lowestZVal) {
-                    lowestZVal = p_meshVertices[i]->vertex().z();
-                    p_lowestVertices.clear();
-                    p_lowestVertices.push_back(p_meshVertices[i]);
-                }
-            }
-            
-            // Create new Mesh::Face from vertices
-            shared_ptr<Mesh::Face> p_meshFace(new Mesh::Face(p_meshVertices[0], p_meshVertices[1], p_meshVertices[2]));
-            
-            // Add face to the mesh and connect it to its surrounding faces
-            addMeshFace(p_mesh, p_meshFace, mapped_p_edges);
-            
-            // Add the new Mesh::Face to the list of connected faces of all its vertices to connect vertices
-            for (unsigned int i = 0; i < 3; i++) {
-                p_meshVertices[i]->addConnectedFace(p_meshFace);
-            }
+        file.read((char*)values, 48);
+        file.read((char*)&abc, 2);
+        if (!file) {
+            writeLog(ERROR, "STL file %s ended after %d of %d triangles", stlFilePath.c_str(), i, size);
+            return false;
         }
-        file.close();	// Close the file
         
-        return p_mesh;
-    } else {
-        writeLog(ERROR, "unable to open file %s [errno: %d]", stlFilePath.c_str(), strerror(errno));
-        return nullptr;
+        for (unsigned int j = 3; j < 12; j += 3) {
+            // Rounds to the nearest micron, floor(x + 0.5) rounds up at >= 0.5 and down at < 0.5
+            points.push_back(Vector3D(floor((values[j] * 1000) + 0.5), floor((values[j + 1] * 1000) + 0.5), floor((values[j + 2] * 1000) + 0.5)));
+        }
     }
+    file.close();	// Close the file
+    
+    return true;
 }
 
 /**
- * Takes a Mesh::Vertex pointer and attempts to add it to the
- * vector of vertices. If it has already been added, this
- * function returns a shared pointer to the already existing point.
- * Otherwise, it returns the same pointer as was given.
+ * Merges equal points into shared vertices
  *
- * @param A Mesh::Vertex shared pointer to add to the unordered map
- *
- * @return A shared pointer to the Mesh::Vertex in the unordered map
+ * @param points Three points per triangle
+ * @param vertices Filled with the distinct points, in order of first appearance
+ * @param triangles Filled with the indices into vertices of each triangle
  */
-shared_ptr<Mesh::Vertex> ProcessSTL::addMeshVertex(shared_ptr<Mesh> p_mesh, shared_ptr<Mesh::Vertex> p_vertex, unordered_map<Vector3D, shared_ptr<Mesh::Vertex>, ProcessSTL::Vector3DHash> & mapped_p_vertices) {
-    shared_ptr<Mesh::Vertex> finalVertex;
-    // Add the vertex to the vertices list unless it's already there
-    pair<unordered_map<Vector3D, shared_ptr<Mesh::Vertex>, Vector3DHash>::iterator, bool> emplacePair = mapped_p_vertices.emplace(p_vertex->vertex(), p_vertex); //place Mesh::Vertex ptr into hashtable
-    finalVertex = emplacePair.first->second; //set Mesh::Vertex ptr to returned value from hashtable in case it has changed
-    if (emplacePair.second) { //if Mesh::Vertex did not exist in hashtable, add to list of vertices
-        p_mesh->addVertex(finalVertex);
-    }
+void ProcessSTL::weldVertices(const vector<Vector3D> & points, vector<Vector3D> & vertices, vector<array<uint32_t, 3>> & triangles) {
+    PROFILE_ZONE("ProcessSTL::weldVertices");
+    unordered_map<Vector3D, uint32_t, ProcessSTL::Vector3DHash> mapped_vertices;
+    mapped_vertices.reserve(points.size() / 2);
     
-    return finalVertex;
+    vertices.clear();
+    triangles.resize(points.size() / 3);
+    for (size_t i = 0; i < points.size(); i++) {
+        pair<unordered_map<Vector3D, uint32_t, ProcessSTL::Vector3DHash>::iterator, bool> emplacePair = mapped_vertices.emplace(points[i], vertices.size());
+        if (emplacePair.second) { //if vertex did not exist in hashtable, add to list of vertices
+            vertices.push_back(points[i]);
+        }
+        triangles[i / 3][i % 3] = emplacePair.first->second;
+    }
 }
 
 /**
- * Takes a Mesh::Face pointer and adds it to the vector
- * of faces, connecting any faces it may share an edge with.
+ * Writes a binary STL file from indexed triangles, scaling microns back to
+ * millimeters. Triangles are written in blocks so meshes with tens of
+ * millions of triangles never need a Mesh.
  *
- * @param face The Mesh::Face to add
+ * @param stlFilePath Path of the STL file
+ * @param vertices Vertices in microns
+ * @param triangles Counter-clockwise triangles of indices into vertices
+ *
+ * @return true if the file could be written
  */
-void ProcessSTL::addMeshFace(shared_ptr<Mesh> p_mesh, shared_ptr<Mesh::Face> p_face, unordered_map<shared_ptr<Mesh::Edge>, shared_ptr<Mesh::Face>, ProcessSTL::MeshEdgePtrHash, ProcessSTL::MeshEdgePtrEquality> & mapped_p_edges) {
-    // Gather vertices and create edges
-    shared_ptr<const Mesh::Vertex> p_vert1 = p_face->p_vertex(0);
-    shared_ptr<const Mesh::Vertex> p_vert2 = p_face->p_vertex(1);
-    shared_ptr<const Mesh::Vertex> p_vert3 = p_face->p_vertex(2);
-    shared_ptr<Mesh::Edge> p_edge1(new Mesh::Edge(p_vert1, p_vert2));
-    shared_ptr<Mesh::Edge> p_edge2(new Mesh::Edge(p_vert2, p_vert3));
-    shared_ptr<Mesh::Edge> p_edge3(new Mesh::Edge(p_vert3, p_vert1));
-    shared_ptr<Mesh::Edge> edges[3] = {p_edge1, p_edge2, p_edge3};
+bool ProcessSTL::writeSTL(string stlFilePath, const vector<Vector3D> & vertices, const vector<array<uint32_t, 3>> & triangles) {
+    PROFILE_ZONE("ProcessSTL::writeSTL");
+    ofstream file;
+    
+    writeLog(INFO, "writing %lu triangles to STL file %s...", triangles.size(), stlFilePath.c_str());
+    if (!getFileHandlerOut(file, stlFilePath)) {
+        writeLog(ERROR, "unable to open file %s [%s]", stlFilePath.c_str(), strerror(errno));
+        return false;
+    }
     
-    Vector3D tv1(38100, 0, 25400);
-    Vector3D tv2(38100, 76200, 25400);
-    shared_ptr<Mesh::Vertex> tmv1(new Mesh::Vertex(tv1));
-    shared_ptr<Mesh::Vertex> tmv2(new Mesh::Vertex(tv2));
-    shared_ptr<Mesh::Edge> tme1(new Mesh::Edge(tmv1, tmv2));
+    char header[80] = "5AxLer";
+    uint32_t size = triangles.size();
+    file.write(header, 80);
+    file.write(reinterpret_cast<const char *>(&size), 4);
     
-    // Check each edge against the map of edges
-    for (unsigned int i = 0; i < 3; ++i) {
-        // Hash the Mesh::Edge to the map of edges
-        pair<unordered_map<shared_ptr<Mesh::Edge>, shared_ptr<Mesh::Face>, MeshEdgePtrHash, MeshEdgePtrEquality>::iterator, bool> emplacePair = mapped_p_edges.emplace(edges[i], p_face);
-        
-        // Get the resulting Mesh::Edge and Mesh::Face from the hash
-        shared_ptr<Mesh::Edge> hashedEdge = emplacePair.first->first;
-        shared_ptr<Mesh::Face> hashedFace = emplacePair.first->second;
-        
-        // Get whether the Mesh::Face was added
-        bool faceWasAdded = emplacePair.second;
-        
-        MeshEdgePtrEquality mepe;
-        
-        if (*edges[i] == *tme1) {
-            printf("MATCHED, faceWasAdded = %d, %d\n", faceWasAdded, mepe(edges[i], tme1));
-        }
-        
-        // If there was already a face at the edge, do some error checking and connect them
-        if (!faceWasAdded) {
-            // If the exact same face has already been added to the mesh, it's logical that
-            // it would have the exact same 3 edges. So we only check the first edge to see
-            // if the already added face is the same face
-            if (i == 0) {
-                if (hashedFace == p_face) {
-                    writeLog(WARNING, "attempted to add a face to the mesh that has already been added, skipping");
-                    return;
-                }
-            }
-            
-            // Connect the two faces
-            int16_t hashedFaceEdgeIndex = hashedFace->getEdgeIndex(hashedEdge);
-            if (hashedFaceEdgeIndex == -1) {
-                writeLog(ERROR, "edge hashed to a face but face did not have that edge, removed face from the hash for that edge");
-                return;
+    const size_t blockSize = 4096; // Triangles per write
+    vector<char> buffer(blockSize * 50);
+    for (size_t blockStart = 0; blockStart < triangles.size(); blockStart += blockSize) {
+        size_t blockEnd = min(triangles.size(), blockStart + blockSize);
+        char * p_record = buffer.data();
+        for (size_t i = blockStart; i < blockEnd; i++) {
+            const Vector3D & v0 = vertices[triangles[i][0]];
+            const Vector3D & v1 = vertices[triangles[i][1]];
+            const Vector3D & v2 = vertices[triangles[i][2]];
+            Vector3D normal = Vector3D::crossProduct(v1 - v0, v2 - v0);
+            if (normal.magnitude() > 0) {
+                normal.normalize();
             }
             
-            hashedFace->connect(p_face, hashedFace->getEdgeIndex(hashedEdge));
-            
-            p_face->connect(hashedFace, i);
-            
-            // Remove the edge from the hashmap since it's only used for the two connected triangles
-            mapped_p_edges.erase(emplacePair.first);
+            float values[12] = {
+                (float)normal.x(), (float)normal.y(), (float)normal.z(),
+                (float)(v0.x() / 1000), (float)(v0.y() / 1000), (float)(v0.z() / 1000),
+                (float)(v1.x() / 1000), (float)(v1.y() / 1000), (float)(v1.z() / 1000),
+                (float)(v2.x() / 1000), (float)(v2.y() / 1000), (float)(v2.z() / 1000)
+            };
+            uint16_t abc = 0;
+            memcpy(p_record, values, 48);
+            memcpy(p_record + 48, &abc, 2);
+            p_record += 50;
         }
+        file.write(buffer.data(), p_record - buffer.data());
     }
+    file.close();
     
-    // Finally, add the face to the mesh list of faces
-    p_mesh->addFace(p_face);
+    if (!file) {
+        writeLog(ERROR, "failed writing STL file %s", stlFilePath.c_str());
+        return false;
+    }
+    return true;
 }
 
 bool ProcessSTL::constructSTLfromMesh(const Mesh & mesh, string stlFilePath) {
@@ -8,8 +8,10 @@
 #ifndef ProcessSTL_hpp
 #define ProcessSTL_hpp
 
+#include <array>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "Mesh.hpp"
 
 namespace mapmqp {
@@ -18,6 +20,13 @@ namespace mapmqp {
         static std::shared_ptr<Mesh> constructMeshFromSTL(std::string stlFilePath);
         static bool constructSTLfromMesh(const Mesh & mesh, std::string stlFilePath);
 
+        // The stages of constructMeshFromSTL, exposed so they can be timed separately
+        static bool readSTL(std::string stlFilePath, std::vector<Vector3D> & points);
+        static void weldVertices(const std::vector<Vector3D> & points, std::vector<Vector3D> & vertices, std::vector<std::array<uint32_t, 3>> & triangles);
+
+        // Writes indexed triangles (e.g. from MeshGenerator) as a binary STL in millimeters, the inverse of readSTL and weldVertices
+        static bool writeSTL(std::string stlFilePath, const std::vector<Vector3D> & vertices, const std::vector<std::array<uint32_t, 3>> & triangles);
+
 	private:
 		/**
 		 * Creates a hash value for a Mesh::Vertex using the vertex's vector
@@ -35,29 +44,6 @@ namespace mapmqp {
 		    }
 		};
 
-		/**
-		 * Creates a hash value for a Mesh::Edge object using its vertices
-		 */
-		struct MeshEdgePtrHash {
-		    std::size_t operator()(const std::shared_ptr<Mesh::Edge> & p_me) const {
-		        Vector3DHash v3hasher;
-
-		        int hash = 17;
-		        hash = hash * 31 + v3hasher(p_me->p_vertex(0)->vertex());
-		        hash = hash * 31 + v3hasher(p_me->p_vertex(0)->vertex()); //TODO should this be accessing the second vertex instead?
-		        return std::hash<int>()(hash);
-		    }
-		};
-        
-		struct MeshEdgePtrEquality {
-		    bool operator()(const std::shared_ptr<Mesh::Edge> & p_edge1, const std::shared_ptr<Mesh::Edge> & p_edge2) const {
-		        return *p_edge1 == *p_edge2;
-		    }
-		};
-
-        static std::shared_ptr<Mesh::Vertex> addMeshVertex(std::shared_ptr<Mesh> p_mesh, std::shared_ptr<Mesh::Vertex> p_vertex, std::unordered_map<Vector3D, std::shared_ptr<Mesh::Vertex>, ProcessSTL::Vector3DHash> & mapped_p_vertices);
-        static void addMeshFace(std::shared_ptr<Mesh> p_mesh, std::shared_ptr<Mesh::Face> p_face, std::unordered_map<std::shared_ptr<Mesh::Edge>, std::shared_ptr<Mesh::Face>, ProcessSTL::MeshEdgePtrHash, ProcessSTL::MeshEdgePtrEquality> & mapped_p_edges);
-        
         static bool getFileHandlerIn(std::ifstream& file, std::string filePath);
         static bool getFileHandlerOut(std::ofstream& file, std::string filePath);
 	};
@@ -0,0 +1,120 @@
+//
+//  Profiler.cpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#include "Profiler.hpp"
+
+#ifdef PROFILING
+
+#include <mutex>
+#include <string.h>
+
+#include "Clock.hpp"
+
+using namespace mapmqp;
+using namespace std;
+
+namespace {
+    mutex s_mergedTreeMutex;
+}
+
+//defined before the exit report so it is destroyed after the report has been written
+Profiler::Node Profiler::s_mergedRoot("total", nullptr);
+
+namespace {
+    //thread local zone trees are destroyed (and merged) before any static object, so this reports every thread
+    struct ExitReport {
+        ~ExitReport() {
+            Profiler::report();
+        }
+    } s_exitReport;
+}
+
+Profiler::Zone::Zone(const char * name) :
+m_p_tree(&threadTree()) {
+    m_p_node = m_p_tree->p_current->child(name);
+    m_p_tree->p_current = m_p_node;
+    m_startTime = Clock::monotonicTime();
+}
+
+Profiler::Zone::~Zone() {
+    m_p_node->inclusiveTime += Clock::monotonicTime() - m_startTime;
+    m_p_node->calls++;
+    m_p_tree->p_current = m_p_node->p_parent;
+}
+
+Profiler::Node::Node(const char * name, Node * p_parent) :
+name(name), p_parent(p_parent) { }
+
+/**
+ * Finds the child zone with the given name, creating it if it does not exist
+ *
+ * @param childName Name of the zone
+ *
+ * @return The child zone
+ */
+Profiler::Node * Profiler::Node::child(const char * childName) {
+    for (vector<unique_ptr<Node>>::iterator it = p_children.begin(); it != p_children.end(); it++) {
+        if (((*it)->name == childName) || (strcmp((*it)->name, childName) == 0)) { //zone names are usually the same string literal
+            return it->get();
+        }
+    }
+    p_children.push_back(unique_ptr<Node>(new Node(childName, this)));
+    return p_children.back().get();
+}
+
+Profiler::ThreadTree::ThreadTree() :
+root("total", nullptr), p_current(&root) { }
+
+Profiler::ThreadTree::~ThreadTree() {
+    lock_guard<mutex> lock(s_mergedTreeMutex);
+    merge(root, s_mergedRoot);
+}
+
+Profiler::ThreadTree & Profiler::threadTree() {
+    static thread_local ThreadTree tree;
+    return tree;
+}
+
+void Profiler::merge(const Node & from, Node & into) {
+    into.inclusiveTime += from.inclusiveTime;
+    into.calls += from.calls;
+    for (vector<unique_ptr<Node>>::const_iterator it = from.p_children.begin(); it != from.p_children.end(); it++) {
+        merge(**it, *into.child((*it)->name));
+    }
+}
+
+/**
+ * Writes the zones of every thread that has exited to the log. Called
+ * automatically when the program exits, after the main thread's zones have
+ * been merged in.
+ */
+void Profiler::report() {
+    lock_guard<mutex> lock(s_mergedTreeMutex);
+    if (s_mergedRoot.p_children.empty()) {
+        return;
+    }
+    
+    writeLog(INFO, "profile: zone, inclusive ms, exclusive ms, calls");
+    for (vector<unique_ptr<Node>>::const_iterator it = s_mergedRoot.p_children.begin(); it != s_mergedRoot.p_children.end(); it++) {
+        reportNode(**it, 0);
+    }
+}
+
+void Profiler::reportNode(const Node & node, unsigned int depth) {
+    int64_t childTime = 0;
+    for (vector<unique_ptr<Node>>::const_iterator it = node.p_children.begin(); it != node.p_children.end(); it++) {
+        childTime += (*it)->inclusiveTime;
+    }
+    
+    writeLog(INFO, "profile: %*s%s, %.3f, %.3f, %llu", depth * 2, "", node.name, node.inclusiveTime / 1e6, (node.inclusiveTime - childTime) / 1e6, static_cast<unsigned long long>(node.calls));
+    for (vector<unique_ptr<Node>>::const_iterator it = node.p_children.begin(); it != node.p_children.end(); it++) {
+        reportNode(**it, depth + 1);
+    }
+}
+
+#endif /* PROFILING */
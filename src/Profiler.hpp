@@ -0,0 +1,82 @@
+//
+//  Profiler.hpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#ifndef Profiler_hpp
+#define Profiler_hpp
+
+#include "Utility.hpp"
+
+#ifdef PROFILING
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mapmqp {
+    class Profiler {
+    private:
+        struct Node;
+        struct ThreadTree;
+        
+    public:
+        //times the scope it is declared in, use through PROFILE_ZONE
+        class Zone {
+        public:
+            Zone(const char * name);
+            ~Zone();
+            
+        private:
+            ThreadTree * m_p_tree;
+            Node * m_p_node;
+            int64_t m_startTime;
+        };
+        
+        //writes the inclusive and exclusive time of every zone, merged over all threads that have finished
+        static void report();
+        
+    private:
+        //zones are kept as a tree per thread so the same zone reached through different callers is timed separately
+        struct Node {
+            const char * name;
+            Node * p_parent;
+            std::vector<std::unique_ptr<Node>> p_children;
+            int64_t inclusiveTime = 0;
+            uint64_t calls = 0;
+            
+            Node(const char * name, Node * p_parent);
+            Node * child(const char * childName);
+        };
+        
+        //zone tree of one thread, merged into the process wide tree when the thread exits
+        struct ThreadTree {
+            Node root;
+            Node * p_current;
+            
+            ThreadTree();
+            ~ThreadTree();
+        };
+        
+        static Node s_mergedRoot; //zone trees of every thread that has exited
+        
+        static ThreadTree & threadTree();
+        static void merge(const Node & from, Node & into);
+        static void reportNode(const Node & node, unsigned int depth);
+    };
+}
+
+#define PROFILE_ZONE_CONCAT_UTIL(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_UTIL(a, b)
+#define PROFILE_ZONE(name) mapmqp::Profiler::Zone PROFILE_ZONE_CONCAT(profileZone, __LINE__)(name)
+
+#else
+
+#define PROFILE_ZONE(name)
+
+#endif /* PROFILING */
+
+#endif /* Profiler_hpp */
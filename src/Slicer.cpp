@@ -8,93 +8,119 @@
 
 #include "Slicer.hpp"
 
+#include <queue>
+
+#include "Profiler.hpp"
 #include "Utility.hpp"
 
 using namespace mapmqp;
 using namespace std;
 
-Slicer::Slicer(std::shared_ptr<const Mesh> p_mesh) :
-m_p_mesh(p_mesh) { }
+#define SLICER_ARENA_COUNT 2 //slices are usually consumed one after another, so the arena of the previous slice is free again by the next one
+
+namespace {
+    //whether point lies inside the loop, both projected onto the plane spanned by axisX and axisY (crossing number test)
+    bool pointInLoop(const Vector3D & point, const ArenaArray<const Vector3D> & loop, const Vector3D & axisX, const Vector3D & axisY) {
+        double x = Vector3D::dotProduct(point, axisX), y = Vector3D::dotProduct(point, axisY);
+        bool inside = false;
+        for (size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++) {
+            double xi = Vector3D::dotProduct(loop[i], axisX), yi = Vector3D::dotProduct(loop[i], axisY);
+            double xj = Vector3D::dotProduct(loop[j], axisX), yj = Vector3D::dotProduct(loop[j], axisY);
+            if (((yi > y) != (yj > y)) && (x < xi + (y - yi) * (xj - xi) / (yj - yi))) {
+                inside = !inside;
+            }
+        }
+        return inside;
+    }
+}
+
+Slicer::Slicer(std::shared_ptr<const Mesh> p_mesh, const SlicerConfig & config) :
+m_p_mesh(p_mesh),
+m_config(config) { }
 
 Slicer::Slice Slicer::slice(const Plane & plane) {
     //TODO is this a good way to do this?
     m_originalSlicingPlane = plane;
     m_currentSlicingPlane = m_originalSlicingPlane;
-    vector<shared_ptr<const Mesh::Face>> p_faces;
+    m_checkedFaces.resize(m_p_mesh->p_faces().size());
+    m_queuedFaces.resize(m_p_mesh->p_faces().size());
+    vector<const Mesh::Face *> p_faces;
+    p_faces.reserve(m_p_mesh->p_faces().size());
     for (vector<shared_ptr<Mesh::Face>>::const_iterator it = m_p_mesh->p_faces().begin(); it != m_p_mesh->p_faces().end(); it++) {
-        p_faces.push_back(*it);
+        p_faces.push_back(it->get());
     }
-    pair<Slicer::Slice, vector<shared_ptr<const Mesh::Face>>> slicePair = slice(m_originalSlicingPlane, p_faces);
+    m_searchSpace.clear();
+    Slice firstSlice = slice(m_originalSlicingPlane, p_faces, &m_searchSpace);
 
-    m_searchSpace = slicePair.second;
-    return slicePair.first;
+    MEMORY_ACCOUNT_SET(m_memoryAccount, MemoryTracker::heapBytes(m_searchSpace));
+    return firstSlice;
 }
 
 Slicer::Slice Slicer::nextSlice() {
-    // TODO: Using hard-coded 0.1mm layer resolution right now, this should be variable
-    Plane newPlane = Plane(m_originalSlicingPlane.normal(), m_currentSlicingPlane.scalar() + 100);
+    PROFILE_ZONE("Slicer::nextSlice");
+    Plane prevPlane = m_currentSlicingPlane;
+    Plane newPlane = Plane(m_originalSlicingPlane.normal(), m_currentSlicingPlane.scalar() + m_config.layerHeight);
     m_currentSlicingPlane = newPlane;
-    m_searchSpace = expandSearchSpace(m_searchSpace, m_originalSlicingPlane, m_currentSlicingPlane);
+    m_searchSpace = expandSearchSpace(m_searchSpace, prevPlane, m_currentSlicingPlane);
+    MEMORY_ACCOUNT_SET(m_memoryAccount, MemoryTracker::heapBytes(m_searchSpace));
 
-    return slice(m_currentSlicingPlane, m_searchSpace).first;
+    return slice(m_currentSlicingPlane, m_searchSpace, nullptr);
 }
 
 /**
  * Takes a plane to slice a collection of mesh faces in. This plane
  * can be in any orientation and position relative to the origin
  *
+ * The islands and their points are built in reused scratch buffers and
+ * copied into an arena, and holes are sorted by testing the island points
+ * in place, so once the buffers and arenas have grown the islands of a
+ * layer cost no heap allocations or reference counting.
+ *
  * @param plane A Plane object representing the slicing plane
  * @param p_facesSearchSpace A vector of pointers to mesh faces which will be sliced
+ * @param p_intersectingFaces If not null, the mesh faces that intersect the slice are appended to it
  *
- * @return A pair containing the Slice object as its first element, and a vector of Mesh::Face
- *         pointers aligned with that slice as the second object
+ * @return The Slice object
  */
-pair<Slicer::Slice, vector<shared_ptr<const Mesh::Face>>> Slicer::slice(const Plane & plane, const vector<shared_ptr<const Mesh::Face>> & p_facesSearchSpace) const {
-    // Create the return slice with the plane it's on
-    Slice slice(plane, vector<shared_ptr<const Island>>());
+Slicer::Slice Slicer::slice(const Plane & plane, const vector<const Mesh::Face *> & p_facesSearchSpace, vector<const Mesh::Face *> * p_intersectingFaces) {
+    PROFILE_ZONE("Slicer::slice");
+    shared_ptr<Arena> p_arena = acquireArena();
     
-    // Our vector of Mesh::Face objects located on the slice
-    vector<shared_ptr<const Mesh::Face>> p_intersectingFaces;
+    // All discovered islands and holes
+    m_islands.clear();
     
-    // List of islands pre-ordering
-    vector<shared_ptr<Island>> p_islands;
-    // List of hole polygons and corresponding Mesh::Faces
-    vector<shared_ptr<Island>> p_holes;
-
-    // Stores all the discovered polygons before they're split off into holes and islands
-    vector<Polygon> polygons;
-    
-    // Stores the vertices that have already been evaluated by mapping its three vertices to a reference to the face
-    Identifier<Mesh::Face>::Roster checkedFacesRoster;
+    // Marks the faces that have already been evaluated
+    m_checkedFaces.clear();
     // Iterate through all faces in the search space
-    for (vector<shared_ptr<const Mesh::Face>>::const_iterator it = p_facesSearchSpace.begin(); it != p_facesSearchSpace.end(); it++) {
+    for (vector<const Mesh::Face *>::const_iterator it = p_facesSearchSpace.begin(); it != p_facesSearchSpace.end(); it++) {
         // Grab the actual Mesh::Face pointer from the iterator
-        shared_ptr<const Mesh::Face> p_face = *it;
+        const Mesh::Face * p_face = *it;
         
         // Get some information about the face in relation to the slice
-        bool alreadyMapped = checkedFacesRoster.contains(*p_face);
+        bool alreadyMapped = m_checkedFaces.marked(p_face->index());
         bool intersectsPlane = p_face->intersectsPlane(plane);
         bool liesOnPlane = p_face->liesOnPlane(plane);
         
         // Check we've never seen this face, it intersects the plane, and it doesn't lie on the plane
         if (!alreadyMapped && intersectsPlane && !liesOnPlane) {
             // Cycle around faces until circle is complete
-            vector<Vector3D> polygonPoints;
-            vector<shared_ptr<const Mesh::Face>> p_polygonMeshFaces;
+            m_polygonPoints.clear();
+            m_polygonMeshFaces.clear();
             
-            shared_ptr<const Mesh::Face> p_startFace = p_face;
-            shared_ptr<const Mesh::Face> p_currentFace = p_startFace;
+            const Mesh::Face * p_startFace = p_face;
+            const Mesh::Face * p_currentFace = p_startFace;
             Vector3D prevIntersectionPoint;
             
             int processedFaceCount = 0;
             do {
-                writeLog(INFO, "Processing face: %s", p_currentFace->toString().c_str());
                 processedFaceCount++;
                 //add ptr to Mesh::Face to list of checked faces
-                checkedFacesRoster.add(*p_currentFace);
+                m_checkedFaces.mark(p_currentFace->index());
                 
-                //add ptr to Mesh::Face to hashtable of intersection faces
-                p_intersectingFaces.push_back(p_currentFace);
+                //add ptr to Mesh::Face to list of intersection faces
+                if (p_intersectingFaces) {
+                    p_intersectingFaces->push_back(p_currentFace);
+                }
                 
                 pair<Vector3D, Vector3D> intersectionLine = p_currentFace->planeIntersection(plane);
 
@@ -108,151 +134,162 @@ pair<Slicer::Slice, vector<shared_ptr<const Mesh::Face>>> Slicer::slice(const Pl
                 }
                 prevIntersectionPoint = intersectionLine.second;
 
-                writeLog(INFO, "Intersection line (%s, %s)", intersectionLine.first.toString().c_str(), intersectionLine.second.toString().c_str());
-
                 // add first point of face intersection to list of polygon points, only if the two points don't match
                 // if the two points match, it means the face intersects with the plane exactly on a vertex, therefore
                 // the next face processed that has more than one point intersecting with the plane will also add that 
                 // point in
                 if (intersectionLine.first != intersectionLine.second) {
-                    polygonPoints.push_back(intersectionLine.first);
+                    m_polygonPoints.push_back(intersectionLine.first);
                 }
-                p_polygonMeshFaces.push_back(p_currentFace);
+                m_polygonMeshFaces.push_back(p_currentFace);
 
-                Vector3D edge0 = Vector3D::crossProduct(intersectionLine.second - p_currentFace->p_vertex(0)->vertex(), p_currentFace->p_vertex(1)->vertex() - p_currentFace->p_vertex(0)->vertex());
-                Vector3D edge1 = Vector3D::crossProduct(intersectionLine.second - p_currentFace->p_vertex(1)->vertex(), p_currentFace->p_vertex(2)->vertex() - p_currentFace->p_vertex(1)->vertex());
-                Vector3D edge2 = Vector3D::crossProduct(intersectionLine.second - p_currentFace->p_vertex(2)->vertex(), p_currentFace->p_vertex(0)->vertex() - p_currentFace->p_vertex(2)->vertex());
-                Vector3D firstEdge0 = Vector3D::crossProduct(intersectionLine.first - p_currentFace->p_vertex(0)->vertex(), p_currentFace->p_vertex(1)->vertex() - p_currentFace->p_vertex(0)->vertex());
-                Vector3D firstEdge1 = Vector3D::crossProduct(intersectionLine.first - p_currentFace->p_vertex(1)->vertex(), p_currentFace->p_vertex(2)->vertex() - p_currentFace->p_vertex(1)->vertex());
-                Vector3D firstEdge2 = Vector3D::crossProduct(intersectionLine.first - p_currentFace->p_vertex(2)->vertex(), p_currentFace->p_vertex(0)->vertex() - p_currentFace->p_vertex(2)->vertex());
-                double secondDotProds[3] = { Vector3D::dotProduct(edge0, p_currentFace->normal()), Vector3D::dotProduct(edge1, p_currentFace->normal()), Vector3D::dotProduct(edge2, p_currentFace->normal()) };
-                double firstDotProds[3] = { Vector3D::dotProduct(firstEdge0, p_currentFace->normal()), Vector3D::dotProduct(firstEdge1, p_currentFace->normal()), Vector3D::dotProduct(firstEdge2, p_currentFace->normal()) };
+                //look up the vertices and neighbors once, each lookup copies a shared_ptr
+                Vector3D vertices[3];
+                const Mesh::Face * p_neighbors[3];
+                for (int i = 0; i < 3; ++i) {
+                    vertices[i] = p_currentFace->p_vertex(i)->vertex();
+                    p_neighbors[i] = p_currentFace->p_connectedFace(i).get();
+                }
+
+                double secondDotProds[3];
+                for (int i = 0; i < 3; ++i) {
+                    Vector3D edge = vertices[(i + 1) % 3] - vertices[i];
+                    secondDotProds[i] = Vector3D::dotProduct(Vector3D::crossProduct(intersectionLine.second - vertices[i], edge), p_currentFace->normal());
+                    //dividing by the edge length gives the distance of the point from each edge, which does not grow with the size of the face
+                    secondDotProds[i] /= edge.magnitude();
+                }
 
-                writeLog(INFO, "Second intersection point:");
-                writeLog(INFO, "\tEdge #1: %s, dot prod: %f, magnitude: %f", edge0.toString().c_str(), secondDotProds[0], edge0.magnitude());
-                writeLog(INFO, "\tEdge #2: %s, dot prod: %f, magnitude: %f", edge1.toString().c_str(), secondDotProds[1], edge1.magnitude());
-                writeLog(INFO, "\tEdge #3: %s, dot prod: %f, magnitude: %f", edge2.toString().c_str(), secondDotProds[2], edge2.magnitude());
-                
-                writeLog(INFO, "First intersection point:");
-                writeLog(INFO, "\tEdge #1: %s, dot prod: %f, magnitude: %f", firstEdge0.toString().c_str(), firstDotProds[0], firstEdge0.magnitude());
-                writeLog(INFO, "\tEdge #2: %s, dot prod: %f, magnitude: %f", firstEdge1.toString().c_str(), firstDotProds[1], firstEdge1.magnitude());
-                writeLog(INFO, "\tEdge #3: %s, dot prod: %f, magnitude: %f", firstEdge2.toString().c_str(), firstDotProds[2], firstEdge2.magnitude());
 
                 //determine which edge of face is next depending on intersection with the plane and already visited status
                 bool alreadyVisited[3];
                 bool intersectsPlane[3];
                 bool liesOnPlane[3];
                 for (int i = 0; i < 3; ++i) {
-                    shared_ptr<const Mesh::Face> neighbor = p_currentFace->p_connectedFace(i);
-
-                    alreadyVisited[i] = checkedFacesRoster.contains(*(p_currentFace->p_connectedFace(i)));
-                    intersectsPlane[i] = p_currentFace->p_connectedFace(i)->intersectsPlane(plane);//Vector3D::crossProduct(intersectionLine.second - p_currentFace->p_vertex(i)->vertex(), p_currentFace->p_vertex(i + 1 == 3 ? 0 : i + 1)->vertex() - p_currentFace->p_vertex(i)->vertex()).magnitude() == 0;
-                    liesOnPlane[i] = p_currentFace->p_connectedFace(i)->liesOnPlane(plane);
-
-                    writeLog(INFO, "\tChecking neighbor: %s, %d, %d, %d", p_currentFace->p_connectedFace(i)->toString().c_str(), alreadyVisited[i], intersectsPlane[i], liesOnPlane[i]);
+                    alreadyVisited[i] = m_checkedFaces.marked(p_neighbors[i]->index());
+                    intersectsPlane[i] = p_neighbors[i]->intersectsPlane(plane);
+                    liesOnPlane[i] = p_neighbors[i]->liesOnPlane(plane);
                 }
 
+                const Mesh::Face * p_previousFace = p_currentFace;
                 for (int i = 0; i < 3; ++i) {
                     if (!alreadyVisited[i] && intersectsPlane[i] && !liesOnPlane[i] && doubleEquals(secondDotProds[i], 0.0)) {
-                        p_currentFace = p_currentFace->p_connectedFace(i);
+                        p_currentFace = p_currentFace->p_connectedFace(i).get();
                         break;
                     }
 
                     // There must be, minimum, three faces for a 3-D shape to have a closed loop, therefore we can only be back at the start if we've processed at least 2 faces
-                    if (processedFaceCount > 2 && p_currentFace->p_connectedFace(i) == p_startFace) p_currentFace = p_startFace;
+                    if (processedFaceCount > 2 && p_currentFace->p_connectedFace(i).get() == p_startFace) p_currentFace = p_startFace;
                 }
                 
                 if (!p_currentFace) {
                     writeLog(ERROR, "connected face to face being sliced is null");
                     break;
+                } else if (p_currentFace == p_previousFace) {
+                    writeLog(ERROR, "could not find next face intersecting slice plane, polygon is left open");
+                    break;
                 }
             } while (p_currentFace != p_startFace);
             
-            writeLog(INFO, "slicing face: %s", p_startFace->toString().c_str());
-            writeLog(INFO, "polygonPoints size: %d", polygonPoints.size());
-            for (int i = 0; i < polygonPoints.size(); ++i) {
-                writeLog(INFO, "%d) %s", i + 1, polygonPoints[i].toString().c_str());
+            //plane only touches the mesh at a vertex or along an edge (e.g. at the very bottom of a part)
+            if (m_polygonPoints.size() < 3) {
+                writeLog(WARNING, "skipping degenerate slice polygon with %lu points", m_polygonPoints.size());
+                continue;
             }
-            Polygon poly(polygonPoints);
-
-            // Assume all polygons are islands, not holes, initially
-            // if (poly.area() < 0) {
-            //     poly.togglePolygonType();
-            // }
-
-            // polygons.push_back(poly);
-
-            writeLog(INFO, "poly area: %f", poly.area());
-            if (poly.area() < 0) { //polygon is a hole
-                p_holes.push_back(shared_ptr<Island>(new Island(poly, p_polygonMeshFaces, true)));
-            } else {
-                p_islands.push_back(shared_ptr<Island>(new Island(poly, p_polygonMeshFaces)));
+            
+            //islands are walked counter-clockwise around the slicing plane's normal and holes clockwise
+            Vector3D doubleArea;
+            for (size_t i = 0, j = m_polygonPoints.size() - 1; i < m_polygonPoints.size(); j = i++) {
+                doubleArea = doubleArea + Vector3D::crossProduct(m_polygonPoints[j], m_polygonPoints[i]);
             }
+            bool isHole = (Vector3D::dotProduct(doubleArea, plane.normal()) < 0);
+            m_islands.push_back(Island(p_arena->copy(m_polygonPoints), p_arena->copy(m_polygonMeshFaces), isHole));
         }
     }
     
+    //move the islands into the arena so they can link to each other by index
+    Island * p_layerIslands = p_arena->allocate<Island>(m_islands.size());
+    for (size_t i = 0; i < m_islands.size(); i++) {
+        p_layerIslands[i] = m_islands[i];
+        p_layerIslands[i].m_p_layerIslands = p_layerIslands;
+    }
+    ArenaArray<const Island> islands(p_layerIslands, m_islands.size());
+    
+    //any two axes perpendicular to the plane's normal keep the loops in the plane apart
+    Vector3D normal = plane.normal();
+    Vector3D axisX = Vector3D::crossProduct(normal, (fabs(normal.x()) < 0.9) ? Vector3D(1, 0, 0) : Vector3D(0, 1, 0));
+    Vector3D axisY = Vector3D::crossProduct(normal, axisX);
+    
     //if holes exist, we need to determine which islands they belong to and if any islands are inside holes
-    if (p_holes.size() > 0) {
-        //check if each island belongs in a hole
-        for (vector<shared_ptr<Island>>::iterator islandIt = p_islands.begin(); islandIt != p_islands.end(); islandIt++) {
-            shared_ptr<Island> p_island = *islandIt;
-            Vector3D firstPoint = p_island->polygon().points()[0];
-            
-            shared_ptr<Island> p_parentHole = nullptr; //which hole (if any) island is inside of
-            for (vector<shared_ptr<Island>>::iterator holeIt = p_holes.begin(); holeIt != p_holes.end(); holeIt++) {
-                shared_ptr<Island> p_hole = *holeIt;
-                
-                //if polygon is in hole
-                if (p_hole->polygon().pointInPolygon(firstPoint)) {
-                    if (p_parentHole) {
-                        //smaller parent is more immediate parent
-                        if (p_hole->polygon().area() < p_parentHole->polygon().area()) {
-                            p_parentHole = p_hole;
-                        }
-                    } else {
-                        p_parentHole = p_hole;
-                    }
-                }
-            }
-            
-            if (!p_parentHole) { //no parent hole means island is top level island
-                slice.islands().push_back(*islandIt);
-            }
+    //islands inside a hole are not top level islands and holes are not linked yet, so neither is in the slice
+    m_p_topLevelIslands.clear();
+    for (size_t islandIndex = 0; islandIndex < islands.size(); islandIndex++) {
+        if (islands[islandIndex].isHole()) {
+            continue;
         }
+        Vector3D firstPoint = islands[islandIndex].points()[0];
         
-        //check which islands each hole belongs to
-        for (vector<shared_ptr<Island>>::iterator holeIt = p_holes.begin(); holeIt != p_holes.end(); holeIt++) {
-            shared_ptr<Island> p_hole = *holeIt;
-            Vector3D firstPoint = p_hole->polygon().points()[0];
-            
-            shared_ptr<Island> p_parentIsland = nullptr; //which island hole is inside of
-            for (vector<shared_ptr<Island>>::iterator islandIt = p_islands.begin(); islandIt != p_islands.end(); islandIt++) {
-                shared_ptr<Island> p_island = *islandIt;
-                
-                //if hole is in island
-                if (p_island->polygon().pointInPolygon(firstPoint)) {
-                    if (p_parentIsland) {
-                        //smaller parent is more immediate parent
-                        if (p_parentIsland->polygon().area() < p_parentIsland->polygon().area()) {
-                            p_parentIsland = p_hole;
-                        }
-                    } else {
-                        p_parentIsland = p_hole;
-                    }
-                }
-            }
-            
-            if (!p_parentIsland) { //every hole should have a parent island
-                writeLog(ERROR, "slice generated hole without a parent island");
-            }
+        bool inHole = false; //whether island is inside any hole
+        for (size_t holeIndex = 0; holeIndex < islands.size() && !inHole; holeIndex++) {
+            inHole = islands[holeIndex].isHole() && pointInLoop(firstPoint, islands[holeIndex].points(), axisX, axisY);
+        }
+        
+        if (!inHole) { //no parent hole means island is top level island
+            m_p_topLevelIslands.push_back(&islands[islandIndex]);
+        }
+    }
+    
+    //every hole should have a parent island
+    for (size_t holeIndex = 0; holeIndex < islands.size(); holeIndex++) {
+        if (!islands[holeIndex].isHole()) {
+            continue;
+        }
+        Vector3D firstPoint = islands[holeIndex].points()[0];
+        
+        bool inIsland = false;
+        for (size_t islandIndex = 0; islandIndex < islands.size() && !inIsland; islandIndex++) {
+            inIsland = !islands[islandIndex].isHole() && pointInLoop(firstPoint, islands[islandIndex].points(), axisX, axisY);
         }
         
-    } else { // if no holes exist, all islands are disjoint
-        for (vector<shared_ptr<Island>>::iterator it = p_islands.begin(); it != p_islands.end(); it++) {
-            slice.islands().push_back(*it);
+        if (!inIsland) {
+            writeLog(ERROR, "slice generated hole without a parent island");
+        }
+    }
+    
+#ifdef PROFILING
+    size_t arenaBytes = 0;
+    for (vector<shared_ptr<Arena>>::iterator it = m_p_arenas.begin(); it != m_p_arenas.end(); it++) {
+        arenaBytes += (*it)->capacity();
+    }
+    MEMORY_ACCOUNT_SET(m_arenaMemoryAccount, arenaBytes);
+#endif
+    
+    return Slice(plane, m_p_mesh, p_arena, p_arena->copy(m_p_topLevelIslands));
+}
+
+/**
+ * Finds an arena that no slice holds anymore and empties it. When every
+ * kept arena is still in use, the oldest one is left to its slices and
+ * replaced with a new arena.
+ *
+ * @return An empty arena
+ */
+shared_ptr<Arena> Slicer::acquireArena() {
+    for (vector<shared_ptr<Arena>>::iterator it = m_p_arenas.begin(); it != m_p_arenas.end(); it++) {
+        if (it->use_count() == 1) {
+            (*it)->reset();
+            return *it;
         }
     }
-    return pair<Slice, vector<shared_ptr<const Mesh::Face>>>(slice, p_intersectingFaces);
+    
+    shared_ptr<Arena> p_arena = make_shared<Arena>();
+    if (m_p_arenas.size() < SLICER_ARENA_COUNT) {
+        m_p_arenas.push_back(p_arena);
+    } else {
+        m_p_arenas[m_nextReplacedArena] = p_arena;
+        m_nextReplacedArena = (m_nextReplacedArena + 1) % SLICER_ARENA_COUNT;
+    }
+
+    return p_arena;
 }
 
 /**
@@ -260,22 +297,22 @@ pair<Slicer::Slice, vector<shared_ptr<const Mesh::Face>>> Slicer::slice(const Pl
  *
  * @return A vector of polygons containing all the polygons in the slice
  */
-std::vector<Polygon> Slicer::Slice::toPoly() {
+std::vector<Polygon> Slicer::Slice::toPoly() const {
     std::vector<Polygon> allPolys;
 
-    for (std::shared_ptr<const Island> island : m_p_islands) {
-        island->toPoly(allPolys);
+    for (const Island * p_island : m_p_islands) {
+        p_island->toPoly(allPolys);
     }
 
     return allPolys;
 }
 
 /**
- * Getter returns the vector of islands in the slice
+ * Getter returns the top level islands of the slice
  *
- * @return Reference to the vector containing all of the slice's islands
+ * @return Reference to the array of the slice's islands, valid while the slice exists
  */
-vector<shared_ptr<const Island>> & Slicer::Slice::islands() {
+const ArenaArray<const Island * const> & Slicer::Slice::islands() const {
     return m_p_islands;
 }
 
@@ -293,15 +330,12 @@ Plane Slicer::Slice::plane() const {
  *
  * @return A vector of mesh face pointers
  */
-vector<shared_ptr<const Mesh::Face>> Slicer::Slice::faces() const {
-    vector<shared_ptr<const Mesh::Face>> allFaces;
-
-    for (shared_ptr<const Island> island : m_p_islands) {
-        vector<shared_ptr<const Mesh::Face>> islandFaces = island->allFaces();
+vector<const Mesh::Face *> Slicer::Slice::faces() const {
+    vector<const Mesh::Face *> allFaces;
 
-        for (shared_ptr<const Mesh::Face> islandFace : islandFaces) {
-            allFaces.push_back(islandFace);
-        }
+    for (const Island * p_island : m_p_islands) {
+        vector<const Mesh::Face *> islandFaces = p_island->allFaces();
+        allFaces.insert(allFaces.end(), islandFaces.begin(), islandFaces.end());
     }
 
     return allFaces;
@@ -316,57 +350,56 @@ vector<shared_ptr<const Mesh::Face>> Slicer::Slice::faces() const {
  *
  * @return all faces that intersect the next slice plane
  */
-std::vector<std::shared_ptr<const Mesh::Face>> Slicer::expandSearchSpace(std::vector<std::shared_ptr<const Mesh::Face>> & p_facesSearchSpace, const Plane & originalPlane, const Plane & nextPlane) const {
+std::vector<const Mesh::Face *> Slicer::expandSearchSpace(std::vector<const Mesh::Face *> & p_facesSearchSpace, const Plane & originalPlane, const Plane & nextPlane) {
+    PROFILE_ZONE("Slicer::expandSearchSpace");
     if (originalPlane.pointOnPlane(nextPlane.origin()) != Plane::ABOVE) {
         writeLog(ERROR, "attempting to expand search space to slice not above previous slice");
         return p_facesSearchSpace;
     }
     
-    std::vector<std::shared_ptr<const Mesh::Face>> p_facesSearchSpaceExpanded;
+    std::vector<const Mesh::Face *> p_facesSearchSpaceExpanded;
     
-    Identifier<Mesh::Face>::Roster faceRoster; //used to check if a face has been searched
-    for (vector<shared_ptr<const Mesh::Face>>::iterator it = p_facesSearchSpace.begin(); it != p_facesSearchSpace.end(); it++) {
-        if (!faceRoster.contains(**it)) {
-            queue<shared_ptr<const Mesh::Face>> queue;
+    m_queuedFaces.clear(); //used to check if a face has been queued
+    queue<const Mesh::Face *> queue;
+    for (vector<const Mesh::Face *>::iterator it = p_facesSearchSpace.begin(); it != p_facesSearchSpace.end(); it++) {
+        if (!m_queuedFaces.marked((*it)->index())) {
+            m_queuedFaces.mark((*it)->index());
             queue.push(*it);
-            while (queue.size() > 0) {
-                //take first element in queue
-                shared_ptr<const Mesh::Face> p_face = queue.front();
-                queue.pop();
-                
-                faceRoster.add(*p_face); //mark face as searched
-                
-                bool intersectsNextPlane = false; //whether of not the face intersects the next plane
-                bool entirelyAboveNextPlane = true; //whether or not face lies entirely on/above next plane
-                
-                Plane::PLANE_POSITION positions[3]; //calculate plane position of each point
-                for (unsigned int i = 0; i < 3; i++) {
-                    positions[i] = originalPlane.pointOnPlane(p_face->p_vertex(i)->vertex());
-                    
-                    Plane::PLANE_POSITION nextPlanePos = nextPlane.pointOnPlane(p_face->p_vertex(i)->vertex());
-                    intersectsNextPlane |= (nextPlanePos != Plane::BELOW);
-                    entirelyAboveNextPlane &= (nextPlanePos != Plane::BELOW);
-                }
-                
-                if (intersectsNextPlane) {
-                    p_facesSearchSpaceExpanded.push_back(p_face);
-                }
-                
-                if (!entirelyAboveNextPlane) {
-                    for (unsigned int i = 0; i < 3; i++) { //check each edge of face
-                        Vector3D pFirst = positions[i];
-                        Vector3D pSecond = positions[i + 1];
-                        if ((originalPlane.pointOnPlane(pFirst) == Plane::ABOVE) || (originalPlane.pointOnPlane(pSecond) == Plane::ABOVE)) { //if edge contains point above plane, add neighboring face of edge to queue
-                            shared_ptr<const Mesh::Face> p_neighbor = p_face->p_connectedFace(i);
-                            if (!faceRoster.contains(*p_neighbor)) { //only add face if it has not been looked at yet
-                                queue.push(p_neighbor);
-                            }
-                        }
-                    }
+        }
+    }
+    
+    //flood fill from the faces of the previous slice through every face edge that passes between the two planes
+    while (queue.size() > 0) {
+        //take first element in queue
+        const Mesh::Face * p_face = queue.front();
+        queue.pop();
+        
+        Plane::PLANE_POSITION originalPositions[3], nextPositions[3]; //calculate plane position of each point
+        bool onOrAboveNextPlane = false, onOrBelowNextPlane = false;
+        for (unsigned int i = 0; i < 3; i++) {
+            originalPositions[i] = originalPlane.pointOnPlane(p_face->p_vertex(i)->vertex());
+            nextPositions[i] = nextPlane.pointOnPlane(p_face->p_vertex(i)->vertex());
+            onOrAboveNextPlane |= (nextPositions[i] != Plane::BELOW);
+            onOrBelowNextPlane |= (nextPositions[i] != Plane::ABOVE);
+        }
+        
+        if (onOrAboveNextPlane && onOrBelowNextPlane) {
+            p_facesSearchSpaceExpanded.push_back(p_face);
+        }
+        
+        for (unsigned int i = 0; i < 3; i++) { //check each edge of face
+            unsigned int j = (i + 1) % 3;
+            bool belowOriginalPlane = (originalPositions[i] == Plane::BELOW) && (originalPositions[j] == Plane::BELOW);
+            bool aboveNextPlane = (nextPositions[i] == Plane::ABOVE) && (nextPositions[j] == Plane::ABOVE);
+            if (!belowOriginalPlane && !aboveNextPlane) { //edge passes between the planes, neighboring face may intersect next plane
+                const Mesh::Face * p_neighbor = p_face->p_connectedFace(i).get();
+                if (p_neighbor && !m_queuedFaces.marked(p_neighbor->index())) { //only add face if it has not been looked at yet
+                    m_queuedFaces.mark(p_neighbor->index());
+                    queue.push(p_neighbor);
                 }
             }
         }
     }
     
     return p_facesSearchSpaceExpanded;
-}
\ No newline at end of file
+}
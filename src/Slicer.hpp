@@ -15,30 +15,37 @@
 #include "Vector3D.hpp"
 #include "Plane.hpp"
 #include "Mesh.hpp"
+#include "Arena.hpp"
 #include "Island.hpp"
+#include "SlicerConfig.hpp"
+#include "MemoryTracker.hpp"
+#include "VisitedMarks.hpp"
 
 namespace mapmqp {
 	// Class definition
 	class Slicer {
 	public:
+        //islands of a slice live in an Arena shared by the copies of the slice, it is reused by the Slicer once they are all gone
         class Slice {
         public:
-            Slice(Plane plane, std::vector<std::shared_ptr<const Island>> p_islands) :
-            m_plane(plane), m_p_islands(p_islands) { }
+            Slice(Plane plane, std::shared_ptr<const Mesh> p_mesh = nullptr, std::shared_ptr<Arena> p_arena = nullptr, ArenaArray<const Island * const> p_islands = ArenaArray<const Island * const>()) :
+            m_plane(plane), m_p_mesh(p_mesh), m_p_arena(p_arena), m_p_islands(p_islands) { }
 
-            std::vector<std::shared_ptr<const Island>> & islands();
+            const ArenaArray<const Island * const> & islands() const;
             Plane plane() const;
-            std::vector<std::shared_ptr<const Mesh::Face>> faces() const;
+            std::vector<const Mesh::Face *> faces() const;
             
             // Returns a Polygon object in the shape of the slice
-            std::vector<Polygon> toPoly();
+            std::vector<Polygon> toPoly() const;
         private:
             Plane m_plane;
-            std::vector<std::shared_ptr<const Island>> m_p_islands;
+            std::shared_ptr<const Mesh> m_p_mesh; //keeps the faces of the islands alive
+            std::shared_ptr<Arena> m_p_arena;
+            ArenaArray<const Island * const> m_p_islands; //top level islands
         };
         
         // Constructor
-        Slicer(std::shared_ptr<const Mesh> p_mesh);
+        Slicer(std::shared_ptr<const Mesh> p_mesh, const SlicerConfig & config);
 
         // Use to begin the slicing process and get the first slice in a particular orientation
         Slice slice(const Plane & plane);
@@ -50,17 +57,34 @@ namespace mapmqp {
         //functions
         
         //slice plane with limited search space
-        //returns slice and vector of ptrs to Mesh::Face that contained slice
-        std::pair<Slice, std::vector<std::shared_ptr<const Mesh::Face>>> slice(const Plane & plane, const std::vector<std::shared_ptr<const Mesh::Face>> & p_facesSearchSpace) const;
+        //appends the ptrs to Mesh::Face that contained slice to p_intersectingFaces unless it is null
+        Slice slice(const Plane & plane, const std::vector<const Mesh::Face *> & p_facesSearchSpace, std::vector<const Mesh::Face *> * p_intersectingFaces);
         
         //TODO this may not be the best way to pass data to this function
-        std::vector<std::shared_ptr<const Mesh::Face>> expandSearchSpace(std::vector<std::shared_ptr<const Mesh::Face>> & p_facesSearchSpace, const Plane & originalPlane, const Plane & nextPlan) const;
+        std::vector<const Mesh::Face *> expandSearchSpace(std::vector<const Mesh::Face *> & p_facesSearchSpace, const Plane & originalPlane, const Plane & nextPlan);
+        
+        //returns an empty arena that no slice uses anymore
+        std::shared_ptr<Arena> acquireArena();
         
         //variables
         std::shared_ptr<const Mesh> m_p_mesh;
+        SlicerConfig m_config;
         Plane m_originalSlicingPlane;
         Plane m_currentSlicingPlane;
-        std::vector<std::shared_ptr<const Mesh::Face>> m_searchSpace;
+        std::vector<const Mesh::Face *> m_searchSpace; //faces are owned by m_p_mesh
+        VisitedMarks m_checkedFaces; //faces already walked around by slice()
+        VisitedMarks m_queuedFaces; //faces already queued by expandSearchSpace()
+        MEMORY_ACCOUNT(m_memoryAccount, SLICER); //search space
+        
+        std::vector<std::shared_ptr<Arena>> m_p_arenas; //arenas of the most recent slices
+        unsigned int m_nextReplacedArena = 0;
+        MEMORY_ACCOUNT(m_arenaMemoryAccount, SLICER); //blocks of m_p_arenas
+        
+        //scratch buffers reused between slices, their contents are copied into the slice's arena
+        std::vector<Vector3D> m_polygonPoints;
+        std::vector<const Mesh::Face *> m_polygonMeshFaces;
+        std::vector<Island> m_islands;
+        std::vector<const Island *> m_p_topLevelIslands;
 
     };
 }
@@ -0,0 +1,213 @@
+//
+//  SlicerConfig.cpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#include "SlicerConfig.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "../libs/rapidjson/reader.h"
+#include "../libs/rapidjson/error/en.h"
+
+#include "Utility.hpp"
+
+using namespace mapmqp;
+using namespace std;
+
+namespace {
+    struct Setting {
+        const char * name;
+        double SlicerConfig::* p_value;
+    };
+
+    const Setting settings[] = {
+        { "thetaMax", &SlicerConfig::thetaMax },
+        { "aAxisRangeDegrees", &SlicerConfig::aAxisRangeDegrees },
+        { "aAxisPrecisionDegrees", &SlicerConfig::aAxisPrecisionDegrees },
+        { "bAxisRangeDegrees", &SlicerConfig::bAxisRangeDegrees },
+        { "bAxisPrecisionDegrees", &SlicerConfig::bAxisPrecisionDegrees },
+        { "layerHeight", &SlicerConfig::layerHeight },
+        { "sliceThickness", &SlicerConfig::sliceThickness }
+    };
+
+    //SAX handler that writes the members of the top level object straight into a SlicerConfig
+    //members of nested objects and arrays are skipped, unknown members are skipped with a warning
+    class SettingsHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, SettingsHandler> {
+    public:
+        SettingsHandler(SlicerConfig & config) :
+        m_config(config) { }
+
+        bool StartObject() {
+            if (!checkNotSetting("an object")) {
+                return false;
+            }
+            m_depth++;
+            return true;
+        }
+
+        bool EndObject(rapidjson::SizeType) {
+            m_depth--;
+            return true;
+        }
+
+        bool StartArray() {
+            if (m_depth == 0) {
+                writeLog(ERROR, "settings must be a json object");
+                return false;
+            } else if (!checkNotSetting("an array")) {
+                return false;
+            }
+            m_depth++;
+            return true;
+        }
+
+        bool EndArray(rapidjson::SizeType) {
+            m_depth--;
+            return true;
+        }
+
+        bool Key(const char * str, rapidjson::SizeType length, bool) {
+            if (m_depth != 1) {
+                return true;
+            }
+            m_key.assign(str, length);
+            m_p_setting = nullptr;
+            for (unsigned int i = 0; i < sizeof(settings) / sizeof(settings[0]); i++) {
+                if (m_key == settings[i].name) {
+                    m_p_setting = &settings[i];
+                    break;
+                }
+            }
+            if (!m_p_setting) {
+                writeLog(WARNING, "ignoring unknown setting \"%s\"", m_key.c_str());
+            }
+            return true;
+        }
+
+        bool Double(double d) {
+            if (m_depth == 0) {
+                writeLog(ERROR, "settings must be a json object");
+                return false;
+            }
+            if ((m_depth == 1) && m_p_setting) {
+                m_config.*(m_p_setting->p_value) = d;
+            }
+            return true;
+        }
+
+        bool Int(int i) { return Double(i); }
+        bool Uint(unsigned int u) { return Double(u); }
+        bool Int64(int64_t i) { return Double(static_cast<double>(i)); }
+        bool Uint64(uint64_t u) { return Double(static_cast<double>(u)); }
+
+        //null, booleans and strings
+        bool Default() {
+            if (m_depth == 0) {
+                writeLog(ERROR, "settings must be a json object");
+                return false;
+            }
+            return checkNotSetting("not a number");
+        }
+
+    private:
+        //a known setting may only hold a number
+        bool checkNotSetting(const char * description) {
+            if ((m_depth == 1) && m_p_setting) {
+                writeLog(ERROR, "setting \"%s\" is %s", m_key.c_str(), description);
+                return false;
+            }
+            return true;
+        }
+
+        SlicerConfig & m_config;
+        unsigned int m_depth = 0;
+        std::string m_key;
+        const Setting * m_p_setting = nullptr;
+    };
+}
+
+bool SlicerConfig::validate() const {
+    bool valid = true;
+    for (unsigned int i = 0; i < sizeof(settings) / sizeof(settings[0]); i++) {
+        double value = this->*(settings[i].p_value);
+        if (!(value > 0) || !isfinite(value)) {
+            writeLog(ERROR, "setting \"%s\" must be positive, is %f", settings[i].name, value);
+            valid = false;
+        }
+    }
+    if (thetaMax >= M_PI) {
+        writeLog(ERROR, "setting \"thetaMax\" must be less than pi, is %f", thetaMax);
+        valid = false;
+    }
+    if (aAxisPrecisionDegrees > aAxisRangeDegrees) {
+        writeLog(ERROR, "setting \"aAxisPrecisionDegrees\" is larger than \"aAxisRangeDegrees\"");
+        valid = false;
+    }
+    if (bAxisPrecisionDegrees > bAxisRangeDegrees) {
+        writeLog(ERROR, "setting \"bAxisPrecisionDegrees\" is larger than \"bAxisRangeDegrees\"");
+        valid = false;
+    }
+    return valid;
+}
+
+/**
+ * Reads settings from a json object in a single SAX pass, no document
+ * is built. Members missing from the json keep their current value.
+ *
+ * @param json Text of a json object
+ * @param config Settings to update, unchanged unless the json is valid
+ *
+ * @return true if the json could be read and all settings are valid
+ */
+bool SlicerConfig::parse(const string & json, SlicerConfig & config) {
+    SlicerConfig parsedConfig = config;
+    SettingsHandler handler(parsedConfig);
+    rapidjson::Reader reader;
+    rapidjson::StringStream stream(json.c_str());
+
+    rapidjson::ParseResult result = reader.Parse(stream, handler);
+    if (result.IsError()) {
+        if (result.Code() != rapidjson::kParseErrorTermination) { //the handler already logged why it stopped
+            writeLog(ERROR, "error parsing settings json at offset %lu: %s", result.Offset(), rapidjson::GetParseError_En(result.Code()));
+        }
+        return false;
+    } else if (!parsedConfig.validate()) {
+        return false;
+    }
+
+    config = parsedConfig;
+    return true;
+}
+
+/**
+ * Reads settings from a json file
+ *
+ * @param filePath Path of the json file
+ * @param config Settings to update, unchanged unless the file is valid
+ *
+ * @return true if the file could be read and all settings are valid
+ */
+bool SlicerConfig::load(const string & filePath, SlicerConfig & config) {
+    writeLog(INFO, "reading settings json file from %s...", filePath.c_str());
+
+    ifstream file(filePath.c_str());
+    if (!file.is_open()) {
+        writeLog(ERROR, "could not read settings json file from path %s", filePath.c_str());
+        return false;
+    }
+    stringstream jsonStream;
+    jsonStream << file.rdbuf();
+
+    if (!parse(jsonStream.str(), config)) {
+        writeLog(ERROR, "error in settings json file %s", filePath.c_str());
+        return false;
+    }
+    return true;
+}
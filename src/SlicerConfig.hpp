@@ -0,0 +1,43 @@
+//
+//  SlicerConfig.hpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#ifndef SlicerConfig_hpp
+#define SlicerConfig_hpp
+
+#include <string>
+
+namespace mapmqp {
+    //machine and slicing parameters, read once from the settings json file and passed to Slicer, BuildMap and VolumeDecomposer
+    //every member can be set in the json file by its name, members that are not in the file keep these defaults
+    struct SlicerConfig {
+        //hardware variables
+        double thetaMax = 0.785398163397448309616; //largest overhang from the build direction that can be printed, in radians (should be between 0-pi)
+
+        double aAxisRangeDegrees = 90.0;
+        double aAxisPrecisionDegrees = 0.1;
+
+        double bAxisRangeDegrees = 360.0;
+        double bAxisPrecisionDegrees = 0.1;
+
+        //slicing variables
+        double layerHeight = 100; //distance between slices in microns
+        double sliceThickness = 1; //layer thickness used to scale BuildMap cusp heights
+
+        int aAxisDiscretePoints() const { return (int)(aAxisRangeDegrees / aAxisPrecisionDegrees); }
+        int bAxisDiscretePoints() const { return (int)(bAxisRangeDegrees / bAxisPrecisionDegrees); }
+
+        //logs every invalid value and returns whether there were none
+        bool validate() const;
+
+        //reads settings from a json object, config is only changed if the json is valid
+        static bool parse(const std::string & json, SlicerConfig & config);
+        static bool load(const std::string & filePath, SlicerConfig & config);
+    };
+}
+
+#endif /* SlicerConfig_hpp */
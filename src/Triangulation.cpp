@@ -0,0 +1,280 @@
+//
+//  Triangulation.cpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#include "Triangulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Utility.hpp"
+
+using namespace mapmqp;
+using namespace std;
+using namespace ClipperLib;
+
+namespace {
+    //twice the signed area of triangle (a, b, c), positive if counter-clockwise
+    inline int64_t cross(const IntPoint & a, const IntPoint & b, const IntPoint & c) {
+        return (b.X - a.X) * (c.Y - a.Y) - (b.Y - a.Y) * (c.X - a.X);
+    }
+
+    //whether p lies inside or on the boundary of counter-clockwise triangle (a, b, c)
+    inline bool pointInTriangle(const IntPoint & a, const IntPoint & b, const IntPoint & c, const IntPoint & p) {
+        return (cross(a, b, p) >= 0) && (cross(b, c, p) >= 0) && (cross(c, a, p) >= 0);
+    }
+    
+    //twice the signed area of a loop of indices, positive if counter-clockwise
+    int64_t loopArea(const vector<uint32_t> & loop, const vector<IntPoint> & points) {
+        int64_t area = 0;
+        for (size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++) {
+            area += points[loop[j]].X * points[loop[i]].Y - points[loop[i]].X * points[loop[j]].Y;
+        }
+        return area;
+    }
+}
+
+/**
+ * Triangulates a polygon with holes. The outline and hole points are appended
+ * to points and the polygon is then triangulated by index.
+ *
+ * @param outline Outer boundary of the polygon, in either orientation
+ * @param holes Holes contained in the outline, in either orientation
+ * @param points Points referenced by the triangles, new points are appended
+ * @param triangles Counter-clockwise triangles are appended here
+ *
+ * @return false if the polygon was degenerate and some ears had to be forced
+ */
+bool Triangulation::triangulate(const Path & outline, const Paths & holes, vector<IntPoint> & points, vector<Triangle> & triangles) {
+    vector<vector<uint32_t>> loops(1);
+    for (size_t i = 0; i < outline.size(); i++) {
+        loops[0].push_back(points.size());
+        points.push_back(outline[i]);
+    }
+    for (Paths::const_iterator it = holes.begin(); it != holes.end(); it++) {
+        loops.push_back(vector<uint32_t>());
+        for (size_t i = 0; i < it->size(); i++) {
+            loops.back().push_back(points.size());
+            points.push_back((*it)[i]);
+        }
+    }
+    
+    return triangulate(points, loops, triangles);
+}
+
+/**
+ * Triangulates a polygon with holes using ear clipping. Each hole is first
+ * joined to the outline with a bridge edge (see David Eberly, "Triangulation
+ * by Ear Clipping"), which turns the polygon into a single weakly-simple loop
+ * that can then be clipped ear by ear, only testing reflex vertices for
+ * containment.
+ *
+ * @param points Coordinates of the polygon's points
+ * @param loops Indices into points, the outline first and then its holes, each in either orientation
+ * @param triangles Counter-clockwise triangles are appended here
+ *
+ * @return false if the polygon was degenerate and some ears had to be forced
+ */
+bool Triangulation::triangulate(const vector<IntPoint> & points, const vector<vector<uint32_t>> & loops, vector<Triangle> & triangles) {
+    if (loops.empty() || (loops[0].size() < 3)) {
+        writeLog(WARNING, "attempted to triangulate outline with fewer than 3 points");
+        return false;
+    }
+    
+    //outline is walked counter-clockwise and holes clockwise
+    const vector<uint32_t> & outline = loops[0];
+    vector<uint32_t> polygon(outline.begin(), outline.end());
+    if (loopArea(outline, points) < 0) {
+        reverse(polygon.begin(), polygon.end());
+    }
+    
+    //holes are bridged in order of decreasing maximum x so that a bridge never crosses a hole that has not been merged yet
+    vector<pair<cInt, vector<uint32_t>>> sortedHoles;
+    for (vector<vector<uint32_t>>::const_iterator it = loops.begin() + 1; it != loops.end(); it++) {
+        if (it->size() < 3) {
+            continue;
+        }
+        
+        vector<uint32_t> hole(it->begin(), it->end());
+        if (loopArea(hole, points) > 0) {
+            reverse(hole.begin(), hole.end());
+        }
+        cInt maxX = points[hole[0]].X;
+        for (size_t i = 1; i < hole.size(); i++) {
+            maxX = max(maxX, points[hole[i]].X);
+        }
+        sortedHoles.push_back(pair<cInt, vector<uint32_t>>(maxX, hole));
+    }
+    sort(sortedHoles.begin(), sortedHoles.end(), [](const pair<cInt, vector<uint32_t>> & h1, const pair<cInt, vector<uint32_t>> & h2) {
+        return h1.first > h2.first;
+    });
+    for (vector<pair<cInt, vector<uint32_t>>>::iterator it = sortedHoles.begin(); it != sortedHoles.end(); it++) {
+        bridgeHole(polygon, it->second, points);
+    }
+    
+    //ear clipping over a doubly linked list of positions in polygon
+    size_t n = polygon.size();
+    vector<size_t> prev(n), next(n);
+    vector<bool> reflex(n);
+    for (size_t i = 0; i < n; i++) {
+        prev[i] = (i + n - 1) % n;
+        next[i] = (i + 1) % n;
+    }
+    for (size_t i = 0; i < n; i++) {
+        reflex[i] = cross(points[polygon[prev[i]]], points[polygon[i]], points[polygon[next[i]]]) <= 0;
+    }
+
+    bool clean = true;
+    size_t remaining = n;
+    size_t current = 0;
+    size_t checked = 0; //number of vertices checked since the last ear was clipped
+    while (remaining > 3) {
+        size_t p = prev[current], nx = next[current];
+        const IntPoint & a = points[polygon[p]];
+        const IntPoint & b = points[polygon[current]];
+        const IntPoint & c = points[polygon[nx]];
+
+        bool isEar = !reflex[current];
+        if (isEar) {
+            //an ear may not contain any other reflex vertex (convex vertices can never be inside it)
+            for (size_t i = next[nx]; i != p; i = next[i]) {
+                if (reflex[i]) {
+                    const IntPoint & r = points[polygon[i]];
+                    if ((r == a) || (r == b) || (r == c)) { //duplicate points created by bridges
+                        continue;
+                    }
+                    if (pointInTriangle(a, b, c, r)) {
+                        isEar = false;
+                        break;
+                    }
+                }
+            }
+        }
+
+        //polygon is degenerate (e.g. self-touching), force an ear so the loop terminates
+        if (!isEar && (checked > remaining)) {
+            isEar = true;
+            clean = false;
+        }
+
+        if (isEar) {
+            triangles.push_back(Triangle{{polygon[p], polygon[current], polygon[nx]}});
+
+            next[p] = nx;
+            prev[nx] = p;
+            remaining--;
+            reflex[p] = cross(points[polygon[prev[p]]], a, c) <= 0;
+            reflex[nx] = cross(a, c, points[polygon[next[nx]]]) <= 0;
+
+            current = p;
+            checked = 0;
+        } else {
+            current = nx;
+            checked++;
+        }
+    }
+
+    //degenerate (zero area) triangles are kept so every edge of the polygon is still covered
+    triangles.push_back(Triangle{{polygon[prev[current]], polygon[current], polygon[next[current]]}});
+
+    if (!clean) {
+        writeLog(WARNING, "triangulated degenerate polygon, some triangles may overlap");
+    }
+    return clean;
+}
+
+/**
+ * Merges a clockwise hole into a counter-clockwise polygon by finding a vertex
+ * of the polygon that is visible from the hole's right-most vertex and splicing
+ * the hole in between two copies of the bridge.
+ *
+ * @param polygon Indices of the polygon points, modified in place
+ * @param hole Indices of the hole points
+ * @param points Point coordinates
+ */
+void Triangulation::bridgeHole(vector<uint32_t> & polygon, const vector<uint32_t> & hole, const vector<IntPoint> & points) {
+    //right-most vertex of the hole
+    size_t holeStart = 0;
+    for (size_t i = 1; i < hole.size(); i++) {
+        const IntPoint & candidate = points[hole[i]];
+        const IntPoint & best = points[hole[holeStart]];
+        if ((candidate.X > best.X) || ((candidate.X == best.X) && (candidate.Y < best.Y))) {
+            holeStart = i;
+        }
+    }
+    const IntPoint & m = points[hole[holeStart]];
+
+    //cast a ray in the +x direction and find the closest edge it hits
+    size_t edgeStart = polygon.size();
+    double closestX = INFINITY;
+    for (size_t i = 0; i < polygon.size(); i++) {
+        const IntPoint & a = points[polygon[i]];
+        const IntPoint & b = points[polygon[(i + 1) % polygon.size()]];
+        if ((a.Y == b.Y) || (a.Y > m.Y && b.Y > m.Y) || (a.Y < m.Y && b.Y < m.Y)) {
+            continue;
+        }
+
+        double x = a.X + static_cast<double>(m.Y - a.Y) * static_cast<double>(b.X - a.X) / static_cast<double>(b.Y - a.Y);
+        if ((x >= m.X) && (x < closestX)) {
+            closestX = x;
+            edgeStart = i;
+        }
+    }
+    if (edgeStart == polygon.size()) {
+        writeLog(ERROR, "could not find bridge from hole to outline while triangulating");
+        return;
+    }
+
+    //candidate is the end point of the hit edge furthest along the ray
+    size_t edgeEnd = (edgeStart + 1) % polygon.size();
+    size_t bridge = (points[polygon[edgeStart]].X > points[polygon[edgeEnd]].X) ? edgeStart : edgeEnd;
+    IntPoint hit(static_cast<cInt>(round(closestX)), m.Y);
+
+    //if a reflex vertex lies inside triangle (m, hit, candidate), the closest one in angle to the ray is visible instead
+    const IntPoint candidate = points[polygon[bridge]];
+    if (!(candidate == hit)) {
+        bool ccw = cross(m, hit, candidate) > 0;
+        const IntPoint & t0 = m;
+        const IntPoint & t1 = ccw ? hit : candidate;
+        const IntPoint & t2 = ccw ? candidate : hit;
+
+        double bestCos = -2;
+        double bestDistance = INFINITY;
+        for (size_t i = 0; i < polygon.size(); i++) {
+            const IntPoint & r = points[polygon[i]];
+            if ((i == bridge) || (r == candidate) || (r.X < m.X)) {
+                continue;
+            }
+            const IntPoint & rPrev = points[polygon[(i + polygon.size() - 1) % polygon.size()]];
+            const IntPoint & rNext = points[polygon[(i + 1) % polygon.size()]];
+            if (cross(rPrev, r, rNext) > 0) { //only reflex vertices can block the candidate
+                continue;
+            }
+            if (pointInTriangle(t0, t1, t2, r)) {
+                double dx = static_cast<double>(r.X - m.X);
+                double dy = static_cast<double>(r.Y - m.Y);
+                double distance = sqrt(dx * dx + dy * dy);
+                double cosAngle = (distance > 0) ? (dx / distance) : 1;
+                if ((cosAngle > bestCos) || ((cosAngle == bestCos) && (distance < bestDistance))) {
+                    bestCos = cosAngle;
+                    bestDistance = distance;
+                    bridge = i;
+                }
+            }
+        }
+    }
+
+    //polygon[..bridge], hole[holeStart..], hole[holeStart], polygon[bridge..]
+    vector<uint32_t> merged;
+    merged.reserve(polygon.size() + hole.size() + 2);
+    merged.insert(merged.end(), polygon.begin(), polygon.begin() + bridge + 1);
+    for (size_t i = 0; i <= hole.size(); i++) {
+        merged.push_back(hole[(holeStart + i) % hole.size()]);
+    }
+    merged.insert(merged.end(), polygon.begin() + bridge, polygon.end());
+    polygon.swap(merged);
+}
@@ -0,0 +1,37 @@
+//
+//  Triangulation.hpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#ifndef Triangulation_hpp
+#define Triangulation_hpp
+
+#include <array>
+#include <vector>
+
+#include "../libs/clipper/clipper.hpp"
+
+namespace mapmqp {
+    class Triangulation {
+    public:
+        typedef std::array<uint32_t, 3> Triangle;
+
+        //triangulates an outline and its holes (as found in a ClipperLib::PolyNode and its children) using ear clipping
+        //holes are bridged into the outline first, so the triangles cover exactly the area between the outline and its holes
+        //appends the points used to points and the counter-clockwise triangles (indices into points) to triangles
+        //coordinates must fit in 32 bits so that cross products can be computed exactly
+        static bool triangulate(const ClipperLib::Path & outline, const ClipperLib::Paths & holes, std::vector<ClipperLib::IntPoint> & points, std::vector<Triangle> & triangles);
+        
+        //same as above for loops of indices into points, loops[0] is the outline and the other loops are its holes
+        //used when the triangles have to reference existing vertices (e.g. when capping a cut mesh)
+        static bool triangulate(const std::vector<ClipperLib::IntPoint> & points, const std::vector<std::vector<uint32_t>> & loops, std::vector<Triangle> & triangles);
+
+    private:
+        static void bridgeHole(std::vector<uint32_t> & polygon, const std::vector<uint32_t> & hole, const std::vector<ClipperLib::IntPoint> & points);
+    };
+}
+
+#endif /* Triangulation_hpp */
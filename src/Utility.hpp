@@ -12,24 +12,11 @@
 #define DEBUG_MODE
 //#define PRINT_SEPERATE_LOGS
 #define PRINT_LOGS_TO_CONSOLE
+//#define PROFILING //times PROFILE_ZONE scopes and writes a report to the log at exit
 
 #define SETTINGS_JSON_FILE_PATH "./settings.json"
 
-//hardware variables
-
-#define THETA_MAX 0.785398163397448309616 //in radians (should be between 0-pi)
-
-#define A_AXIS_RANGE_DEGREES 90.0
-#define A_AXIS_PRECISION_DEGREES 0.1
-#define A_AXIS_DISCRETE_POINTS (int)(A_AXIS_RANGE_DEGREES / A_AXIS_PRECISION_DEGREES)
-
-#define B_AXIS_PRECISION_DEGREES 0.1
-#define B_AXIS_RANGE_DEGREES 360.0
-#define B_AXIS_DISCRETE_POINTS (int)(B_AXIS_RANGE_DEGREES / B_AXIS_PRECISION_DEGREES)
-
-#define SLICE_THICKNESS 1
-
-//end hardware variables
+//machine and slicing parameters are in SlicerConfig and can be set in SETTINGS_JSON_FILE_PATH
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -43,8 +30,6 @@
 
 #include <sys/stat.h>
 
-#include "../libs/rapidjson/document.h"
-
 #include "Clock.hpp"
 
 namespace mapmqp {
@@ -171,41 +156,6 @@ namespace mapmqp {
         va_end(argsConsole);
 #endif
     }
-    
-    inline const std::shared_ptr<rapidjson::Document> settingsDocument() {
-        static bool settingsInit = false;
-        static std::shared_ptr<rapidjson::Document> jsonDoc(new rapidjson::Document());
-        
-        if (!settingsInit) {
-            writeLog(INFO, "reading settings json file from %s...", SETTINGS_JSON_FILE_PATH);
-            
-            //open settings json file
-            std::ifstream jsonFile;
-            jsonFile.open(SETTINGS_JSON_FILE_PATH);
-            if (jsonFile.is_open()) {
-                //place string value of json in jsonStr
-                std::stringstream strStream;
-                strStream << jsonFile.rdbuf();
-                jsonFile.close();
-                
-                //move json string to buffer and parse into document
-                std::string jsonStr = strStream.str();
-                int jsonStrLen = strlen(jsonStr.c_str());
-                char * buffer = new char[jsonStrLen - 1]; //TODO does this need to be deleted?
-                std::memcpy(buffer, jsonStr.c_str(), jsonStrLen - 1);
-                if (jsonDoc->ParseInsitu(buffer).HasParseError()) {
-                    writeLog(ERROR, "error parsing settings json file");
-                } else {
-                    settingsInit = true;
-                }
-                writeLog(INFO, "%s:\n%s", SETTINGS_JSON_FILE_PATH, jsonStr.c_str());
-            } else {
-                writeLog(ERROR, "could not read settings json file from path %s", SETTINGS_JSON_FILE_PATH);
-            }
-        }
-        
-        return jsonDoc;
-    }
 }
 
 #endif /* Utility_hpp */
@@ -0,0 +1,57 @@
+//
+//  VisitedMarks.hpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#ifndef VisitedMarks_hpp
+#define VisitedMarks_hpp
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace mapmqp {
+    //set of dense indices (e.g. Mesh::Face::index()) for graph searches
+    //an index is marked when its stamp equals the current epoch, so clearing the set only increments the epoch
+    //marks are owned by whoever searches, so several threads can search the same mesh with their own marks
+    class VisitedMarks {
+    public:
+        VisitedMarks(std::size_t size = 0) :
+        m_stamps(size, 0) { }
+
+        //number of indices that can be marked, indices added by growing are unmarked
+        std::size_t size() const {
+            return m_stamps.size();
+        }
+
+        void resize(std::size_t size) {
+            m_stamps.resize(size, 0);
+        }
+
+        //unmarks every index
+        void clear() {
+            m_epoch++;
+            if (m_epoch == 0) { //stamps from 2^32 clears ago would look current, start over
+                std::fill(m_stamps.begin(), m_stamps.end(), 0);
+                m_epoch = 1;
+            }
+        }
+
+        void mark(uint32_t index) {
+            m_stamps[index] = m_epoch;
+        }
+
+        bool marked(uint32_t index) const {
+            return m_stamps[index] == m_epoch;
+        }
+
+    private:
+        std::vector<uint32_t> m_stamps; //epoch each index was last marked in
+        uint32_t m_epoch = 1;
+    };
+}
+
+#endif /* VisitedMarks_hpp */
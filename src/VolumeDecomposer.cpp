@@ -7,140 +7,530 @@
 //
 
 #include "VolumeDecomposer.hpp"
-#include "Slicer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include "Profiler.hpp"
+#include "Triangulation.hpp"
+#include "Utility.hpp"
+
+// Number of clipper units per mesh unit, the slice coordinates are rounded to this precision
+#define DECOMPOSER_PRECISION 10
+// Fraction of the allowed overhang added to it so that walls exactly at the overhang angle are not split off
+#define OVERHANG_TOLERANCE 0.01
 
 using namespace mapmqp;
 using namespace std;
+using namespace ClipperLib;
+
+namespace {
+	// A connected region of a layer that no piece of the previous layer has claimed yet
+	struct Region {
+		Paths paths;
+		IntRect bounds;
+	};
+
+	// Bounding box of a set of paths
+	IntRect pathsBounds(const Paths & paths) {
+		IntRect bounds = {0, 0, 0, 0};
+		bool first = true;
+		for (Paths::const_iterator pathIt = paths.begin(); pathIt != paths.end(); pathIt++) {
+			for (Path::const_iterator pointIt = pathIt->begin(); pointIt != pathIt->end(); pointIt++) {
+				if (first) {
+					bounds.left = bounds.right = pointIt->X;
+					bounds.top = bounds.bottom = pointIt->Y;
+					first = false;
+				} else {
+					bounds.left = min(bounds.left, pointIt->X);
+					bounds.right = max(bounds.right, pointIt->X);
+					bounds.top = min(bounds.top, pointIt->Y);
+					bounds.bottom = max(bounds.bottom, pointIt->Y);
+				}
+			}
+		}
+		return bounds;
+	}
+
+	bool boundsOverlap(const IntRect & bounds1, const IntRect & bounds2) {
+		return (bounds1.left <= bounds2.right) && (bounds2.left <= bounds1.right) && (bounds1.top <= bounds2.bottom) && (bounds2.top <= bounds1.bottom);
+	}
+
+	// Splits a clipper PolyTree into one set of paths per outline, holding the outline and its holes. Outlines nested inside holes get their own set
+	void splitTree(const PolyTree & tree, vector<Paths> & regions) {
+		vector<const PolyNode *> outlines;
+		for (int i = 0; i < tree.ChildCount(); i++) {
+			outlines.push_back(tree.Childs[i]);
+		}
+
+		while (!outlines.empty()) {
+			const PolyNode * p_outline = outlines.back();
+			outlines.pop_back();
+
+			regions.push_back(Paths());
+			regions.back().push_back(p_outline->Contour);
+			for (int i = 0; i < p_outline->ChildCount(); i++) {
+				const PolyNode * p_hole = p_outline->Childs[i];
+				regions.back().push_back(p_hole->Contour);
+				for (int j = 0; j < p_hole->ChildCount(); j++) {
+					outlines.push_back(p_hole->Childs[j]);
+				}
+			}
+		}
+	}
+
+	// Points of one slicing plane of a sub-volume mesh, sorted so that they can be found by binary search
+	struct CapPlane {
+		vector<IntPoint> points;
+		vector<bool> rounded; // Whether each point was only made by clipper, where outlines of the two layers cross
+		uint32_t firstVertex; // Mesh vertex of points[0], the other points follow it in order
+	};
+
+	bool pointLess(const IntPoint & p1, const IntPoint & p2) {
+		return (p1.X < p2.X) || ((p1.X == p2.X) && (p1.Y < p2.Y));
+	}
+
+	// Index of a point in the plane
+	uint32_t planePoint(const CapPlane & plane, const IntPoint & point) {
+		return lower_bound(plane.points.begin(), plane.points.end(), point, pointLess) - plane.points.begin();
+	}
+
+	// Appends the points of the plane that lie on the open edge (a, b) ordered from a to b, rounded points counting up to a clipper unit
+	// away from it. Splitting every edge of a plane this way gives walls and caps the same edges wherever they meet
+	void splitEdge(const CapPlane & plane, const IntPoint & a, const IntPoint & b, vector<uint32_t> & loop) {
+		double dx = static_cast<double>(b.X - a.X);
+		double dy = static_cast<double>(b.Y - a.Y);
+		double lengthSquared = dx * dx + dy * dy;
+		IntPoint low(min(a.X, b.X) - 1, min(a.Y, b.Y) - 1);
+
+		vector<pair<double, uint32_t>> onEdge;
+		for (vector<IntPoint>::const_iterator it = lower_bound(plane.points.begin(), plane.points.end(), low, pointLess); (it != plane.points.end()) && (it->X <= max(a.X, b.X) + 1); it++) {
+			if ((it->Y < low.Y) || (it->Y > max(a.Y, b.Y) + 1) || (*it == a) || (*it == b)) {
+				continue;
+			}
+			double px = static_cast<double>(it->X - a.X);
+			double py = static_cast<double>(it->Y - a.Y);
+			double along = px * dx + py * dy;
+			double across = px * dy - py * dx;
+			if ((along > 0) && (along < lengthSquared) && ((across == 0) || (plane.rounded[it - plane.points.begin()] && (across * across <= lengthSquared)))) {
+				onEdge.push_back(pair<double, uint32_t>(along, it - plane.points.begin()));
+			}
+		}
+
+		sort(onEdge.begin(), onEdge.end());
+		for (vector<pair<double, uint32_t>>::const_iterator it = onEdge.begin(); it != onEdge.end(); it++) {
+			loop.push_back(it->second);
+		}
+	}
+
+	// A path of the plane as a loop of plane point indices, with the points lying on its edges inserted
+	vector<uint32_t> splitLoop(const CapPlane & plane, const Path & path) {
+		vector<uint32_t> loop;
+		for (size_t i = 0; i < path.size(); i++) {
+			loop.push_back(planePoint(plane, path[i]));
+			splitEdge(plane, path[i], path[(i + 1) % path.size()], loop);
+		}
+		return loop;
+	}
+}
+
+VolumeDecomposer::VolumeDecomposer(const SlicerConfig & config) :
+m_config(config) { }
 
-vector<shared_ptr<Mesh>> run(shared_ptr<Mesh> p_mesh, Plane orientation) {
+/**
+ * Decomposes a mesh into sub-volumes that can each be built along the
+ * orientation's normal. The mesh is sliced layer by layer; each layer's
+ * area is split into pieces, and every piece is either:
+ *		- supported: it lies within the area of a piece of the previous layer grown by
+ *		  the allowed overhang, in which case it joins that piece's sub-volume
+ *		- overhanging: it lies outside all grown pieces of the previous layer
+ *		  and starts a new sub-volume
+ * Each grown piece claims what is left unclaimed of the layer regions its bounds
+ * overlap, with a single clipper pass, and whatever is left at the end overhangs.
+ * Pieces are grouped with a union-find over piece indices, so the whole
+ * decomposition only ever compares a layer to the one directly below it.
+ *
+ * @param p_mesh The mesh to decompose
+ * @param orientation The first slicing plane, its normal is the build direction
+ *
+ * @return One closed mesh per sub-volume
+ */
+vector<shared_ptr<Mesh>> VolumeDecomposer::run(shared_ptr<Mesh> p_mesh, Plane orientation) {
+	PROFILE_ZONE("VolumeDecomposer::run");
 	// The return vector
 	vector<shared_ptr<Mesh>> decomposedVolumes;
 
-	// Initializes the slicer for the decomposition
-	Slicer slicer = Slicer(p_mesh);
+	m_pieces.clear();
+	MEMORY_ACCOUNT_SET(m_memoryAccount, 0);
+	m_layerScalars.clear();
+	m_subVolumes = UnionFind();
+	// Replaced by the actual plane spacing once a second layer is sliced
+	m_layerThickness = m_config.layerHeight;
 
-	// The two slice planes that will be used, one on top of the other
-	Plane firstPlane = orientation;
+	// Right-handed axes of the slicing plane, so counter-clockwise outlines face along the normal
+	m_planeNormal = orientation.normal();
+	m_planeNormal.normalize();
+	Vector3D helper = (fabs(m_planeNormal.z()) < 0.9) ? Vector3D(0, 0, 1) : Vector3D(1, 0, 0);
+	m_planeAxisX = Vector3D::crossProduct(m_planeNormal, helper);
+	m_planeAxisX.normalize();
+	m_planeAxisY = Vector3D::crossProduct(m_planeNormal, m_planeAxisX);
 
-	// The comparison slice used to determine the buildable portions of the model
-	Slicer::Slice comparisonSlice = slicer.slice(firstPlane);
+	// Initializes the slicer for the decomposition
+	Slicer slicer = Slicer(p_mesh, m_config);
+	Slicer::Slice currSlice = slicer.slice(orientation);
 
-	// The polygonal representations of both slices
-	vector<Polygon> comparisonPoly = comparisonSlice.toPoly();
+	unsigned int prevLayerStart = 0;
+	unsigned int layer = 0;
+	while (currSlice.islands().size() > 0) {
+		PolyTree area;
+		sliceToTree(currSlice, area);
+		m_layerScalars.push_back(currSlice.plane().scalar());
+		unsigned int layerStart = m_pieces.size();
 
-	// Retrieve the first slice
-	Slicer::Slice currSlice = slicer.nextSlice();
+		if (layer == 0) {
+			// The first layer rests on the build plate, every piece starts a sub-volume
+			addPieces(area, layer);
+		} else {
+			m_layerThickness = m_layerScalars[layer] - m_layerScalars[layer - 1];
+			double allowedOverhang = m_layerThickness * tan(m_config.thetaMax) * (1.0 + OVERHANG_TOLERANCE) * DECOMPOSER_PRECISION;
 
-	// TODO: Update the slicer to have hasNextSlice(), nextSlice(), and plane()
-	// Go through all the slices
-	while (currSlice.islands().size() > 0) {
-		// Go through each face in the slice
-		for (shared_ptr<const Mesh::Face> mf : currSlice.faces()) {
-			// Check that all points of the face are inside the comparison poly
-			bool allInsideComparison = true;
-			bool allOutsideComparison = true;
-			vector<Vector3D> flattenedPoints;
-
-			for (int i = 0; i < 3 && allInsideComparison; ++i) {
-				// TODO: write a dropVertexToPlane function that drops each vertex of a face
-				// onto the plane along the normal of the plane
-				Vector3D pt = dropVertexToPlane(mf->p_vertex(i)->vertex(), currSlice.plane());
-
-				// Check if the point is in the polygon and update the flags
-				// A point directly on the polygon boundary is considered outside
-				bool inPoly = pointInPolygonArray(comparisonPoly, pt);
-				allInsideComparison &= (inPoly == 1);
-				allOutsideComparison &= (inPoly <= 0);
-
-				// Add the point to our vector of flattened points
-				flattenedPoints.push_back(pt);
+			// Grow the pieces of the previous layer by the allowed overhang
+			for (unsigned int i = prevLayerStart; i < layerStart; i++) {
+				ClipperOffset offset;
+				offset.AddPaths(m_pieces[i].paths, jtMiter, etClosedPolygon);
+				offset.Execute(m_pieces[i].grownPaths, allowedOverhang);
 			}
 
-			// TODO: Figure out a better way to handle fatal errors
-			// Error case where the vertices of the triangle are all both in and out of the comparison poly
-			if (allInsideComparison && allOutsideComparison) {
-				writeLog(ERROR, "all of the vertices of a triangle are both inside and outside the comparison polygon");
-				exit(0);
+			vector<Paths> areaRegions;
+			splitTree(area, areaRegions);
+			vector<Region> unclaimed(areaRegions.size());
+			for (unsigned int i = 0; i < areaRegions.size(); i++) {
+				unclaimed[i].bounds = pathsBounds(areaRegions[i]);
+				unclaimed[i].paths.swap(areaRegions[i]);
 			}
-			// Second case where the triangle has some vertices inside and some vertices outside the polygon
-			else if (!allInsideComparison && !allOutsideComparison) {
-				// First, check to see if the comparison polygon and triangle are parallel to each other
-				bool parallel = areParallel(comparisonPoly, mf);
-				vector<std::shared_ptr<Mesh::Face>> newFaces;
-
-				// If they are not parallel, we can find the intersection between comparison poly and face
-				if (!parallel) {
-					// TODO: Write function that takes the comparison poly and the mesh face
-					// and returns the <x, y, z> intersecting point
-					Vector3D intersection = findPolyFaceIntersection(mf, comparisonPoly);
-
-					// TODO: Write a function that takes a point on the face and a split direction
-					// and splits the face along that direction, creating three new faces
-					// newFaces = splitFaceAlongDirection(mf, intersection, plane.normal());
+
+			// Supported area is split between the pieces below it, each point going to the first piece that supports it
+			for (unsigned int i = prevLayerStart; i < layerStart; i++) {
+				IntRect grownBounds = pathsBounds(m_pieces[i].grownPaths);
+				vector<Region>::iterator candidates = partition(unclaimed.begin(), unclaimed.end(), [&grownBounds](const Region & region) {
+					return !boundsOverlap(region.bounds, grownBounds);
+				});
+				if (m_pieces[i].grownPaths.empty() || (candidates == unclaimed.end())) {
+					continue;
+				}
+
+				// The piece claims the part of the candidates it covers and leaves the rest, both from the same clipper edges
+				Clipper claimClipper;
+				for (vector<Region>::const_iterator it = candidates; it != unclaimed.end(); it++) {
+					claimClipper.AddPaths(it->paths, ptSubject, true);
 				}
-				// However if they are parallel, we must cut the triangle with the slice
-				else {
-					// TODO: Write a function that takes the face and the comparison polygon,
-					// intersects them, 
-					// newFaces = splitFaceAlongSlice(mf, comparisonPoly);
+				claimClipper.AddPaths(m_pieces[i].grownPaths, ptClip, true);
+				PolyTree claimTree, restTree;
+				claimClipper.Execute(ctIntersection, claimTree, pftNonZero, pftNonZero);
+				claimClipper.Execute(ctDifference, restTree, pftNonZero, pftNonZero);
+
+				unsigned int childStart = m_pieces.size();
+				addPieces(claimTree, layer);
+				for (unsigned int child = childStart; child < m_pieces.size(); child++) {
+					m_subVolumes.join(child, i);
+				}
+
+				unclaimed.erase(candidates, unclaimed.end());
+				vector<Paths> restRegions;
+				splitTree(restTree, restRegions);
+				for (vector<Paths>::iterator it = restRegions.begin(); it != restRegions.end(); it++) {
+					unclaimed.push_back(Region());
+					unclaimed.back().bounds = pathsBounds(*it);
+					unclaimed.back().paths.swap(*it);
 				}
 			}
+
+			// Overhang is whatever the grown previous layer does not cover
+			for (vector<Region>::iterator it = unclaimed.begin(); it != unclaimed.end(); it++) {
+				addPiece(it->paths, layer);
+			}
+
+			// Grown paths are only needed while the next layer is processed
+			for (unsigned int i = prevLayerStart; i < layerStart; i++) {
+				Paths().swap(m_pieces[i].grownPaths);
+			}
 		}
 
+		prevLayerStart = layerStart;
+		layer++;
+
 		// Get the next slice
 		currSlice = slicer.nextSlice();
 	}
 
+	// Group pieces by sub-volume, in order of each sub-volume's first piece
+	map<unsigned int, unsigned int> rootToVolume;
+	vector<vector<unsigned int>> volumePieces;
+	for (unsigned int i = 0; i < m_pieces.size(); i++) {
+		unsigned int root = m_subVolumes.find(i);
+		pair<map<unsigned int, unsigned int>::iterator, bool> emplacePair = rootToVolume.emplace(root, volumePieces.size());
+		if (emplacePair.second) {
+			volumePieces.push_back(vector<unsigned int>());
+		}
+		volumePieces[emplacePair.first->second].push_back(i);
+	}
+
+	writeLog(INFO, "decomposed mesh into %zu sub-volumes over %u layers", volumePieces.size(), layer);
+
+	for (vector<vector<unsigned int>>::iterator it = volumePieces.begin(); it != volumePieces.end(); it++) {
+		decomposedVolumes.push_back(piecesToMesh(*it));
+	}
+
 	return decomposedVolumes;
 }
 
 /**
- * findPolyFaceIntersection is fairly straightforward:
- * 1. Iterate through each line segment in the polygon
- * 2. Take the mesh face and the two points of the line and pass them through the following equations:
- *		d = (n_x * x_0) + (n_y * y_0) + (n_z * z_0)
- *		t = (d - x_0 - y_0 - z_0) / (deltaX + deltaY + deltaZ)
- *		
- *		d is part of the scalar equation of the plane
- *		<n_x, n_y, n_z> are the face's normal
- *		<x_0, y_0, z_0> in the top equation is the <x, y, z> of one of the face's vertices
- *		<x_0, y_0, z_0> in the bottom equation is the <x, y, z> of one of the endpoints of the line
- *		deltaX = x_1 - x_0, where x_1 is the other endpoint of the line's x-coordinate (etc for deltaY, deltaZ)
- * 3. Now we check t. If 0 <= t <= 1, then the line from the comparison poly intersects the face
- * 4. In that case, we plug t into the following equation to get the final intersection's <x, y, z>:
- *		r(t) = <x_0 + deltaX*t, y_0 + deltaY*t, z_0 + deltaZ*t>
- *		<x_0, y_0, z_0> is the first endpoint of the line
- *		deltaX etc are defined as above
- * 5. Otherwise, the line does not intersect and we move on to the next line
- * 6. If no intersections are found, an exception is thrown
+ * Maps the polygons of a slice onto the 2D axes of the slicing plane and
+ * takes their even-odd union, which gives the filled area of the slice no
+ * matter how the slicer oriented islands and holes.
+ *
+ * @param slice The slice to project
+ * @param area Filled with the area of the slice in clipper coordinates
  */
-Vector3D findPolyFaceIntersection(shared_ptr<const Mesh::Face> face, Polygon intersectingPoly) {
-	const Vector3D faceVert = face->p_vertex(0)->vertex();
-	const Vector3D faceNorm = face->normal();
-	const std::vector<Vector3D> polyPoints = intersectingPoly.points();
+void VolumeDecomposer::sliceToTree(Slicer::Slice & slice, PolyTree & area) const {
+	Paths loops;
+	vector<Polygon> polygons = slice.toPoly();
+	for (vector<Polygon>::const_iterator it = polygons.begin(); it != polygons.end(); it++) {
+		Path loop;
+		loop.reserve(it->points().size());
+		for (vector<Vector3D>::const_iterator pointIt = it->points().begin(); pointIt != it->points().end(); pointIt++) {
+			loop << IntPoint(llround(Vector3D::dotProduct(*pointIt, m_planeAxisX) * DECOMPOSER_PRECISION), llround(Vector3D::dotProduct(*pointIt, m_planeAxisY) * DECOMPOSER_PRECISION));
+		}
+		loops.push_back(loop);
+	}
 
-	double d = (faceNorm.x() * faceVert.x()) + (faceNorm.y() * faceVert.y()) + (faceNorm.z() * faceVert.z());
+	Clipper clipper;
+	clipper.AddPaths(loops, ptSubject, true);
+	clipper.Execute(ctUnion, area, pftEvenOdd, pftEvenOdd);
+}
 
-	for (int i = 0; i < 3; ++i) {
-		Vector3D p1 = polyPoints[i];
-		Vector3D p2 = (i == 2) ? polyPoints[0] : polyPoints[i + 1];
+/**
+ * Adds one piece per outline of a clipper PolyTree, each holding the
+ * outline and its holes. Outlines nested inside holes become their own pieces.
+ *
+ * @param tree The area to split
+ * @param layer Layer index of the area
+ */
+void VolumeDecomposer::addPieces(const PolyTree & tree, unsigned int layer) {
+	vector<Paths> regions;
+	splitTree(tree, regions);
+	for (vector<Paths>::iterator it = regions.begin(); it != regions.end(); it++) {
+		addPiece(*it, layer);
+	}
+}
 
-		double dX = p2.x() - p1.x();
-		double dY = p2.y() - p1.y();
-		double dZ = p2.z() - p1.z();
+/**
+ * Adds a piece, which starts out as its own sub-volume.
+ *
+ * @param paths Outline and holes of the piece, moved into the piece
+ * @param layer Layer index of the piece
+ */
+void VolumeDecomposer::addPiece(Paths & paths, unsigned int layer) {
+	m_pieces.push_back(Piece());
+	m_pieces.back().layer = layer;
+	m_pieces.back().paths.swap(paths);
+	MEMORY_ACCOUNT_ADD(m_memoryAccount, MemoryTracker::heapBytes(m_pieces.back().paths));
+	m_subVolumes.add();
+}
 
-		double t = (d - p1.x() - p1.y() - p1.z()) / (dX + dY + dZ);
+/**
+ * Builds a closed mesh out of a group of pieces. The pieces of each layer
+ * are merged into the sub-volume's area in that layer, whose outlines and
+ * holes are extruded into walls one layer thick. On each slicing plane the
+ * sub-volume only gets caps where it ends: facing up where the layer below
+ * is not covered by the layer above, and facing down the other way round,
+ * so stacked layers never leave faces inside the volume. All walls and caps
+ * of a plane share its vertices and split their edges at each other's
+ * points, which makes the whole sub-volume a single shell.
+ *
+ * @param pieceIndices Indices of the pieces making up the sub-volume
+ *
+ * @return The sub-volume's mesh
+ */
+shared_ptr<Mesh> VolumeDecomposer::piecesToMesh(const vector<unsigned int> & pieceIndices) const {
+	shared_ptr<Mesh> p_mesh(new Mesh());
 
-		if (t >= 0 && t <= 1) {
-			double newX = p1.x() + dX * t;
-			double newY = p1.y() + dY * t;
-			double newZ = p1.z() + dZ * t;
-			Vector3D intersectPoint = Vector3D(newX, newY, newZ);
+	unsigned int firstLayer = m_pieces[pieceIndices.front()].layer;
+	unsigned int lastLayer = firstLayer;
+	for (vector<unsigned int>::const_iterator it = pieceIndices.begin(); it != pieceIndices.end(); it++) {
+		firstLayer = min(firstLayer, m_pieces[*it].layer);
+		lastLayer = max(lastLayer, m_pieces[*it].layer);
+	}
+	unsigned int layerCount = lastLayer - firstLayer + 1;
 
-			return intersectPoint;
+	// Area of the sub-volume in each of its layers, with touching pieces merged so no wall runs between them
+	vector<Paths> layerAreas(layerCount);
+	{
+		vector<Paths> layerPieces(layerCount);
+		for (vector<unsigned int>::const_iterator it = pieceIndices.begin(); it != pieceIndices.end(); it++) {
+			const Paths & paths = m_pieces[*it].paths;
+			layerPieces[m_pieces[*it].layer - firstLayer].insert(layerPieces[m_pieces[*it].layer - firstLayer].end(), paths.begin(), paths.end());
+		}
+		for (unsigned int i = 0; i < layerCount; i++) {
+			Clipper clipper;
+			clipper.AddPaths(layerPieces[i], ptSubject, true);
+			clipper.Execute(ctUnion, layerAreas[i], pftNonZero, pftNonZero);
 		}
 	}
 
-	writeLog(ERROR, "when trying to find the intersection between a face and a polygon, no intersection was found");
-	exit(0);
-}
\ No newline at end of file
+	// Plane i is the bottom of layer i and the top of layer i - 1
+	vector<Vector3D> vertices;
+	vector<array<uint32_t, 3>> triangles;
+	vector<CapPlane> planes(layerCount + 1);
+	for (unsigned int i = 0; i <= layerCount; i++) {
+		const Paths noArea;
+		const Paths & below = (i > 0) ? layerAreas[i - 1] : noArea;
+		const Paths & above = (i < layerCount) ? layerAreas[i] : noArea;
+
+		PolyTree upTree, downTree;
+		Clipper upClipper;
+		upClipper.AddPaths(below, ptSubject, true);
+		upClipper.AddPaths(above, ptClip, true);
+		upClipper.Execute(ctDifference, upTree, pftNonZero, pftNonZero);
+		Clipper downClipper;
+		downClipper.AddPaths(above, ptSubject, true);
+		downClipper.AddPaths(below, ptClip, true);
+		downClipper.Execute(ctDifference, downTree, pftNonZero, pftNonZero);
+		vector<Paths> upCaps, downCaps;
+		splitTree(upTree, upCaps);
+		splitTree(downTree, downCaps);
+
+		CapPlane & plane = planes[i];
+		vector<IntPoint> outlinePoints;
+		const Paths * planePaths[2] = {&below, &above};
+		for (unsigned int j = 0; j < 2; j++) {
+			for (Paths::const_iterator pathIt = planePaths[j]->begin(); pathIt != planePaths[j]->end(); pathIt++) {
+				outlinePoints.insert(outlinePoints.end(), pathIt->begin(), pathIt->end());
+			}
+		}
+		sort(outlinePoints.begin(), outlinePoints.end(), pointLess);
+		plane.points = outlinePoints;
+		vector<Paths> * capRegions[2] = {&upCaps, &downCaps};
+		for (unsigned int j = 0; j < 2; j++) {
+			for (vector<Paths>::const_iterator regionIt = capRegions[j]->begin(); regionIt != capRegions[j]->end(); regionIt++) {
+				for (Paths::const_iterator pathIt = regionIt->begin(); pathIt != regionIt->end(); pathIt++) {
+					plane.points.insert(plane.points.end(), pathIt->begin(), pathIt->end());
+				}
+			}
+		}
+		sort(plane.points.begin(), plane.points.end(), pointLess);
+		plane.points.erase(unique(plane.points.begin(), plane.points.end()), plane.points.end());
+		plane.rounded.resize(plane.points.size());
+		for (size_t j = 0; j < plane.points.size(); j++) {
+			plane.rounded[j] = !binary_search(outlinePoints.begin(), outlinePoints.end(), plane.points[j], pointLess);
+		}
+
+		plane.firstVertex = vertices.size();
+		unsigned int layerIndex = firstLayer + i;
+		double scalar = (layerIndex < m_layerScalars.size()) ? m_layerScalars[layerIndex] : m_layerScalars.back() + m_layerThickness;
+		Vector3D planeOffset = m_planeNormal * scalar;
+		for (vector<IntPoint>::const_iterator pointIt = plane.points.begin(); pointIt != plane.points.end(); pointIt++) {
+			vertices.push_back(planeOffset + m_planeAxisX * (static_cast<double>(pointIt->X) / DECOMPOSER_PRECISION) + m_planeAxisY * (static_cast<double>(pointIt->Y) / DECOMPOSER_PRECISION));
+		}
+
+		// Triangulation returns counter-clockwise triangles, which face along the normal
+		for (unsigned int j = 0; j < 2; j++) {
+			for (vector<Paths>::const_iterator regionIt = capRegions[j]->begin(); regionIt != capRegions[j]->end(); regionIt++) {
+				vector<vector<uint32_t>> loops;
+				for (Paths::const_iterator pathIt = regionIt->begin(); pathIt != regionIt->end(); pathIt++) {
+					loops.push_back(splitLoop(plane, *pathIt));
+				}
+				vector<Triangulation::Triangle> capTriangles;
+				Triangulation::triangulate(plane.points, loops, capTriangles);
+				for (vector<Triangulation::Triangle>::const_iterator triIt = capTriangles.begin(); triIt != capTriangles.end(); triIt++) {
+					uint32_t a = (*triIt)[0] + plane.firstVertex;
+					uint32_t b = (*triIt)[1] + plane.firstVertex;
+					uint32_t c = (*triIt)[2] + plane.firstVertex;
+					triangles.push_back((j == 0) ? array<uint32_t, 3>{{a, b, c}} : array<uint32_t, 3>{{a, c, b}});
+				}
+			}
+		}
+	}
+
+	// Clipper stores outlines counter-clockwise and holes clockwise, so the solid is always left of an edge. Each edge's wall is a strip
+	// between the points of the bottom and top planes that lie on it, merged in order along the edge
+	for (unsigned int i = 0; i < layerCount; i++) {
+		const CapPlane & bottomPlane = planes[i];
+		const CapPlane & topPlane = planes[i + 1];
+		for (Paths::const_iterator pathIt = layerAreas[i].begin(); pathIt != layerAreas[i].end(); pathIt++) {
+			for (size_t j = 0; j < pathIt->size(); j++) {
+				const IntPoint & a = (*pathIt)[j];
+				const IntPoint & b = (*pathIt)[(j + 1) % pathIt->size()];
+				vector<uint32_t> bottom(1, planePoint(bottomPlane, a)), top(1, planePoint(topPlane, a));
+				splitEdge(bottomPlane, a, b, bottom);
+				splitEdge(topPlane, a, b, top);
+				bottom.push_back(planePoint(bottomPlane, b));
+				top.push_back(planePoint(topPlane, b));
+
+				double dx = static_cast<double>(b.X - a.X);
+				double dy = static_cast<double>(b.Y - a.Y);
+				size_t k = 0, l = 0;
+				while ((k + 1 < bottom.size()) || (l + 1 < top.size())) {
+					bool advanceBottom = (l + 1 == top.size());
+					if ((k + 1 < bottom.size()) && !advanceBottom) {
+						const IntPoint & nextBottom = bottomPlane.points[bottom[k + 1]];
+						const IntPoint & nextTop = topPlane.points[top[l + 1]];
+						advanceBottom = (nextBottom.X - a.X) * dx + (nextBottom.Y - a.Y) * dy <= (nextTop.X - a.X) * dx + (nextTop.Y - a.Y) * dy;
+					}
+					if (advanceBottom) {
+						triangles.push_back(array<uint32_t, 3>{{bottom[k] + bottomPlane.firstVertex, bottom[k + 1] + bottomPlane.firstVertex, top[l] + topPlane.firstVertex}});
+						k++;
+					} else {
+						triangles.push_back(array<uint32_t, 3>{{bottom[k] + bottomPlane.firstVertex, top[l + 1] + topPlane.firstVertex, top[l] + topPlane.firstVertex}});
+						l++;
+					}
+				}
+			}
+		}
+	}
+
+	p_mesh->addShell(vertices, triangles);
+	return p_mesh;
+}
+
+unsigned int VolumeDecomposer::UnionFind::add() {
+	unsigned int element = m_parents.size();
+	m_parents.push_back(element);
+	m_ranks.push_back(0);
+	return element;
+}
+
+unsigned int VolumeDecomposer::UnionFind::find(unsigned int element) {
+	unsigned int root = element;
+	while (m_parents[root] != root) {
+		root = m_parents[root];
+	}
+
+	// Path compression
+	while (m_parents[element] != root) {
+		unsigned int next = m_parents[element];
+		m_parents[element] = root;
+		element = next;
+	}
+
+	return root;
+}
+
+void VolumeDecomposer::UnionFind::join(unsigned int element1, unsigned int element2) {
+	unsigned int root1 = find(element1);
+	unsigned int root2 = find(element2);
+	if (root1 == root2) {
+		return;
+	}
+
+	// Union by rank
+	if (m_ranks[root1] < m_ranks[root2]) {
+		m_parents[root1] = root2;
+	} else if (m_ranks[root1] > m_ranks[root2]) {
+		m_parents[root2] = root1;
+	} else {
+		m_parents[root2] = root1;
+		m_ranks[root1]++;
+	}
+}
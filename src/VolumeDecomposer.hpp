@@ -9,23 +9,67 @@
 #ifndef VolumeDecomposer_hpp
 #define VolumeDecomposer_hpp
 
+#include <memory>
+#include <vector>
+
+#include "../libs/clipper/clipper.hpp"
+
 #include "Mesh.hpp"
-#include "Polygon.hpp"
+#include "Plane.hpp"
+#include "Slicer.hpp"
+#include "SlicerConfig.hpp"
+#include "MemoryTracker.hpp"
 
 namespace mapmqp {
 	// Class definition
 	class VolumeDecomposer {
 	public:
 		// Constructor
-		VolumeDecomposer();
+		VolumeDecomposer(const SlicerConfig & config);
 
 		// Returns the decomposed array of sub-meshes
 		std::vector<std::shared_ptr<Mesh>> run(std::shared_ptr<Mesh> p_mesh, Plane orientation);
 
 	private:
-		// Finds the point of intersection between the face and the intersecting poly
-		Vector3D findPolyFaceIntersection(std::shared_ptr<const Mesh::Face> face, Polygon intersectingPoly);
+		// A connected region of one layer (an outline and its holes) in slicing plane coordinates
+		struct Piece {
+			unsigned int layer;
+			ClipperLib::Paths paths;
+			ClipperLib::Paths grownPaths; // Paths offset by the allowed overhang, i.e. the area this piece supports
+		};
+
+		// Disjoint set forest over piece indices, used to group pieces into sub-volumes
+		class UnionFind {
+		public:
+			unsigned int add();
+			unsigned int find(unsigned int element);
+			void join(unsigned int element1, unsigned int element2);
+
+		private:
+			std::vector<unsigned int> m_parents;
+			std::vector<unsigned int> m_ranks;
+		};
+
+		// Projects a slice onto the slicing plane's 2D coordinates and fills in its filled area
+		void sliceToTree(Slicer::Slice & slice, ClipperLib::PolyTree & area) const;
+
+		// Splits an area into its connected pieces
+		void addPieces(const ClipperLib::PolyTree & tree, unsigned int layer);
+
+		// Adds a single piece, taking its paths
+		void addPiece(ClipperLib::Paths & paths, unsigned int layer);
+
+		// Builds the closed mesh of a group of pieces
+		std::shared_ptr<Mesh> piecesToMesh(const std::vector<unsigned int> & pieceIndices) const;
+
+		SlicerConfig m_config;
+		Vector3D m_planeAxisX, m_planeAxisY, m_planeNormal;
+		std::vector<double> m_layerScalars;
+		double m_layerThickness = 0;
+		std::vector<Piece> m_pieces;
+		UnionFind m_subVolumes;
+		MEMORY_ACCOUNT(m_memoryAccount, DECOMPOSER); // Paths of m_pieces
 	};
 }
 
-#endif /* VolumeDecomposer_hpp */
\ No newline at end of file
+#endif /* VolumeDecomposer_hpp */
@@ -33,7 +33,9 @@
 #include "BuildMapToMATLAB.hpp"
 #include "Slicer.hpp"
 #include "DirectedGraph.hpp"
-// #include "VolumeDecomposer.hpp"
+#include "VolumeDecomposer.hpp"
+#include "MemoryTracker.hpp"
+#include "SlicerConfig.hpp"
 //end debugging
 
 using namespace mapmqp;
@@ -89,7 +91,6 @@ int main(int argc, const char * argv[]) {
     }
     
     //     mapmqp::writeLog(mapmqp::INFO, "starting 5AxLer at time %s", mapmqp::Clock::wallTimeString().c_str());
-    //     mapmqp::settingsDocument();
     
     //     mapmqp::Mesh mesh;
     
@@ -107,7 +108,13 @@ int main(int argc, const char * argv[]) {
         return 0;
     }
     
+    SlicerConfig config;
+    if (!SlicerConfig::load(SETTINGS_JSON_FILE_PATH, config)) {
+        writeLog(WARNING, "using default settings");
+    }
+    
     std::shared_ptr<mapmqp::Mesh> p_mesh = ProcessSTL::constructMeshFromSTL(argv[1]);
+    MEMORY_REPORT("loading STL");
     const std::vector<std::shared_ptr<mapmqp::Mesh::Face>> meshFaces = p_mesh->p_faces();
     // for (uint32_t i = 0; i < meshFaces.size(); ++i) {
     //     const std::shared_ptr<mapmqp::Mesh::Face> currFace = meshFaces[i];
@@ -131,23 +138,22 @@ int main(int argc, const char * argv[]) {
     // }
 
     // THIS SECTION FOR TESTING VOLUME DECOMPOSITION
-    // VolumeDecomposer decomposer = VolumeDecomposer(p_mesh, Plane());
+    // VolumeDecomposer decomposer(config);
+    // vector<shared_ptr<Mesh>> p_subMeshes = decomposer.run(p_mesh, Plane());
+    // for (unsigned int i = 0; i < p_subMeshes.size(); i++) {
+    //     ProcessSTL::constructSTLfromMesh(*p_subMeshes[i], "debug/sub-volume-" + to_string(i) + ".STL");
+    // }
     // END TESTING VOLUME DECOMPOSITION
 
     // THIS SECTION FOR TESTING SLICING
-    Slicer slicer = Slicer(p_mesh);
+    Slicer slicer = Slicer(p_mesh, config);
     Plane originPlane = Plane();
     Slicer::Slice slice = slicer.slice(originPlane);
 
     int sliceCount = 0;
     do {
         sliceCount++;
-        vector<shared_ptr<const Island>> islands = slice.islands();
-        vector<Polygon> islandPolys;
-
-        for (int i = 0; i < islands.size(); ++i) {
-            islands[i]->toPoly(islandPolys);
-        }
+        vector<Polygon> islandPolys = slice.toPoly();
 
         for (int i = 0; i < islandPolys.size(); ++i) {
             vector<Vector3D> points = islandPolys[i].points();
@@ -161,6 +167,7 @@ int main(int argc, const char * argv[]) {
         slice = slicer.nextSlice();
         writeLog(INFO, "Number of islands: %d", slice.islands().size());
     } while (slice.islands().size() > 0);
+    MEMORY_REPORT("slicing");
 
     // for (shared_ptr<const Mesh::Face> p_faceSlicer : firstSlice.faces()) {
     //     writeLog(INFO, "%s", p_faceSlicer->toString());
@@ -169,7 +176,7 @@ int main(int argc, const char * argv[]) {
     
     // ProcessSTL::constructSTLfromMesh(*p_mesh, "debug/TestSTL.STL");
     
-    // mapmqp::BuildMap map(p_mesh);
+    // mapmqp::BuildMap map(p_mesh, config);
     // map.solve();
     // BuildMapToMATLAB::parse("debug/buildmap-plane.m", map, BuildMapToMATLAB::PLANE, 25);
     // BuildMapToMATLAB::parse("debug/buildmap-sphere.m", map, BuildMapToMATLAB::SPHERE, 25);
@@ -177,7 +184,7 @@ int main(int argc, const char * argv[]) {
     
     // map.checkVector(mapmqp::Vector3D(mapmqp::Angle(0), mapmqp::Angle(0)));
     
-    // double originalArea = A_AXIS_DISCRETE_POINTS * B_AXIS_DISCRETE_POINTS;
+    // double originalArea = config.aAxisDiscretePoints() * config.bAxisDiscretePoints();
     // printf("original area: %f\n", originalArea);
     
     // double area = map.area();
@@ -0,0 +1,64 @@
+//
+//  ArenaTest.cpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#include "../libs/Catch/catch.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include "../src/Arena.hpp"
+
+using namespace mapmqp;
+
+TEST_CASE("Arena hands out aligned memory and reuses it after reset", "[Arena]") {
+    Arena arena(256);
+
+    SECTION("allocations are aligned for their type") {
+        arena.allocate<char>(3);
+        double * p_double = arena.allocate<double>(2);
+        REQUIRE(reinterpret_cast<uintptr_t>(p_double) % alignof(double) == 0);
+        arena.allocate<char>(1);
+        uint32_t * p_int = arena.allocate<uint32_t>(1);
+        REQUIRE(reinterpret_cast<uintptr_t>(p_int) % alignof(uint32_t) == 0);
+    }
+
+    SECTION("copies keep their values across blocks") {
+        std::vector<int> first(50, 1), second(100, 2);
+        ArenaArray<const int> firstCopy = arena.copy(first);
+        ArenaArray<const int> secondCopy = arena.copy(second);
+        REQUIRE(firstCopy.size() == 50);
+        REQUIRE(secondCopy.size() == 100);
+        for (size_t i = 0; i < firstCopy.size(); i++) {
+            REQUIRE(firstCopy[i] == 1);
+        }
+        for (const int * p_value = secondCopy.begin(); p_value != secondCopy.end(); p_value++) {
+            REQUIRE(*p_value == 2);
+        }
+    }
+
+    SECTION("allocations larger than a block get their own block") {
+        char * p_large = arena.allocate<char>(1000);
+        p_large[999] = 'x';
+        REQUIRE(arena.capacity() >= 1000);
+    }
+
+    SECTION("reset reuses blocks without growing") {
+        for (int i = 0; i < 10; i++) {
+            arena.allocate<double>(20);
+        }
+        size_t capacity = arena.capacity();
+        double * p_first = arena.allocate<double>(1);
+
+        arena.reset();
+        for (int i = 0; i < 10; i++) {
+            arena.allocate<double>(20);
+        }
+        REQUIRE(arena.allocate<double>(1) == p_first);
+        REQUIRE(arena.capacity() == capacity);
+    }
+}
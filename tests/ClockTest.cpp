@@ -0,0 +1,35 @@
+//
+//  ClockTest.cpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#include "../libs/Catch/catch.hpp"
+
+#include <thread>
+
+#include "../src/Clock.hpp"
+
+using namespace mapmqp;
+
+TEST_CASE("Clock measures durations with a monotonic clock", "[Clock]") {
+    SECTION("monotonic time never goes backwards") {
+        int64_t previous = Clock::monotonicTime();
+        for (int i = 0; i < 1000; i++) {
+            int64_t current = Clock::monotonicTime();
+            REQUIRE(current >= previous);
+            previous = current;
+        }
+    }
+    
+    SECTION("delta resets and split does not") {
+        Clock clock;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        int64_t split = clock.splitNanoseconds();
+        REQUIRE(split >= 5000000);
+        REQUIRE(clock.deltaNanoseconds() >= split);
+        REQUIRE(clock.splitNanoseconds() < split);
+    }
+}
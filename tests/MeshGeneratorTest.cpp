@@ -0,0 +1,90 @@
+//
+//  MeshGeneratorTest.cpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#include "../libs/Catch/catch.hpp"
+
+#include <map>
+
+#include "../src/Utility.hpp"
+#include "../src/MeshGenerator.hpp"
+#include "../src/Mesh.hpp"
+
+using namespace mapmqp;
+
+namespace {
+    //every directed edge is used once and its reverse is used by exactly one other triangle
+    bool closedAndManifold(const std::vector<MeshGenerator::Triangle> & triangles) {
+        std::map<std::pair<uint32_t, uint32_t>, int> edgeCounts;
+        for (const MeshGenerator::Triangle & triangle : triangles) {
+            for (int i = 0; i < 3; i++) {
+                edgeCounts[std::make_pair(triangle[i], triangle[(i + 1) % 3])]++;
+            }
+        }
+        for (const std::pair<const std::pair<uint32_t, uint32_t>, int> & edge : edgeCounts) {
+            std::map<std::pair<uint32_t, uint32_t>, int>::iterator reverse = edgeCounts.find(std::make_pair(edge.first.second, edge.first.first));
+            if ((edge.second != 1) || (reverse == edgeCounts.end()) || (reverse->second != 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //signed volume, positive when the triangles face outwards
+    double volume(const std::vector<Vector3D> & vertices, const std::vector<MeshGenerator::Triangle> & triangles) {
+        double total = 0;
+        for (const MeshGenerator::Triangle & triangle : triangles) {
+            total += Vector3D::dotProduct(vertices[triangle[0]], Vector3D::crossProduct(vertices[triangle[1]], vertices[triangle[2]])) / 6;
+        }
+        return total;
+    }
+}
+
+TEST_CASE("generated meshes are closed and face outwards", "[MeshGenerator]") {
+    std::vector<Vector3D> vertices;
+    std::vector<MeshGenerator::Triangle> triangles;
+
+    SECTION("sphere") {
+        MeshGenerator::sphere(10000, 8, vertices, triangles);
+        REQUIRE(triangles.size() == 12 * 8 * 8);
+        REQUIRE(closedAndManifold(triangles));
+        REQUIRE(volume(vertices, triangles) == Approx(4.0 / 3.0 * M_PI * 1e12).epsilon(0.05));
+    }
+
+    SECTION("torus") {
+        MeshGenerator::torus(20000, 5000, 40, 20, vertices, triangles);
+        REQUIRE(triangles.size() == 2 * 40 * 20);
+        REQUIRE(closedAndManifold(triangles));
+        REQUIRE(volume(vertices, triangles) == Approx(2 * M_PI * M_PI * 20000 * 5000.0 * 5000).epsilon(0.05));
+    }
+
+    SECTION("gyroid") {
+        MeshGenerator::gyroid(20000, 10000, 0.5, 32, vertices, triangles);
+        REQUIRE(triangles.size() > 0);
+        REQUIRE(closedAndManifold(triangles));
+        REQUIRE(volume(vertices, triangles) > 0);
+    }
+
+    SECTION("honeycomb") {
+        MeshGenerator::perforatedBlock(5, 4, 2000, 1600, 6, 3000, 3, vertices, triangles);
+        REQUIRE(closedAndManifold(triangles));
+        double cellArea = 1.5 * sqrt(3.0) * 2000 * 2000, holeArea = 1.5 * sqrt(3.0) * 1600 * 1600;
+        REQUIRE(volume(vertices, triangles) == Approx(20 * (cellArea - holeArea) * 3000).epsilon(0.01));
+    }
+
+    SECTION("all shapes by name") {
+        for (const std::string & shape : MeshGenerator::shapes()) {
+            REQUIRE(MeshGenerator::generate(shape, 5000, vertices, triangles));
+            REQUIRE(closedAndManifold(triangles));
+
+            Mesh mesh;
+            mesh.addShell(vertices, triangles);
+            REQUIRE(mesh.p_faces().size() == triangles.size());
+        }
+        REQUIRE_FALSE(MeshGenerator::generate("cube", 5000, vertices, triangles));
+    }
+}
@@ -17,3 +17,71 @@ TEST_CASE("build a basic Mesh from a STL file", "[Mesh]") {
         
     }
 }
+
+namespace {
+    //builds a closed axis-aligned cube with one corner at the origin
+    std::shared_ptr<Mesh> cubeMesh(double size) {
+        std::vector<Vector3D> vertices;
+        for (int i = 0; i < 8; i++) {
+            vertices.push_back(Vector3D((i & 1) * size, ((i >> 1) & 1) * size, ((i >> 2) & 1) * size));
+        }
+        std::vector<std::array<uint32_t, 3>> triangles = {
+            {{0, 2, 3}}, {{0, 3, 1}}, {{4, 5, 7}}, {{4, 7, 6}}, //bottom, top
+            {{0, 1, 5}}, {{0, 5, 4}}, {{2, 6, 7}}, {{2, 7, 3}}, //front, back
+            {{0, 4, 6}}, {{0, 6, 2}}, {{1, 3, 7}}, {{1, 7, 5}} //left, right
+        };
+        
+        std::shared_ptr<Mesh> p_mesh(new Mesh());
+        p_mesh->addShell(vertices, triangles);
+        return p_mesh;
+    }
+    
+    //volume enclosed by a closed mesh, by the divergence theorem
+    double meshVolume(const Mesh & mesh) {
+        double volume = 0;
+        for (std::shared_ptr<Mesh::Face> p_face : mesh.p_faces()) {
+            volume += Vector3D::dotProduct(p_face->p_vertex(0)->vertex(), Vector3D::crossProduct(p_face->p_vertex(1)->vertex(), p_face->p_vertex(2)->vertex())) / 6;
+        }
+        return volume;
+    }
+    
+    bool meshClosed(const Mesh & mesh) {
+        for (std::shared_ptr<Mesh::Face> p_face : mesh.p_faces()) {
+            for (uint16_t i = 0; i < 3; i++) {
+                if (!p_face->p_connectedFace(i)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+TEST_CASE("cut a Mesh into two closed parts", "[Mesh]") {
+    std::shared_ptr<Mesh> p_cube = cubeMesh(10);
+    REQUIRE(meshVolume(*p_cube) == Approx(1000));
+    
+    SECTION("cut through the middle of faces") {
+        Vector3D normal(1, 2, 3);
+        std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Mesh>> parts = p_cube->cut(Plane(normal, Vector3D::dotProduct(Vector3D(5, 5, 5), normal) / normal.magnitude()));
+        REQUIRE(meshClosed(*parts.first));
+        REQUIRE(meshClosed(*parts.second));
+        REQUIRE(meshVolume(*parts.first) == Approx(500));
+        REQUIRE(meshVolume(*parts.second) == Approx(500));
+    }
+    
+    SECTION("cut through vertices") {
+        Vector3D normal(1, 1, 0);
+        std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Mesh>> parts = p_cube->cut(Plane(normal, Vector3D::dotProduct(Vector3D(5, 5, 5), normal) / normal.magnitude()));
+        REQUIRE(meshClosed(*parts.first));
+        REQUIRE(meshClosed(*parts.second));
+        REQUIRE(meshVolume(*parts.first) == Approx(500));
+        REQUIRE(meshVolume(*parts.second) == Approx(500));
+    }
+    
+    SECTION("cut along a face") {
+        std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Mesh>> parts = p_cube->cut(Plane(Vector3D(0, 0, 1), 10));
+        REQUIRE(parts.first->p_faces().size() == 12);
+        REQUIRE(parts.second->p_faces().size() == 0);
+    }
+}
@@ -0,0 +1,52 @@
+//
+//  SlicerConfigTest.cpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#include "../libs/Catch/catch.hpp"
+
+#include "../src/SlicerConfig.hpp"
+
+using namespace mapmqp;
+
+TEST_CASE("SlicerConfig reads and validates settings json", "[SlicerConfig]") {
+    SlicerConfig config;
+
+    SECTION("defaults match the machine") {
+        REQUIRE(config.aAxisDiscretePoints() == 900);
+        REQUIRE(config.bAxisDiscretePoints() == 3600);
+        REQUIRE(config.validate());
+    }
+
+    SECTION("settings in the json are set and others keep their value") {
+        REQUIRE(SlicerConfig::parse("{ \"layerHeight\": 200, \"aAxisPrecisionDegrees\": 0.5 }", config));
+        REQUIRE(config.layerHeight == 200);
+        REQUIRE(config.aAxisPrecisionDegrees == 0.5);
+        REQUIRE(config.aAxisDiscretePoints() == 180);
+        REQUIRE(config.bAxisPrecisionDegrees == SlicerConfig().bAxisPrecisionDegrees);
+    }
+
+    SECTION("unknown and nested settings are skipped") {
+        REQUIRE(SlicerConfig::parse("{ \"name\": \"Ethan\", \"extra\": { \"layerHeight\": 5 }, \"list\": [1, 2], \"sliceThickness\": 2 }", config));
+        REQUIRE(config.layerHeight == SlicerConfig().layerHeight);
+        REQUIRE(config.sliceThickness == 2);
+    }
+
+    SECTION("invalid json leaves the config unchanged") {
+        REQUIRE_FALSE(SlicerConfig::parse("{ \"layerHeight\": 200, ", config));
+        REQUIRE_FALSE(SlicerConfig::parse("{ \"layerHeight\": 200, \"thetaMax\": \"wide\" }", config));
+        REQUIRE_FALSE(SlicerConfig::parse("{ \"layerHeight\": [200] }", config));
+        REQUIRE_FALSE(SlicerConfig::parse("[]", config));
+        REQUIRE(config.layerHeight == SlicerConfig().layerHeight);
+    }
+
+    SECTION("out of range settings are rejected") {
+        REQUIRE_FALSE(SlicerConfig::parse("{ \"layerHeight\": 0 }", config));
+        REQUIRE_FALSE(SlicerConfig::parse("{ \"thetaMax\": 4 }", config));
+        REQUIRE_FALSE(SlicerConfig::parse("{ \"bAxisPrecisionDegrees\": 400 }", config));
+        REQUIRE(config.validate());
+    }
+}
@@ -0,0 +1,42 @@
+//
+//  TimeEstimateTest.cpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#include "../libs/Catch/catch.hpp"
+
+#include <cmath>
+
+#include "../libs/Cura/timeEstimate.h"
+
+using namespace cura;
+
+TEST_CASE("Streamed time estimates match planning all moves at once", "[TimeEstimate]") {
+    // An arc of short segments never reaches its maximum entry speed within a single segment,
+    // so the moves only leave the lookahead window when it is full.
+    const double segmentLength = 0.3;
+    const double speed = 60;
+    const double acceleration = 3000;
+    const double radius = segmentLength / (2 * std::sin(M_PI / 360)); // 1 degree per segment
+    const unsigned int segmentCount = 4 * TimeEstimateCalculator::lookahead_size;
+    
+    TimeEstimateCalculator calculator;
+    calculator.setAcceleration(acceleration);
+    for (unsigned int i = 1; i <= segmentCount; i++) {
+        double angle = i * M_PI / 180;
+        calculator.plan(TimeEstimateCalculator::Position(radius * std::sin(angle), radius * (1 - std::cos(angle)), 0, 0), speed);
+    }
+    REQUIRE(calculator.getRunningTime() > 0);
+    
+    // planned all at once, the arc accelerates from the junction speed of the first move (half the xy jerk) once,
+    // cruises at the nominal speed across every split of the window and decelerates to the minimum planner speed once
+    const double entrySpeed = 10;
+    const double exitSpeed = 0.05;
+    const double expected = segmentCount * segmentLength / speed
+        + (speed - entrySpeed) * (speed - entrySpeed) / (2 * acceleration * speed)
+        + (speed - exitSpeed) * (speed - exitSpeed) / (2 * acceleration * speed);
+    REQUIRE(calculator.calculate() == Approx(expected).epsilon(1e-6));
+}
@@ -0,0 +1,49 @@
+//
+//  VisitedMarksTest.cpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#include "../libs/Catch/catch.hpp"
+
+#include "../src/VisitedMarks.hpp"
+
+using namespace mapmqp;
+
+TEST_CASE("VisitedMarks marks dense indices and clears by epoch", "[VisitedMarks]") {
+    VisitedMarks marks(10);
+
+    SECTION("indices start unmarked") {
+        for (uint32_t i = 0; i < marks.size(); i++) {
+            REQUIRE_FALSE(marks.marked(i));
+        }
+    }
+
+    SECTION("marking only marks that index") {
+        marks.mark(3);
+        REQUIRE(marks.marked(3));
+        REQUIRE_FALSE(marks.marked(2));
+        REQUIRE_FALSE(marks.marked(4));
+    }
+
+    SECTION("clear unmarks every index") {
+        for (uint32_t i = 0; i < marks.size(); i++) {
+            marks.mark(i);
+        }
+        marks.clear();
+        for (uint32_t i = 0; i < marks.size(); i++) {
+            REQUIRE_FALSE(marks.marked(i));
+        }
+        marks.mark(7);
+        REQUIRE(marks.marked(7));
+    }
+
+    SECTION("growing keeps marks and adds unmarked indices") {
+        marks.mark(9);
+        marks.resize(20);
+        REQUIRE(marks.marked(9));
+        REQUIRE_FALSE(marks.marked(15));
+    }
+}
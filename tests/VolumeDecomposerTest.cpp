@@ -0,0 +1,103 @@
+//
+//  VolumeDecomposerTest.cpp
+//  5AxLer
+//
+//  Created by MAP MQP on 1/20/17.
+//  Copyright © 2016 MAP MQP. All rights reserved.
+//
+
+#include "../libs/Catch/catch.hpp"
+
+#include "../src/Utility.hpp"
+#include "../src/Triangulation.hpp"
+#include "../src/VolumeDecomposer.hpp"
+
+using namespace mapmqp;
+
+namespace {
+    //builds a closed mushroom: a square stem with a wider square cap on top of it
+    std::shared_ptr<Mesh> mushroomMesh(double stemHalfWidth, double stemHeight, double capHalfWidth, double capHeight) {
+        std::vector<Vector3D> vertices;
+        double stem[4][2] = {{-stemHalfWidth, -stemHalfWidth}, {stemHalfWidth, -stemHalfWidth}, {stemHalfWidth, stemHalfWidth}, {-stemHalfWidth, stemHalfWidth}};
+        double cap[4][2] = {{-capHalfWidth, -capHalfWidth}, {capHalfWidth, -capHalfWidth}, {capHalfWidth, capHalfWidth}, {-capHalfWidth, capHalfWidth}};
+        for (int i = 0; i < 4; i++) vertices.push_back(Vector3D(stem[i][0], stem[i][1], 0)); //0-3
+        for (int i = 0; i < 4; i++) vertices.push_back(Vector3D(stem[i][0], stem[i][1], stemHeight)); //4-7
+        for (int i = 0; i < 4; i++) vertices.push_back(Vector3D(cap[i][0], cap[i][1], stemHeight)); //8-11
+        for (int i = 0; i < 4; i++) vertices.push_back(Vector3D(cap[i][0], cap[i][1], stemHeight + capHeight)); //12-15
+
+        std::vector<std::array<uint32_t, 3>> triangles;
+        triangles.push_back({{0, 2, 1}}); //stem bottom
+        triangles.push_back({{0, 3, 2}});
+        triangles.push_back({{12, 13, 14}}); //cap top
+        triangles.push_back({{12, 14, 15}});
+        for (uint32_t i = 0; i < 4; i++) {
+            uint32_t j = (i + 1) % 4;
+            triangles.push_back({{i, j, j + 4}}); //stem walls
+            triangles.push_back({{i, j + 4, i + 4}});
+            triangles.push_back({{i + 8, j + 8, j + 12}}); //cap walls
+            triangles.push_back({{i + 8, j + 12, i + 12}});
+        }
+
+        //underside of the cap is a square ring, triangulated with the stem as a hole
+        ClipperLib::Path outline, hole;
+        for (int i = 0; i < 4; i++) outline << ClipperLib::IntPoint(cap[i][0], cap[i][1]);
+        for (int i = 0; i < 4; i++) hole << ClipperLib::IntPoint(stem[i][0], stem[i][1]);
+        std::vector<ClipperLib::IntPoint> ringPoints;
+        std::vector<Triangulation::Triangle> ringTriangles;
+        REQUIRE(Triangulation::triangulate(outline, ClipperLib::Paths(1, hole), ringPoints, ringTriangles));
+        for (Triangulation::Triangle & triangle : ringTriangles) {
+            uint32_t indices[3];
+            for (int k = 0; k < 3; k++) {
+                const ClipperLib::IntPoint & p = ringPoints[triangle[k]];
+                for (uint32_t v = 4; v < 12; v++) {
+                    if ((vertices[v].x() == p.X) && (vertices[v].y() == p.Y)) {
+                        indices[k] = v;
+                    }
+                }
+            }
+            triangles.push_back({{indices[0], indices[2], indices[1]}}); //facing down
+        }
+
+        std::shared_ptr<Mesh> p_mesh(new Mesh());
+        p_mesh->addShell(vertices, triangles);
+        return p_mesh;
+    }
+}
+
+TEST_CASE("triangulate a square with a square hole", "[VolumeDecomposer]") {
+    ClipperLib::Path outline, hole;
+    outline << ClipperLib::IntPoint(0, 0) << ClipperLib::IntPoint(10, 0) << ClipperLib::IntPoint(10, 10) << ClipperLib::IntPoint(0, 10);
+    hole << ClipperLib::IntPoint(3, 3) << ClipperLib::IntPoint(7, 3) << ClipperLib::IntPoint(7, 7) << ClipperLib::IntPoint(3, 7);
+
+    std::vector<ClipperLib::IntPoint> points;
+    std::vector<Triangulation::Triangle> triangles;
+    REQUIRE(Triangulation::triangulate(outline, ClipperLib::Paths(1, hole), points, triangles));
+    REQUIRE(triangles.size() == 8); //n + 2h - 2 triangles for n vertices and h holes
+
+    double area = 0;
+    for (Triangulation::Triangle & triangle : triangles) {
+        ClipperLib::Path path;
+        path << points[triangle[0]] << points[triangle[1]] << points[triangle[2]];
+        REQUIRE(ClipperLib::Area(path) >= 0);
+        area += ClipperLib::Area(path);
+    }
+    REQUIRE(area == 84);
+}
+
+TEST_CASE("decompose a mushroom into its stem and overhanging cap", "[VolumeDecomposer]") {
+    //cap starts between two slices so no face lies on a slicing plane
+    std::shared_ptr<Mesh> p_mesh = mushroomMesh(5000, 2050, 15000, 1000);
+
+    VolumeDecomposer decomposer((SlicerConfig()));
+    std::vector<std::shared_ptr<Mesh>> p_subMeshes = decomposer.run(p_mesh, Plane());
+
+    REQUIRE(p_subMeshes.size() == 2);
+    for (std::shared_ptr<Mesh> p_subMesh : p_subMeshes) {
+        REQUIRE(p_subMesh->p_faces().size() > 0);
+        for (std::shared_ptr<Mesh::Face> p_face : p_subMesh->p_faces()) {
+            REQUIRE(p_face->p_connectedFace(0) != nullptr);
+            REQUIRE(p_face->p_connectedFace(1) != nullptr);
+            REQUIRE(p_face->p_connectedFace(2) != nullptr);
+        }
+    }
+}